@@ -21,8 +21,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <wx/imagpng.h>
 #include <wx/imaglist.h>
 #include <wx/html/htmlwin.h>
+#include <wx/stopwatch.h>
 #include "global/ids.h"
-#include "global/Compatibility.h"
 #include "global/ProfileKeys.h"
 #include "generated/configure_launcher.h"
 #include "MainWindow.h"
@@ -32,11 +32,19 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "tabs/AdvSettingsPage.h"
 #include "tabs/InstallPage.h"
 #include "controls/BottomButtons.h"
+#include "controls/LaunchHistoryDialog.h"
 #include "apis/SkinManager.h"
 #include "controls/Logger.h"
 #include "controls/StatusBar.h"
 #include "apis/HelpManager.h"
 #include "apis/FREDManager.h"
+#include "apis/FlagListManager.h"
+#include "apis/HardwareProber.h"
+#include "apis/LaunchPipeline.h"
+#include "apis/ProcessSupervisor.h"
+#include "apis/TCManager.h"
+#include "apis/resolution_manager.hpp"
+#include "datastructures/LaunchPreset.h"
 
 #include "global/MemoryDebugging.h" // Last include for memory debugging
 
@@ -51,8 +59,10 @@ MainWindow::MainWindow() {
 	
 	SkinSystem::RegisterTCSkinChanged(this);
 
-	this->FS2_pid = 0;
-	this->FRED2_pid = 0;
+	this->processes = new ProcessSupervisor(this);
+	this->launch = NULL;
+	this->launchingFred = false;
+	this->launchPlanWasReady = false;
 
 	this->SetFont(SkinSystem::GetSkinSystem()->GetFont());
 	this->SetBackgroundColour(wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOW));
@@ -64,9 +74,10 @@ MainWindow::MainWindow() {
 #endif
 
 	// setup keyboard shortcuts
-	wxAcceleratorEntry entries[1];
+	wxAcceleratorEntry entries[2];
 	entries[0].Set(wxACCEL_NORMAL, WXK_F3, ID_F3_PRESSED);
-	wxAcceleratorTable accel(1, entries);
+	entries[1].Set(wxACCEL_NORMAL, WXK_F4, ID_F4_PRESSED);
+	wxAcceleratorTable accel(2, entries);
 	SetAcceleratorTable(accel);
 	
 	// setup tabs
@@ -94,10 +105,35 @@ MainWindow::MainWindow() {
 	this->SetSizerAndFit(sizer);
 	this->Layout();
 	this->Center();
+
+	// the pages have set up the managers by now. Changes to the profile are
+	// caught by its version, these are for changes that happen outside it
+	ProMan::GetProfileManager()->AddEventHandler(this);
+	TCManager::RegisterTCChanged(this);
+	TCManager::RegisterTCBinaryChanged(this);
+	TCManager::RegisterTCFredBinaryChanged(this);
+	FlagListManager::RegisterFlagFileProcessingStatusChanged(this);
 }
 
 MainWindow::~MainWindow() {
-	//
+	if (this->launch != NULL) {
+		this->launch->Cancel();
+		this->launch->Join();
+		delete this->launch;
+		this->launch = NULL;
+	}
+	// the game and FRED are left running
+	delete this->processes;
+	this->processes = NULL;
+	if (ProMan::IsInitialized()) {
+		ProMan::GetProfileManager()->RemoveEventHandler(this);
+	}
+	TCManager::UnRegisterTCChanged(this);
+	TCManager::UnRegisterTCBinaryChanged(this);
+	TCManager::UnRegisterTCFredBinaryChanged(this);
+	if (FlagListManager::IsInitialized()) {
+		FlagListManager::UnRegisterFlagFileProcessingStatusChanged(this);
+	}
 }
 
 BEGIN_EVENT_TABLE(MainWindow, wxFrame)
@@ -108,10 +144,19 @@ BEGIN_EVENT_TABLE(MainWindow, wxFrame)
 	EVT_BUTTON(ID_PLAY_BUTTON, MainWindow::OnFSButton)
 	EVT_BUTTON(ID_ABOUT_BUTTON, MainWindow::OnAbout)
 	EVT_HELP(wxID_ANY, MainWindow::OnContextHelp)
-	EVT_END_PROCESS(ID_FS2_PROCESS, MainWindow::OnFS2Exited)
-	EVT_END_PROCESS(ID_FRED2_PROCESS, MainWindow::OnFRED2Exited)
+	EVT_COMMAND(wxID_NONE, EVT_PROCESS_EXITED, MainWindow::OnProcessExited)
 	EVT_COMMAND(wxID_NONE, EVT_TC_SKIN_CHANGED, MainWindow::OnTCSkinChanged)
 	EVT_MENU(ID_F3_PRESSED, MainWindow::OnF3Pressed)
+	EVT_MENU(ID_F4_PRESSED, MainWindow::OnF4Pressed)
+	EVT_IDLE(MainWindow::OnIdle)
+	EVT_DISPLAY_CHANGED(MainWindow::OnDisplayChanged)
+	EVT_COMMAND(wxID_NONE, EVT_LAUNCH_STAGE_DONE, MainWindow::OnLaunchStageDone)
+	EVT_COMMAND(wxID_NONE, EVT_LAUNCH_PREPARED, MainWindow::OnLaunchPrepared)
+	EVT_COMMAND(wxID_NONE, EVT_CURRENT_PROFILE_CHANGED, MainWindow::OnLaunchInputsChanged)
+	EVT_COMMAND(wxID_NONE, EVT_TC_CHANGED, MainWindow::OnLaunchInputsChanged)
+	EVT_COMMAND(wxID_NONE, EVT_TC_BINARY_CHANGED, MainWindow::OnLaunchInputsChanged)
+	EVT_COMMAND(wxID_NONE, EVT_TC_FRED_BINARY_CHANGED, MainWindow::OnLaunchInputsChanged)
+	EVT_COMMAND(wxID_NONE, EVT_FLAG_FILE_PROCESSING_STATUS_CHANGED, MainWindow::OnLaunchInputsChanged)
 END_EVENT_TABLE()
 
 void MainWindow::OnQuit(wxCommandEvent& WXUNUSED(event)) {
@@ -132,7 +177,9 @@ void MainWindow::OnStartFred(wxCommandEvent& WXUNUSED(event)) {
 			wxWindow::FindWindowById(ID_FRED_BUTTON, this));
 		wxCHECK_RET(fred != NULL, _T("Unable to find FRED button"));
 
-		if (this->FRED2_pid == 0) {
+		if (this->launch != NULL && this->launchingFred) {
+			this->CancelLaunch(fred);
+		} else if (this->processes->CountRunning(RUN_FRED) == 0) {
 			this->OnStart(fred, true);
 		} else {
 			this->OnKill(fred, true);
@@ -146,138 +193,287 @@ void MainWindow::OnFSButton(wxCommandEvent& WXUNUSED(event)) {
 		wxWindow::FindWindowById(ID_PLAY_BUTTON, this));
 	wxCHECK_RET(play != NULL, _T("Unable to find play button"));
 
-	if (this->FS2_pid == 0) {
+	if (this->launch != NULL && !this->launchingFred) {
+		this->CancelLaunch(play);
+	} else if (this->processes->CountRunning(RUN_FS2) == 0
+		|| (this->launch == NULL && ::wxGetKeyState(WXK_SHIFT))) {
+		// shift starts another instance, e.g. for testing multiplayer
 		this->OnStart(play);
 	} else {
 		this->OnKill(play);
 	}
 }
 
-void MainWindow::OnStart(wxButton* button, bool startFred) {
-	button->SetLabel(_("Starting"));
-	button->Disable();
+LaunchPlan& MainWindow::GetLaunchPlan(bool forFred) {
+	return forFred ? this->fredPlan : this->gamePlan;
+}
 
-	const wxString defaultButtonValue((startFred)?_("FRED"):_("Play"));
-	const wxString cfgBinaryPath((startFred)? PRO_CFG_TC_CURRENT_FRED : PRO_CFG_TC_CURRENT_BINARY);
-	
+bool MainWindow::IsLaunchPlanCurrent(const LaunchPlan& plan) const {
+	return plan.isPrepared
+		&& plan.profileVersion == ProMan::GetProfileManager()->GetProfileVersion();
+}
+
+void MainWindow::InvalidateLaunchPlans() {
+	this->gamePlan.isPrepared = false;
+	this->fredPlan.isPrepared = false;
+}
+
+/** Works out how to launch the current profile's game or FRED executable.
+ Problems are stored in the plan rather than logged, as the user may never
+ press the button; OnStart() logs them if they do. */
+void MainWindow::PrepareLaunchPlan(LaunchPlan& plan, bool forFred) {
 	ProMan* p = ProMan::GetProfileManager();
-	wxString folder, binary;
-	if ( !p->ProfileRead(PRO_CFG_TC_ROOT_FOLDER, &folder) ) {
-		wxLogError(_T("Game root folder for current profile is not set (%s)"),
+	const wxString cfgBinaryPath((forFred)? PRO_CFG_TC_CURRENT_FRED : PRO_CFG_TC_CURRENT_BINARY);
+
+	plan = LaunchPlan();
+	plan.isPrepared = true;
+	plan.profileVersion = p->GetProfileVersion();
+	plan.profile = p->GetSnapshot();
+
+	wxString binary;
+	if ( !plan.profile.IsOk() ) {
+		plan.error = _T("There is no current profile to launch");
+		return;
+	}
+	if ( !plan.profile->Read(PRO_CFG_TC_ROOT_FOLDER, &plan.folder) ) {
+		plan.error = wxString::Format(_T("Game root folder for current profile is not set (%s)"),
 			PRO_CFG_TC_ROOT_FOLDER.c_str());
-		button->SetLabel(defaultButtonValue);
-		button->Enable();
 		return;
 	}
-	if ( !p->ProfileRead(cfgBinaryPath, &binary) ) {
-		wxLogError(_T("No FS2 Open executable has been selected (%s)"), cfgBinaryPath.c_str());
-		button->SetLabel(defaultButtonValue);
-		button->Enable();
+	if ( !plan.profile->Read(cfgBinaryPath, &binary) ) {
+		plan.error = wxString::Format(_T("No FS2 Open executable has been selected (%s)"),
+			cfgBinaryPath.c_str());
 		return;
 	}
 
 #if IS_APPLE
-	wxFileName path(folder + wxFileName::GetPathSeparator() + binary, wxPATH_NATIVE);
+	plan.path = wxFileName(plan.folder + wxFileName::GetPathSeparator() + binary, wxPATH_NATIVE);
 #else
-	wxFileName path(folder, binary, wxPATH_NATIVE);
+	plan.path = wxFileName(plan.folder, binary, wxPATH_NATIVE);
 #endif
 
-	if ( !path.FileExists() ) {
-		wxLogError(_T("Executable %s does not exist"), path.GetFullName().c_str());
-		button->SetLabel(defaultButtonValue);
-		button->Enable();
+	if ( !plan.path.FileExists() ) {
+		plan.error = wxString::Format(_T("Executable %s does not exist"),
+			plan.path.GetFullName().c_str());
 		return;
 	}
 
-	if (!Compatibility::MigrateOldConfig()) {
-		wxLogError(_T("Failed to migrate old config!!"));
-		button->SetLabel(defaultButtonValue);
-		button->Enable();
+	if ( !LaunchPreset::GetProcessOptions(*plan.profile, plan.options, plan.error) ) {
+		return;
+	}
+	// the launch history records how long the game takes to say anything
+	plan.options.trackFirstOutput = true;
+
+	// the "" correct for spaces in the path
+	if (plan.path.GetFullPath().Find(_T(" ")) != wxNOT_FOUND) {
+		plan.command = _T("\"") + plan.path.GetFullPath() + _T("\"");
+	} else {
+		plan.command = plan.path.GetFullPath();
+	}
+
+	plan.isOk = true;
+}
+
+void MainWindow::OnIdle(wxIdleEvent& event) {
+	event.Skip();
+	// a launch in progress is still using its plan
+	if (!ProMan::IsInitialized() || this->launch != NULL) {
 		return;
 	}
+	if (this->processes->CountRunning(RUN_FS2) == 0
+		&& !this->IsLaunchPlanCurrent(this->gamePlan)) {
+		this->PrepareLaunchPlan(this->gamePlan, false);
+		// one plan per idle event keeps the UI responsive
+		event.RequestMore();
+		return;
+	}
+
+	bool fredEnabled;
+	ProMan::GetProfileManager()->GlobalRead(GBL_CFG_OPT_CONFIG_FRED, &fredEnabled, false);
+	if (fredEnabled && this->processes->CountRunning(RUN_FRED) == 0
+		&& !this->IsLaunchPlanCurrent(this->fredPlan)) {
+		this->PrepareLaunchPlan(this->fredPlan, true);
+	}
+}
 
-	if ( ProMan::NoError != p->PushCurrentProfile() ) {
+/** The display modes found so far may no longer be there. */
+void MainWindow::OnDisplayChanged(wxDisplayChangedEvent& event) {
+	event.Skip();
+	ResolutionMan::FlagDisplaysChanged();
+	if (HardwareProber::IsInitialized()) {
+		HardwareProber::Get()->Probe();
+	}
+}
+
+void MainWindow::OnLaunchInputsChanged(wxCommandEvent& event) {
+	event.Skip();
+	this->InvalidateLaunchPlans();
+}
+
+void MainWindow::OnStart(wxButton* button, bool startFred) {
+	if ( this->launch != NULL ) {
+		wxLogWarning(_T("%s is already being started"),
+			this->launchingFred ? _T("FRED2 Open") : _T("FS2 Open"));
+		return;
+	}
+
+	this->clickToExec.Start();
+	button->SetLabel(_("Starting"));
+	button->Disable();
+
+	const wxString defaultButtonValue(this->GetIdleButtonLabel(startFred));
+	
+	LaunchPlan& plan = this->GetLaunchPlan(startFred);
+	this->launchPlanWasReady = this->IsLaunchPlanCurrent(plan);
+	if ( !this->launchPlanWasReady ) {
+		this->PrepareLaunchPlan(plan, startFred);
+	}
+	if ( !plan.isOk ) {
+		wxLogError(_T("%s"), plan.error.c_str());
 		button->SetLabel(defaultButtonValue);
 		button->Enable();
 		return;
 	}
-
-	if (!Compatibility::SynchronizeOldPilots(p)) {
-		wxLogError(_T("Failed to synchronize old pilot files!"));
+	// idle time may have passed since the plan was made
+	if ( this->launchPlanWasReady && !plan.path.FileExists() ) {
+		wxLogError(_T("Executable %s does not exist"), plan.path.GetFullName().c_str());
+		plan.isPrepared = false;
 		button->SetLabel(defaultButtonValue);
 		button->Enable();
 		return;
 	}
 
-#if !wxCHECK_VERSION(2, 9, 2)
-	wxString previousWorkingDir(::wxGetCwd());
-	// hopefully this doesn't goof anything up
-	if ( !::wxSetWorkingDirectory(folder) ) {
-		wxLogError(_T("Unable to change working directory to %s"),
-			folder.c_str());
+	this->pendingLaunch = LaunchRecord();
+	this->pendingLaunch.startedAt = wxDateTime::Now().GetTicks();
+	this->pendingLaunch.binary = plan.path.GetFullName();
+	plan.profile->Read(PRO_CFG_TC_CURRENT_MODLINE, &this->pendingLaunch.modLine, wxEmptyString);
+	plan.profile->Read(PRO_CFG_TC_CURRENT_FLAG_LINE, &this->pendingLaunch.flagLine, wxEmptyString);
+
+	this->launch = new LaunchPipeline(this, plan.profile, plan.folder);
+	this->launchingFred = startFred;
+	if ( !this->launch->Start() ) {
+		delete this->launch;
+		this->launch = NULL;
 		button->SetLabel(defaultButtonValue);
 		button->Enable();
 		return;
 	}
-#endif
 
-	if ( startFred ) {
-		this->process = new wxProcess(this, ID_FRED2_PROCESS);
-	} else {
-		this->process = new wxProcess(this, ID_FS2_PROCESS);
+	// until the executable has been started, the button cancels the launch
+	if ( this->launch != NULL ) {
+		button->SetLabel(_("Cancel"));
+		button->Enable();
 	}
+}
 
-	wxString command;
-	// the "" correct for spaces in the path
-	if (path.GetFullPath().Find(_T(" ")) != wxNOT_FOUND) {
-		command = _T("\"") + path.GetFullPath() + _T("\"");
-	} else {
-		command = path.GetFullPath();
+/** What the launch button says when nothing is being launched. */
+wxString MainWindow::GetIdleButtonLabel(bool forFred) const {
+	if (this->processes->CountRunning(forFred ? RUN_FRED : RUN_FS2) > 0) {
+		return _T("Kill");
 	}
+	return forFred ? _("FRED") : _("Play");
+}
 
-	wxLogDebug(_T("Starting a process using '%s'"), command.c_str());
+wxButton* MainWindow::GetLaunchButton(bool forFred) {
+	wxButton* button = dynamic_cast<wxButton*>(wxWindow::FindWindowById(
+		forFred ? ID_FRED_BUTTON : ID_PLAY_BUTTON, this));
+	wxASSERT_MSG(button != NULL, _T("Unable to find launch button"));
+	return button;
+}
 
-#if wxCHECK_VERSION(2, 9, 2)
-	wxExecuteEnv env;
-	env.cwd = folder;
+void MainWindow::CancelLaunch(wxButton* button) {
+	wxCHECK_RET(this->launch != NULL, _T("CancelLaunch called with no launch in progress"));
+	button->SetLabel(_("Cancelling"));
+	button->Disable();
+	this->launch->Cancel();
+}
 
-	long pid = ::wxExecute(command, wxEXEC_ASYNC, this->process, &env);
-#else
-	long pid = ::wxExecute(command, wxEXEC_ASYNC, this->process);
-#endif
+void MainWindow::OnLaunchStageDone(wxCommandEvent& event) {
+	const LaunchPipeline::Stage stage =
+		static_cast<LaunchPipeline::Stage>(event.GetInt());
+	wxLogStatus(_T("%s: done in %ldms (step %d of %d)"),
+		LaunchPipeline::GetStageDescription(stage).c_str(), event.GetExtraLong(),
+		stage + 1, static_cast<int>(LaunchPipeline::STAGE_COUNT));
+
+	// the pipeline's stages are the first phases of a launch
+	wxCOMPILE_TIME_ASSERT(static_cast<int>(LaunchPipeline::STAGE_EXEC)
+		== static_cast<int>(LaunchRecord::PHASE_EXEC), LaunchStagesMatchPhases);
+	if (stage < LaunchPipeline::STAGE_EXEC) {
+		this->pendingLaunch.phaseTimes[stage] = event.GetExtraLong();
+	}
+}
+
+void MainWindow::OnLaunchPrepared(wxCommandEvent& event) {
+	wxCHECK_RET(this->launch != NULL, _T("OnLaunchPrepared called with no launch in progress"));
 
-	if ( pid == 0 ) {
+	// a cancel that arrives after the last stage must still stop the exec
+	const bool wasCancelled = this->launch->IsCancelled();
+	this->launch->Join();
+	delete this->launch;
+	this->launch = NULL;
+
+	const bool startFred = this->launchingFred;
+	wxButton* button = this->GetLaunchButton(startFred);
+	wxCHECK_RET(button != NULL, _T("Unable to find launch button"));
+	const wxString defaultButtonValue(this->GetIdleButtonLabel(startFred));
+
+	if ( event.GetInt() != LaunchPipeline::RESULT_READY || wasCancelled ) {
+		if ( wasCancelled || event.GetInt() == LaunchPipeline::RESULT_CANCELLED ) {
+			wxLogStatus(_T("Launch cancelled"));
+		}
 		button->SetLabel(defaultButtonValue);
 		button->Enable();
 		return;
 	}
-	if ( startFred ) {
-		this->FRED2_pid = pid;
-		wxLogInfo(_T("FRED2 Open is now running..."));
+
+	button->SetLabel(_("Starting"));
+	button->Disable();
+	if ( this->ExecuteLaunchPlan(this->GetLaunchPlan(startFred), startFred) ) {
+		button->SetLabel(_T("Kill"));
 	} else {
-		this->FS2_pid = pid;
-		wxLogInfo(_T("FS2 Open is now running..."));
+		button->SetLabel(defaultButtonValue);
 	}
+	button->Enable();
+}
 
-#if !wxCHECK_VERSION(2, 9, 2)
-	if (!::wxSetWorkingDirectory(previousWorkingDir)) {
-		wxLogError(_T("Unable to change back to working directory %s"),
-			previousWorkingDir.c_str());
+/** Starts the executable. Returns true if it is now running. */
+bool MainWindow::ExecuteLaunchPlan(const LaunchPlan& plan, bool startFred) {
+	wxStopWatch execTimer;
+
+	const long run = this->processes->Start(startFred ? RUN_FRED : RUN_FS2,
+		plan.command, plan.folder, plan.options);
+	if ( run == 0 ) {
+		return false;
+	}
+	const long execTime = execTimer.Time();
+	this->pendingLaunch.phaseTimes[LaunchRecord::PHASE_EXEC] = execTime;
+	this->runLaunches[run] = this->pendingLaunch;
+	wxLogStatus(_T("%s: done in %ldms (step %d of %d)"),
+		LaunchPipeline::GetStageDescription(LaunchPipeline::STAGE_EXEC).c_str(),
+		execTime, static_cast<int>(LaunchPipeline::STAGE_COUNT),
+		static_cast<int>(LaunchPipeline::STAGE_COUNT));
+	wxLogInfo(_T("Started %s %ldms after the button was pressed (launch plan was %s)"),
+		plan.path.GetFullName().c_str(), this->clickToExec.Time(),
+		this->launchPlanWasReady ? _T("ready") : _T("made on click"));
+	if ( startFred ) {
+		wxLogInfo(_T("FRED2 Open is now running..."));
+	} else {
+		wxLogInfo(_T("FS2 Open is now running (%lu instances)..."),
+			static_cast<unsigned long>(this->processes->CountRunning(RUN_FS2)));
 	}
-#endif
 
-	button->SetLabel(_T("Kill"));
-	button->Enable();
+	return true;
 }
 
 void MainWindow::OnKill(wxButton* button, bool killFred) {
 	button->SetLabel(_T("Stopping"));
 	button->Disable();
 
-	int ret = ::wxKill((killFred)?this->FRED2_pid:this->FS2_pid, wxSIGKILL);
-	if ( ret != wxKILL_OK ) {
-		wxLogError(_T("Got KillError %d"), ret);
-		wxLogError(_T("Failed to kill %s process!"), killFred?_T("FRED2 Open"):_T("FS2 Open"));
+	// asks nicely first, and kills whatever hasn't exited a while later
+	if ( this->processes->StopAll(killFred ? RUN_FRED : RUN_FS2) == 0 ) {
+		wxLogError(_T("Failed to stop %s!"), killFred?_T("FRED2 Open"):_T("FS2 Open"));
+		button->SetLabel(_T("Kill"));
+		button->Enable();
 	}
 }
 
@@ -294,46 +490,45 @@ void MainWindow::OnContextHelp(wxHelpEvent& event) {
 	HelpManager::OpenHelpById((WindowIDS)event.GetId());
 }
 
-void MainWindow::OnFS2Exited(wxProcessEvent &event) {
-	if ( this->FS2_pid == 0 ) {
-		wxLogError(_T("OnFS2Exited called before there is a process running"));
+void MainWindow::OnProcessExited(wxCommandEvent& event) {
+	ProcessRun run;
+	if ( !this->processes->TakeFinishedRun(event.GetExtraLong(), run) ) {
+		wxLogError(_T("OnProcessExited called for a process that is not running"));
 		return;
 	}
 
-	int exitCode = event.GetExitCode();
-
-	wxLogInfo(_T("FS2 Open exited with a status of %d"), exitCode);
+	const bool isFred = (run.tag == RUN_FRED);
+	const wxChar* name = isFred ? _T("FRED2 Open") : _T("FS2 Open");
+	if ( run.exitSignal != 0 ) {
+		wxLogInfo(_T("%s was ended by signal %d%s"), name, run.exitSignal,
+			run.wasKilled ? _T(" after it did not stop when asked") : _T(""));
+	} else {
+		wxLogInfo(_T("%s exited with a status of %d"), name, run.exitCode);
+	}
+	if ( run.hasUsage ) {
+		wxLogInfo(_T("%s ran for %.1fs using %.2fs user and %.2fs system CPU time,")
+			_T(" %ld KB at most, %ld minor and %ld major page faults"),
+			name, run.runTime / 1000.0, run.userSeconds, run.systemSeconds,
+			run.maxResidentKB, run.minorFaults, run.majorFaults);
+	}
 
-	delete this->process;
-	this->process = NULL;
-	this->FS2_pid = 0;
-	
-	wxButton* play = dynamic_cast<wxButton*>(
-		wxWindow::FindWindowById(ID_PLAY_BUTTON, this));
-	wxCHECK_RET(play != NULL, _T("Unable to find play button"));
-	play->SetLabel(_T("Play"));
-	play->Enable();	
-}
+	std::map<long, LaunchRecord>::iterator launch = this->runLaunches.find(run.id);
+	if ( launch != this->runLaunches.end() ) {
+		launch->second.phaseTimes[LaunchRecord::PHASE_FIRST_OUTPUT] = run.firstOutputTime;
+		launch->second.phaseTimes[LaunchRecord::PHASE_RUN] = run.runTime;
+		launch->second.exitCode = run.exitCode;
+		LaunchHistory::Append(launch->second);
+		this->runLaunches.erase(launch);
+	}
 
-void MainWindow::OnFRED2Exited(wxProcessEvent &event) {
-	if ( this->FRED2_pid == 0 ) {
-		wxLogError(_T("OnFRED2Exited called before there is a process running"));
+	// the button stays Kill while other instances are running
+	if ( this->processes->CountRunning(run.tag) > 0 ) {
 		return;
 	}
-
-	int exitCode = event.GetExitCode();
-
-	wxLogInfo(_T("FRED2 Open exited with a status of %d"), exitCode);
-
-	delete this->process;
-	this->process = NULL;
-	this->FRED2_pid = 0;
-	
-	wxButton* fred = dynamic_cast<wxButton*>(
-		wxWindow::FindWindowById(ID_FRED_BUTTON, this));
-	wxCHECK_RET(fred != NULL, _T("Unable to find FRED button"));
-	fred->SetLabel(_T("FRED"));
-	fred->Enable();
+	wxButton* button = this->GetLaunchButton(isFred);
+	wxCHECK_RET(button != NULL, _T("Unable to find launch button"));
+	button->SetLabel(this->GetIdleButtonLabel(isFred));
+	button->Enable();
 }
 
 void MainWindow::OnTCSkinChanged(wxCommandEvent& event) {
@@ -351,3 +546,8 @@ void MainWindow::OnF3Pressed(wxCommandEvent& WXUNUSED(event)) {
 	proman->GlobalWrite(GBL_CFG_OPT_CONFIG_FRED, !fredEnabled);
 	FREDManager::GenerateFREDEnabledChanged();
 }
+
+void MainWindow::OnF4Pressed(wxCommandEvent& WXUNUSED(event)) {
+	LaunchHistoryDialog dialog(this);
+	dialog.ShowModal();
+}
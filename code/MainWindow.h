@@ -21,7 +21,30 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <wx/wx.h>
 #include <wx/notebook.h>
-#include <wx/process.h>
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+#include "apis/ProcessSupervisor.h"
+#include "datastructures/LaunchHistory.h"
+#include "datastructures/ProfileSnapshot.h"
+
+#include <map>
+
+class LaunchPipeline;
+
+/** Everything OnStart() needs to launch FS2 Open or FRED, worked out while
+ the launcher is idle so that pressing the button only has to run it. */
+struct LaunchPlan {
+	LaunchPlan() : isPrepared(false), isOk(false), profileVersion(0) { }
+	bool isPrepared; //!< false until prepared, and again once the plan is stale
+	bool isOk; //!< false if the current profile can't be launched; see error
+	unsigned long profileVersion; //!< ProMan::GetProfileVersion() the plan was made for
+	ProfileSnapshotPtr profile; //!< the settings that will be pushed
+	wxString folder; //!< working directory
+	wxFileName path; //!< the executable
+	wxString command;
+	ProcessOptions options; //!< from the profile's launch preset and CPUs
+	wxString error;
+};
 
 class MainWindow: public wxFrame {
 public:
@@ -37,17 +60,44 @@ public:
 	void OnUpdate(wxCommandEvent& event);
 	void OnAbout(wxCommandEvent& event);
 	void OnContextHelp(wxHelpEvent& event);
-	void OnFS2Exited(wxProcessEvent& event);
-	void OnFRED2Exited(wxProcessEvent& event);
+	void OnProcessExited(wxCommandEvent& event);
 	void OnTCSkinChanged(wxCommandEvent& event);
+	void OnIdle(wxIdleEvent& event);
+	void OnDisplayChanged(wxDisplayChangedEvent& event);
+	void OnLaunchInputsChanged(wxCommandEvent& event);
+	void OnLaunchStageDone(wxCommandEvent& event);
+	void OnLaunchPrepared(wxCommandEvent& event);
 	
 	/** F3 toggles FRED launching. */
 	void OnF3Pressed(wxCommandEvent& event);
+	/** F4 shows how long launches have taken. */
+	void OnF4Pressed(wxCommandEvent& event);
 
 private:
-	wxProcess* process;
+	LaunchPlan& GetLaunchPlan(bool forFred);
+	void PrepareLaunchPlan(LaunchPlan& plan, bool forFred);
+	bool IsLaunchPlanCurrent(const LaunchPlan& plan) const;
+	void InvalidateLaunchPlans();
+	bool ExecuteLaunchPlan(const LaunchPlan& plan, bool startFred);
+	wxButton* GetLaunchButton(bool forFred);
+	wxString GetIdleButtonLabel(bool forFred) const;
+	void CancelLaunch(wxButton* button);
+
+	/** Tags for the processes the supervisor runs. */
+	enum RunTag {
+		RUN_FS2,
+		RUN_FRED
+	};
+
+	ProcessSupervisor* processes;
+	LaunchPlan gamePlan, fredPlan;
+	LaunchPipeline* launch; //!< the launch in progress, if any; only one at a time
+	bool launchingFred;
+	bool launchPlanWasReady; //!< whether the launch in progress found its plan already made
+	wxStopWatch clickToExec;
+	LaunchRecord pendingLaunch; //!< the timings of the launch in progress
+	std::map<long, LaunchRecord> runLaunches; //!< by run id, until the run exits
 	wxNotebook* mainTab;
-	long FS2_pid, FRED2_pid;
 
 	DECLARE_EVENT_TABLE();
 };
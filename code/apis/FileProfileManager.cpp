@@ -25,7 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "apis/ProfileManager.h"
 #include "apis/PlatformProfileManager.h"
 #include "apis/FlagListManager.h"
-#include "apis/JoystickManager.h"
+#include "global/AtomicFileBatch.h"
 #include "global/BasicDefaults.h"
 #include "global/ProfileKeys.h"
 #include "global/RegistryKeys.h"
@@ -67,15 +67,17 @@ wxFileName GetPlatformDefaultConfigFilePathNew() {
 	return path;
 }
 
-wxFileName GetPlatformDefaultConfigFilePath(const wxString& tcPath) {
+wxFileName GetPlatformDefaultConfigFilePath(const ProfileSnapshot& profile) {
 	wxFileName path;
-	if (FlagListManager::GetFlagListManager()->GetBuildCaps() & FlagListManager::BUILD_CAPS_SDL) {
-		path = GetPlatformDefaultConfigFilePathNew();
+	if (GetLaunchBuildCaps(profile) & FlagListManager::BUILD_CAPS_SDL) {
+		path = GetLaunchPrefFolder(profile);
 	}
 	else {
 #if IS_LINUX || IS_APPLE // write to folder in home dir
 		path = GetPlatformDefaultConfigFilePathOld().GetFullPath().c_str();
 #else
+		wxString tcPath;
+		profile.Read(PRO_CFG_TC_ROOT_FOLDER, &tcPath);
 		path.AssignDir(tcPath);
 #endif
 	}
@@ -91,31 +93,60 @@ wxFileName GetPlatformDefaultConfigFilePath(const wxString& tcPath) {
 		return ProMan::UnknownError;\
 	}
 
-ProMan::RegistryCodes FilePushProfile(wxFileConfig *cfg) {
-	wxFileName configFileName;
-	wxString tcPath;
-	cfg->Read(PRO_CFG_TC_ROOT_FOLDER, &tcPath);
+/** Every profile key that WriteConfigFile() reads. */
+static const wxString* const FILE_PUSH_KEYS[] = {
+	&PRO_CFG_VIDEO_RESOLUTION_WIDTH,
+	&PRO_CFG_VIDEO_RESOLUTION_HEIGHT,
+	&PRO_CFG_VIDEO_BIT_DEPTH,
+	&PRO_CFG_VIDEO_TEXTURE_FILTER,
+	&PRO_CFG_VIDEO_ANISOTROPIC,
+	&PRO_CFG_VIDEO_ANTI_ALIAS,
+	&PRO_CFG_OPENAL_DEVICE,
+	&PRO_CFG_OPENAL_CAPTURE_DEVICE,
+	&PRO_CFG_OPENAL_EFX,
+	&PRO_CFG_OPENAL_SAMPLE_RATE,
+	&PRO_CFG_SPEECH_VOICE,
+	&PRO_CFG_SPEECH_VOLUME,
+	&PRO_CFG_SPEECH_IN_TECHROOM,
+	&PRO_CFG_SPEECH_IN_BRIEFINGS,
+	&PRO_CFG_SPEECH_IN_GAME,
+	&PRO_CFG_SPEECH_IN_MULTI,
+	&PRO_CFG_JOYSTICK_ID,
+	&PRO_CFG_JOYSTICK_FORCE_FEEDBACK,
+	&PRO_CFG_JOYSTICK_DIRECTIONAL,
+	&PRO_CFG_NETWORK_TYPE,
+	&PRO_CFG_NETWORK_SPEED,
+	&PRO_CFG_NETWORK_PORT,
+	&PRO_CFG_NETWORK_IP,
+};
+
+/** Writes value to key unless the config already holds exactly that,
+ counting the keys that did need writing in changedKeys. */
+static bool WriteIfChanged(wxFileConfig& config, const wxString& key,
+	const wxString& value, size_t& changedKeys) {
+	wxString existing;
+	if (config.Read(key, &existing) && existing == value) {
+		return true;
+	}
+	changedKeys++;
+	return config.Write(key, value);
+}
 
-	if ( cfg->Exists(INT_CONFIG_FILE_LOCATION) ) {
-		wxString configFileNameString;
-		if (cfg->Read(INT_CONFIG_FILE_LOCATION, &configFileNameString)) {
-			configFileName.Assign(configFileNameString);
-		} else {
-			wxLogError(_T("Unable to retrieve Config File location even though config says key exists"));
-			return ProMan::UnknownError;
-		}
-	} else {
-		configFileName = GetPlatformDefaultConfigFilePath(tcPath);
-	}
-	wxASSERT_MSG( configFileName.Normalize(),
-		wxString::Format(_T("Unable to normalize PlatformDefaultConfigFilePath (%s)"),
-		configFileName.GetFullPath().c_str()));
+static bool WriteIfChanged(wxFileConfig& config, const wxString& key,
+	long value, size_t& changedKeys) {
+	// wxFileConfig stores numbers as their decimal text
+	return WriteIfChanged(config, key, wxString::Format(_T("%ld"), value), changedKeys);
+}
 
-	if ( !configFileName.FileExists() && configFileName.DirExists() ) {
-		// was given a directory name
-		configFileName.SetFullName(FSO_CONFIG_FILENAME);
-	}
+static bool WriteIfChanged(wxFileConfig& config, const wxString& key,
+	int value, size_t& changedKeys) {
+	return WriteIfChanged(config, key, static_cast<long>(value), changedKeys);
+}
 
+/** Updates the settings in fs2_open.ini, only writing the file if
+ any of them differ from what it already has. */
+static ProMan::RegistryCodes WriteConfigFile(const ProfileSnapshot& profile,
+	const wxFileName& configFileName) {
 	wxFFileInputStream configFileInputStream(configFileName.GetFullPath());
 	wxStringInputStream configBlankInputStream(_T("")); // in case ini file doesn't exist
 	wxInputStream* configInputStreamPtr = &configFileInputStream;
@@ -126,52 +157,54 @@ ProMan::RegistryCodes FilePushProfile(wxFileConfig *cfg) {
 		configInputStreamPtr = &configBlankInputStream;
 	}
 	wxFileConfig outConfig(*configInputStreamPtr, wxMBConvUTF8());
+	outConfig.SetExpandEnvVars(false);
 	bool ret;
+	size_t changedKeys = 0;
 	
 	// most settings are written to "Default" folder
 	outConfig.SetPath(REG_KEY_DEFAULT_FOLDER_CFG);
 
 	// Video
 	int width, height, bitdepth;
-	cfg->Read(PRO_CFG_VIDEO_RESOLUTION_WIDTH, &width, DEFAULT_VIDEO_RESOLUTION_WIDTH);
-	cfg->Read(PRO_CFG_VIDEO_RESOLUTION_HEIGHT, &height, DEFAULT_VIDEO_RESOLUTION_HEIGHT);
-	cfg->Read(PRO_CFG_VIDEO_BIT_DEPTH, &bitdepth, DEFAULT_VIDEO_BIT_DEPTH);
+	profile.Read(PRO_CFG_VIDEO_RESOLUTION_WIDTH, &width, DEFAULT_VIDEO_RESOLUTION_WIDTH);
+	profile.Read(PRO_CFG_VIDEO_RESOLUTION_HEIGHT, &height, DEFAULT_VIDEO_RESOLUTION_HEIGHT);
+	profile.Read(PRO_CFG_VIDEO_BIT_DEPTH, &bitdepth, DEFAULT_VIDEO_BIT_DEPTH);
 
 	wxString videocardValue = wxString::Format(_T("OGL -(%dx%d)x%d bit"), width, height, bitdepth);
 
-	ret = outConfig.Write(REG_KEY_VIDEO_RESOLUTION_DEPTH, videocardValue);
+	ret = WriteIfChanged(outConfig, REG_KEY_VIDEO_RESOLUTION_DEPTH, videocardValue, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 	
 	wxString filterMethod;
-	cfg->Read(PRO_CFG_VIDEO_TEXTURE_FILTER, &filterMethod, DEFAULT_VIDEO_TEXTURE_FILTER);
+	profile.Read(PRO_CFG_VIDEO_TEXTURE_FILTER, &filterMethod, DEFAULT_VIDEO_TEXTURE_FILTER);
 	int filterMethodValue = ( filterMethod.StartsWith(_T("Bilinear"))) ? 0 : 1;
 	
-	ret = outConfig.Write(REG_KEY_VIDEO_TEXTURE_FILTER, filterMethodValue);
+	ret = WriteIfChanged(outConfig, REG_KEY_VIDEO_TEXTURE_FILTER, filterMethodValue, changedKeys);
 	ReturnChecker(ret, __LINE__);
 	
 
 	int oglAnisotropicFilter;
-	cfg->Read(PRO_CFG_VIDEO_ANISOTROPIC, &oglAnisotropicFilter, DEFAULT_VIDEO_ANISOTROPIC);
+	profile.Read(PRO_CFG_VIDEO_ANISOTROPIC, &oglAnisotropicFilter, DEFAULT_VIDEO_ANISOTROPIC);
 
 	// Caution: FSO expects anisotropic values to be a string,
 	// but since we're writing to an .ini file, we can write it out as an int
-	ret = outConfig.Write(REG_KEY_VIDEO_ANISOTROPIC, oglAnisotropicFilter);
+	ret = WriteIfChanged(outConfig, REG_KEY_VIDEO_ANISOTROPIC, oglAnisotropicFilter, changedKeys);
 	ReturnChecker(ret, __LINE__);
 	
 
 	int oglAntiAliasSample;
-	cfg->Read(PRO_CFG_VIDEO_ANTI_ALIAS, &oglAntiAliasSample, DEFAULT_VIDEO_ANTI_ALIAS);
+	profile.Read(PRO_CFG_VIDEO_ANTI_ALIAS, &oglAntiAliasSample, DEFAULT_VIDEO_ANTI_ALIAS);
 
-	ret = outConfig.Write(REG_KEY_VIDEO_ANTI_ALIAS, oglAntiAliasSample);
+	ret = WriteIfChanged(outConfig, REG_KEY_VIDEO_ANTI_ALIAS, oglAntiAliasSample, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	// Audio
 	wxString soundDevice;
-	cfg->Read(PRO_CFG_OPENAL_DEVICE, &soundDevice, DEFAULT_AUDIO_OPENAL_DEVICE);
+	profile.Read(PRO_CFG_OPENAL_DEVICE, &soundDevice, DEFAULT_AUDIO_OPENAL_DEVICE);
 
-	ret = outConfig.Write(REG_KEY_AUDIO_OPENAL_DEVICE, soundDevice);
+	ret = WriteIfChanged(outConfig, REG_KEY_AUDIO_OPENAL_DEVICE, soundDevice, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
@@ -180,44 +213,44 @@ ProMan::RegistryCodes FilePushProfile(wxFileConfig *cfg) {
 
 
 	wxString playbackDevice;
-	cfg->Read(
+	profile.Read(
 		PRO_CFG_OPENAL_DEVICE,
 		&playbackDevice,
 		DEFAULT_AUDIO_OPENAL_PLAYBACK_DEVICE);
 
-	ret = outConfig.Write(REG_KEY_AUDIO_OPENAL_PLAYBACK_DEVICE, playbackDevice);
+	ret = WriteIfChanged(outConfig, REG_KEY_AUDIO_OPENAL_PLAYBACK_DEVICE, playbackDevice, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	wxString captureDevice;
-	bool hasEntry = cfg->Read(
+	bool hasEntry = profile.Read(
 		PRO_CFG_OPENAL_CAPTURE_DEVICE,
 		&captureDevice,
 		DEFAULT_AUDIO_OPENAL_CAPTURE_DEVICE);
 
 	if (hasEntry) {
-		ret = outConfig.Write(REG_KEY_AUDIO_OPENAL_CAPTURE_DEVICE, captureDevice);
+		ret = WriteIfChanged(outConfig, REG_KEY_AUDIO_OPENAL_CAPTURE_DEVICE, captureDevice, changedKeys);
 		ReturnChecker(ret, __LINE__);
 	}
 
 
 	int enableEFX;
-	hasEntry = cfg->Read(PRO_CFG_OPENAL_EFX, &enableEFX, DEFAULT_AUDIO_OPENAL_EFX);
+	hasEntry = profile.Read(PRO_CFG_OPENAL_EFX, &enableEFX, DEFAULT_AUDIO_OPENAL_EFX);
 
 	if (hasEntry) {
-		ret = outConfig.Write(REG_KEY_AUDIO_OPENAL_EFX, enableEFX);
+		ret = WriteIfChanged(outConfig, REG_KEY_AUDIO_OPENAL_EFX, enableEFX, changedKeys);
 		ReturnChecker(ret, __LINE__);
 	}
 
 
 	int sampleRate;
-	cfg->Read(
+	profile.Read(
 		PRO_CFG_OPENAL_SAMPLE_RATE,
 		&sampleRate,
 		DEFAULT_AUDIO_OPENAL_SAMPLE_RATE);
 
 	if (sampleRate != DEFAULT_AUDIO_OPENAL_SAMPLE_RATE) {
-		ret = outConfig.Write(REG_KEY_AUDIO_OPENAL_SAMPLE_RATE, sampleRate);
+		ret = WriteIfChanged(outConfig, REG_KEY_AUDIO_OPENAL_SAMPLE_RATE, sampleRate, changedKeys);
 		ReturnChecker(ret, __LINE__);
 	}
 
@@ -228,93 +261,94 @@ ProMan::RegistryCodes FilePushProfile(wxFileConfig *cfg) {
 	// Speech
 #if IS_WIN32 // speech is currently not supported in OS X or Linux (although Windows doesn't use this code)
 	int speechVoice;
-	cfg->Read(PRO_CFG_SPEECH_VOICE, &speechVoice, DEFAULT_SPEECH_VOICE);
+	profile.Read(PRO_CFG_SPEECH_VOICE, &speechVoice, DEFAULT_SPEECH_VOICE);
 
-	ret = outConfig.Write(REG_KEY_SPEECH_VOICE, speechVoice);
+	ret = WriteIfChanged(outConfig, REG_KEY_SPEECH_VOICE, speechVoice, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	int speechVolume;
-	cfg->Read(PRO_CFG_SPEECH_VOLUME, &speechVolume, DEFAULT_SPEECH_VOLUME);
+	profile.Read(PRO_CFG_SPEECH_VOLUME, &speechVolume, DEFAULT_SPEECH_VOLUME);
 
-	ret = outConfig.Write(REG_KEY_SPEECH_VOLUME, speechVolume);
+	ret = WriteIfChanged(outConfig, REG_KEY_SPEECH_VOLUME, speechVolume, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	int inTechroom, inBriefings, inGame, inMulti;
-	cfg->Read(PRO_CFG_SPEECH_IN_TECHROOM, &inTechroom, DEFAULT_SPEECH_IN_TECHROOM);
-	cfg->Read(PRO_CFG_SPEECH_IN_BRIEFINGS, &inBriefings, DEFAULT_SPEECH_IN_BRIEFINGS);
-	cfg->Read(PRO_CFG_SPEECH_IN_GAME, &inGame, DEFAULT_SPEECH_IN_GAME);
-	cfg->Read(PRO_CFG_SPEECH_IN_MULTI, &inMulti, DEFAULT_SPEECH_IN_MULTI);
+	profile.Read(PRO_CFG_SPEECH_IN_TECHROOM, &inTechroom, DEFAULT_SPEECH_IN_TECHROOM);
+	profile.Read(PRO_CFG_SPEECH_IN_BRIEFINGS, &inBriefings, DEFAULT_SPEECH_IN_BRIEFINGS);
+	profile.Read(PRO_CFG_SPEECH_IN_GAME, &inGame, DEFAULT_SPEECH_IN_GAME);
+	profile.Read(PRO_CFG_SPEECH_IN_MULTI, &inMulti, DEFAULT_SPEECH_IN_MULTI);
 
-	ret = outConfig.Write(REG_KEY_SPEECH_IN_TECHROOM, inTechroom);
+	ret = WriteIfChanged(outConfig, REG_KEY_SPEECH_IN_TECHROOM, inTechroom, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
-	ret = outConfig.Write(REG_KEY_SPEECH_IN_BRIEFINGS, inBriefings);
+	ret = WriteIfChanged(outConfig, REG_KEY_SPEECH_IN_BRIEFINGS, inBriefings, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
-	ret = outConfig.Write(REG_KEY_SPEECH_IN_GAME, inGame);
+	ret = WriteIfChanged(outConfig, REG_KEY_SPEECH_IN_GAME, inGame, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
-	ret = outConfig.Write(REG_KEY_SPEECH_IN_MULTI, inMulti);
+	ret = WriteIfChanged(outConfig, REG_KEY_SPEECH_IN_MULTI, inMulti, changedKeys);
 	ReturnChecker(ret, __LINE__);
 #endif
 
 
 	// Joystick
 	int currentJoystick;
-	cfg->Read(PRO_CFG_JOYSTICK_ID, &currentJoystick, DEFAULT_JOYSTICK_ID);
+	profile.Read(PRO_CFG_JOYSTICK_ID, &currentJoystick, DEFAULT_JOYSTICK_ID);
 
-	ret = outConfig.Write(REG_KEY_JOYSTICK_ID, currentJoystick);
+	ret = WriteIfChanged(outConfig, REG_KEY_JOYSTICK_ID, currentJoystick, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 	// Joystick GUID
-	wxString currentJoystickGUID = JoyMan::JoystickGUID(currentJoystick);
+	wxString currentJoystickGUID = GetLaunchJoystickGUID(profile);
 
-	ret = outConfig.Write(REG_KEY_JOYSTICK_GUID, currentJoystickGUID);
+	ret = WriteIfChanged(outConfig, REG_KEY_JOYSTICK_GUID, currentJoystickGUID, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	int joystickForceFeedback;
-	cfg->Read(
+	profile.Read(
 		PRO_CFG_JOYSTICK_FORCE_FEEDBACK,
 		&joystickForceFeedback,
 		DEFAULT_JOYSTICK_FORCE_FEEDBACK);
 
-	ret = outConfig.Write(REG_KEY_JOYSTICK_FORCE_FEEDBACK, joystickForceFeedback);
+	ret = WriteIfChanged(outConfig, REG_KEY_JOYSTICK_FORCE_FEEDBACK, joystickForceFeedback, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	int joystickHit;
-	cfg->Read(PRO_CFG_JOYSTICK_DIRECTIONAL, &joystickHit, DEFAULT_JOYSTICK_DIRECTIONAL);
+	profile.Read(PRO_CFG_JOYSTICK_DIRECTIONAL, &joystickHit, DEFAULT_JOYSTICK_DIRECTIONAL);
 
-	ret = outConfig.Write(REG_KEY_JOYSTICK_DIRECTIONAL, joystickHit);
+	ret = WriteIfChanged(outConfig, REG_KEY_JOYSTICK_DIRECTIONAL, joystickHit, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	// Network
 	wxString networkConnectionValue;
-	cfg->Read(PRO_CFG_NETWORK_TYPE, &networkConnectionValue, DEFAULT_NETWORK_TYPE);
+	profile.Read(PRO_CFG_NETWORK_TYPE, &networkConnectionValue, DEFAULT_NETWORK_TYPE);
 
-	ret = outConfig.Write(REG_KEY_NETWORK_TYPE, networkConnectionValue);
+	ret = WriteIfChanged(outConfig, REG_KEY_NETWORK_TYPE, networkConnectionValue, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	wxString connectionSpeedValue;
-	cfg->Read(PRO_CFG_NETWORK_SPEED, &connectionSpeedValue, DEFAULT_NETWORK_SPEED);
+	profile.Read(PRO_CFG_NETWORK_SPEED, &connectionSpeedValue, DEFAULT_NETWORK_SPEED);
 
-	ret = outConfig.Write(REG_KEY_NETWORK_SPEED, connectionSpeedValue);
+	ret = WriteIfChanged(outConfig, REG_KEY_NETWORK_SPEED, connectionSpeedValue, changedKeys);
 	ReturnChecker(ret, __LINE__);
 
 
 	int forcedport;
-	cfg->Read(PRO_CFG_NETWORK_PORT, &forcedport, DEFAULT_NETWORK_PORT);
+	profile.Read(PRO_CFG_NETWORK_PORT, &forcedport, DEFAULT_NETWORK_PORT);
 
 	if (forcedport != DEFAULT_NETWORK_PORT) {
-		ret = outConfig.Write(REG_KEY_NETWORK_PORT, forcedport);
+		ret = WriteIfChanged(outConfig, REG_KEY_NETWORK_PORT, forcedport, changedKeys);
 		ReturnChecker(ret, __LINE__);
 	} else if (outConfig.Exists(REG_KEY_NETWORK_PORT)) {
 		ret = outConfig.DeleteEntry(REG_KEY_NETWORK_PORT, false);
+		changedKeys++;
 		ReturnChecker(ret, __LINE__);
 	}
 
@@ -323,25 +357,75 @@ ProMan::RegistryCodes FilePushProfile(wxFileConfig *cfg) {
 	outConfig.SetPath(REG_KEY_NETWORK_FOLDER_CFG);
 
 	wxString networkIP;
-	cfg->Read(PRO_CFG_NETWORK_IP, &networkIP, DEFAULT_NETWORK_IP);
+	profile.Read(PRO_CFG_NETWORK_IP, &networkIP, DEFAULT_NETWORK_IP);
 
 	if (networkIP != DEFAULT_NETWORK_IP) {
-		ret = outConfig.Write(REG_KEY_NETWORK_IP, networkIP);
+		ret = WriteIfChanged(outConfig, REG_KEY_NETWORK_IP, networkIP, changedKeys);
 		ReturnChecker(ret, __LINE__);
 	} else if (outConfig.Exists(REG_KEY_NETWORK_IP)) {
 		ret = outConfig.DeleteEntry(REG_KEY_NETWORK_IP, false);
+		changedKeys++;
 		ReturnChecker(ret, __LINE__);
 	}
 
 	outConfig.SetPath(REG_KEY_DEFAULT_FOLDER_CFG);
 
 
-	wxLogDebug(_T("Writing fs2_open.ini to %s"), configFileName.GetFullPath().c_str());
-	wxFFileOutputStream outFileStream(configFileName.GetFullPath());
+	if (changedKeys == 0 && configFileInputStream.IsOk()) {
+		wxLogDebug(_T("fs2_open.ini at %s already has the current settings"),
+			configFileName.GetFullPath().c_str());
+		return ProMan::NoError;
+	}
+
+	wxLogDebug(_T("Writing %lu changed setting(s) to fs2_open.ini at %s"),
+		static_cast<unsigned long>(changedKeys), configFileName.GetFullPath().c_str());
+	AtomicFileBatch batch;
+	if (!batch.Save(outConfig, configFileName) || !batch.Commit()) {
+		return ProMan::UnknownError;
+	}
 
-	outConfig.Save(outFileStream);
+	return ProMan::NoError;
+}
+
+ProMan::RegistryCodes FilePushProfile(const ProfileSnapshot& profile) {
+	wxFileName configFileName;
+
+	if ( profile.Exists(INT_CONFIG_FILE_LOCATION) ) {
+		wxString configFileNameString;
+		if (profile.Read(INT_CONFIG_FILE_LOCATION, &configFileNameString)) {
+			configFileName.Assign(configFileNameString);
+		} else {
+			wxLogError(_T("Unable to retrieve Config File location even though config says key exists"));
+			return ProMan::UnknownError;
+		}
+	} else {
+		configFileName = GetPlatformDefaultConfigFilePath(profile);
+	}
+	wxASSERT_MSG( configFileName.Normalize(),
+		wxString::Format(_T("Unable to normalize PlatformDefaultConfigFilePath (%s)"),
+		configFileName.GetFullPath().c_str()));
+
+	if ( !configFileName.FileExists() && configFileName.DirExists() ) {
+		// was given a directory name
+		configFileName.SetFullName(FSO_CONFIG_FILENAME);
+	}
+
+	// the GUID is part of the fingerprint because the same joystick id can
+	// refer to a different stick once devices are plugged in or removed
+	const wxString fingerprint(MakePushFingerprint(profile,
+		FILE_PUSH_KEYS, WXSIZEOF(FILE_PUSH_KEYS))
+		+ GetLaunchJoystickGUID(profile));
+	if (IsPushCurrent(configFileName, fingerprint)) {
+		wxLogDebug(_T("%s is up to date"), configFileName.GetFullPath().c_str());
+	} else {
+		ProMan::RegistryCodes code = WriteConfigFile(profile, configFileName);
+		if (code != ProMan::NoError) {
+			return code;
+		}
+		RememberPush(configFileName, fingerprint);
+	}
 
-	return PushCmdlineFSO(cfg);
+	return PushCmdlineFSO(profile);
 }
 
 ProMan::RegistryCodes FilePullProfile(wxFileConfig *cfg) {
@@ -66,6 +66,9 @@ public:
 	/** Returns true when the flag file processing has succeeded, false otherwise. */
 	inline bool IsProcessingOK() const { return (this->processingStatus == PROCESSING_OK); }
 	
+	/** Returns the high-level status of flag file processing. */
+	FlagFileProcessingStatus GetFlagFileProcessingStatus() const;
+	
 	/** Returns the message to display when processing has not (yet) succeded.
 	 This function should not called when processing has succeeded. */
 	wxString GetStatusMessage() const;
@@ -114,7 +117,6 @@ private:
 	
 	void SetProcessingStatus(const ProcessingStatus& processingStatus);
 	inline const ProcessingStatus& GetProcessingStatus() const { return this->processingStatus; }
-	FlagFileProcessingStatus GetFlagFileProcessingStatus() const;
 	
 	FlagFileData* data;
 	ProxyFlagData* proxyData;
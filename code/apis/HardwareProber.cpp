@@ -0,0 +1,433 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/stopwatch.h>
+
+#include "generated/configure_launcher.h"
+#include "apis/HardwareProber.h"
+#include "apis/FlagListManager.h"
+#include "apis/JoystickManager.h"
+#include "apis/OpenALManager.h"
+#include "apis/resolution_manager.hpp"
+#include "global/ProfileKeys.h"
+
+#include "global/MemoryDebugging.h"
+
+LAUNCHER_DEFINE_EVENT_TYPE(EVT_HARDWARE_SNAPSHOT_CHANGED);
+LAUNCHER_DEFINE_EVENT_TYPE(EVT_HARDWARE_JOYSTICK_CHANGED);
+/** The audio probe has finished. Only sent to the prober itself. */
+LAUNCHER_DECLARE_EVENT_TYPE(EVT_HARDWARE_AUDIO_PROBED);
+LAUNCHER_DEFINE_EVENT_TYPE(EVT_HARDWARE_AUDIO_PROBED);
+
+namespace
+{
+	const wxByte BUILD_CAP_SDL = 1 << 3;
+	const wxString HARDWARE_CACHE_FILE_NAME(_T("hardware.ini"));
+	const int ID_HOTPLUG_TIMER = 1;
+	const int HOTPLUG_INTERVAL = 500; // ms
+}
+
+HardwareProber* HardwareProber::prober = NULL;
+EventHandlers HardwareProber::snapshotChangedHandlers;
+
+BEGIN_EVENT_TABLE(HardwareProber, wxEvtHandler)
+EVT_COMMAND(wxID_NONE, EVT_HARDWARE_AUDIO_PROBED, HardwareProber::OnAudioProbed)
+EVT_COMMAND(wxID_NONE, EVT_FLAG_FILE_PROCESSING_STATUS_CHANGED,
+	HardwareProber::OnFlagFileProcessingStatusChanged)
+EVT_TIMER(ID_HOTPLUG_TIMER, HardwareProber::OnHotplugTimer)
+END_EVENT_TABLE()
+
+bool HardwareProber::Initialize() {
+	wxCHECK_MSG(HardwareProber::prober == NULL, false,
+		_T("HardwareProber has already been initialized"));
+	HardwareProber::prober = new HardwareProber();
+	return true;
+}
+
+void HardwareProber::DeInitialize() {
+	delete HardwareProber::prober;
+	HardwareProber::prober = NULL;
+}
+
+bool HardwareProber::IsInitialized() {
+	return HardwareProber::prober != NULL;
+}
+
+HardwareProber* HardwareProber::Get() {
+	wxCHECK_MSG(HardwareProber::IsInitialized(), NULL,
+		_T("Attempt to get hardware prober when it has not been initialized."));
+	return HardwareProber::prober;
+}
+
+void HardwareProber::RegisterHardwareSnapshotChanged(wxEvtHandler *handler) {
+	wxASSERT_MSG(snapshotChangedHandlers.IndexOf(handler) == wxNOT_FOUND,
+		wxString::Format(
+			_T("RegisterHardwareSnapshotChanged(): Handler at %p already registered."),
+			handler));
+	snapshotChangedHandlers.Append(handler);
+}
+
+void HardwareProber::UnRegisterHardwareSnapshotChanged(wxEvtHandler *handler) {
+	wxASSERT_MSG(snapshotChangedHandlers.IndexOf(handler) != wxNOT_FOUND,
+		wxString::Format(
+			_T("UnRegisterHardwareSnapshotChanged(): Handler at %p not registered."),
+			handler));
+	snapshotChangedHandlers.DeleteObject(handler);
+}
+
+HardwareProber::HardwareProber()
+: audioProbe(NULL), isProbing(false), isProbeWanted(false),
+  hotplugTimer(this, ID_HOTPLUG_TIMER) {
+	wxStopWatch timer;
+	this->snapshot = HardwareSnapshotPtr(HardwareSnapshot::Load(GetCacheFile()));
+	if (this->snapshot.IsOk()) {
+		wxLogDebug(_T("Loaded hardware snapshot %s in %ld ms"),
+			this->snapshot->GetFingerprint().c_str(), timer.Time());
+		this->UseKnownDisplayModes();
+	}
+	FlagListManager::RegisterFlagFileProcessingStatusChanged(this);
+}
+
+HardwareProber::~HardwareProber() {
+	this->hotplugTimer.Stop();
+	FlagListManager::UnRegisterFlagFileProcessingStatusChanged(this);
+	if (this->audioProbe != NULL) {
+		this->audioProbe->Wait();
+		delete this->audioProbe;
+	}
+}
+
+wxFileName HardwareProber::GetCacheFile() {
+	return wxFileName(GetProfileStorageFolder(), HARDWARE_CACHE_FILE_NAME);
+}
+
+/** Looks at the hardware again. If a probe is already running, another
+ is made once it finishes. */
+void HardwareProber::Probe() {
+	if (this->IsProbing()) {
+		this->isProbeWanted = true;
+		return;
+	}
+	this->isProbing = true;
+	this->isProbeWanted = false;
+
+	if (!OpenALMan::WasCompiledIn() || !OpenALMan::Initialize()) {
+		// nothing to do on a worker, so go straight to the rest
+		wxCommandEvent event(EVT_HARDWARE_AUDIO_PROBED, wxID_NONE);
+		this->AddPendingEvent(event);
+		return;
+	}
+
+	this->audioProbe = new AudioProbe(this);
+#if wxCHECK_VERSION(2, 9, 1)
+	if (this->audioProbe->Create() != wxTHREAD_NO_ERROR
+		|| this->audioProbe->Run() != wxTHREAD_NO_ERROR) {
+		wxLogError(_T("Unable to start the hardware probe thread"));
+		delete this->audioProbe;
+		this->audioProbe = NULL;
+		this->isProbing = false;
+	}
+#else
+	this->audioProbe->Entry();
+#endif
+}
+
+HardwareProber::AudioProbe::AudioProbe(wxEvtHandler* owner)
+: wxThread(wxTHREAD_JOINABLE), owner(owner) {
+}
+
+wxThread::ExitCode HardwareProber::AudioProbe::Entry() {
+	wxStopWatch timer;
+	this->info.hasAudio = true;
+	this->info.defaultPlaybackDevice = OpenALMan::GetSystemDefaultPlaybackDevice();
+	this->info.defaultCaptureDevice = OpenALMan::GetSystemDefaultCaptureDevice();
+	this->info.captureDevices = OpenALMan::GetAvailableCaptureDevices();
+
+	const wxArrayString playbackDevices(OpenALMan::GetAvailablePlaybackDevices());
+	for (size_t i = 0; i < playbackDevices.GetCount(); ++i) {
+		OpenALMan::DeviceInfo deviceInfo;
+		OpenALMan::GetDeviceInfo(playbackDevices[i], deviceInfo);
+
+		HardwareAudioDevice device;
+		device.name = playbackDevices[i];
+		device.isOk = deviceInfo.isOk;
+		device.version = deviceInfo.isOk ? deviceInfo.version : deviceInfo.error;
+		device.hasEFX = deviceInfo.hasEFX;
+		device.maxAuxiliarySends = deviceInfo.maxAuxiliarySends;
+		this->info.playbackDevices.push_back(device);
+	}
+	wxLogDebug(_T("Probed %lu OpenAL playback devices in %ld ms"),
+		static_cast<unsigned long>(playbackDevices.GetCount()), timer.Time());
+
+	wxCommandEvent event(EVT_HARDWARE_AUDIO_PROBED, wxID_NONE);
+	this->owner->AddPendingEvent(event);
+	return 0;
+}
+
+void HardwareProber::OnAudioProbed(wxCommandEvent& WXUNUSED(event)) {
+	HardwareInfo audio;
+	if (this->audioProbe != NULL) {
+#if wxCHECK_VERSION(2, 9, 1)
+		this->audioProbe->Wait();
+#endif
+		audio = this->audioProbe->info;
+		delete this->audioProbe;
+		this->audioProbe = NULL;
+	}
+	this->FinishProbe(audio);
+}
+
+/** Adds the displays and joysticks to what the audio probe found. Parts
+ that can't be probed yet keep what the current snapshot has. */
+void HardwareProber::FinishProbe(const HardwareInfo& audio) {
+	const HardwareInfo* previous = this->snapshot.IsOk() ? &this->snapshot->GetInfo() : NULL;
+	HardwareInfo info(audio);
+	if (!info.hasAudio && previous != NULL) {
+		info.hasAudio = previous->hasAudio;
+		info.playbackDevices = previous->playbackDevices;
+		info.captureDevices = previous->captureDevices;
+		info.defaultPlaybackDevice = previous->defaultPlaybackDevice;
+		info.defaultCaptureDevice = previous->defaultCaptureDevice;
+	}
+	if (!this->ProbeDisplays(info) && previous != NULL) {
+		info.displayApi = previous->displayApi;
+		info.displaySignature = previous->displaySignature;
+		info.displayModes = previous->displayModes;
+	}
+	if (!this->ProbeJoysticks(info) && previous != NULL) {
+		info.joystickApi = previous->joystickApi;
+		info.joysticks = previous->joysticks;
+	}
+	this->Publish(info);
+
+	if (info.displayApi == ResolutionMan::API_SDL || info.joystickApi == JoyMan::API_SDL) {
+		this->hotplugTimer.Start(HOTPLUG_INTERVAL);
+	} else {
+		// the native APIs don't report changes
+		this->hotplugTimer.Stop();
+	}
+
+	this->isProbing = false;
+	if (this->isProbeWanted) {
+		this->Probe();
+	}
+}
+
+/** The APIs an executable uses depend on whether it was built with SDL,
+ so on Windows nothing can be probed until its flags have been read. */
+static bool IsBinaryUsingSDL(bool& usesSDL) {
+#if IS_WIN32
+	if (!FlagListManager::IsInitialized()
+		|| !FlagListManager::GetFlagListManager()->IsProcessingOK()) {
+		return false;
+	}
+	usesSDL = (FlagListManager::GetFlagListManager()->GetBuildCaps() & BUILD_CAP_SDL) != 0;
+#else
+	// OSX and Linux always use SDL
+	usesSDL = true;
+#endif
+	return true;
+}
+
+bool HardwareProber::ProbeDisplays(HardwareInfo& info) {
+	bool usesSDL;
+	if (!IsBinaryUsingSDL(usesSDL)) {
+		return false;
+	}
+	const ResolutionMan::ApiType api = usesSDL ? ResolutionMan::API_SDL : ResolutionMan::API_WIN32;
+	const wxString signature(ResolutionMan::GetDisplaySignature(api));
+	const bool areDisplaysChanged = (api == ResolutionMan::API_SDL)
+		? ResolutionMan::PollDisplayChanges() : ResolutionMan::HaveDisplaysChanged();
+
+	// the modes in use, whether from the snapshot or the display, still
+	// apply unless the displays look different or have been seen to change
+	const HardwareInfo* previous = this->snapshot.IsOk() ? &this->snapshot->GetInfo() : NULL;
+	if (previous != NULL && previous->displayApi == api && !signature.IsEmpty()
+		&& previous->displaySignature == signature && !areDisplaysChanged) {
+		info.displayApi = api;
+		info.displaySignature = signature;
+		info.displayModes = previous->displayModes;
+		return true;
+	}
+
+	wxLogDebug(_T("Displays are now %s"), signature.c_str());
+	ResolutionMan::InvalidateGraphicsModes();
+	ResolutionMan::ResolutionArray modes;
+	ResolutionMan::EnumerateGraphicsModes(api, modes, 0, 0);
+
+	info.displayApi = api;
+	info.displaySignature = signature;
+	info.displayModes.clear();
+	for (size_t i = 0; i < modes.GetCount(); ++i) {
+		if (!modes[i]->IsHeader()) {
+			info.displayModes.push_back(
+				HardwareDisplayMode(modes[i]->GetWidth(), modes[i]->GetHeight()));
+		}
+	}
+	WX_CLEAR_ARRAY(modes);
+	return true;
+}
+
+bool HardwareProber::ProbeJoysticks(HardwareInfo& info) {
+	bool usesSDL;
+	if (!JoyMan::WasCompiledIn() || !IsBinaryUsingSDL(usesSDL)) {
+		return false;
+	}
+	const JoyMan::ApiType api = usesSDL ? JoyMan::API_SDL : JoyMan::API_NATIVE;
+
+	if (JoyMan::IsInitialized() && JoyMan::GetApi() == api && api == JoyMan::API_SDL) {
+		// SDL reports the joysticks plugged in or unplugged since, so there
+		// is no need to start over
+		wxArrayInt changed;
+		JoyMan::PollDeviceChanges(changed);
+	} else {
+		// the native API only finds joysticks when it starts
+		JoyMan::DeInitialize();
+		if (!JoyMan::Initialize(api)) {
+			return false;
+		}
+	}
+
+	info.joystickApi = api;
+	HardwareProber::FindJoysticks(info.joysticks);
+	return true;
+}
+
+static HardwareJoystick DescribeJoystick(unsigned int i) {
+	HardwareJoystick joystick;
+	if (JoyMan::IsJoystickPluggedIn(i)) {
+		joystick.name = JoyMan::JoystickName(i);
+		joystick.guid = JoyMan::JoystickGUID(i);
+		joystick.hasForceFeedback = JoyMan::SupportsForceFeedback(i);
+	}
+	return joystick;
+}
+
+/** Lists the joysticks JoyMan knows about, in JoyMan's order. Joysticks
+ that aren't plugged in are left nameless so the rest keep their numbers. */
+void HardwareProber::FindJoysticks(HardwareJoysticks& joysticks) {
+	wxCHECK_RET(JoyMan::IsInitialized(), _T("FindJoysticks: JoyMan is not initialized"));
+	joysticks.clear();
+	for (unsigned int i = 0; i < JoyMan::NumberOfJoysticks(); ++i) {
+		joysticks.push_back(DescribeJoystick(i));
+	}
+}
+
+void HardwareProber::Publish(const HardwareInfo& info) {
+	if (this->Replace(info)) {
+		wxCommandEvent event(EVT_HARDWARE_SNAPSHOT_CHANGED, wxID_NONE);
+		wxLogDebug(_T("Generating EVT_HARDWARE_SNAPSHOT_CHANGED event"));
+		HardwareProber::SendToHandlers(event);
+	}
+}
+
+/** Makes info the snapshot and saves it, unless it is the same as the
+ current one. Returns true if the snapshot was replaced. */
+bool HardwareProber::Replace(const HardwareInfo& info) {
+	HardwareSnapshotPtr fresh(new HardwareSnapshot(info));
+	if (this->snapshot.IsOk()
+		&& this->snapshot->GetFingerprint() == fresh->GetFingerprint()) {
+		wxLogDebug(_T("Hardware is unchanged (%s)"), fresh->GetFingerprint().c_str());
+		return false;
+	}
+
+	wxLogDebug(_T("Hardware snapshot is now %s"), fresh->GetFingerprint().c_str());
+	this->snapshot = fresh;
+	if (!fresh->Save(GetCacheFile())) {
+		wxLogWarning(_T("Unable to save the hardware cache to %s"),
+			GetCacheFile().GetFullPath().c_str());
+	}
+	return true;
+}
+
+void HardwareProber::SendToHandlers(wxCommandEvent& event) {
+	for (EventHandlers::iterator iter = snapshotChangedHandlers.begin();
+		 iter != snapshotChangedHandlers.end(); ++iter) {
+		(*iter)->AddPendingEvent(event);
+	}
+}
+
+/** Patches display changes, and the joysticks that were plugged in or
+ unplugged, into the snapshot, without probing the rest of the hardware
+ again. */
+void HardwareProber::OnHotplugTimer(wxTimerEvent& WXUNUSED(event)) {
+	// a probe starts JoyMan over, and finds the changes itself
+	if (this->IsProbing() || !this->snapshot.IsOk()) {
+		return;
+	}
+	if (this->snapshot->GetInfo().displayApi == ResolutionMan::API_SDL
+		&& ResolutionMan::PollDisplayChanges()) {
+		HardwareInfo info(this->snapshot->GetInfo());
+		if (this->ProbeDisplays(info)) {
+			this->Publish(info);
+		}
+	}
+	if (this->snapshot->GetInfo().joystickApi != JoyMan::API_SDL) {
+		return;
+	}
+	wxArrayInt changed;
+	if (!JoyMan::PollDeviceChanges(changed)) {
+		return;
+	}
+
+	HardwareInfo info(this->snapshot->GetInfo());
+	info.joysticks.resize(JoyMan::NumberOfJoysticks());
+	for (size_t i = 0; i < changed.GetCount(); ++i) {
+		info.joysticks[changed[i]] = DescribeJoystick(changed[i]);
+	}
+	if (!this->Replace(info)) {
+		return;
+	}
+	for (size_t i = 0; i < changed.GetCount(); ++i) {
+		wxCommandEvent event(EVT_HARDWARE_JOYSTICK_CHANGED, wxID_NONE);
+		event.SetInt(changed[i]);
+		wxLogDebug(_T("Generating EVT_HARDWARE_JOYSTICK_CHANGED event for joystick %d"), changed[i]);
+		HardwareProber::SendToHandlers(event);
+	}
+}
+
+/** Lets ResolutionMan use the display modes of the snapshot loaded from
+ disk until ProbeDisplays() asks the display for them. */
+void HardwareProber::UseKnownDisplayModes() {
+	const HardwareInfo& info = this->snapshot->GetInfo();
+	if (info.displayApi >= 0 && info.displayApi < ResolutionMan::API_COUNT) {
+		ResolutionMan::UseGraphicsModes(
+			static_cast<ResolutionMan::ApiType>(info.displayApi), info.displayModes);
+	}
+}
+
+/** On Windows, choosing an executable can change which APIs are used, in
+ which case the snapshot no longer applies. */
+void HardwareProber::OnFlagFileProcessingStatusChanged(wxCommandEvent& event) {
+	event.Skip();
+	if (event.GetInt() != FlagListManager::FLAG_FILE_PROCESSING_OK) {
+		return;
+	}
+	bool usesSDL;
+	if (!IsBinaryUsingSDL(usesSDL)) {
+		return;
+	}
+	const int displayApi = usesSDL ? ResolutionMan::API_SDL : ResolutionMan::API_WIN32;
+	const int joystickApi = usesSDL ? JoyMan::API_SDL : JoyMan::API_NATIVE;
+	if (!this->snapshot.IsOk()
+		|| this->snapshot->GetInfo().displayApi != displayApi
+		|| (JoyMan::WasCompiledIn() && this->snapshot->GetInfo().joystickApi != joystickApi)) {
+		this->Probe();
+	}
+}
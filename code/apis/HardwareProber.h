@@ -0,0 +1,112 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef HARDWAREPROBER_H
+#define HARDWAREPROBER_H
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+#include <wx/timer.h>
+
+#include "apis/EventHandlers.h"
+#include "datastructures/HardwareSnapshot.h"
+
+/** The hardware snapshot has been replaced by one that differs from it. */
+LAUNCHER_DECLARE_EVENT_TYPE(EVT_HARDWARE_SNAPSHOT_CHANGED);
+/** A joystick has been plugged in or unplugged, and the hardware snapshot
+ updated to match. The event's int is the joystick's number. */
+LAUNCHER_DECLARE_EVENT_TYPE(EVT_HARDWARE_JOYSTICK_CHANGED);
+
+/** Finds out which display modes, audio devices and joysticks the system
+ has, so that the settings page doesn't have to ask the hardware each time
+ the executable or profile changes.
+
+ What was found last time is loaded from disk by Initialize(), so the
+ settings page can be filled in straight away. Probe() then looks at the
+ hardware again: the audio devices, which are the slowest to open, are
+ probed on a worker thread, and the displays and joysticks on the main
+ thread afterwards, as SDL needs them to be. If the result differs from
+ the snapshot being shown, it replaces it, is saved, and
+ EVT_HARDWARE_SNAPSHOT_CHANGED is sent to the registered handlers.
+
+ While JoyMan uses SDL, joysticks being plugged in or unplugged are picked
+ up as they happen: SDL's device events are checked for on a timer, and
+ each joystick that changed is patched into the snapshot and announced with
+ EVT_HARDWARE_JOYSTICK_CHANGED, which goes to the same handlers. The same
+ timer takes SDL's display events while ResolutionMan uses SDL, and asks
+ the display for its modes again when there were any.
+
+ wxWidgets 2.8 can't log from worker threads, so there the audio devices
+ are probed during Probe() instead. */
+class HardwareProber: public wxEvtHandler {
+public:
+	static bool Initialize();
+	static void DeInitialize();
+	static bool IsInitialized();
+	static HardwareProber* Get();
+
+	static void RegisterHardwareSnapshotChanged(wxEvtHandler *handler);
+	static void UnRegisterHardwareSnapshotChanged(wxEvtHandler *handler);
+
+	HardwareSnapshotPtr GetSnapshot() const { return this->snapshot; }
+	void Probe();
+	bool IsProbing() const { return this->audioProbe != NULL || this->isProbing; }
+
+	static void FindJoysticks(HardwareJoysticks& joysticks);
+
+private:
+	HardwareProber();
+	~HardwareProber();
+
+	/** Opens each OpenAL device on a worker thread. */
+	class AudioProbe: public wxThread {
+	public:
+		AudioProbe(wxEvtHandler* owner);
+		HardwareInfo info; //!< only the audio part is filled in
+	protected:
+		virtual ExitCode Entry();
+	private:
+		wxEvtHandler* owner;
+		friend class HardwareProber; // runs Entry() itself on wxWidgets 2.8
+	};
+
+	void OnAudioProbed(wxCommandEvent& event);
+	void OnFlagFileProcessingStatusChanged(wxCommandEvent& event);
+	void OnHotplugTimer(wxTimerEvent& event);
+	void FinishProbe(const HardwareInfo& audio);
+	bool ProbeDisplays(HardwareInfo& info);
+	bool ProbeJoysticks(HardwareInfo& info);
+	void Publish(const HardwareInfo& info);
+	bool Replace(const HardwareInfo& info);
+	static void SendToHandlers(wxCommandEvent& event);
+	void UseKnownDisplayModes();
+	static wxFileName GetCacheFile();
+
+	HardwareSnapshotPtr snapshot;
+	AudioProbe* audioProbe;
+	bool isProbing;
+	bool isProbeWanted; //!< Probe() was called while a probe was running
+	wxTimer hotplugTimer;
+
+	static HardwareProber* prober;
+	static EventHandlers snapshotChangedHandlers;
+
+	DECLARE_EVENT_TABLE()
+};
+
+#endif
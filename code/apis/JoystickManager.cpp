@@ -28,6 +28,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "global/BasicDefaults.h"
 #include "global/MemoryDebugging.h"
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace JoyMan {
@@ -35,16 +37,72 @@ namespace JoyMan {
 	ApiType currentApi = API_NATIVE;
 #if HAS_SDL
 	bool isSdlInitialized = false;
-	std::vector<SDL_Joystick*> sdlJoysticks;
+	std::vector<SDL_Joystick*> sdlJoysticks; //!< NULL for joysticks that have been unplugged
+	std::vector<SDL_JoystickGUID> sdlJoystickGUIDs;
 
 	void clearSDLJoystickList()
 	{
 		for (std::vector<SDL_Joystick*>::iterator iter = sdlJoysticks.begin(); iter != sdlJoysticks.end(); ++iter)
 		{
-			SDL_JoystickClose(*iter);
+			if (*iter != NULL) {
+				SDL_JoystickClose(*iter);
+			}
 		}
 		sdlJoysticks.clear();
 	}
+
+	bool isSameGUID(const SDL_JoystickGUID& a, const SDL_JoystickGUID& b)
+	{
+		return memcmp(a.data, b.data, sizeof(a.data)) == 0;
+	}
+
+	/** Opens a joystick that SDL says was added. A joystick that was unplugged
+	gets its old number back, so that a selection made by number still refers
+	to it; other joysticks are added to the end.
+	\return the joystick's number, or -1 if it was already open or couldn't
+	be opened. */
+	int addSDLJoystick(int deviceIndex)
+	{
+		SDL_Joystick* joy = SDL_JoystickOpen(deviceIndex);
+		if (joy == NULL) {
+			wxLogWarning(_T("Unable to open added joystick: %s"),
+				wxString::FromUTF8(SDL_GetError()).c_str());
+			return -1;
+		}
+		// SDL also reports the joysticks that were there when it started,
+		// and opening one of those again just returns the open one
+		if (std::find(sdlJoysticks.begin(), sdlJoysticks.end(), joy) != sdlJoysticks.end()) {
+			SDL_JoystickClose(joy);
+			return -1;
+		}
+
+		const SDL_JoystickGUID guid = SDL_JoystickGetGUID(joy);
+		for (size_t i = 0; i < sdlJoysticks.size(); ++i) {
+			if (sdlJoysticks[i] == NULL
+				&& isSameGUID(sdlJoystickGUIDs[i], guid)) {
+				sdlJoysticks[i] = joy;
+				return static_cast<int>(i);
+			}
+		}
+		sdlJoysticks.push_back(joy);
+		sdlJoystickGUIDs.push_back(guid);
+		return static_cast<int>(sdlJoysticks.size() - 1);
+	}
+
+	/** Closes a joystick that SDL says was removed, leaving its number empty.
+	\return the joystick's number, or -1 if it wasn't open. */
+	int removeSDLJoystick(SDL_JoystickID instanceId)
+	{
+		for (size_t i = 0; i < sdlJoysticks.size(); ++i) {
+			if (sdlJoysticks[i] != NULL
+				&& SDL_JoystickInstanceID(sdlJoysticks[i]) == instanceId) {
+				SDL_JoystickClose(sdlJoysticks[i]);
+				sdlJoysticks[i] = NULL;
+				return static_cast<int>(i);
+			}
+		}
+		return -1;
+	}
 #endif
 #if IS_WIN32
 	bool isWinInitialized = false;
@@ -88,6 +146,16 @@ bool JoyMan::IsInitialized() {
 #endif
 }
 
+/** \return the API JoyMan was last asked to use.
+\note Always returns API_NATIVE when JoyMan is not compiled in. */
+ApiType JoyMan::GetApi() {
+#if USE_JOYSTICK
+	return currentApi;
+#else
+	return API_NATIVE;
+#endif
+}
+
 /** Gets JoyMan ready to manage joysticks.
 \return true if successful, false otherwise.
 \note Will also return false if JoyMan is not compiled in.
@@ -157,6 +225,7 @@ bool JoyMan::Initialize(ApiType apiType) {
 		}
 		wxLogInfo(_T("Windows reports %d joysticks, %d seem to be plugged in."),
 			totalNumberOfJoysticks, static_cast<int>(winJoysticks.size()));
+		isWinInitialized = true;
 		return true;
 	}
 #endif
@@ -170,14 +239,27 @@ bool JoyMan::Initialize(ApiType apiType) {
 		}
 
 		JoyMan::clearSDLJoystickList();
+		JoyMan::sdlJoystickGUIDs.clear();
+
+		// only device changes are wanted, not every stick movement
+		SDL_EventState(SDL_JOYAXISMOTION, SDL_IGNORE);
+		SDL_EventState(SDL_JOYBALLMOTION, SDL_IGNORE);
+		SDL_EventState(SDL_JOYHATMOTION, SDL_IGNORE);
+		SDL_EventState(SDL_JOYBUTTONDOWN, SDL_IGNORE);
+		SDL_EventState(SDL_JOYBUTTONUP, SDL_IGNORE);
+		// changes from before now are covered by the list made below
+		SDL_PumpEvents();
+		SDL_FlushEvents(SDL_JOYDEVICEADDED, SDL_JOYDEVICEREMOVED);
 
 		for (int i = 0; i < SDL_NumJoysticks(); i++) {
 			SDL_Joystick* joy = SDL_JoystickOpen(i);
 			if (joy != NULL) {
 				sdlJoysticks.push_back(joy);
+				sdlJoystickGUIDs.push_back(SDL_JoystickGetGUID(joy));
 			}
 		}
 
+		isSdlInitialized = true;
 		return true;
 	}
 #endif
@@ -197,8 +279,8 @@ bool JoyMan::DeInitialize() {
 #if HAS_SDL
 	if ( isSdlInitialized ) {
 		JoyMan::isSdlInitialized = false;
-		JoyMan::sdlJoysticks.clear();
 		JoyMan::clearSDLJoystickList();
+		JoyMan::sdlJoystickGUIDs.clear();
 
 		SDL_QuitSubSystem(SDL_INIT_JOYSTICK | SDL_INIT_HAPTIC);
 	}
@@ -267,7 +349,7 @@ bool JoyMan::SupportsForceFeedback(unsigned int i) {
 #if HAS_SDL
 		if (currentApi == API_SDL)
 		{
-			if (sdlJoysticks.size() <= i) {
+			if (sdlJoysticks.size() <= i || sdlJoysticks[i] == NULL) {
 				return false;
 			}
 			else {
@@ -320,7 +402,7 @@ wxString JoyMan::JoystickName(unsigned int i) {
 #if HAS_SDL
 	if (currentApi == API_SDL)
 	{
-		if (sdlJoysticks.size() <= i) {
+		if (sdlJoysticks.size() <= i || sdlJoysticks[i] == NULL) {
 			return wxEmptyString;
 		}
 		else {
@@ -354,7 +436,7 @@ wxString JoyMan::JoystickGUID(unsigned int i)
 #if HAS_SDL
 	if (currentApi == API_SDL)
 	{
-		if (sdlJoysticks.size() <= i) {
+		if (sdlJoysticks.size() <= i || sdlJoysticks[i] == NULL) {
 			return wxEmptyString;
 		} else {
 			SDL_JoystickGUID guid = SDL_JoystickGetGUID(sdlJoysticks[i]);
@@ -393,3 +475,37 @@ bool JoyMan::IsJoystickPluggedIn(unsigned int) {
 	return false;
 #endif
 }
+
+/** Looks for joysticks that have been plugged in or unplugged since JoyMan
+was initialized or last asked. A joystick keeps its number while it is
+unplugged, and gets it back if it is plugged in again.
+Must be called from the main thread, as SDL has to pump its events there.
+\param[out] changedJoysticks the numbers of the joysticks that changed.
+\return true if any joysticks changed.
+\note The native API doesn't report changes, so it always returns false. */
+bool JoyMan::PollDeviceChanges(wxArrayInt& changedJoysticks) {
+	changedJoysticks.Clear();
+#if USE_JOYSTICK && HAS_SDL
+	if (currentApi != API_SDL || !isSdlInitialized) {
+		return false;
+	}
+
+	SDL_PumpEvents();
+	SDL_Event events[8];
+	int count;
+	while ((count = SDL_PeepEvents(events, WXSIZEOF(events), SDL_GETEVENT,
+		SDL_JOYDEVICEADDED, SDL_JOYDEVICEREMOVED)) > 0) {
+		for (int i = 0; i < count; ++i) {
+			const int number = (events[i].type == SDL_JOYDEVICEADDED)
+				? JoyMan::addSDLJoystick(events[i].jdevice.which)
+				: JoyMan::removeSDLJoystick(events[i].jdevice.which);
+			if (number >= 0 && changedJoysticks.Index(number) == wxNOT_FOUND) {
+				wxLogDebug(_T("Joystick %d was %s"), number,
+					(events[i].type == SDL_JOYDEVICEADDED) ? _T("plugged in") : _T("unplugged"));
+				changedJoysticks.Add(number);
+			}
+		}
+	}
+#endif
+	return !changedJoysticks.IsEmpty();
+}
@@ -30,6 +30,7 @@ namespace JoyMan {
 	bool Initialize(ApiType apiType);
 	bool DeInitialize();
 	bool IsInitialized();
+	ApiType GetApi();
 	bool WasCompiledIn();
 
 	unsigned int NumberOfJoysticks();
@@ -40,6 +41,7 @@ namespace JoyMan {
 	wxString JoystickName(unsigned int i);
 	wxString JoystickGUID(unsigned int i);
 	bool IsJoystickPluggedIn(unsigned int i);
+	bool PollDeviceChanges(wxArrayInt& changedJoysticks);
 };
 
 #endif
@@ -0,0 +1,573 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/evtloop.h>
+#include <wx/filename.h>
+#include <wx/regex.h>
+#include <wx/stopwatch.h>
+#include <wx/textfile.h>
+#include <wx/tokenzr.h>
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include "generated/configure_launcher.h"
+#include "apis/LaunchBenchmark.h"
+#include "apis/PlatformProfileManager.h"
+#include "apis/ProcessSupervisor.h"
+#include "apis/ProfileManager.h"
+#include "apis/ProfileManagerOperator.h"
+#include "datastructures/LaunchPreset.h"
+#include "global/ProfileKeys.h"
+
+#include "global/MemoryDebugging.h"
+
+namespace
+{
+	const int RUN_BENCHMARK = 0; // the supervisor tag of every run
+	const unsigned long WAIT_INTERVAL = 2; // ms between checks for a run having exited
+	const long DEFAULT_RUN_TIMEOUT = 300; // s
+
+	const wxChar* const DEFAULT_METRIC_PATTERN =
+		_T("^METRIC[[:space:]]+([^[:space:]=]+)[[:space:]]*=[[:space:]]*([-+0-9.eE]+)");
+
+	/** What is always measured, before whatever the child reports. */
+	const wxChar* const BUILT_IN_MEASUREMENTS[] = {
+		_T("wall_ms"),
+		_T("user_ms"),
+		_T("sys_ms"),
+		_T("max_rss_kb"),
+		_T("minor_faults"),
+		_T("major_faults"),
+		NULL
+	};
+
+	typedef std::map<wxString, double> Measurements;
+
+	/** One way of running the game that is being compared with the others. */
+	struct Variant {
+		Variant() : successes(0), failures(0) { }
+		wxString label;
+		ProfileSnapshotPtr profile;
+		wxString command;
+		wxString folder;
+		ProcessOptions options;
+		/** Everything measured, by name, with one value per good run. */
+		std::map<wxString, std::vector<double> > samples;
+		unsigned long successes;
+		unsigned long failures;
+	};
+
+	/** The manifest's lines that aren't variants. */
+	struct Settings {
+		Settings()
+		: warmups(0), timeout(DEFAULT_RUN_TIMEOUT), metricPattern(DEFAULT_METRIC_PATTERN) { }
+		wxString base;
+		wxString binary;
+		wxString args;
+		long warmups;
+		long timeout; //!< s a run may take before it is stopped
+		wxString metricPattern;
+	};
+
+	/** Two-sided 95% critical values of Student's t distribution, for 1 to
+	 30 degrees of freedom. */
+	const double T_95[] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+	};
+
+	struct Stats {
+		size_t n;
+		double mean;
+		double variance; //!< of the sample, so divided by n - 1
+	};
+
+	/** Sees EVT_PROCESS_EXITED for the run being waited for. */
+	class RunWaiter: public wxEvtHandler {
+	public:
+		RunWaiter() : exitedId(0) { }
+		long exitedId;
+	private:
+		void OnProcessExited(wxCommandEvent& event) {
+			this->exitedId = event.GetExtraLong();
+		}
+		DECLARE_EVENT_TABLE()
+	};
+}
+
+BEGIN_EVENT_TABLE(RunWaiter, wxEvtHandler)
+EVT_COMMAND(wxID_NONE, EVT_PROCESS_EXITED, RunWaiter::OnProcessExited)
+END_EVENT_TABLE()
+
+/** Between the table's rows the row with fewer degrees of freedom is used,
+ which makes intervals a little too wide rather than too narrow. */
+static double TCritical95(double degreesOfFreedom) {
+	if (degreesOfFreedom < 1) {
+		return T_95[0];
+	} else if (degreesOfFreedom < WXSIZEOF(T_95) + 1) {
+		return T_95[static_cast<size_t>(degreesOfFreedom) - 1];
+	} else if (degreesOfFreedom < 40) {
+		return T_95[WXSIZEOF(T_95) - 1];
+	} else if (degreesOfFreedom < 60) {
+		return 2.021;
+	} else if (degreesOfFreedom < 120) {
+		return 2.000;
+	}
+	return 1.980;
+}
+
+static Stats Describe(const std::vector<double>& values) {
+	Stats stats = { values.size(), 0, 0 };
+	for (size_t i = 0; i < values.size(); ++i) {
+		stats.mean += values[i];
+	}
+	if (stats.n > 0) {
+		stats.mean /= stats.n;
+	}
+	for (size_t i = 0; i < values.size(); ++i) {
+		stats.variance += (values[i] - stats.mean) * (values[i] - stats.mean);
+	}
+	if (stats.n > 1) {
+		stats.variance /= (stats.n - 1);
+	}
+	return stats;
+}
+
+/** Numbers from the child are read the same whatever the locale. */
+static bool ToNumber(const wxString& text, double* value) {
+#if wxCHECK_VERSION(2, 9, 0)
+	return text.ToCDouble(value);
+#else
+	return text.ToDouble(value);
+#endif
+}
+
+/** Reads the lines of the manifest that set up the benchmark into settings,
+ and lists the profiles, mod lines and flag lines to compare. Returns false
+ if a line isn't understood. */
+static bool ReadManifest(const wxTextFile& manifest, Settings& settings,
+	wxArrayString& profiles, wxArrayString& modLabels, wxArrayString& modLines,
+	wxArrayString& flagLabels, wxArrayString& flagLines) {
+	bool ok = true;
+	for (size_t i = 0, n = manifest.GetLineCount(); i < n; i++) {
+		const wxString& line = manifest[i];
+		if (line.Strip(wxString::both).IsEmpty() || line.StartsWith(_T("#"))) {
+			continue;
+		}
+
+		const wxArrayString fields(wxStringTokenize(line, _T("\t"), wxTOKEN_RET_EMPTY_ALL));
+		const wxString& op = fields[0];
+		const size_t count = fields.GetCount();
+		if (op == _T("base") && count == 2) {
+			settings.base = fields[1];
+		} else if (op == _T("binary") && count == 2) {
+			wxFileName binary(fields[1]);
+			binary.MakeAbsolute();
+			settings.binary = binary.GetFullPath();
+		} else if (op == _T("args") && count == 2) {
+			settings.args = fields[1];
+		} else if (op == _T("warmup") && count == 2
+			&& fields[1].ToLong(&settings.warmups) && settings.warmups >= 0) {
+			// read by ToLong()
+		} else if (op == _T("timeout") && count == 2
+			&& fields[1].ToLong(&settings.timeout) && settings.timeout > 0) {
+			// read by ToLong()
+		} else if (op == _T("metric") && count == 2) {
+			settings.metricPattern = fields[1];
+		} else if (op == _T("profile") && count == 2) {
+			profiles.Add(fields[1]);
+		} else if (op == _T("mods") && count == 3) {
+			modLabels.Add(fields[1]);
+			modLines.Add(fields[2]);
+		} else if (op == _T("flags") && count == 3) {
+			flagLabels.Add(fields[1]);
+			flagLines.Add(fields[2]);
+		} else {
+			wxLogError(_("Line %lu of the launch benchmark manifest: unknown setting '%s' or wrong number of fields"),
+				static_cast<unsigned long>(i + 1), op.c_str());
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+/** Works out how variant is to be launched from its profile, as the
+ launcher itself would, unless settings name a binary to run instead. */
+static bool PrepareVariant(Variant& variant, const Settings& settings) {
+	wxString error;
+	if (!variant.profile->Read(PRO_CFG_TC_ROOT_FOLDER, &variant.folder)) {
+		wxLogError(_("%s: the game root folder is not set (%s)"),
+			variant.label.c_str(), PRO_CFG_TC_ROOT_FOLDER.c_str());
+		return false;
+	}
+
+	wxFileName path;
+	if (!settings.binary.IsEmpty()) {
+		path = wxFileName(settings.binary);
+	} else {
+		wxString binary;
+		if (!variant.profile->Read(PRO_CFG_TC_CURRENT_BINARY, &binary)) {
+			wxLogError(_("%s: no FS2 Open executable has been selected (%s)"),
+				variant.label.c_str(), PRO_CFG_TC_CURRENT_BINARY.c_str());
+			return false;
+		}
+#if IS_APPLE
+		path = wxFileName(variant.folder + wxFileName::GetPathSeparator() + binary, wxPATH_NATIVE);
+#else
+		path = wxFileName(variant.folder, binary, wxPATH_NATIVE);
+#endif
+	}
+	if (!path.FileExists()) {
+		wxLogError(_("%s: executable %s does not exist"),
+			variant.label.c_str(), path.GetFullPath().c_str());
+		return false;
+	}
+
+	if (!LaunchPreset::GetProcessOptions(*variant.profile, variant.options, error)) {
+		wxLogError(_T("%s: %s"), variant.label.c_str(), error.c_str());
+		return false;
+	}
+#if IS_LINUX
+	variant.options.captureOutput = true;
+#endif
+
+	// the "" correct for spaces in the path
+	if (path.GetFullPath().Find(_T(" ")) != wxNOT_FOUND) {
+		variant.command = _T("\"") + path.GetFullPath() + _T("\"");
+	} else {
+		variant.command = path.GetFullPath();
+	}
+	if (!settings.args.IsEmpty()) {
+		variant.command += _T(" ") + settings.args;
+	}
+	return true;
+}
+
+/** Reads every line of output that metricPattern matches as a name and a
+ value. */
+static void ReadMetrics(const wxArrayString& output, wxRegEx& metricPattern,
+	Measurements& measurements) {
+	for (size_t i = 0; i < output.GetCount(); ++i) {
+		if (!metricPattern.Matches(output[i]) || metricPattern.GetMatchCount() < 3) {
+			continue;
+		}
+		const wxString name(metricPattern.GetMatch(output[i], 1));
+		double value;
+		if (ToNumber(metricPattern.GetMatch(output[i], 2), &value)) {
+			measurements[name] = value;
+		} else {
+			wxLogDebug(_T("Ignoring metric %s, which is not a number"), name.c_str());
+		}
+	}
+}
+
+/** Writes variant's cmdline_fso.cfg, then runs it once and waits for it to
+ exit, stopping it if it runs for longer than timeout seconds. Returns false
+ if it could not be started, was stopped or did not exit cleanly, which
+ makes what was measured worthless. */
+static bool RunVariant(ProcessSupervisor& supervisor, RunWaiter& waiter,
+	const Variant& variant, long timeout, wxRegEx& metricPattern,
+	Measurements& measurements) {
+	measurements.clear();
+	if (PushCmdlineFSO(*variant.profile) != ProMan::NoError) {
+		wxLogError(_("%s: unable to write cmdline_fso.cfg"), variant.label.c_str());
+		return false;
+	}
+
+	const long id = supervisor.Start(RUN_BENCHMARK, variant.command, variant.folder,
+		variant.options);
+	if (id == 0) {
+		return false;
+	}
+	wxStopWatch timer;
+	bool isTimedOut = false;
+	while (waiter.exitedId != id) {
+		if (!isTimedOut && timer.Time() > timeout * 1000) {
+			// killed if it doesn't exit within the supervisor's STOP_TIMEOUT
+			wxLogError(_("%s: still running after %ld s, stopping it"),
+				variant.label.c_str(), timeout);
+			supervisor.Stop(id);
+			isTimedOut = true;
+		}
+		wxTheApp->Yield(true);
+		::wxMilliSleep(WAIT_INTERVAL);
+	}
+	ProcessRun run;
+	if (!supervisor.TakeFinishedRun(id, run) || isTimedOut) {
+		return false;
+	}
+	if (run.exitCode != 0) {
+		if (run.exitSignal != 0) {
+			wxLogError(_("%s: process %ld was ended by signal %d"),
+				variant.label.c_str(), run.pid, run.exitSignal);
+		} else {
+			wxLogError(_("%s: process %ld exited with %d"),
+				variant.label.c_str(), run.pid, run.exitCode);
+		}
+		return false;
+	}
+
+	measurements[_T("wall_ms")] = run.runTime;
+	if (run.hasUsage) {
+		measurements[_T("user_ms")] = run.userSeconds * 1000;
+		measurements[_T("sys_ms")] = run.systemSeconds * 1000;
+		measurements[_T("max_rss_kb")] = run.maxResidentKB;
+		measurements[_T("minor_faults")] = run.minorFaults;
+		measurements[_T("major_faults")] = run.majorFaults;
+	}
+
+	wxString text(run.output.c_str(), wxConvUTF8);
+	if (text.IsEmpty() && !run.output.empty()) {
+		text = wxString(run.output.c_str(), wxConvISO8859_1);
+	}
+	text.Replace(_T("\r"), wxEmptyString);
+	ReadMetrics(wxStringTokenize(text, _T("\n")), metricPattern, measurements);
+	return true;
+}
+
+/** Reports each variant's mean and its 95% confidence interval for
+ everything measured, then how each differs from the first variant, using
+ Welch's t interval as the variants' spreads needn't be the same. A
+ difference whose interval doesn't include 0 is marked with *. Where
+ neither variant's runs varied at all there is no interval, so the
+ difference is reported as not tested rather than as significant. */
+static void ReportComparison(const std::vector<Variant>& variants,
+	const wxArrayString& names) {
+	for (size_t v = 0; v < variants.size(); ++v) {
+		const Variant& variant = variants[v];
+		ProManOperator::ReportBenchmark(wxString::Format(
+			_T("%s: %lu good run(s), %lu failed"), variant.label.c_str(),
+			variant.successes, variant.failures));
+		for (size_t i = 0; i < names.GetCount(); ++i) {
+			std::map<wxString, std::vector<double> >::const_iterator samples =
+				variant.samples.find(names[i]);
+			if (samples == variant.samples.end()) {
+				continue;
+			}
+			const Stats stats = Describe(samples->second);
+			if (stats.n < 2) {
+				ProManOperator::ReportBenchmark(wxString::Format(
+					_T("  %-16s n=%lu mean %.3f"), names[i].c_str(),
+					static_cast<unsigned long>(stats.n), stats.mean));
+				continue;
+			}
+			const double halfWidth = TCritical95(stats.n - 1) * std::sqrt(stats.variance / stats.n);
+			ProManOperator::ReportBenchmark(wxString::Format(
+				_T("  %-16s n=%lu mean %.3f sd %.3f 95%% CI [%.3f, %.3f]"), names[i].c_str(),
+				static_cast<unsigned long>(stats.n), stats.mean, std::sqrt(stats.variance),
+				stats.mean - halfWidth, stats.mean + halfWidth));
+		}
+	}
+
+	const Variant& baseline = variants[0];
+	for (size_t v = 1; v < variants.size(); ++v) {
+		const Variant& variant = variants[v];
+		ProManOperator::ReportBenchmark(wxString::Format(_T("%s compared with %s:"),
+			variant.label.c_str(), baseline.label.c_str()));
+		for (size_t i = 0; i < names.GetCount(); ++i) {
+			std::map<wxString, std::vector<double> >::const_iterator a =
+				baseline.samples.find(names[i]);
+			std::map<wxString, std::vector<double> >::const_iterator b =
+				variant.samples.find(names[i]);
+			if (a == baseline.samples.end() || b == variant.samples.end()) {
+				continue;
+			}
+			const Stats before = Describe(a->second);
+			const Stats after = Describe(b->second);
+			if (before.n < 2 || after.n < 2) {
+				continue;
+			}
+			const double difference = after.mean - before.mean;
+			const wxString percent((before.mean != 0)
+				? wxString::Format(_T(" (%+.1f%%)"), difference * 100 / before.mean)
+				: wxString());
+			const double beforeError = before.variance / before.n;
+			const double afterError = after.variance / after.n;
+			// Welch-Satterthwaite
+			const double denominator = beforeError * beforeError / (before.n - 1)
+				+ afterError * afterError / (after.n - 1);
+			if (!(denominator > 0)) {
+				// the runs are too coarse to say how much the difference could vary
+				ProManOperator::ReportBenchmark(wxString::Format(
+					_T("  %-16s %+.3f%s not tested, no variation in either variant"),
+					names[i].c_str(), difference, percent.c_str()));
+				continue;
+			}
+			const double standardError = std::sqrt(beforeError + afterError);
+			const double degreesOfFreedom =
+				(beforeError + afterError) * (beforeError + afterError) / denominator;
+			const double halfWidth = TCritical95(degreesOfFreedom) * standardError;
+			const bool isSignificant = std::fabs(difference) > halfWidth;
+			ProManOperator::ReportBenchmark(wxString::Format(
+				_T("  %-16s %+.3f%s 95%% CI [%+.3f, %+.3f]%s"), names[i].c_str(),
+				difference, percent.c_str(), difference - halfWidth, difference + halfWidth,
+				isSignificant ? _T(" *") : _T("")));
+		}
+	}
+}
+
+/** Runs the launch benchmark described by the manifest at manifestPath.
+
+ Each line of the manifest is one setting, with its fields separated by
+ tabs so that names and command lines may contain spaces:
+   base     PROFILE          the profile mods and flags are applied to
+   binary   PATH             run PATH instead of the profile's executable
+   args     ARGS             added to the command line of every run
+   warmup   N                runs of each variant not measured, default 0
+   timeout  SECONDS          how long a run may take before it is stopped
+                             and counted as failed, default 300
+   metric   REGEX            how the child reports a measurement
+   profile  PROFILE          compare PROFILE as it is
+   mods     LABEL  MODLINE   a mod line to compare
+   flags    LABEL  FLAGLINE  a flag line to compare
+ Every mods line is tried with every flags line, on top of the base
+ profile, which is the current one unless given; a profile's own mod or
+ flag line is used where there are no mods or flags lines.
+
+ REGEX must have two groups, the name and the value. By default lines like
+ "METRIC frame_ms = 16.6" are read. Wall time is always measured. On
+ Linux, CPU time, peak memory and page faults are measured too, and the
+ child's output is read for what it reports; elsewhere only wall time is
+ measured.
+
+ Runs take turns across the variants, so that anything slowly changing on
+ the machine affects them all alike. cmdline_fso.cfg is written for each
+ run and put back for the current profile at the end. */
+int RunLaunchBenchmark(const wxString& manifestPath, long runs) {
+	wxTextFile manifest;
+	if (!manifest.Open(manifestPath, wxConvUTF8)) {
+		wxLogError(_("Unable to read launch benchmark manifest %s"), manifestPath.c_str());
+		return 1;
+	}
+
+	Settings settings;
+	wxArrayString profiles, modLabels, modLines, flagLabels, flagLines;
+	if (!ReadManifest(manifest, settings, profiles, modLabels, modLines,
+		flagLabels, flagLines)) {
+		return 1;
+	}
+	wxRegEx metricPattern(settings.metricPattern);
+	if (!metricPattern.IsValid()) {
+		wxLogError(_("'%s' is not a valid metric pattern"), settings.metricPattern.c_str());
+		return 1;
+	}
+
+	ProMan* proman = ProMan::GetProfileManager();
+	if (settings.base.IsEmpty()) {
+		settings.base = proman->GetCurrentName();
+	}
+
+	std::vector<Variant> variants;
+	for (size_t i = 0; i < profiles.GetCount(); ++i) {
+		Variant variant;
+		variant.label = profiles[i];
+		variant.profile = proman->GetSnapshotOf(profiles[i]);
+		variants.push_back(variant);
+	}
+	if (!modLines.IsEmpty() || !flagLines.IsEmpty()) {
+		// an axis that isn't given is the base profile's own line
+		const size_t mods = wxMax(modLines.GetCount(), static_cast<size_t>(1));
+		const size_t flags = wxMax(flagLines.GetCount(), static_cast<size_t>(1));
+		for (size_t m = 0; m < mods; ++m) {
+			for (size_t f = 0; f < flags; ++f) {
+				Variant variant;
+				ProfileEntryValues overrides;
+				if (!modLines.IsEmpty()) {
+					overrides[PRO_CFG_TC_CURRENT_MODLINE] = modLines[m];
+					variant.label = modLabels[m];
+				}
+				if (!flagLines.IsEmpty()) {
+					overrides[PRO_CFG_TC_CURRENT_FLAG_LINE] = flagLines[f];
+					variant.label += (variant.label.IsEmpty() ? wxString() : wxString(_T("/")))
+						+ flagLabels[f];
+				}
+				variant.profile = proman->GetSnapshotOf(settings.base, &overrides);
+				variants.push_back(variant);
+			}
+		}
+	}
+	if (variants.empty()) {
+		wxLogError(_("The launch benchmark manifest %s has nothing to compare"),
+			manifestPath.c_str());
+		return 1;
+	}
+	for (size_t v = 0; v < variants.size(); ++v) {
+		if (!variants[v].profile.IsOk() || !PrepareVariant(variants[v], settings)) {
+			return 1;
+		}
+	}
+
+	// the benchmark runs instead of the main loop, so it has a loop of its
+	// own for Yield() to dispatch the supervisor's events with
+	wxEventLoop loop;
+	wxEventLoopActivator activate(&loop);
+	RunWaiter waiter;
+	ProcessSupervisor supervisor(&waiter);
+
+	// what is measured, in the order it is reported
+	wxArrayString names;
+	for (const wxChar* const* name = BUILT_IN_MEASUREMENTS; *name != NULL; ++name) {
+		names.Add(*name);
+	}
+	Measurements measurements;
+	bool ok = true;
+	wxStopWatch timer;
+
+	for (long r = 0; r < settings.warmups; ++r) {
+		for (size_t v = 0; v < variants.size(); ++v) {
+			RunVariant(supervisor, waiter, variants[v], settings.timeout,
+				metricPattern, measurements);
+		}
+	}
+	for (long r = 0; r < runs; ++r) {
+		for (size_t v = 0; v < variants.size(); ++v) {
+			Variant& variant = variants[v];
+			if (!RunVariant(supervisor, waiter, variant, settings.timeout,
+				metricPattern, measurements)) {
+				variant.failures++;
+				ok = false;
+				continue;
+			}
+			variant.successes++;
+			for (Measurements::const_iterator it = measurements.begin(), end = measurements.end();
+				 it != end; ++it) {
+				variant.samples[it->first].push_back(it->second);
+				if (names.Index(it->first) == wxNOT_FOUND) {
+					names.Add(it->first);
+				}
+			}
+		}
+	}
+
+	ProfileSnapshotPtr current(proman->GetSnapshot());
+	if (current.IsOk() && PushCmdlineFSO(*current) != ProMan::NoError) {
+		wxLogError(_("Unable to put back cmdline_fso.cfg for the current profile"));
+		ok = false;
+	}
+
+	ProManOperator::ReportBenchmark(wxString::Format(
+		_T("Ran %lu variant(s) %ld time(s) each in %ld ms"),
+		static_cast<unsigned long>(variants.size()), runs, timer.Time()));
+	ReportComparison(variants, names);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef LAUNCHBENCHMARK_H
+#define LAUNCHBENCHMARK_H
+
+#include <wx/wx.h>
+
+/** Runs of each variant when no count is given. */
+const long LAUNCH_BENCHMARK_DEFAULT_RUNS = 5;
+
+/** Launches FS2 Open, or anything standing in for it, runs times for each
+ profile or mod and flag combination listed in the manifest at
+ manifestPath, and reports how each compares with the first. Returns 0 if
+ every run succeeded. */
+int RunLaunchBenchmark(const wxString& manifestPath, long runs);
+
+#endif
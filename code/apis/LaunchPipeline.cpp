@@ -0,0 +1,142 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/stopwatch.h>
+
+#include "apis/LaunchPipeline.h"
+#include "apis/PlatformProfileManager.h"
+#include "apis/ProfileManager.h"
+#include "global/Compatibility.h"
+
+#include "global/MemoryDebugging.h"
+
+LAUNCHER_DEFINE_EVENT_TYPE(EVT_LAUNCH_STAGE_DONE);
+LAUNCHER_DEFINE_EVENT_TYPE(EVT_LAUNCH_PREPARED);
+
+LaunchPipeline::LaunchPipeline(wxEvtHandler* owner,
+	const ProfileSnapshotPtr& profile, const wxString& rootFolder)
+: wxThread(wxTHREAD_JOINABLE), owner(owner), profile(MakeLaunchSnapshot(*profile)),
+  // the worker thread must not share a buffer with the caller's string
+  rootFolder(rootFolder.c_str()), isCancelled(false) {
+	wxASSERT(owner != NULL);
+	wxASSERT(profile.IsOk());
+}
+
+/** Starts running the stages. Returns false if they could not be
+ started, in which case no events will be sent. */
+bool LaunchPipeline::Start() {
+#if wxCHECK_VERSION(2, 9, 1)
+	if (this->Create() != wxTHREAD_NO_ERROR || this->Run() != wxTHREAD_NO_ERROR) {
+		wxLogError(_T("Unable to start the launch thread"));
+		return false;
+	}
+#else
+	this->Entry();
+#endif
+	return true;
+}
+
+/** Waits for the worker thread to end. */
+void LaunchPipeline::Join() {
+#if wxCHECK_VERSION(2, 9, 1)
+	this->Wait();
+#endif
+}
+
+/** Stops the pipeline before its next stage. The stage that is running
+ is allowed to finish so that no file is left half written. */
+void LaunchPipeline::Cancel() {
+	wxCriticalSectionLocker locker(this->cancelLock);
+	this->isCancelled = true;
+}
+
+bool LaunchPipeline::IsCancelled() const {
+	wxCriticalSectionLocker locker(this->cancelLock);
+	return this->isCancelled;
+}
+
+wxString LaunchPipeline::GetStageDescription(Stage stage) {
+	switch (stage) {
+		case STAGE_MIGRATE_CONFIG:
+			return _("Migrating old configuration");
+		case STAGE_PUSH_PROFILE:
+			return _("Writing settings");
+		case STAGE_SYNC_PILOTS:
+			return _("Synchronizing pilot files");
+		case STAGE_EXEC:
+			return _("Starting executable");
+		default:
+			wxFAIL_MSG(wxString::Format(_T("Unknown launch stage %d"), stage));
+			return wxEmptyString;
+	}
+}
+
+wxThread::ExitCode LaunchPipeline::Entry() {
+	wxCommandEvent event(EVT_LAUNCH_PREPARED, wxID_NONE);
+	event.SetInt(this->RunStages());
+	this->owner->AddPendingEvent(event);
+	return 0;
+}
+
+LaunchPipeline::Result LaunchPipeline::RunStages() {
+	for (int stage = 0; stage < STAGE_EXEC; stage++) {
+		if (this->IsCancelled()) {
+			return RESULT_CANCELLED;
+		}
+
+		wxStopWatch timer;
+		if (!this->RunStage(static_cast<Stage>(stage))) {
+			return RESULT_FAILED;
+		}
+		this->SendStageDone(static_cast<Stage>(stage), timer.Time());
+	}
+	return this->IsCancelled() ? RESULT_CANCELLED : RESULT_READY;
+}
+
+bool LaunchPipeline::RunStage(Stage stage) {
+	switch (stage) {
+		case STAGE_MIGRATE_CONFIG:
+			if (!Compatibility::MigrateOldConfig(*this->profile)) {
+				wxLogError(_T("Failed to migrate old config!!"));
+				return false;
+			}
+			return true;
+
+		case STAGE_PUSH_PROFILE:
+			return ProMan::NoError == ProMan::PushProfile(*this->profile);
+
+		case STAGE_SYNC_PILOTS:
+			if (!Compatibility::SynchronizeOldPilots(*this->profile, this->rootFolder)) {
+				wxLogError(_T("Failed to synchronize old pilot files!"));
+				return false;
+			}
+			return true;
+
+		default:
+			wxFAIL_MSG(wxString::Format(_T("Launch stage %d can't run on the pipeline"), stage));
+			return false;
+	}
+}
+
+void LaunchPipeline::SendStageDone(Stage stage, long milliseconds) {
+	wxCommandEvent event(EVT_LAUNCH_STAGE_DONE, wxID_NONE);
+	event.SetInt(stage);
+	event.SetExtraLong(milliseconds);
+	this->owner->AddPendingEvent(event);
+}
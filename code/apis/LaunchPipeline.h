@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef LAUNCHPIPELINE_H
+#define LAUNCHPIPELINE_H
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+
+#include "apis/EventHandlers.h"
+#include "datastructures/ProfileSnapshot.h"
+
+/** A launch stage has finished. The int is the LaunchPipeline::Stage, the
+ extra long how many milliseconds it took. */
+LAUNCHER_DECLARE_EVENT_TYPE(EVT_LAUNCH_STAGE_DONE);
+/** Every stage before exec has run. The int is a LaunchPipeline::Result. */
+LAUNCHER_DECLARE_EVENT_TYPE(EVT_LAUNCH_PREPARED);
+
+/** Does the work that has to happen between pressing Play or FRED and
+ starting the executable, on a worker thread so that slow disks don't
+ freeze the window.
+
+ The stages only read the profile snapshot they are given and the root
+ folder. The constructor, which runs on the main thread, adds to the
+ snapshot what they would otherwise ask the flag list manager, the
+ joystick manager and SDL, none of which may be used from the worker
+ thread; see MakeLaunchSnapshot(). Each stage sends
+ EVT_LAUNCH_STAGE_DONE to the owner when it finishes, and when they are
+ all done the owner gets EVT_LAUNCH_PREPARED. Starting the executable is
+ left to the owner, as wxExecute() must be called from the main thread.
+ Once it has EVT_LAUNCH_PREPARED the owner must Join() the pipeline and
+ delete it.
+
+ wxWidgets 2.8 can't log from worker threads, so there the stages run
+ during Start() instead. */
+class LaunchPipeline: public wxThread {
+public:
+	enum Stage {
+		STAGE_MIGRATE_CONFIG,
+		STAGE_PUSH_PROFILE,
+		STAGE_SYNC_PILOTS,
+		STAGE_EXEC,
+		STAGE_COUNT
+	};
+	enum Result {
+		RESULT_READY,
+		RESULT_FAILED,
+		RESULT_CANCELLED
+	};
+
+	LaunchPipeline(wxEvtHandler* owner, const ProfileSnapshotPtr& profile,
+		const wxString& rootFolder);
+
+	bool Start();
+	void Join();
+	void Cancel();
+	bool IsCancelled() const;
+
+	static wxString GetStageDescription(Stage stage);
+
+protected:
+	virtual ExitCode Entry();
+
+private:
+	Result RunStages();
+	bool RunStage(Stage stage);
+	void SendStageDone(Stage stage, long milliseconds);
+
+	wxEvtHandler* owner;
+	ProfileSnapshotPtr profile;
+	const wxString rootFolder;
+
+	mutable wxCriticalSection cancelLock;
+	bool isCancelled;
+};
+
+#endif
@@ -51,6 +51,8 @@ const wxByte BUILD_CAP_NEW_SND = 1<<2;
 namespace OpenALMan {
 wxDynamicLibrary OpenALLib;
 bool isInitialized = false;
+void ResolveFunctions();
+void ClearDevices();
 };
 using namespace OpenALMan;
 #endif
@@ -63,26 +65,25 @@ bool OpenALMan::Initialize() {
 	} else if ( OpenALLib.Load(_T("/System/Library/Frameworks/OpenAL.framework/OpenAL"),
 							   wxDL_VERBATIM) ) {
 		isInitialized = true;
-		return true;
-	} else if ( OpenALLib.Load(_T("/Library/Frameworks/OpenAL.framework/OpenAL"),
-							   wxDL_VERBATIM) ) {
-		isInitialized = true;
-		return true;
 #elif IS_WIN32
 	} else if ( OpenALLib.Load(_T("OpenAL32")) ) {
 		isInitialized = true;
-		return true;
 #else
 	} else if ( OpenALLib.Load(_T("libopenal")) ) {
 		isInitialized = true;
-		return true;
+#endif
+#if IS_APPLE
+	} else if ( OpenALLib.Load(_T("/Library/Frameworks/OpenAL.framework/OpenAL"),
+							   wxDL_VERBATIM) ) {
+		isInitialized = true;
 #endif
 	} else if ( OpenALLib.Load(_T("OpenAL")) ) {
 		isInitialized = true;
-		return true;
 	} else {
 		return false;
 	}
+	ResolveFunctions();
+	return true;
 #else
 	return false;
 #endif
@@ -90,6 +91,9 @@ bool OpenALMan::Initialize() {
 
 bool OpenALMan::DeInitialize() {
 #if USE_OPENAL
+	ClearDevices();
+	isInitialized = false;
+	ResolveFunctions();
 	OpenALLib.Unload();
 	return true;
 #else
@@ -123,11 +127,41 @@ typedef ALCboolean (ALC_APIENTRY *alcCloseDeviceType)(ALCdevice *);
 typedef ALCcontext* (ALC_APIENTRY *alcCreateContextType)(const ALCdevice*, const ALCint*);
 typedef ALCboolean (ALC_APIENTRY *alcMakeContextCurrentType)(ALCcontext*);
 typedef void (ALC_APIENTRY *alcDestroyContextType)(ALCcontext*);
+typedef void (ALC_APIENTRY *alcGetIntegervType)(ALCdevice*, ALCenum, ALCsizei, ALCint*);
+
+#ifndef ALC_MAX_AUXILIARY_SENDS
+#define ALC_MAX_AUXILIARY_SENDS                  0x20003
+#endif
 
 namespace OpenALMan {
 	template< typename funcPtrType> 
 	funcPtrType GetOpenALFunctionPointer(const wxString& name, size_t line);
 	bool checkForALError_(size_t line);
+
+	/** The OpenAL functions the launcher uses, looked up once when the
+	 library is loaded. An entry is NULL if the library doesn't have it. */
+	struct Functions {
+		alcGetStringType GetString;
+		alcIsExtensionPresentType IsExtensionPresent;
+		alcGetIntegervType GetIntegerv;
+		alcOpenDeviceType OpenDevice;
+		alcCloseDeviceType CloseDevice;
+		alcCreateContextType CreateContext;
+		alcMakeContextCurrentType MakeContextCurrent;
+		alcDestroyContextType DestroyContext;
+		alGetStringType GetALString;
+		alGetErrorType GetError;
+	};
+	Functions AL;
+
+	WX_DECLARE_STRING_HASH_MAP(DeviceInfo, DeviceInfoMap);
+	/** Every playback device that has been opened and given a context, so
+	 that none is opened twice. Devices that couldn't be aren't kept, as they
+	 may be plugged in or freed up by the next time they are asked about. */
+	DeviceInfoMap probedDevices;
+	wxCriticalSection probedDevicesLock;
+
+	DeviceInfo ProbeDevice(const wxString& playbackDeviceName);
 };
 #define ___GetOALFuncPtr(type, name, line) GetOpenALFunctionPointer<type>(_T(name), line)
 #define GetOALFuncPtr(type, name) ___GetOALFuncPtr(type, #name, __LINE__)
@@ -156,12 +190,30 @@ OpenALMan::GetOpenALFunctionPointer(const wxString& name, size_t line) {
 	return pointer;
 }
 
+/** Fills in the function table from the loaded library, or empties it if
+ the library isn't loaded. */
+void OpenALMan::ResolveFunctions() {
+	memset(&AL, 0, sizeof(AL));
+	if ( !isInitialized ) {
+		return;
+	}
+	AL.GetString = GetOALFuncPtr(alcGetStringType, alcGetString);
+	AL.IsExtensionPresent = GetOALFuncPtr(alcIsExtensionPresentType, alcIsExtensionPresent);
+	AL.GetIntegerv = GetOALFuncPtr(alcGetIntegervType, alcGetIntegerv);
+	AL.OpenDevice = GetOALFuncPtr(alcOpenDeviceType, alcOpenDevice);
+	AL.CloseDevice = GetOALFuncPtr(alcCloseDeviceType, alcCloseDevice);
+	AL.CreateContext = GetOALFuncPtr(alcCreateContextType, alcCreateContext);
+	AL.MakeContextCurrent = GetOALFuncPtr(alcMakeContextCurrentType, alcMakeContextCurrent);
+	AL.DestroyContext = GetOALFuncPtr(alcDestroyContextType, alcDestroyContext);
+	AL.GetALString = GetOALFuncPtr(alGetStringType, alGetString);
+	AL.GetError = GetOALFuncPtr(alGetErrorType, alGetError);
+}
+
 bool OpenALMan::checkForALError_(size_t line) {
-	alGetErrorType getError = GetOALFuncPtr(alGetErrorType, alGetError);
-	if ( getError == NULL ) {
+	if ( AL.GetError == NULL ) {
 		return false;
 	}
-	ALenum errorcode = (*getError)();
+	ALenum errorcode = (*AL.GetError)();
 	if ( errorcode == AL_NO_ERROR ) {
 		return true;
 	} else if ( errorcode == AL_INVALID_NAME ) {
@@ -188,8 +240,7 @@ wxArrayString GetAvailableDevices(const ALenum deviceType) {
 
 	ALenum adjustedDeviceType = deviceType;
 	
-	alcIsExtensionPresentType isExtensionPresent =
-		GetOALFuncPtr(alcIsExtensionPresentType, alcIsExtensionPresent);
+	alcIsExtensionPresentType isExtensionPresent = AL.IsExtensionPresent;
 
 	if ( isExtensionPresent != NULL ) {
 		if ( (*isExtensionPresent)(NULL, "ALC_ENUMERATION_EXT") != AL_TRUE ) {
@@ -205,7 +256,7 @@ wxArrayString GetAvailableDevices(const ALenum deviceType) {
 		adjustedDeviceType = ALC_ALL_DEVICES_SPECIFIER;
 	}
 	
-	alcGetStringType GetString = GetOALFuncPtr(alcGetStringType, alcGetString);
+	alcGetStringType GetString = AL.GetString;
 
 	if ( GetString != NULL ) {
 		const ALCchar* devices = (*GetString)(NULL, adjustedDeviceType);
@@ -262,8 +313,7 @@ wxString GetSystemDefaultDevice(const ALenum deviceType) {
 	
 	ALenum adjustedDeviceType = deviceType;
 	
-	alcIsExtensionPresentType isExtensionPresent =
-		GetOALFuncPtr(alcIsExtensionPresentType, alcIsExtensionPresent);
+	alcIsExtensionPresentType isExtensionPresent = AL.IsExtensionPresent;
 	
 	if ((isExtensionPresent != NULL) &&
 		(deviceType == ALC_DEFAULT_DEVICE_SPECIFIER) &&
@@ -271,7 +321,7 @@ wxString GetSystemDefaultDevice(const ALenum deviceType) {
 			adjustedDeviceType = ALC_DEFAULT_ALL_DEVICES_SPECIFIER;
 	}
 	
-	alcGetStringType GetString = GetOALFuncPtr(alcGetStringType, alcGetString);
+	alcGetStringType GetString = AL.GetString;
 
 	if ( GetString == NULL ) {
 		return wxEmptyString;
@@ -316,86 +366,135 @@ wxString OpenALMan::GetSystemDefaultCaptureDevice() {
 }
 
 
-wxString OpenALMan::GetCurrentVersion() {
 #if USE_OPENAL
-	alGetStringType GetString = GetOALFuncPtr(alGetStringType,alGetString);
-
-	if ( GetString == NULL ) {
-		return _("Unknown version");
+/** Reads an AL string from the current context. */
+static wxString GetContextString(ALenum param) {
+	const ALchar* value = (*AL.GetALString)(param);
+	if ( !checkForALError() || value == NULL ) {
+		return wxEmptyString;
 	}
-	
-	wxString selectedDevice;
-	ProMan::GetProfileManager()->ProfileRead(PRO_CFG_OPENAL_DEVICE, &selectedDevice);
+	return wxString(value, wxConvUTF8);
+}
 
-	alcOpenDeviceType OpenDevice = 
-		GetOALFuncPtr(alcOpenDeviceType,alcOpenDevice);
-	if ( OpenDevice == NULL) {
-		return _("Unable to get open device function");
+/** Opens the device and records what it can do. A device that works is
+ only ever opened once; later calls return what was found the first time.
+ One that doesn't is opened again each time it is asked about.
+ 
+ bits are adapted from the old GetCurrentVersion() and IsEFXSupported() and
+ FSO, sound/ds.cpp, ds_init() */
+DeviceInfo OpenALMan::ProbeDevice(const wxString& playbackDeviceName) {
+	wxCriticalSectionLocker locker(probedDevicesLock);
+	DeviceInfoMap::iterator it = probedDevices.find(playbackDeviceName);
+	if ( it != probedDevices.end() ) {
+		return it->second;
 	}
-
-	ALCdevice* device = (*OpenDevice)(selectedDevice.char_str());
-	if ( device == NULL) {
-		wxLogError(_T("alcOpenDevice returned NULL for selected device '%s'"),
-			selectedDevice.c_str());
-		return _("Error opening device");
+	DeviceInfo info;
+	
+	if ( AL.OpenDevice == NULL || AL.CloseDevice == NULL
+		|| AL.IsExtensionPresent == NULL || AL.GetIntegerv == NULL ) {
+		info.error = _("Unable to get open device function");
+		return info;
 	}
-
-	alcCreateContextType CreateContext =
-		GetOALFuncPtr(alcCreateContextType,alcCreateContext);
-	if ( CreateContext == NULL) {
-		return _("Unable to get open context on device function");
+	if ( AL.CreateContext == NULL || AL.MakeContextCurrent == NULL
+		|| AL.DestroyContext == NULL || AL.GetALString == NULL ) {
+		info.error = _("Unable to get open context on device function");
+		return info;
 	}
 
-	ALCint attributes = 0;
-	ALCcontext* context = (*CreateContext)(device,NULL);
-	if ( context == NULL) {
-		return _("Error in opening context");
+	ALCdevice* device = (*AL.OpenDevice)(playbackDeviceName.char_str());
+	if ( device == NULL ) {
+		wxLogError(_T("alcOpenDevice returned NULL for device '%s'"),
+			playbackDeviceName.c_str());
+		info.error = _("Error opening device");
+		return info;
 	}
 
-	alcMakeContextCurrentType MakeContextCurrent =
-		GetOALFuncPtr(alcMakeContextCurrentType,alcMakeContextCurrent);
-	if ( MakeContextCurrent == NULL) {
-		return _("Unable to get the set context as current function");
+	info.hasEFX = (*AL.IsExtensionPresent)(device, "ALC_EXT_EFX") == AL_TRUE;
+	ALCint value = 0;
+	(*AL.GetIntegerv)(device, ALC_MAJOR_VERSION, 1, &value);
+	info.alcMajorVersion = value;
+	value = 0;
+	(*AL.GetIntegerv)(device, ALC_MINOR_VERSION, 1, &value);
+	info.alcMinorVersion = value;
+	if ( info.hasEFX ) {
+		value = 0;
+		(*AL.GetIntegerv)(device, ALC_MAX_AUXILIARY_SENDS, 1, &value);
+		info.maxAuxiliarySends = value;
 	}
 
-	if ( (*MakeContextCurrent)(context) != ALC_TRUE || checkForALError() == false ) {
-		return _("Error in setting context as current");
-	}
-	
-	const ALCchar* version = (*GetString)(AL_VERSION);
-	if ( !checkForALError() || version == NULL ) {
-		wxLogError(_T("OpenAL: Unable to retrieve Version String"));
-		return _("Unknown version");
+	ALCcontext* context = (*AL.CreateContext)(device, NULL);
+	if ( context == NULL ) {
+		info.error = _("Error in opening context");
+	} else {
+		if ( (*AL.MakeContextCurrent)(context) != ALC_TRUE || checkForALError() == false ) {
+			info.error = _("Error in setting context as current");
+		} else {
+			info.version = GetContextString(AL_VERSION);
+			info.renderer = GetContextString(AL_RENDERER);
+			info.vendor = GetContextString(AL_VENDOR);
+			if ( info.version.IsEmpty() ) {
+				wxLogError(_T("OpenAL: Unable to retrieve Version String"));
+				info.error = _("Unknown version");
+			} else {
+				info.isOk = true;
+			}
+			// unset the current context
+			(*AL.MakeContextCurrent)(NULL);
+		}
+		(*AL.DestroyContext)(context);
 	}
-	wxString Version(version, wxConvUTF8);
 
-	// unset the current context
-	(*MakeContextCurrent)(NULL);
+	(*AL.CloseDevice)(device);
 
-	alcDestroyContextType DestroyContext =
-		GetOALFuncPtr(alcDestroyContextType,alcDestroyContext);
-	if ( DestroyContext == NULL ) {
-		return _("Unable to destroy context");
+	wxLogDebug(_T("OpenAL device '%s': %s, ALC %d.%d, EFX %s with %d sends"),
+		playbackDeviceName.c_str(),
+		info.isOk ? info.version.c_str() : info.error.c_str(),
+		info.alcMajorVersion, info.alcMinorVersion,
+		info.hasEFX ? _T("supported") : _T("not supported"),
+		info.maxAuxiliarySends);
+	if ( info.isOk ) {
+		probedDevices[playbackDeviceName] = info;
 	}
+	return info;
+}
 
-	(*DestroyContext)(context);
-	context = NULL;
+void OpenALMan::ClearDevices() {
+	wxCriticalSectionLocker locker(probedDevicesLock);
+	probedDevices.clear();
+}
+#endif
 
-	alcCloseDeviceType CloseDevice =
-		GetOALFuncPtr(alcCloseDeviceType,alcCloseDevice);
-	if ( CloseDevice == NULL ) {
-		return _("Unable to close device");
-	}
+/** Gets what is known about the playback device, opening it if it hasn't
+ been opened successfully before. Returns false if OpenAL isn't available. */
+bool OpenALMan::GetDeviceInfo(const wxString& playbackDeviceName, DeviceInfo& info) {
+#if USE_OPENAL
+	wxCHECK_MSG( OpenALMan::IsInitialized(), false,
+		_T("GetDeviceInfo called but OpenALMan not initialized"));
+	info = ProbeDevice(playbackDeviceName);
+	return true;
+#else
+	return false;
+#endif
+}
 
-	(*CloseDevice)(device);
+wxString OpenALMan::GetCurrentVersion() {
+#if USE_OPENAL
+	wxString selectedDevice;
+	ProMan::GetProfileManager()->ProfileRead(PRO_CFG_OPENAL_DEVICE, &selectedDevice);
 
-	return wxString::Format(_("Detected OpenAL version: %s"), Version.c_str());
+	DeviceInfo info;
+	if ( !GetDeviceInfo(selectedDevice, info) ) {
+		return _("Unknown version");
+	}
+	if ( !info.isOk ) {
+		return info.error;
+	}
+	return wxString::Format(_("Detected OpenAL version: %s"), info.version.c_str());
 #else
 	return wxEmptyString;
 #endif
 }
 
-// bits are adapted from GetCurrentVersion() and FSO, sound/ds.cpp, ds_init()
 bool OpenALMan::IsEFXSupported(const wxString& playbackDeviceName) {
 #if USE_OPENAL
 	wxCHECK_MSG( OpenALMan::IsInitialized(), false,
@@ -406,45 +505,9 @@ bool OpenALMan::IsEFXSupported(const wxString& playbackDeviceName) {
 		return false;
 	}
 	
-	alcOpenDeviceType OpenDevice = 
-		GetOALFuncPtr(alcOpenDeviceType, alcOpenDevice);
-
-	if (OpenDevice == NULL) {
-		wxLogError(_T("IsEFXSupported: Unable to open device."));
-		return false;
-	}
-
-	ALCdevice* playbackDevice = (*OpenDevice)(playbackDeviceName.char_str());
-	
-	if (playbackDevice == NULL) {
-		wxLogError(
-			_T("IsEFXSupported: alcOpenDevice returned NULL when opening device '%s'"),
-			playbackDeviceName.c_str());
-		return false;
-	}
-
-	alcIsExtensionPresentType isExtensionPresent =
-		GetOALFuncPtr(alcIsExtensionPresentType, alcIsExtensionPresent);
-	
-	if (isExtensionPresent == NULL) {
-		wxLogError(
-			_T("IsEFXSupported: Could not get alcIsExtensionPresent function."));
-		return false;
-	}
-	
-	bool hasEFX = (*isExtensionPresent)(playbackDevice, "ALC_EXT_EFX") == AL_TRUE;
-
-	alcCloseDeviceType CloseDevice =
-		GetOALFuncPtr(alcCloseDeviceType, alcCloseDevice);
-	
-	if (CloseDevice == NULL) {
-		wxLogError(_T("IsEFXSupported: Unable to close device."));
-		return false;
-	}
-
-	(*CloseDevice)(playbackDevice);
-
-	return hasEFX;
+	DeviceInfo info;
+	GetDeviceInfo(playbackDeviceName, info);
+	return info.hasEFX;
 #else
 	return false;
 #endif
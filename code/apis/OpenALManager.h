@@ -26,6 +26,22 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #endif
 
 namespace OpenALMan {
+	/** What was found out about a playback device by opening it. */
+	struct DeviceInfo {
+		DeviceInfo()
+		: isOk(false), hasEFX(false),
+		  alcMajorVersion(0), alcMinorVersion(0), maxAuxiliarySends(0) { }
+		bool isOk; //!< the device could be opened and given a context
+		wxString error; //!< why it couldn't, if it couldn't
+		wxString version; //!< AL_VERSION
+		wxString renderer; //!< AL_RENDERER
+		wxString vendor; //!< AL_VENDOR
+		bool hasEFX; //!< has ALC_EXT_EFX
+		int alcMajorVersion;
+		int alcMinorVersion;
+		int maxAuxiliarySends; //!< EFX effect slots a source can feed
+	};
+
 	bool Initialize();
 	bool DeInitialize();
 	bool WasCompiledIn();
@@ -40,6 +56,7 @@ namespace OpenALMan {
 	wxString GetSystemDefaultCaptureDevice();
 	
 	bool IsEFXSupported(const wxString& playbackDeviceName);
+	bool GetDeviceInfo(const wxString& playbackDeviceName, DeviceInfo& info);
 	bool BuildHasNewSoundCode();
 };
 
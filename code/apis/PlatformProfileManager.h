@@ -19,14 +19,45 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef PLATFORMPROFILEMANAGER_H
 #define PLATFORMPROFILEMANAGER_H
 #include <wx/fileconf.h>
+#include <wx/filename.h>
 #include "apis/ProfileManager.h"
 
-ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg);
+ProMan::RegistryCodes RegistryPushProfile(const ProfileSnapshot& profile);
 ProMan::RegistryCodes RegistryPullProfile(wxFileConfig *cfg);
 
-ProMan::RegistryCodes FilePushProfile(wxFileConfig *cfg);
+ProMan::RegistryCodes FilePushProfile(const ProfileSnapshot& profile);
 ProMan::RegistryCodes FilePullProfile(wxFileConfig *cfg);
 
-ProMan::RegistryCodes PushCmdlineFSO(wxFileConfig *cfg);
+ProMan::RegistryCodes PushCmdlineFSO(const ProfileSnapshot& profile);
+
+wxFileName GetPlatformDefaultConfigFilePath(const ProfileSnapshot& profile);
+
+/** \defgroup launchsnapshots What a push needs to know besides the profile
+ The build's capabilities, the selected joystick's GUID and SDL's
+ preference folder come from the flag list manager, the joystick manager
+ and SDL, which may only be used from the main thread. MakeLaunchSnapshot()
+ copies them into a snapshot on the main thread so that the push can run
+ on a worker thread; the GetLaunch functions read them from there, and
+ only look them up themselves for snapshots made some other way. */
+/** @{ */
+ProfileSnapshotPtr MakeLaunchSnapshot(const ProfileSnapshot& profile);
+int GetLaunchBuildCaps(const ProfileSnapshot& profile);
+wxString GetLaunchJoystickGUID(const ProfileSnapshot& profile);
+wxFileName GetLaunchPrefFolder(const ProfileSnapshot& profile);
+/** @} */
+
+/** \defgroup pushfingerprints Skipping pushes that would change nothing
+ A push remembers a fingerprint of what it wrote to each target file along
+ with the file's size and modification time, so the next push with the same
+ fingerprint can skip the file as long as nothing else has touched it.
+ The records are also kept in a file in the launcher's own storage folder,
+ keyed by the target's path, so a new session can skip pushes that the last
+ one already made. */
+/** @{ */
+wxString MakePushFingerprint(const ProfileSnapshot& profile,
+	const wxString* const keys[], size_t count);
+bool IsPushCurrent(const wxFileName& target, const wxString& fingerprint);
+void RememberPush(const wxFileName& target, const wxString& fingerprint);
+/** @} */
 
 #endif
\ No newline at end of file
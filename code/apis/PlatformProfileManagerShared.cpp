@@ -18,36 +18,242 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <wx/wx.h>
 #include <wx/dir.h>
+#include <wx/ffile.h>
 #include <wx/filename.h>
-#include <wx/wfstream.h>
+#include <wx/hashmap.h>
+#include <wx/thread.h>
+#include <wx/tokenzr.h>
 #include "generated/configure_launcher.h"
 #include "apis/PlatformProfileManager.h"
+#include "apis/FlagListManager.h"
+#include "apis/JoystickManager.h"
 #include "controls/LightingPresets.h"
+#include "global/AtomicFileBatch.h"
+#include "global/BasicDefaults.h"
 #include "global/ProfileKeys.h"
 
-ProMan::RegistryCodes PushCmdlineFSO(wxFileConfig *cfg) {
+#include <string>
+
+WX_DECLARE_STRING_HASH_MAP( wxString, PushRecords );
+
+/** Stat stamp and fingerprint hash of the last push, by full path of the
+ file. They are also kept in a file in the launcher's own storage folder,
+ so that the first push of a session can be skipped too. */
+static PushRecords pushRecords;
+static bool arePushRecordsLoaded = false;
+static wxCriticalSection pushRecordsLock;
+
+/** Bumped whenever what the records file holds changes, so older ones are
+ ignored. */
+static const wxChar* const PUSH_RECORDS_HEADER = _T("wxLauncher push records 1");
+static const wxChar* const PUSH_RECORDS_FILE_NAME = _T("pushes.txt");
+
+/** Size and modification time of path, or an empty string if it cannot
+ be stat'd. */
+static wxString GetStatStamp(const wxString& path) {
+	wxStructStat st;
+	if (wxStat(path, &st) != 0) {
+		return wxEmptyString;
+	}
+	return wxString::Format(_T("%ld:%ld"),
+		static_cast<long>(st.st_size), static_cast<long>(st.st_mtime));
+}
+
+/** FNV-1a of the fingerprint, so the records stay small and don't repeat the
+ profile's settings. */
+static wxString HashFingerprint(const wxString& fingerprint) {
+	const wxCharBuffer bytes(fingerprint.mb_str(wxConvUTF8));
+	wxUint64 hash = wxULL(14695981039346656037);
+	for (const char* c = bytes.data(); *c != '\0'; ++c) {
+		hash ^= static_cast<unsigned char>(*c);
+		hash *= wxULL(1099511628211);
+	}
+	return wxString::Format(_T("%08lx%08lx"),
+		static_cast<unsigned long>(hash >> 32),
+		static_cast<unsigned long>(hash & 0xffffffff));
+}
+
+static wxFileName GetPushRecordsFile() {
+	return wxFileName(GetProfileStorageFolder(), PUSH_RECORDS_FILE_NAME);
+}
+
+/** Reads the records a previous session left, one "record<TAB>path" per
+ line. Must be called with pushRecordsLock held. */
+static void LoadPushRecords() {
+	arePushRecordsLoaded = true;
+	const wxFileName recordsFile(GetPushRecordsFile());
+	if (!recordsFile.FileExists()) {
+		return;
+	}
+	wxFFile file(recordsFile.GetFullPath(), _T("rb"));
+	wxString contents;
+	if (!file.IsOpened() || !file.ReadAll(&contents, wxConvUTF8)
+		|| contents.BeforeFirst(_T('\n')) != PUSH_RECORDS_HEADER) {
+		return;
+	}
+	wxStringTokenizer lines(contents.AfterFirst(_T('\n')), _T("\n"));
+	while (lines.HasMoreTokens()) {
+		const wxString line(lines.GetNextToken());
+		const wxString path(line.AfterFirst(_T('\t')));
+		if (!path.IsEmpty() && pushRecords.find(path) == pushRecords.end()) {
+			pushRecords[path] = line.BeforeFirst(_T('\t'));
+		}
+	}
+}
+
+/** Must be called with pushRecordsLock held. Records that can't be saved
+ only cost the next session a push. */
+static void SavePushRecords() {
+	wxString contents(PUSH_RECORDS_HEADER);
+	contents += _T('\n');
+	for (PushRecords::const_iterator it = pushRecords.begin(), end = pushRecords.end();
+		 it != end; ++it) {
+		if (!it->second.IsEmpty()) {
+			contents << it->second << _T('\t') << it->first << _T('\n');
+		}
+	}
+	const wxCharBuffer bytes(contents.mb_str(wxConvUTF8));
+	AtomicFileBatch batch;
+	if (!batch.SaveBytes(bytes.data(), strlen(bytes.data()), GetPushRecordsFile())
+		|| !batch.Commit()) {
+		wxLogDebug(_T("Unable to save push records to %s"),
+			GetPushRecordsFile().GetFullPath().c_str());
+	}
+}
+
+extern wxFileName GetPlatformDefaultConfigFilePathNew();
+
+/** Must be called on the main thread. */
+ProfileSnapshotPtr MakeLaunchSnapshot(const ProfileSnapshot& profile) {
+	wxASSERT_MSG(wxThread::IsMain(), _T("MakeLaunchSnapshot() called off the main thread"));
+	ProfileEntryValues resolved;
+	resolved[INT_LAUNCH_BUILD_CAPS] = wxString::Format(_T("%d"), GetLaunchBuildCaps(profile));
+	resolved[INT_LAUNCH_JOYSTICK_GUID] = GetLaunchJoystickGUID(profile);
+	resolved[INT_LAUNCH_PREF_FOLDER] = GetLaunchPrefFolder(profile).GetFullPath();
+	return ProfileSnapshotPtr(new ProfileSnapshot(profile, resolved));
+}
+
+int GetLaunchBuildCaps(const ProfileSnapshot& profile) {
+	long caps;
+	if (profile.Read(INT_LAUNCH_BUILD_CAPS, &caps)) {
+		return static_cast<int>(caps);
+	}
+	wxASSERT_MSG(wxThread::IsMain(), _T("Build caps read off the main thread"));
+	return FlagListManager::GetFlagListManager()->GetBuildCaps();
+}
+
+wxString GetLaunchJoystickGUID(const ProfileSnapshot& profile) {
+	wxString guid;
+	if (profile.Read(INT_LAUNCH_JOYSTICK_GUID, &guid)) {
+		return guid;
+	}
+	wxASSERT_MSG(wxThread::IsMain(), _T("Joystick GUID read off the main thread"));
+	int currentJoystick;
+	profile.Read(PRO_CFG_JOYSTICK_ID, &currentJoystick, DEFAULT_JOYSTICK_ID);
+	return JoyMan::JoystickGUID(currentJoystick);
+}
+
+wxFileName GetLaunchPrefFolder(const ProfileSnapshot& profile) {
+	wxString folder;
+	if (profile.Read(INT_LAUNCH_PREF_FOLDER, &folder)) {
+		wxFileName path;
+		path.AssignDir(folder);
+		return path;
+	}
+	wxASSERT_MSG(wxThread::IsMain(), _T("SDL's preference folder looked up off the main thread"));
+	return GetPlatformDefaultConfigFilePathNew();
+}
+
+wxString MakePushFingerprint(const ProfileSnapshot& profile,
+	const wxString* const keys[], size_t count) {
+	wxString fingerprint;
+	for (size_t i = 0; i < count; i++) {
+		wxString value;
+		fingerprint += *keys[i];
+		// a missing key and an empty value are pushed differently
+		if (profile.Read(*keys[i], &value)) {
+			fingerprint += _T('=');
+			fingerprint += value;
+		}
+		fingerprint += _T('\n');
+	}
+	return fingerprint;
+}
+
+/** Returns true if target was last written by a push with the same
+ fingerprint, in this session or an earlier one, and its size and
+ modification time show it has not been changed since. */
+bool IsPushCurrent(const wxFileName& target, const wxString& fingerprint) {
+	const wxString path(target.GetFullPath());
+	const wxString stamp(GetStatStamp(path));
+	if (stamp.IsEmpty()) {
+		return false;
+	}
+	const wxString record(stamp + _T(' ') + HashFingerprint(fingerprint));
+
+	wxCriticalSectionLocker locker(pushRecordsLock);
+	if (!arePushRecordsLoaded) {
+		LoadPushRecords();
+	}
+	PushRecords::const_iterator iter = pushRecords.find(path);
+	return iter != pushRecords.end() && iter->second == record;
+}
+
+void RememberPush(const wxFileName& target, const wxString& fingerprint) {
+	const wxString path(target.GetFullPath());
+	const wxString stamp(GetStatStamp(path));
+	const wxString record(stamp.IsEmpty() ? wxString()
+		: stamp + _T(' ') + HashFingerprint(fingerprint));
+
+	wxCriticalSectionLocker locker(pushRecordsLock);
+	if (!arePushRecordsLoaded) {
+		LoadPushRecords();
+	}
+	pushRecords[path] = record;
+	SavePushRecords();
+}
+
+ProMan::RegistryCodes PushCmdlineFSO(const ProfileSnapshot& profile) {
 	wxString modLine, flagLine, tcPath;
-	cfg->Read(PRO_CFG_TC_CURRENT_MODLINE, &modLine);
-	cfg->Read(PRO_CFG_TC_CURRENT_FLAG_LINE, &flagLine);
-	cfg->Read(PRO_CFG_TC_ROOT_FOLDER, &tcPath);
+	profile.Read(PRO_CFG_TC_CURRENT_MODLINE, &modLine);
+	profile.Read(PRO_CFG_TC_CURRENT_FLAG_LINE, &flagLine);
+	profile.Read(PRO_CFG_TC_ROOT_FOLDER, &tcPath);
 	
 	wxString presetName;
 	wxString lightingPresetFlagSet;
-	if (cfg->Read(PRO_CFG_LIGHTING_PRESET, &presetName)) {
-		lightingPresetFlagSet = LightingPresets::PresetNameToPresetFlagSet(presetName);
+	if (profile.Read(PRO_CFG_LIGHTING_PRESET, &presetName)) {
+		// copied rather than shared, as pushes may run on a worker thread
+		lightingPresetFlagSet = LightingPresets::PresetNameToPresetFlagSet(presetName).c_str();
 	}
 
-	extern wxFileName GetPlatformDefaultConfigFilePath(const wxString&);
-	wxString cmdLineString = GetPlatformDefaultConfigFilePath(tcPath).GetFullPath();
+	wxString cmdLineString = GetPlatformDefaultConfigFilePath(profile).GetFullPath();
 
 	cmdLineString += _T("data");
-	
-#if IS_LINUX // try to rename file in root folder if exists
+	const wxString dataFolder(cmdLineString);
+	cmdLineString += wxFileName::GetPathSeparator();
+	cmdLineString += _T("cmdline_fso.cfg");
+	wxFileName cmdLineFileName(cmdLineString);
+
+#if IS_LINUX // a copy in the root folder would be used instead of ours
 	wxFileName tcCfgFile(tcPath + wxFileName::GetPathSeparator());
 	tcCfgFile.AppendDir(_T("data"));
 	tcCfgFile.SetFullName(_T("cmdline_fso.cfg"));
-	
-	if (tcCfgFile.IsOk() && ::wxFileExists(tcCfgFile.GetFullPath())) {
+	const bool hasRootFolderCopy = tcCfgFile.IsOk() && ::wxFileExists(tcCfgFile.GetFullPath());
+#else
+	const bool hasRootFolderCopy = false;
+#endif
+
+	// checked before anything is renamed or created, so that a push that
+	// would change nothing touches nothing
+	const wxString fingerprint(modLine + _T('\n') + flagLine + _T('\n')
+		+ lightingPresetFlagSet);
+	if (!hasRootFolderCopy && IsPushCurrent(cmdLineFileName, fingerprint)) {
+		wxLogDebug(_T("%s is up to date"), cmdLineFileName.GetFullPath().c_str());
+		return ProMan::NoError;
+	}
+
+#if IS_LINUX // try to rename file in root folder if exists
+	if (hasRootFolderCopy) {
 		wxFileName tcCfgRenameFile(tcCfgFile);
 		tcCfgRenameFile.SetFullName(_T("cmdline_fso.old.cfg"));
 		
@@ -75,45 +281,41 @@ ProMan::RegistryCodes PushCmdlineFSO(wxFileConfig *cfg) {
 #endif
 
 	// if data folder does not exist in cmdline folder, attempt to create it first
-	if (!wxDir::Exists(cmdLineString)) {
-		if (!::wxMkdir(cmdLineString)) {
+	if (!wxDir::Exists(dataFolder)) {
+		if (!::wxMkdir(dataFolder)) {
 			wxLogError(_T("Couldn't create 'data' folder %s"),
-				cmdLineString.c_str());
+				dataFolder.c_str());
 			return ProMan::UnknownError;
 		}
 		wxLogDebug(_T("'data' folder %s created"),
-			cmdLineString.c_str());
+			dataFolder.c_str());
 	} else {
 		wxLogDebug(_T("'data' folder %s found"),
-			cmdLineString.c_str());	
+			dataFolder.c_str());	
 	}
 
-	cmdLineString += wxFileName::GetPathSeparator();
-	cmdLineString += _T("cmdline_fso.cfg");
-	wxFileName cmdLineFileName(cmdLineString);
-	wxFFileOutputStream outStream(cmdLineFileName.GetFullPath(), _T("w+b"));
-	if ( !outStream.IsOk() ) {
-		return ProMan::UnknownError;
-	}
+	std::string cmdLine;
 	if ( !modLine.IsEmpty()) {
-		outStream.Write("-mod ", 5);
-
 		// Enclose the mod parameter in quotes to escape spaces
-		outStream.Write("\"", 1);
-		outStream.Write(modLine.char_str(), modLine.size());
-		outStream.Write("\"", 1);
+		cmdLine += "-mod \"";
+		cmdLine += static_cast<const char*>(modLine.char_str());
+		cmdLine += "\"";
 	}
 	if ( !flagLine.IsEmpty() ) {
-		outStream.Write(" ", 1);
-		outStream.Write(flagLine.char_str(), flagLine.size());
+		cmdLine += " ";
+		cmdLine += static_cast<const char*>(flagLine.char_str());
 	}
 	if ( !lightingPresetFlagSet.IsEmpty()) {
-		outStream.Write(" ", 1);
-		outStream.Write(lightingPresetFlagSet.char_str(), lightingPresetFlagSet.size());
+		cmdLine += " ";
+		cmdLine += static_cast<const char*>(lightingPresetFlagSet.char_str());
 	}
-	if ( !outStream.Close() ) {
+	// the game must never see a half written command line
+	AtomicFileBatch batch;
+	if ( !batch.SaveBytes(cmdLine.data(), cmdLine.size(), cmdLineFileName)
+		|| !batch.Commit() ) {
 		return ProMan::UnknownError;
 	}
+	RememberPush(cmdLineFileName, fingerprint);
 
 	return ProMan::NoError;
 }
\ No newline at end of file
@@ -0,0 +1,830 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/cmdline.h>
+
+#include "apis/ProcessSupervisor.h"
+
+#if IS_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+extern char** environ;
+#endif
+
+#include "global/MemoryDebugging.h"
+
+LAUNCHER_DEFINE_EVENT_TYPE(EVT_PROCESS_EXITED);
+
+namespace
+{
+	const int STOP_CHECK_INTERVAL = 250; // ms
+#if IS_LINUX
+	const int FALLBACK_POLL_INTERVAL = 100; // ms, for children without a pidfd
+	const int IOPRIO_WHO_PROCESS = 1;
+	const int IOPRIO_CLASS_SHIFT = 13;
+
+	/** What the child reports back to Spawn() before it execs. */
+	struct SpawnReport {
+		enum Step {
+			STEP_AFFINITY,
+			STEP_NICE,
+			STEP_IO_PRIORITY,
+			STEP_CHDIR, //!< fatal
+			STEP_EXEC //!< fatal
+		};
+		int step;
+		int error;
+	};
+
+	/** Only uses what is safe between fork() and exec(). */
+	void ReportFromChild(int fd, int step) {
+		const SpawnReport report = { step, errno };
+		ssize_t ignored = ::write(fd, &report, sizeof(report));
+		(void)ignored;
+	}
+
+	/** Gives the read ends of children's output pipes to a process of their
+	 own that reads them, throwing away what it reads, until every writer
+	 has closed them. Closing them instead would kill the children with
+	 SIGPIPE the next time they wrote anything. The fds are still the
+	 caller's to close. */
+	void DiscardOutput(const std::vector<int>& outputFds) {
+		if (outputFds.empty()) {
+			return;
+		}
+		// nothing may be allocated after fork(), as other threads may have
+		// held the allocator's locks
+		std::vector<struct pollfd> fds;
+		for (size_t i = 0; i < outputFds.size(); ++i) {
+			struct pollfd fd = { outputFds[i], POLLIN, 0 };
+			fds.push_back(fd);
+		}
+		struct rlimit limit;
+		const int maxFd = (::getrlimit(RLIMIT_NOFILE, &limit) == 0
+			&& limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < 65536)
+			? static_cast<int>(limit.rlim_cur) : 65536;
+
+		const pid_t pid = ::fork();
+		if (pid < 0) {
+			wxLogWarning(_T("Unable to keep reading the output of running processes, ")
+				_T("they may be stopped the next time they write any"));
+			return;
+		} else if (pid > 0) {
+			::waitpid(pid, NULL, 0);
+			return;
+		}
+		// forking again leaves the reader to init, so nothing has to reap it
+		if (::fork() != 0) {
+			::_exit(0);
+		}
+		for (int fd = 0; fd < maxFd; ++fd) {
+			bool isOutput = false;
+			for (size_t i = 0; i < fds.size(); ++i) {
+				isOutput = isOutput || (fds[i].fd == fd);
+			}
+			if (!isOutput) {
+				::close(fd);
+			}
+		}
+		size_t openCount = fds.size();
+		char buffer[4096];
+		while (openCount > 0) {
+			if (::poll(&fds[0], fds.size(), -1) < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				break;
+			}
+			for (size_t i = 0; i < fds.size(); ++i) {
+				if (fds[i].fd < 0 || fds[i].revents == 0) {
+					continue;
+				}
+				const ssize_t n = ::read(fds[i].fd, buffer, sizeof(buffer));
+				if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN)) {
+					::close(fds[i].fd);
+					// poll() skips negative fds
+					fds[i].fd = -1;
+					openCount--;
+				}
+			}
+		}
+		::_exit(0);
+	}
+#endif
+}
+
+BEGIN_EVENT_TABLE(ProcessSupervisor, wxEvtHandler)
+EVT_COMMAND(wxID_NONE, EVT_PROCESS_EXITED, ProcessSupervisor::OnChildExited)
+EVT_TIMER(wxID_ANY, ProcessSupervisor::OnStopTimer)
+#if !IS_LINUX
+EVT_END_PROCESS(wxID_ANY, ProcessSupervisor::OnProcessTerminated)
+#endif
+END_EVENT_TABLE()
+
+ProcessSupervisor::ProcessSupervisor(wxEvtHandler* owner)
+: owner(owner), nextId(1), stopTimer(this), isUsingPidfds(true) {
+	wxASSERT(owner != NULL);
+#if IS_LINUX
+	this->watcher = new Watcher(this);
+	if (!this->watcher->Start()) {
+		delete this->watcher;
+		this->watcher = NULL;
+	}
+#endif
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+	this->stopTimer.Stop();
+#if IS_LINUX
+	if (this->watcher != NULL) {
+		this->watcher->Finish();
+		delete this->watcher;
+		this->watcher = NULL;
+	}
+#endif
+#if IS_LINUX
+	std::vector<int> outputFds;
+	for (Children::iterator it = this->children.begin(), end = this->children.end();
+		 it != end; ++it) {
+		for (int stream = 0; stream < 2; ++stream) {
+			if (it->second->outputFds[stream] >= 0) {
+				outputFds.push_back(it->second->outputFds[stream]);
+			}
+		}
+	}
+	DiscardOutput(outputFds);
+#endif
+	for (Children::iterator it = this->children.begin(), end = this->children.end();
+		 it != end; ++it) {
+		Child* child = it->second;
+#if IS_LINUX
+		if (child->pidfd >= 0) {
+			::close(child->pidfd);
+		}
+		for (int stream = 0; stream < 2; ++stream) {
+			if (child->outputFds[stream] >= 0) {
+				::close(child->outputFds[stream]);
+			}
+		}
+#else
+		if (child->process != NULL) {
+			if (child->hasExited) {
+				delete child->process;
+			} else {
+				// wxWidgets deletes it once the process exits
+				child->process->Detach();
+			}
+		}
+#endif
+		delete child;
+	}
+	this->children.clear();
+}
+
+/** Whether the processes started from now on are waited for with a pidfd
+ where the kernel has them. Turning them off is only for checking the
+ fallback, which is otherwise only used on kernels without them. */
+void ProcessSupervisor::UsePidfds(bool use) {
+	this->isUsingPidfds = use;
+}
+
+/** Starts command in folder. Returns the run's id, or 0 if it could not
+ be started. */
+long ProcessSupervisor::Start(int tag, const wxString& command, const wxString& folder,
+	const ProcessOptions& options) {
+#if IS_LINUX
+	if (this->watcher == NULL) {
+		wxLogError(_T("Unable to start '%s': no thread is watching for processes to exit"),
+			command.c_str());
+		return 0;
+	}
+#endif
+	Child* child = new Child();
+	child->run.id = this->nextId;
+	child->run.tag = tag;
+	child->startedAt = ::wxGetLocalTimeMillis();
+
+	wxLogDebug(_T("Starting a process using '%s'"), command.c_str());
+	{
+		// the watcher must not see the child before it is in the list
+		wxCriticalSectionLocker lock(this->childrenLock);
+		if (!this->Spawn(*child, command, folder, options)) {
+			delete child;
+			return 0;
+		}
+		this->children[child->run.id] = child;
+	}
+#if IS_LINUX
+	this->watcher->Wake();
+#endif
+	wxLogDebug(_T("Process %ld is run %ld"), child->run.pid, child->run.id);
+	return this->nextId++;
+}
+
+#if IS_LINUX
+/** Forks and execs command, with options applied in between. The child
+ reports what failed back through a pipe that is closed when the exec
+ succeeds; options that can't be applied are warned about, but don't stop
+ the launch. */
+bool ProcessSupervisor::Spawn(Child& child, const wxString& command, const wxString& folder,
+	const ProcessOptions& options) {
+#if wxCHECK_VERSION(2, 9, 0)
+	const wxArrayString args(wxCmdLineParser::ConvertStringToArgs(command, wxCMD_LINE_SPLIT_UNIX));
+#else
+	const wxArrayString args(wxCmdLineParser::ConvertStringToArgs(command.c_str()));
+#endif
+	if (args.IsEmpty()) {
+		wxLogError(_T("There is no command to start"));
+		return false;
+	}
+
+	// nothing may be allocated between fork() and exec()
+	std::vector<std::string> argStrings;
+	for (size_t i = 0; i < args.GetCount(); ++i) {
+		argStrings.push_back(std::string(static_cast<const char*>(args[i].fn_str())));
+	}
+	std::vector<char*> argv;
+	for (size_t i = 0; i < argStrings.size(); ++i) {
+		argv.push_back(const_cast<char*>(argStrings[i].c_str()));
+	}
+	argv.push_back(NULL);
+	const std::string workingDir(static_cast<const char*>(folder.fn_str()));
+
+	// setenv() allocates, so the child is given a finished environment
+	std::vector<std::string> extraEnv;
+	for (size_t i = 0; i < options.environment.GetCount(); ++i) {
+		const wxString name(options.environment[i].BeforeFirst(_T('=')));
+		if (!::wxGetEnv(name, NULL)) {
+			extraEnv.push_back(std::string(static_cast<const char*>(options.environment[i].fn_str())));
+		}
+	}
+	std::vector<char*> envp;
+	for (char** var = environ; *var != NULL; ++var) {
+		envp.push_back(*var);
+	}
+	for (size_t i = 0; i < extraEnv.size(); ++i) {
+		envp.push_back(const_cast<char*>(extraEnv[i].c_str()));
+	}
+	envp.push_back(NULL);
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	for (size_t i = 0; i < options.cpus.size(); ++i) {
+		if (options.cpus[i] >= 0 && options.cpus[i] < CPU_SETSIZE) {
+			CPU_SET(options.cpus[i], &cpus);
+		}
+	}
+
+	// [0] carries the child's SpawnReports, [1] and [2] are its stdout and
+	// stderr when they are read; otherwise it keeps the launcher's
+	const bool isReadingOutput = options.captureOutput || options.trackFirstOutput;
+	const int pipeCount = isReadingOutput ? 3 : 1;
+	int pipes[3][2];
+	for (int i = 0; i < pipeCount; ++i) {
+		if (::pipe(pipes[i]) != 0) {
+			wxLogError(_T("Unable to create a pipe to start '%s'"), command.c_str());
+			for (int j = 0; j < i; ++j) {
+				::close(pipes[j][0]);
+				::close(pipes[j][1]);
+			}
+			return false;
+		}
+		::fcntl(pipes[i][0], F_SETFD, FD_CLOEXEC);
+		::fcntl(pipes[i][1], F_SETFD, FD_CLOEXEC);
+	}
+	int* execErrorFds = pipes[0];
+
+	const pid_t pid = ::fork();
+	if (pid == 0) {
+		::close(execErrorFds[0]);
+		if (isReadingOutput) {
+			::dup2(pipes[1][1], STDOUT_FILENO);
+			::dup2(pipes[2][1], STDERR_FILENO);
+		}
+		if (!options.cpus.empty()
+			&& ::sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+			ReportFromChild(execErrorFds[1], SpawnReport::STEP_AFFINITY);
+		}
+		if (options.niceness != 0) {
+			errno = 0;
+			if (::nice(options.niceness) == -1 && errno != 0) {
+				ReportFromChild(execErrorFds[1], SpawnReport::STEP_NICE);
+			}
+		}
+		if (options.ioClass != ProcessOptions::IO_CLASS_DEFAULT) {
+#if defined(SYS_ioprio_set)
+			const int level = (options.ioClass == ProcessOptions::IO_CLASS_IDLE) ? 0 : options.ioLevel;
+			if (::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0,
+				(options.ioClass << IOPRIO_CLASS_SHIFT) | level) != 0) {
+				ReportFromChild(execErrorFds[1], SpawnReport::STEP_IO_PRIORITY);
+			}
+#else
+			errno = ENOSYS;
+			ReportFromChild(execErrorFds[1], SpawnReport::STEP_IO_PRIORITY);
+#endif
+		}
+		if (!workingDir.empty() && ::chdir(workingDir.c_str()) != 0) {
+			ReportFromChild(execErrorFds[1], SpawnReport::STEP_CHDIR);
+		} else {
+			environ = &envp[0];
+			::execvp(argv[0], &argv[0]);
+			ReportFromChild(execErrorFds[1], SpawnReport::STEP_EXEC);
+		}
+		::_exit(127);
+	}
+	for (int i = 0; i < pipeCount; ++i) {
+		::close(pipes[i][1]);
+	}
+	if (pid < 0) {
+		for (int i = 0; i < pipeCount; ++i) {
+			::close(pipes[i][0]);
+		}
+		wxLogError(_T("Unable to fork to start '%s'"), command.c_str());
+		return false;
+	}
+
+	// each report is written in one go, well under PIPE_BUF, so it is read
+	// in one go; the pipe reaches EOF when the exec succeeds or the child exits
+	bool hasFailed = false;
+	int execError = 0;
+	for (;;) {
+		SpawnReport report;
+		const ssize_t n = ::read(execErrorFds[0], &report, sizeof(report));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		} else if (n != static_cast<ssize_t>(sizeof(report))) {
+			break;
+		}
+		switch (report.step) {
+			case SpawnReport::STEP_AFFINITY:
+				wxLogWarning(_T("Unable to set which CPUs '%s' runs on: %s"),
+					command.c_str(), wxSysErrorMsg(report.error));
+				break;
+			case SpawnReport::STEP_NICE:
+				wxLogWarning(_T("Unable to change the priority of '%s' by %d: %s"),
+					command.c_str(), options.niceness, wxSysErrorMsg(report.error));
+				break;
+			case SpawnReport::STEP_IO_PRIORITY:
+				wxLogWarning(_T("Unable to set the I/O priority of '%s': %s"),
+					command.c_str(), wxSysErrorMsg(report.error));
+				break;
+			default:
+				hasFailed = true;
+				execError = report.error;
+				break;
+		}
+	}
+	::close(execErrorFds[0]);
+	if (hasFailed) {
+		// the child has exited, so reap it
+		for (int i = 1; i < pipeCount; ++i) {
+			::close(pipes[i][0]);
+		}
+		::waitpid(pid, NULL, 0);
+		wxLogError(_T("Unable to start '%s' in %s: %s"), command.c_str(),
+			folder.c_str(), wxSysErrorMsg(execError));
+		return false;
+	}
+
+	child.run.pid = pid;
+	child.captureOutput = options.captureOutput;
+	for (int stream = 0; isReadingOutput && stream < 2; ++stream) {
+		child.outputFds[stream] = pipes[stream + 1][0];
+		::fcntl(child.outputFds[stream], F_SETFL, O_NONBLOCK);
+	}
+#if defined(SYS_pidfd_open)
+	if (this->isUsingPidfds) {
+		child.pidfd = static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+	}
+	if (child.pidfd < 0) {
+		wxLogDebug(_T("No pidfd for process %ld, will check on it every %dms"),
+			child.run.pid, FALLBACK_POLL_INTERVAL);
+	}
+#endif
+	return true;
+}
+#else
+bool ProcessSupervisor::Spawn(Child& child, const wxString& command, const wxString& folder,
+	const ProcessOptions& options) {
+	if (!options.cpus.empty() || options.niceness != 0
+		|| options.ioClass != ProcessOptions::IO_CLASS_DEFAULT) {
+		wxLogInfo(_T("CPUs, priority and I/O priority are only applied on Linux"));
+	}
+	if (options.captureOutput) {
+		wxLogInfo(_T("Output is only captured on Linux"));
+	}
+#if !wxCHECK_VERSION(2, 9, 2)
+	if (!options.environment.IsEmpty()) {
+		wxLogInfo(_T("The environment of launch presets needs wxWidgets 2.9.2 or later"));
+	}
+	wxString previousWorkingDir(::wxGetCwd());
+	// hopefully this doesn't goof anything up
+	if ( !::wxSetWorkingDirectory(folder) ) {
+		wxLogError(_T("Unable to change working directory to %s"),
+			folder.c_str());
+		return false;
+	}
+#endif
+
+	child.process = new wxProcess(this);
+#if wxCHECK_VERSION(2, 9, 2)
+	wxExecuteEnv env;
+	env.cwd = folder;
+	if (!options.environment.IsEmpty()) {
+		// wxExecute() replaces the whole environment when it is given one
+		::wxGetEnvMap(&env.env);
+		for (size_t i = 0; i < options.environment.GetCount(); ++i) {
+			const wxString name(options.environment[i].BeforeFirst(_T('=')));
+			if (env.env.find(name) == env.env.end()) {
+				env.env[name] = options.environment[i].AfterFirst(_T('='));
+			}
+		}
+	}
+
+	child.run.pid = ::wxExecute(command, wxEXEC_ASYNC, child.process, &env);
+#else
+	child.run.pid = ::wxExecute(command, wxEXEC_ASYNC, child.process);
+#endif
+
+#if !wxCHECK_VERSION(2, 9, 2)
+	if (!::wxSetWorkingDirectory(previousWorkingDir)) {
+		wxLogError(_T("Unable to change back to working directory %s"),
+			previousWorkingDir.c_str());
+	}
+#endif
+
+	if (child.run.pid == 0) {
+		delete child.process;
+		child.process = NULL;
+		return false;
+	}
+	return true;
+}
+#endif
+
+/** Sends a signal to child. Must be called with childrenLock held, so that
+ the child can't be reaped, and its pid reused, while it is signalled. */
+bool ProcessSupervisor::Signal(Child& child, bool kill) {
+	if (child.hasExited) {
+		return false;
+	}
+#if IS_LINUX
+	return ::kill(static_cast<pid_t>(child.run.pid), kill ? SIGKILL : SIGTERM) == 0;
+#else
+	return ::wxKill(child.run.pid, kill ? wxSIGKILL : wxSIGTERM) == wxKILL_OK;
+#endif
+}
+
+/** Asks the run to exit, and kills it if it hasn't after STOP_TIMEOUT.
+ Returns false if it has already exited or could not be signalled. */
+bool ProcessSupervisor::Stop(long id) {
+	Children::iterator it = this->children.find(id);
+	wxCHECK_MSG(it != this->children.end(), false,
+		wxString::Format(_T("Stop(): there is no run %ld"), id));
+	Child& child = *it->second;
+
+	wxCriticalSectionLocker lock(this->childrenLock);
+	if (child.hasExited || child.isStopping) {
+		return !child.hasExited;
+	}
+	if (!this->Signal(child, false)) {
+		wxLogError(_T("Unable to ask process %ld to exit"), child.run.pid);
+		return false;
+	}
+	child.isStopping = true;
+	child.stopDeadline = ::wxGetLocalTimeMillis() + STOP_TIMEOUT;
+	if (!this->stopTimer.IsRunning()) {
+		this->stopTimer.Start(STOP_CHECK_INTERVAL);
+	}
+	return true;
+}
+
+/** Stops every run with tag. Returns how many are being stopped. */
+size_t ProcessSupervisor::StopAll(int tag) {
+	size_t stopping = 0;
+	for (Children::iterator it = this->children.begin(), end = this->children.end();
+		 it != end; ++it) {
+		if (it->second->run.tag == tag && this->Stop(it->first)) {
+			stopping++;
+		}
+	}
+	return stopping;
+}
+
+size_t ProcessSupervisor::CountRunning(int tag) const {
+	wxCriticalSectionLocker lock(this->childrenLock);
+	size_t running = 0;
+	for (Children::const_iterator it = this->children.begin(), end = this->children.end();
+		 it != end; ++it) {
+		if (it->second->run.tag == tag && !it->second->hasExited) {
+			running++;
+		}
+	}
+	return running;
+}
+
+/** Gives the owner what is known about a run that has exited, and forgets
+ it. Returns false if the run doesn't exist or is still running. */
+bool ProcessSupervisor::TakeFinishedRun(long id, ProcessRun& run) {
+	Children::iterator it = this->children.find(id);
+	if (it == this->children.end()) {
+		return false;
+	}
+	Child* child = it->second;
+	{
+		wxCriticalSectionLocker lock(this->childrenLock);
+		if (!child->hasExited) {
+			return false;
+		}
+		this->children.erase(it);
+	}
+	run = child->run;
+#if IS_LINUX
+	if (child->pidfd >= 0) {
+		::close(child->pidfd);
+	}
+#else
+	delete child->process;
+#endif
+	delete child;
+	return true;
+}
+
+void ProcessSupervisor::OnChildExited(wxCommandEvent& event) {
+	Children::iterator it = this->children.find(event.GetExtraLong());
+	wxCHECK_RET(it != this->children.end(), _T("OnChildExited(): unknown run"));
+	it->second->run.runTime =
+		(::wxGetLocalTimeMillis() - it->second->startedAt).ToLong();
+	this->owner->AddPendingEvent(event);
+}
+
+/** Kills the runs that haven't exited in time after being asked to. */
+void ProcessSupervisor::OnStopTimer(wxTimerEvent& WXUNUSED(event)) {
+	const wxLongLong now = ::wxGetLocalTimeMillis();
+	bool isAnyStopping = false;
+
+	wxCriticalSectionLocker lock(this->childrenLock);
+	for (Children::iterator it = this->children.begin(), end = this->children.end();
+		 it != end; ++it) {
+		Child& child = *it->second;
+		if (!child.isStopping || child.hasExited || child.run.wasKilled) {
+			continue;
+		}
+		if (now < child.stopDeadline) {
+			isAnyStopping = true;
+		} else if (this->Signal(child, true)) {
+			wxLogWarning(_T("Process %ld did not exit within %ds, killing it"),
+				child.run.pid, static_cast<int>(STOP_TIMEOUT / 1000));
+			child.run.wasKilled = true;
+		} else {
+			wxLogError(_T("Failed to kill process %ld"), child.run.pid);
+		}
+	}
+	if (!isAnyStopping) {
+		this->stopTimer.Stop();
+	}
+}
+
+#if IS_LINUX
+ProcessSupervisor::Watcher::Watcher(ProcessSupervisor* supervisor)
+: wxThread(wxTHREAD_JOINABLE), supervisor(supervisor), isFinishing(false) {
+	this->wakeFds[0] = this->wakeFds[1] = -1;
+}
+
+bool ProcessSupervisor::Watcher::Start() {
+	if (::pipe(this->wakeFds) != 0) {
+		wxLogError(_T("Unable to create the process watcher's pipe"));
+		return false;
+	}
+	for (int i = 0; i < 2; ++i) {
+		::fcntl(this->wakeFds[i], F_SETFD, FD_CLOEXEC);
+		::fcntl(this->wakeFds[i], F_SETFL, O_NONBLOCK);
+	}
+	if (this->Create() != wxTHREAD_NO_ERROR || this->Run() != wxTHREAD_NO_ERROR) {
+		wxLogError(_T("Unable to start the process watcher thread"));
+		::close(this->wakeFds[0]);
+		::close(this->wakeFds[1]);
+		return false;
+	}
+	return true;
+}
+
+/** Makes the watcher look at the list of children again. */
+void ProcessSupervisor::Watcher::Wake() {
+	const char wake = 0;
+	ssize_t ignored = ::write(this->wakeFds[1], &wake, 1);
+	(void)ignored;
+}
+
+/** Stops the watcher and waits for it to end. */
+void ProcessSupervisor::Watcher::Finish() {
+	{
+		wxCriticalSectionLocker lock(this->supervisor->childrenLock);
+		this->isFinishing = true;
+	}
+	this->Wake();
+	this->Wait();
+	::close(this->wakeFds[0]);
+	::close(this->wakeFds[1]);
+}
+
+wxThread::ExitCode ProcessSupervisor::Watcher::Entry() {
+	// a launcher whose own output has gone away gets EPIPE, not killed
+	sigset_t sigpipe;
+	sigemptyset(&sigpipe);
+	sigaddset(&sigpipe, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &sigpipe, NULL);
+
+	std::vector<struct pollfd> fds;
+	// which child and stream each of fds after the pidfds is
+	std::vector<std::pair<Child*, int> > outputs;
+	bool hasChildWithoutPidfd = false;
+	for (;;) {
+		fds.clear();
+		outputs.clear();
+		struct pollfd wakeFd = { this->wakeFds[0], POLLIN, 0 };
+		fds.push_back(wakeFd);
+		{
+			wxCriticalSectionLocker lock(this->supervisor->childrenLock);
+			if (this->isFinishing) {
+				break;
+			}
+			hasChildWithoutPidfd = false;
+			for (Children::iterator it = this->supervisor->children.begin(),
+				 end = this->supervisor->children.end(); it != end; ++it) {
+				const Child& child = *it->second;
+				if (child.hasExited) {
+					continue;
+				} else if (child.pidfd >= 0) {
+					struct pollfd childFd = { child.pidfd, POLLIN, 0 };
+					fds.push_back(childFd);
+				} else {
+					hasChildWithoutPidfd = true;
+				}
+			}
+			// only this thread marks children as exited, and only exited
+			// children are deleted, so these stay valid until the next pass
+			for (Children::iterator it = this->supervisor->children.begin(),
+				 end = this->supervisor->children.end(); it != end; ++it) {
+				for (int stream = 0; stream < 2; ++stream) {
+					if (!it->second->hasExited && it->second->outputFds[stream] >= 0) {
+						struct pollfd outputFd = { it->second->outputFds[stream], POLLIN, 0 };
+						fds.push_back(outputFd);
+						outputs.push_back(std::make_pair(it->second, stream));
+					}
+				}
+			}
+		}
+
+		const int ready = ::poll(&fds[0], fds.size(),
+			hasChildWithoutPidfd ? FALLBACK_POLL_INTERVAL : -1);
+		if (ready < 0 && errno != EINTR) {
+			break;
+		}
+		if (fds[0].revents & POLLIN) {
+			char drain[64];
+			while (::read(this->wakeFds[0], drain, sizeof(drain)) > 0) { }
+		}
+		if (ready > 0 && !outputs.empty()) {
+			wxCriticalSectionLocker lock(this->supervisor->childrenLock);
+			const size_t firstOutput = fds.size() - outputs.size();
+			for (size_t i = 0; i < outputs.size(); ++i) {
+				if (fds[firstOutput + i].revents != 0) {
+					this->ForwardOutput(*outputs[i].first, outputs[i].second);
+				}
+			}
+		}
+		// a readable pidfd only says some child exited; waiting with
+		// WNOHANG on each tells which without blocking on the rest
+		this->ReapExited();
+	}
+	return 0;
+}
+
+/** Passes what the child has written to stream on to the launcher's own
+ stdout or stderr, or keeps its stdout if that is being captured. Must be
+ called with the supervisor's childrenLock held. */
+void ProcessSupervisor::Watcher::ForwardOutput(Child& child, int stream) {
+	int& fd = child.outputFds[stream];
+	char buffer[4096];
+	while (fd >= 0) {
+		const ssize_t n = ::read(fd, buffer, sizeof(buffer));
+		if (n > 0) {
+			if (child.run.firstOutputTime < 0 && ::memchr(buffer, '\n', n) != NULL) {
+				child.run.firstOutputTime =
+					(::wxGetLocalTimeMillis() - child.startedAt).ToLong();
+			}
+			if (stream == 0 && child.captureOutput) {
+				const size_t room = ProcessOptions::MAX_CAPTURED_OUTPUT - child.run.output.size();
+				child.run.output.append(buffer, wxMin(static_cast<size_t>(n), room));
+			} else {
+				ssize_t ignored = ::write(stream == 0 ? STDOUT_FILENO : STDERR_FILENO, buffer, n);
+				(void)ignored;
+			}
+		} else if (n < 0 && errno == EINTR) {
+			continue;
+		} else if (n < 0 && errno == EAGAIN) {
+			break;
+		} else {
+			::close(fd);
+			fd = -1;
+		}
+	}
+}
+
+/** Collects the exit status and resource usage of children that have
+ exited, and tells the supervisor about them. */
+void ProcessSupervisor::Watcher::ReapExited() {
+	wxCriticalSectionLocker lock(this->supervisor->childrenLock);
+	for (Children::iterator it = this->supervisor->children.begin(),
+		 end = this->supervisor->children.end(); it != end; ++it) {
+		Child& child = *it->second;
+		if (child.hasExited) {
+			continue;
+		}
+		int status = 0;
+		struct rusage usage;
+		const pid_t pid = ::wait4(static_cast<pid_t>(child.run.pid), &status, WNOHANG, &usage);
+		if (pid != static_cast<pid_t>(child.run.pid)) {
+			continue;
+		}
+
+		child.hasExited = true;
+		for (int stream = 0; stream < 2; ++stream) {
+			// whatever is left; anything its own children write later is lost
+			this->ForwardOutput(child, stream);
+			if (child.outputFds[stream] >= 0) {
+				::close(child.outputFds[stream]);
+				child.outputFds[stream] = -1;
+			}
+		}
+		if (WIFEXITED(status)) {
+			child.run.exitCode = WEXITSTATUS(status);
+		} else if (WIFSIGNALED(status)) {
+			child.run.exitSignal = WTERMSIG(status);
+		}
+		child.run.hasUsage = true;
+		child.run.userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+		child.run.systemSeconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+		child.run.maxResidentKB = usage.ru_maxrss; // already in KB on Linux
+		child.run.minorFaults = usage.ru_minflt;
+		child.run.majorFaults = usage.ru_majflt;
+
+		wxCommandEvent event(EVT_PROCESS_EXITED, wxID_NONE);
+		event.SetExtraLong(child.run.id);
+		this->supervisor->AddPendingEvent(event);
+	}
+}
+#else
+void ProcessSupervisor::OnProcessTerminated(wxProcessEvent& event) {
+	for (Children::iterator it = this->children.begin(), end = this->children.end();
+		 it != end; ++it) {
+		Child& child = *it->second;
+		if (child.run.pid != event.GetPid() || child.hasExited) {
+			continue;
+		}
+		{
+			wxCriticalSectionLocker lock(this->childrenLock);
+			child.hasExited = true;
+			child.run.exitCode = event.GetExitCode();
+		}
+		wxCommandEvent exited(EVT_PROCESS_EXITED, wxID_NONE);
+		exited.SetExtraLong(child.run.id);
+		this->OnChildExited(exited);
+		return;
+	}
+	wxLogError(_T("Process %d exited, but it isn't being supervised"), event.GetPid());
+}
+#endif
@@ -0,0 +1,202 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROCESSSUPERVISOR_H
+#define PROCESSSUPERVISOR_H
+
+#include <wx/wx.h>
+#include <wx/arrstr.h>
+#include <wx/hashmap.h>
+#include <wx/longlong.h>
+#include <wx/process.h>
+#include <wx/thread.h>
+#include <wx/timer.h>
+
+#include "apis/EventHandlers.h"
+#include "generated/configure_launcher.h"
+
+#include <string>
+#include <vector>
+
+/** A process started by a ProcessSupervisor has exited. The extra long is
+ the run's id, which the owner passes to TakeFinishedRun(). */
+LAUNCHER_DECLARE_EVENT_TYPE(EVT_PROCESS_EXITED);
+
+/** What is known about one process started by a ProcessSupervisor. */
+struct ProcessRun {
+	ProcessRun()
+	: id(0), tag(0), pid(0), exitCode(-1), exitSignal(0), wasKilled(false),
+	  runTime(0), firstOutputTime(-1), hasUsage(false), userSeconds(0), systemSeconds(0),
+	  maxResidentKB(0), minorFaults(0), majorFaults(0) { }
+	long id;
+	int tag; //!< what the owner started it as
+	long pid;
+	int exitCode; //!< -1 if it was ended by a signal
+	int exitSignal; //!< the signal that ended it, or 0
+	bool wasKilled; //!< it didn't stop when asked to, so it was killed
+	long runTime; //!< ms from being started to being seen to exit
+	long firstOutputTime; //!< ms from being started to its first line of output, or -1
+
+	// resource usage is only known where the supervisor waits for its
+	// children itself, which is on Linux
+	bool hasUsage;
+	double userSeconds;
+	double systemSeconds;
+	long maxResidentKB;
+	long minorFaults;
+	long majorFaults;
+
+	/** Its stdout as it wrote it, if it was started with captureOutput. */
+	std::string output;
+};
+
+/** How a process is to be run, besides its command line and folder. */
+struct ProcessOptions {
+	/** The same values as Linux's IOPRIO_CLASS_*. */
+	enum IoClass {
+		IO_CLASS_DEFAULT,
+		IO_CLASS_REALTIME,
+		IO_CLASS_BEST_EFFORT,
+		IO_CLASS_IDLE
+	};
+
+	enum { MAX_CAPTURED_OUTPUT = 1024*1024 }; //!< bytes, the rest is dropped
+
+	ProcessOptions()
+	: niceness(0), ioClass(IO_CLASS_DEFAULT), ioLevel(4), captureOutput(false),
+	  trackFirstOutput(false) { }
+	bool IsDefault() const {
+		return cpus.empty() && niceness == 0 && ioClass == IO_CLASS_DEFAULT
+			&& environment.IsEmpty() && !captureOutput && !trackFirstOutput;
+	}
+
+	std::vector<int> cpus; //!< the CPUs it may run on, empty for any
+	int niceness; //!< added to the launcher's own
+	IoClass ioClass;
+	int ioLevel; //!< 0 (first) to 7, for the realtime and best effort classes
+	/** NAME=value, each set unless the launcher's own environment already
+	 has it, so that the user's own settings win. */
+	wxArrayString environment;
+	/** Keep its stdout in ProcessRun::output rather than passing it on.
+	 Only on Linux. */
+	bool captureOutput;
+	/** Note when its first line of output arrives in
+	 ProcessRun::firstOutputTime. Only on Linux. */
+	bool trackFirstOutput;
+};
+
+/** Starts executables and keeps track of them until they exit, however many
+ are running at once.
+
+ Each process is given a tag by the owner, so the owner can ask how many of
+ a kind are running or stop all of them. When a process exits, the owner is
+ sent EVT_PROCESS_EXITED and must then call TakeFinishedRun().
+
+ On Linux the supervisor starts the processes itself and waits for them on
+ a worker thread, using a pidfd for each where the kernel has them and
+ checking a few times a second where it doesn't. As nothing else reaps the
+ processes, their pids can't be reused until the supervisor has seen them
+ exit, so signalling them can't hit the wrong process, and wait4() gives
+ their resource usage. A process writes straight to the launcher's own
+ output unless it was started to have its output captured or the time of
+ its first line of output noted; then its output is read through pipes,
+ and what isn't captured is passed on. Elsewhere wxExecute() is used.
+
+ The ProcessOptions a process is started with are applied between fork()
+ and exec() on Linux, so they are in place before the executable runs.
+ Elsewhere only its environment is applied, with wxWidgets 2.9.2 or later.
+
+ Stop() asks a process to exit and kills it if it hasn't after
+ STOP_TIMEOUT. Deleting the supervisor leaves running processes running;
+ the output of those being read through pipes is thrown away from then on,
+ so that they can go on writing it.
+
+ Only to be used from the main thread. */
+class ProcessSupervisor: public wxEvtHandler {
+public:
+	enum { STOP_TIMEOUT = 5000 }; //!< ms
+
+	ProcessSupervisor(wxEvtHandler* owner);
+	~ProcessSupervisor();
+
+	long Start(int tag, const wxString& command, const wxString& folder,
+		const ProcessOptions& options = ProcessOptions());
+	bool Stop(long id);
+	size_t StopAll(int tag);
+	size_t CountRunning(int tag) const;
+	bool TakeFinishedRun(long id, ProcessRun& run);
+	void UsePidfds(bool use);
+
+private:
+	struct Child {
+		Child() : hasExited(false), isStopping(false), captureOutput(false), pidfd(-1),
+			process(NULL) {
+			outputFds[0] = outputFds[1] = -1;
+		}
+		ProcessRun run;
+		bool hasExited;
+		bool isStopping;
+		bool captureOutput;
+		wxLongLong startedAt;
+		wxLongLong stopDeadline;
+		int pidfd; //!< -1 where there is none
+		int outputFds[2]; //!< the child's stdout and stderr, where they are read, or -1
+		wxProcess* process; //!< where wxExecute() is used
+	};
+	WX_DECLARE_HASH_MAP( long, Child*, wxIntegerHash, wxIntegerEqual, Children );
+
+	bool Spawn(Child& child, const wxString& command, const wxString& folder,
+		const ProcessOptions& options);
+	bool Signal(Child& child, bool kill);
+	void OnChildExited(wxCommandEvent& event);
+	void OnStopTimer(wxTimerEvent& event);
+#if !IS_LINUX
+	void OnProcessTerminated(wxProcessEvent& event);
+#endif
+
+	wxEvtHandler* owner;
+	Children children;
+	mutable wxCriticalSection childrenLock; //!< guards children's exit state
+	long nextId;
+	wxTimer stopTimer;
+	bool isUsingPidfds; //!< only used on Linux
+
+#if IS_LINUX
+	/** Waits for the supervisor's children to exit. */
+	class Watcher: public wxThread {
+	public:
+		Watcher(ProcessSupervisor* supervisor);
+		bool Start();
+		void Wake();
+		void Finish();
+	protected:
+		virtual ExitCode Entry();
+	private:
+		void ReapExited();
+		void ForwardOutput(Child& child, int stream);
+		ProcessSupervisor* supervisor;
+		int wakeFds[2];
+		bool isFinishing; //!< guarded by the supervisor's childrenLock
+	};
+	Watcher* watcher;
+#endif
+
+	DECLARE_EVENT_TABLE()
+};
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/evtloop.h>
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#include "generated/configure_launcher.h"
+#include "apis/ProcessSupervisor.h"
+#include "apis/ProcessSupervisorCheck.h"
+#include "apis/ProfileManagerOperator.h"
+
+#if IS_LINUX
+#include <signal.h>
+#endif
+
+#include "global/MemoryDebugging.h"
+
+namespace
+{
+	const int RUN_CHECK = 0; // the supervisor tag of every run
+	const unsigned long WAIT_INTERVAL = 2; // ms between checks for a run having exited
+	const long STOP_AFTER = 300; // ms a run is left before it is stopped
+	const long RUN_TIMEOUT = 30000; // ms, much longer than STOP_TIMEOUT
+
+	/** Sees EVT_PROCESS_EXITED for the run being waited for. */
+	class RunWaiter: public wxEvtHandler {
+	public:
+		RunWaiter() : exitedId(0) { }
+		long exitedId;
+	private:
+		void OnProcessExited(wxCommandEvent& event) {
+			this->exitedId = event.GetExtraLong();
+		}
+		DECLARE_EVENT_TABLE()
+	};
+}
+
+BEGIN_EVENT_TABLE(RunWaiter, wxEvtHandler)
+EVT_COMMAND(wxID_NONE, EVT_PROCESS_EXITED, RunWaiter::OnProcessExited)
+END_EVENT_TABLE()
+
+#if IS_LINUX
+/** Starts the stand-in with args, asks it to stop after STOP_AFTER ms if
+ isStopped, and waits for it to exit. Returns false if it couldn't be
+ started or never exited. */
+static bool RunStandIn(ProcessSupervisor& supervisor, RunWaiter& waiter,
+	const wxString& command, const wxString& args, bool isStopped,
+	const ProcessOptions& options, ProcessRun& run) {
+	const long id = supervisor.Start(RUN_CHECK, command + _T(" ") + args,
+		::wxGetCwd(), options);
+	if (id == 0) {
+		return false;
+	}
+	wxStopWatch timer;
+	bool isStopping = false;
+	while (waiter.exitedId != id) {
+		if (isStopped && !isStopping && timer.Time() > STOP_AFTER) {
+			isStopping = supervisor.Stop(id);
+		}
+		if (timer.Time() > RUN_TIMEOUT) {
+			wxLogError(_T("Run %ld didn't exit within %ld ms"), id, RUN_TIMEOUT);
+			return false;
+		}
+		wxTheApp->Yield(true);
+		::wxMilliSleep(WAIT_INTERVAL);
+	}
+	return supervisor.TakeFinishedRun(id, run);
+}
+
+/** Reports one check, and returns whether it passed. */
+static bool Expect(const wxString& what, bool passed) {
+	ProManOperator::ReportBenchmark(wxString::Format(_T("    %s %s"),
+		passed ? _T("ok  ") : _T("FAIL"), what.c_str()));
+	return passed;
+}
+
+/** Runs each case once, with the supervisor waiting on pidfds as it does
+ where the kernel has them or checking on the children every
+ FALLBACK_POLL_INTERVAL as it does where it doesn't. */
+static bool RunChecks(const wxString& command, bool usePidfds) {
+	RunWaiter waiter;
+	ProcessSupervisor supervisor(&waiter);
+	supervisor.UsePidfds(usePidfds);
+	bool ok = true;
+	ProcessRun run;
+
+	ProManOperator::ReportBenchmark(_T("  exits with a code, output captured"));
+	ProcessOptions captured;
+	captured.captureOutput = true;
+	if (Expect(_T("started and exited"), RunStandIn(supervisor, waiter, command,
+		_T("-exit 3 -metric check=1"), false, captured, run))) {
+		ok = Expect(_T("exit code is 3"), run.exitCode == 3) && ok;
+		ok = Expect(_T("no signal"), run.exitSignal == 0 && !run.wasKilled) && ok;
+		ok = Expect(_T("output captured"),
+			run.output.find("METRIC check = 1") != std::string::npos) && ok;
+		ok = Expect(_T("first output time noted"), run.firstOutputTime >= 0) && ok;
+		ok = Expect(_T("resource usage from wait4()"), run.hasUsage) && ok;
+	} else {
+		ok = false;
+	}
+
+	ProManOperator::ReportBenchmark(_T("  first output timed, output passed on"));
+	ProcessOptions timed;
+	timed.trackFirstOutput = true;
+	if (Expect(_T("started and exited"), RunStandIn(supervisor, waiter, command,
+		_T("-sleep 0.1"), false, timed, run))) {
+		ok = Expect(_T("exit code is 0"), run.exitCode == 0) && ok;
+		ok = Expect(_T("first output time noted"),
+			run.firstOutputTime >= 0 && run.firstOutputTime <= run.runTime) && ok;
+		ok = Expect(_T("nothing captured"), run.output.empty()) && ok;
+	} else {
+		ok = false;
+	}
+
+	ProManOperator::ReportBenchmark(_T("  stopped, exits on SIGTERM"));
+	if (Expect(_T("started and exited"), RunStandIn(supervisor, waiter, command,
+		_T("-sleep 10"), true, ProcessOptions(), run))) {
+		ok = Expect(_T("ended by SIGTERM"), run.exitSignal == SIGTERM) && ok;
+		ok = Expect(_T("not killed"), !run.wasKilled) && ok;
+		ok = Expect(_T("exited before STOP_TIMEOUT"),
+			run.runTime < STOP_AFTER + ProcessSupervisor::STOP_TIMEOUT) && ok;
+	} else {
+		ok = false;
+	}
+
+	ProManOperator::ReportBenchmark(_T("  stopped, ignores SIGTERM"));
+	if (Expect(_T("started and exited"), RunStandIn(supervisor, waiter, command,
+		_T("-sleep 10 -ignore-term"), true, ProcessOptions(), run))) {
+		ok = Expect(_T("ended by SIGKILL"), run.exitSignal == SIGKILL) && ok;
+		ok = Expect(_T("marked as killed"), run.wasKilled) && ok;
+		ok = Expect(_T("killed after STOP_TIMEOUT"),
+			run.runTime >= ProcessSupervisor::STOP_TIMEOUT) && ok;
+	} else {
+		ok = false;
+	}
+	return ok;
+}
+#endif
+
+/** Checks exit codes, captured and timed output, resource usage, and
+ stopping a child that exits when asked and one that has to be killed, both
+ with pidfds and with the fallback used where there are none. Only on
+ Linux, where the supervisor waits for its children itself. */
+int RunProcessSupervisorCheck(const wxString& standInPath) {
+#if IS_LINUX
+	wxFileName standIn(standInPath);
+	standIn.MakeAbsolute();
+	if (!standIn.FileExists()) {
+		wxLogError(_("Stand-in %s does not exist"), standIn.GetFullPath().c_str());
+		return 1;
+	}
+	// the "" correct for spaces in the path
+	wxString command(standIn.GetFullPath());
+	if (command.Find(_T(" ")) != wxNOT_FOUND) {
+		command = _T("\"") + command + _T("\"");
+	}
+
+	// the check runs instead of the main loop, so it has a loop of its own
+	// for Yield() to dispatch the supervisor's events with
+	wxEventLoop loop;
+	wxEventLoopActivator activate(&loop);
+
+	ProManOperator::ReportBenchmark(_T("Waiting with pidfds:"));
+	bool ok = RunChecks(command, true);
+	ProManOperator::ReportBenchmark(_T("Waiting without pidfds:"));
+	ok = RunChecks(command, false) && ok;
+
+	ProManOperator::ReportBenchmark(ok ? _T("All checks passed") : _T("Some checks failed"));
+	return ok ? 0 : 1;
+#else
+	wxLogError(_("The process supervisor can only be checked on Linux"));
+	return 1;
+#endif
+}
@@ -0,0 +1,30 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROCESSSUPERVISORCHECK_H
+#define PROCESSSUPERVISORCHECK_H
+
+#include <wx/wx.h>
+
+/** Runs the stand-in at standInPath, scripts/standins/fake_fs2_open.sh or
+ anything that takes the same arguments, through a ProcessSupervisor in the
+ ways the launcher uses it, and reports whether what the supervisor saw is
+ what the stand-in did. Returns 0 if it all was. */
+int RunProcessSupervisorCheck(const wxString& standInPath);
+
+#endif
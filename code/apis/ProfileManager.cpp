@@ -24,7 +24,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <wx/stdpaths.h>
 #include <wx/filename.h>
 #include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <wx/sstream.h>
 #include <wx/dir.h>
+#include <wx/textfile.h>
 
 #include "generated/configure_launcher.h"
 #include "apis/EventHandlers.h"
@@ -32,6 +35,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "apis/PlatformProfileManager.h"
 #include "apis/FlagListManager.h"
 #include "wxLauncherApp.h"
+#include "datastructures/ProfileDatabase.h"
+#include "global/AtomicFileBatch.h"
 #include "global/ProfileKeys.h"
 
 #include "global/MemoryDebugging.h"
@@ -42,6 +47,9 @@ ProMan::Flags ProMan::flags;
 
 const wxString& ProMan::DEFAULT_PROFILE_NAME = _T("Default");
 #define GLOBAL_INI_FILE_NAME _T("global.ini")
+#define PROFILE_INDEX_FILE_NAME _T("profiles.idx")
+#define PROFILE_INDEX_HEADER _T("# wxLauncher profile index, version 1")
+#define PROFILE_DATABASE_FILE_NAME _T("profiles.db")
 
 ///////////// Events
 
@@ -61,9 +69,10 @@ void ProMan::GenerateChangeEvent() {
 	}
 }
 
-void ProMan::GenerateCurrentProfileChangedEvent() {
+void ProMan::GenerateCurrentProfileChangedEvent(int changes) {
 	wxCommandEvent event(EVT_CURRENT_PROFILE_CHANGED, wxID_NONE);
-	wxLogDebug(wxT_2("Generating current profile changed event"));
+	event.SetInt(changes);
+	wxLogDebug(wxT_2("Generating current profile changed event (changes 0x%x)"), changes);
 	EventHandlers::iterator iter = this->eventHandlers.begin();
 	while (iter != this->eventHandlers.end()) {
 		wxEvtHandler* current = *iter;
@@ -95,6 +104,12 @@ NewsData::NewsData(const wxString& theNews, const wxDateTime& lastDownloadNews)
 	wxASSERT(lastDownloadNews.IsValid());
 }
 
+ProfileIndexEntry::ProfileIndexEntry(const wxString& name, const wxString& fileName,
+	unsigned long modificationTime, unsigned long size)
+: name(name), fileName(fileName), modificationTime(modificationTime), size(size) {
+	wxASSERT(!fileName.IsEmpty());
+}
+
 /** Load a profile from a fully quaified path.  Returns NULL on failure
 or a pointer to a wxFileConfig that you must delete when done. */
 wxFileConfig* LoadProfileFromFile(const wxFileName &file)
@@ -129,24 +144,30 @@ bool ProMan::Initialize(Flags flags) {
 		return false;
 	}
 
-	ProMan::proman->globalProfile = LoadProfileFromFile(file);
-	ProMan::proman->LoadNewsMapFromGlobalProfile();
-
-	// fetch all profiles.
-	wxArrayString foundProfiles;
-	wxDir::GetAllFiles(GetProfileStorageFolder(), &foundProfiles, wxT_2("pro?????.ini"));
+	// profiles live in the database instead of in files once it exists
+	wxFileName databaseFile(GetProfileStorageFolder(), PROFILE_DATABASE_FILE_NAME);
+	if ( databaseFile.FileExists() ) {
+		ProMan::proman->database = new ProfileDatabase(databaseFile);
+		if ( !ProMan::proman->database->Load() ) {
+			wxLogError(_(" Unable to read profile database."));
+			return false;
+		}
+		wxLogInfo(_(" Using profile database: %s"), databaseFile.GetFullPath().c_str());
+	}
 
-	wxLogInfo(wxT_2(" Found %d profile(s)."), foundProfiles.Count());
-	for( size_t i = 0; i < foundProfiles.Count(); i++) {
-		wxLogDebug(wxT_2("  Opening %s"), foundProfiles[i].c_str());
-		wxFFileInputStream instream(foundProfiles[i]);
-		wxFileConfig *config = new wxFileConfig(instream);
-		
-		wxString name;
-		config->Read(PRO_CFG_MAIN_NAME, &name, wxString::Format(wxT_2("Profile %05ld"), i));
+	if ( ProMan::proman->database != NULL ) {
+		ProMan::proman->globalProfile = MakeConfig(
+			ProMan::proman->database->GetEntries(ProfileDatabase::GLOBAL_SETTINGS));
+	} else {
+		ProMan::proman->globalProfile = LoadProfileFromFile(file);
+	}
+	ProMan::proman->LoadNewsMapFromGlobalProfile();
 
-		ProMan::proman->profiles[name] = config;
-		wxLogDebug(wxT_2("  Opened profile named: %s"), name.c_str());
+	if ( ProMan::proman->database != NULL ) {
+		ProMan::proman->ReadDatabaseProfiles();
+	} else {
+		// find all profiles, only reading the ones the index can't vouch for
+		ProMan::proman->ScanProfiles();
 	}
 
 	wxString currentProfile;
@@ -154,12 +175,10 @@ bool ProMan::Initialize(Flags flags) {
 		GBL_CFG_MAIN_LASTPROFILE, &currentProfile, ProMan::DEFAULT_PROFILE_NAME);
 	
 	wxLogDebug(wxT_2(" Searching for profile: %s"), currentProfile.c_str());
-	if ( ProMan::proman->profiles.find(currentProfile)
-	== ProMan::proman->profiles.end() ) {
+	if ( !ProMan::proman->DoesProfileExist(currentProfile) ) {
 		// lastprofile does not exist
 		wxLogDebug(wxT_2(" lastprofile '%s' does not exist!"), currentProfile.c_str());
-		if ( ProMan::proman->profiles.find(ProMan::DEFAULT_PROFILE_NAME)
-		== ProMan::proman->profiles.end() ) {
+		if ( !ProMan::proman->DoesProfileExist(ProMan::DEFAULT_PROFILE_NAME) ) {
 			// default profile also does not exist.
 			// Means this is likely the first run this system
 			// Create a default profile
@@ -172,8 +191,9 @@ bool ProMan::Initialize(Flags flags) {
 		wxLogInfo(wxT_2(" Resetting lastprofile to Default."));
 		// Do not ignore updating last profile here because this is fixing bad data
 		ProMan::proman->globalProfile->Write(GBL_CFG_MAIN_LASTPROFILE, ProMan::DEFAULT_PROFILE_NAME);
-		wxFFileOutputStream globalProfileOutput(file.GetFullPath());
-		ProMan::proman->globalProfile->Save(globalProfileOutput);
+		AtomicFileBatch batch;
+		ProMan::proman->SaveGlobalProfile(batch);
+		ProMan::proman->CommitChanges(batch);
 		currentProfile = ProMan::DEFAULT_PROFILE_NAME;
 	}
 
@@ -225,10 +245,9 @@ ProMan::ProMan() {
 	this->globalProfile = NULL;
 	this->isAutoSaving = true;
 	this->currentProfile = NULL;
-	
-	this->privateCopyFilename = wxFileName::CreateTempFileName(wxT_2("wxLtest"));
-	wxFFileInputStream instream(this->privateCopyFilename);
-	this->privateCopy = new wxFileConfig(instream);
+	this->profileVersion = 0;
+	this->database = NULL;
+	this->isDeferringSaves = false;
 }
 
 /** Destructor. */
@@ -239,24 +258,26 @@ ProMan::~ProMan() {
 		delete iter->second;
 		iter++;
 	}
-	
-	delete this->privateCopy;
-	privateCopy = NULL;
-	::wxRemoveFile(this->privateCopyFilename);
+	for (ProfileTemplateMap::iterator it = this->templates.begin(),
+		 end = this->templates.end(); it != end; ++it) {
+		delete it->second;
+	}
+	for (ProfileOverlayMap::iterator it = this->overlays.begin(),
+		 end = this->overlays.end(); it != end; ++it) {
+		delete it->second;
+	}
+	delete this->database;
 }
 
 /** Saves changes to profiles according to autosave profiles checkbox. */
 void ProMan::SaveProfilesBeforeExiting() {
+	// the global profile and the current profile share one directory sync
+	AtomicFileBatch batch;
+
 	if ( this->globalProfile != NULL ) {
 		wxLogInfo(wxT_2("saving global profile before exiting."));
 		SaveNewsMapToGlobalProfile();
-		
-		wxFileName file;
-		file.Assign(GetProfileStorageFolder(), GLOBAL_INI_FILE_NAME);
-		wxFFileOutputStream globalProfileOutput(file.GetFullPath());
-		this->globalProfile->Save(globalProfileOutput);
-		
-		delete this->globalProfile;
+		this->SaveGlobalProfile(batch);
 	} else {
 		wxLogWarning(_("global profile is null, cannot save it"));
 	}
@@ -265,7 +286,7 @@ void ProMan::SaveProfilesBeforeExiting() {
 		if (this->isAutoSaving) {
 			wxLogInfo(_("autosaving profile %s before exiting"),
 				this->GetCurrentName().c_str());
-			this->SaveCurrentProfile();
+			this->SaveCurrentProfile(batch);
 		} else {
 			int response = wxMessageBox(
 				GetSaveDialogMessageText(ProMan::ON_EXIT, this->GetCurrentName()),
@@ -274,7 +295,7 @@ void ProMan::SaveProfilesBeforeExiting() {
 			if ( response == wxYES ) {
 				wxLogInfo(wxT_2("saving profile %s before exiting"),
 					this->GetCurrentName().c_str());
-				this->SaveCurrentProfile();
+				this->SaveCurrentProfile(batch);
 			} else {
 				wxLogWarning(wxT_2("exiting without saving changes to profile %s"),
 					this->GetCurrentName().c_str());
@@ -284,6 +305,15 @@ void ProMan::SaveProfilesBeforeExiting() {
 		wxLogInfo(wxT_2("Current profile %s has no unsaved changes. Exiting."),
 			this->GetCurrentName().c_str());
 	}
+
+	this->CommitChanges(batch);
+	// the database is only ever compacted here, as the launcher exits
+	if (this->database != NULL && this->database->NeedsCompaction()) {
+		wxLogInfo(wxT_2("compacting profile database before exiting."));
+		this->database->Compact();
+	}
+	delete this->globalProfile;
+	this->globalProfile = NULL;
 }
 
 void ProMan::LoadNewsMapFromGlobalProfile() {
@@ -343,17 +373,13 @@ void ProMan::SaveNewsMapToGlobalProfile() {
 	globalProfile->SetPath(wxT_2("/"));
 }
 
-/** Resets the private copy so that it contains a copy
- of the current profile's contents. */
-void ProMan::ResetPrivateCopy() {
-	wxCHECK_RET(this->currentProfile != NULL, wxT_2("ResetPrivateCopy called with null current profile!"));
-	ClearConfig(*(this->privateCopy));
-	CopyConfig(*(this->currentProfile), *(this->privateCopy));
-}
-
 /** Creates a new profile including the directory for it to go in, the entry
-in the profiles map. Returns true if creation was successful. */
-bool ProMan::CreateNewProfile(wxString newName) {
+in the profiles map. Returns true if creation was successful.
+If base is given the profile's file is written straight from the template,
+and the profile is only read back in when it is first needed. While saves
+are deferred, a profile made from base is only an overlay on it until it is
+first needed or saved. */
+bool ProMan::CreateNewProfile(wxString newName, const ProfileTemplate* base) {
 	wxFileName profile;
 	profile.Assign(
 		GetProfileStorageFolder(),
@@ -369,59 +395,291 @@ bool ProMan::CreateNewProfile(wxString newName) {
 		return false;
 	}
 
-	wxFFileInputStream configInput(profile.GetFullPath(), wxT_2("w+b"));
-	wxFileConfig* config = new wxFileConfig(configInput);
-	config->Write(PRO_CFG_MAIN_NAME, newName);
-	config->Write(PRO_CFG_MAIN_FILENAME, profile.GetFullName());
-	wxFFileOutputStream configOutput(profile.GetFullPath());
-	config->Save(configOutput);
+	if (this->isDeferringSaves && base != NULL) {
+		this->overlays[newName] = new ProfileOverlay(*base, newName, profile.GetFullName());
+		this->profileFiles[newName] = ProfileIndexEntry(newName, profile.GetFullName(), 0, 0);
+		this->deferredProfiles.Add(newName);
+		return true;
+	}
 
-	this->profiles[newName] = config;
-	return true;
+	if (this->database != NULL || this->isDeferringSaves) {
+		wxFileConfig* config;
+		if (base == NULL) {
+			config = MakeConfig(NULL);
+			config->Write(PRO_CFG_MAIN_NAME, newName);
+			config->Write(PRO_CFG_MAIN_FILENAME, profile.GetFullName());
+		} else {
+			wxMemoryBuffer contents;
+			if ( !base->Materialize(newName, profile.GetFullName(), contents) ) {
+				return false;
+			}
+			wxMemoryInputStream configInput(contents.GetData(), contents.GetDataLen());
+			config = new wxFileConfig(configInput);
+		}
+		this->profiles[newName] = config;
+		// the file name is kept so that the profile can be exported later
+		this->profileFiles[newName] = ProfileIndexEntry(newName, profile.GetFullName(), 0, 0);
+		if (this->isDeferringSaves) {
+			this->deferredProfiles.Add(newName);
+			return true;
+		}
+		this->SaveProfileToDatabase(newName, *config);
+		return this->database->Flush();
+	}
+
+	AtomicFileBatch batch;
+	if (base == NULL) {
+		wxStringInputStream configInput(wxEmptyString);
+		wxFileConfig* config = new wxFileConfig(configInput);
+		config->Write(PRO_CFG_MAIN_NAME, newName);
+		config->Write(PRO_CFG_MAIN_FILENAME, profile.GetFullName());
+		if ( !batch.Save(*config, profile) ) {
+			delete config;
+			return false;
+		}
+		this->profiles[newName] = config;
+	} else {
+		wxMemoryBuffer contents;
+		if ( !base->Materialize(newName, profile.GetFullName(), contents)
+			|| !batch.SaveBytes(contents.GetData(), contents.GetDataLen(), profile) ) {
+			return false;
+		}
+	}
+
+	this->UpdateProfileIndex(newName, profile.GetFullName());
+	this->SaveProfileIndex(batch);
+	return this->CommitChanges(batch);
 }
 
 /** Generates a filename for a new profile, where the name is of the form
- pro#####.ini with ##### being the least 5-digit number not yet taken. */
-wxString ProMan::GenerateNewProfileFileName() {
-	wxArrayString profileFiles;
-	wxDir::GetAllFiles(GetProfileStorageFolder(), &profileFiles, wxT_2("pro*.ini"), wxDIR_FILES);
+ pro#####.ini with ##### being the least 5-digit number not yet taken.
+ The numbers in use come from the profile index rather than from a
+ directory listing. */
+wxString ProMan::GenerateNewProfileFileName() const {
+	std::vector<long> proNums;
+	proNums.reserve(this->profileFiles.size());
 	
 	long l;
+	for (ProfileIndex::const_iterator it = this->profileFiles.begin(),
+		 end = this->profileFiles.end(); it != end; ++it) {
+		// pro#####.ini
+		if (it->second.fileName.Mid(3, 5).ToLong(&l)) {
+			proNums.push_back(l);
+		}
+	}
 	
-	std::vector<long> proNums;
+	sort(proNums.begin(), proNums.end());
 	
-	for (int i = 0, n = profileFiles.GetCount(); i < n; ++i) {
-		profileFiles[i] = profileFiles[i].AfterLast(wxT_2('o')).BeforeLast(wxT_2('.'));
-		profileFiles[i].ToLong(&l);
-		proNums.push_back(l);
+	// the file check catches pro#####.ini files that appeared since startup
+	long proIndex = 0;
+	while (std::binary_search(proNums.begin(), proNums.end(), proIndex)
+		|| wxFileName::FileExists(wxFileName(GetProfileStorageFolder(),
+			wxString::Format(wxT_2("pro%05ld.ini"), proIndex)).GetFullPath())) {
+		++proIndex;
 	}
+
+	wxLogDebug(wxT_2("new profile number: %ld"), proIndex);
 	
-	// just in case they're not already in sorted order
-	sort(proNums.begin(), proNums.end());
+	wxASSERT(proIndex <= 99999); // the maximum possible index given a 5-digit number
 	
-	proNums.insert(proNums.begin(), -1); // dummy value that allows for easily checking first element
+	return wxString::Format(wxT_2("pro%05ld.ini"), proIndex);
+}
+
+/** Fills profileFiles with every profile in the profile folder.
+ Profile files whose modification time and size match the profile index
+ are not opened at all; only new or changed files are read, and those
+ are kept loaded since the work has already been done. */
+void ProMan::ScanProfiles() {
+	wxASSERT(this->profileFiles.empty());
 	
-	long proIndex = 0;
+	ProfileIndex indexedFiles; // by file name
+	ReadProfileIndex(indexedFiles);
 	
-	int i;
-	const int n = proNums.size();
+	wxArrayString foundProfiles;
+	wxDir::GetAllFiles(GetProfileStorageFolder(), &foundProfiles,
+		wxT_2("pro?????.ini"), wxDIR_FILES);
 	
-	for (i = 1; i < n; ++i) {
-		if (proNums[i] - proNums[i-1] > 1) { // if there's a gap in the numbering, try to fill it
-			proIndex = proNums[i-1] + 1;
-			break;
+	size_t readCount = 0;
+	for (size_t i = 0; i < foundProfiles.Count(); i++) {
+		wxStructStat st;
+		if (wxStat(foundProfiles[i], &st) != 0) {
+			wxLogWarning(_("Unable to get information on profile file %s"),
+				foundProfiles[i].c_str());
+			continue;
 		}
+		
+		const wxString fileName(wxFileName(foundProfiles[i]).GetFullName());
+		const unsigned long modificationTime =
+			static_cast<unsigned long>(st.st_mtime);
+		const unsigned long size = static_cast<unsigned long>(st.st_size);
+		
+		wxString name;
+		ProfileIndex::const_iterator indexed = indexedFiles.find(fileName);
+		if (indexed != indexedFiles.end()
+			&& indexed->second.modificationTime == modificationTime
+			&& indexed->second.size == size) {
+			name = indexed->second.name;
+		} else {
+			wxLogDebug(wxT_2("  Opening %s"), foundProfiles[i].c_str());
+			wxFFileInputStream instream(foundProfiles[i]);
+			wxFileConfig *config = new wxFileConfig(instream);
+			
+			config->Read(PRO_CFG_MAIN_NAME, &name, wxString::Format(wxT_2("Profile %05ld"), i));
+			
+			ProfileMap::iterator duplicate = this->profiles.find(name);
+			if (duplicate != this->profiles.end()) {
+				delete duplicate->second;
+			}
+			this->profiles[name] = config;
+			readCount++;
+			wxLogDebug(wxT_2("  Opened profile named: %s"), name.c_str());
+		}
+		
+		this->profileFiles[name] =
+			ProfileIndexEntry(name, fileName, modificationTime, size);
 	}
 	
-	if (i == n) { // there are no gaps, so increment from the last element
-		proIndex = proNums[n-1] + 1;
+	wxLogInfo(wxT_2(" Found %lu profile(s), read %lu."),
+		static_cast<unsigned long>(this->profileFiles.size()),
+		static_cast<unsigned long>(readCount));
+	
+	if (readCount > 0 || indexedFiles.size() != this->profileFiles.size()) {
+		AtomicFileBatch batch;
+		this->SaveProfileIndex(batch);
+		batch.Commit();
 	}
+}
 
-	wxLogDebug(wxT_2("new profile number: %ld"), proIndex);
+/** Returns the named profile, reading it from disk the first time it is asked for.
+ Returns NULL if there is no such profile. */
+wxFileConfig* ProMan::GetProfile(const wxString& name) {
+	ProfileMap::iterator loaded = this->profiles.find(name);
+	if (loaded != this->profiles.end()) {
+		return loaded->second;
+	}
+
+	ProfileOverlayMap::iterator overlay = this->overlays.find(name);
+	if (overlay != this->overlays.end()) {
+		wxFileConfig* config = overlay->second->Materialize();
+		if (config != NULL) {
+			this->profiles[name] = config;
+		}
+		this->DiscardOverlay(name);
+		return config;
+	}
 	
-	wxASSERT(proIndex <= 99999); // the maximum possible index given a 5-digit number
+	if (this->database != NULL) {
+		const ProfileEntryValues* entries = this->database->GetEntries(name);
+		if (entries == NULL) {
+			return NULL;
+		}
+		wxFileConfig* config = MakeConfig(entries);
+		this->profiles[name] = config;
+		return config;
+	}
 	
-	return wxString::Format(wxT_2("pro%05ld.ini"), proIndex);
+	ProfileIndex::const_iterator entry = this->profileFiles.find(name);
+	if (entry == this->profileFiles.end()) {
+		return NULL;
+	}
+	
+	wxFileName file(GetProfileStorageFolder(), entry->second.fileName);
+	if (!file.FileExists()) {
+		wxLogWarning(_("Backing file (%s) for profile '%s' does not exist"),
+			file.GetFullPath().c_str(), name.c_str());
+		return NULL;
+	}
+	
+	wxLogDebug(wxT_2("Opening %s for profile '%s'"),
+		file.GetFullPath().c_str(), name.c_str());
+	wxFFileInputStream instream(file.GetFullPath());
+	wxFileConfig* config = new wxFileConfig(instream);
+	this->profiles[name] = config;
+	return config;
+}
+
+/** Reads the profile index into index, keyed by file name.
+ A missing or unreadable index just leaves index empty, in which case
+ every profile gets read once and the index is rebuilt. */
+void ProMan::ReadProfileIndex(ProfileIndex& index) {
+	wxFileName file(GetProfileStorageFolder(), PROFILE_INDEX_FILE_NAME);
+	if (!file.FileExists()) {
+		return;
+	}
+	
+	wxTextFile indexFile;
+	if (!indexFile.Open(file.GetFullPath(), wxConvUTF8)) {
+		wxLogWarning(_("Unable to read the profile index, rebuilding it."));
+		return;
+	}
+	
+	if (indexFile.GetLineCount() == 0 || indexFile[0] != PROFILE_INDEX_HEADER) {
+		wxLogInfo(wxT_2(" Profile index has an unknown format, rebuilding it."));
+		return;
+	}
+	
+	// each line is file name, modification time, size and name, tab separated
+	for (size_t i = 1, n = indexFile.GetLineCount(); i < n; ++i) {
+		wxString rest(indexFile[i]);
+		const wxString fileName(rest.BeforeFirst(wxT_2('\t')));
+		rest = rest.AfterFirst(wxT_2('\t'));
+		const wxString modificationTime(rest.BeforeFirst(wxT_2('\t')));
+		rest = rest.AfterFirst(wxT_2('\t'));
+		const wxString size(rest.BeforeFirst(wxT_2('\t')));
+		const wxString name(rest.AfterFirst(wxT_2('\t')));
+		
+		ProfileIndexEntry entry;
+		if (fileName.IsEmpty() || name.IsEmpty()
+			|| !modificationTime.ToULong(&entry.modificationTime)
+			|| !size.ToULong(&entry.size)) {
+			wxLogDebug(wxT_2(" Ignoring malformed profile index line %lu"),
+				static_cast<unsigned long>(i));
+			continue;
+		}
+		entry.name = name;
+		entry.fileName = fileName;
+		index[fileName] = entry;
+	}
+}
+
+/** Writes the profile index through the batch.
+ The profile database is its own index, so this does nothing when it is used. */
+bool ProMan::SaveProfileIndex(AtomicFileBatch& batch) const {
+	if (this->database != NULL) {
+		return true;
+	}
+	
+	wxString contents(PROFILE_INDEX_HEADER);
+	contents += wxT_2("\n");
+	for (ProfileIndex::const_iterator it = this->profileFiles.begin(),
+		 end = this->profileFiles.end(); it != end; ++it) {
+		const ProfileIndexEntry& entry = it->second;
+		contents += wxString::Format(wxT_2("%s\t%lu\t%lu\t%s\n"),
+			entry.fileName.c_str(), entry.modificationTime, entry.size,
+			entry.name.c_str());
+	}
+	
+	const wxCharBuffer buffer(contents.mb_str(wxConvUTF8));
+	return batch.SaveBytes(buffer.data(), strlen(buffer.data()),
+		wxFileName(GetProfileStorageFolder(), PROFILE_INDEX_FILE_NAME));
+}
+
+/** Records the current modification time and size of a profile's file
+ in the index, after the file has been written. */
+bool ProMan::UpdateProfileIndex(const wxString& name, const wxString& fileName) {
+	wxStructStat st;
+	const wxFileName file(GetProfileStorageFolder(), fileName);
+	if (wxStat(file.GetFullPath(), &st) != 0) {
+		wxLogDebug(wxT_2("Unable to stat %s to update the profile index"),
+			file.GetFullPath().c_str());
+		// a zero size never matches, so the file will be read on next startup
+		this->profileFiles[name] = ProfileIndexEntry(name, fileName, 0, 0);
+		return false;
+	}
+	this->profileFiles[name] = ProfileIndexEntry(name, fileName,
+		static_cast<unsigned long>(st.st_mtime),
+		static_cast<unsigned long>(st.st_size));
+	return true;
 }
 
 // global profile access functions
@@ -638,6 +896,7 @@ bool ProMan::ProfileRead(const wxString& key, bool* b, bool defaultVal, bool wri
 		if (!readSuccess && writeBackIfAbsent) {
 			wxLogDebug(wxT_2("entry %s in current profile is absent. writing default value %s to it."),
 				key.c_str(), defaultVal ? wxT_2("true") : wxT_2("false"));
+			this->RecordProfileChange(key, defaultVal);
 			this->currentProfile->Write(key, defaultVal);
 		}
 		return readSuccess;
@@ -672,6 +931,7 @@ bool ProMan::ProfileRead(const wxString& key, wxString* str, const wxString& def
 		if (!readSuccess && writeBackIfAbsent) {
 			wxLogDebug(wxT_2("entry %s in current profile is absent. writing default value %s to it."),
 				key.c_str(), defaultVal.c_str());
+			this->RecordProfileChange(key, defaultVal);
 			this->currentProfile->Write(key, defaultVal);
 		}
 		return readSuccess;
@@ -706,12 +966,105 @@ bool ProMan::ProfileRead(const wxString& key, long* l, long defaultVal, bool wri
 		if (!readSuccess && writeBackIfAbsent) {
 			wxLogDebug(wxT_2("entry %s in current profile is absent. writing default value %ld to it."),
 				key.c_str(), defaultVal);
+			this->RecordProfileChange(key, defaultVal);
 			this->currentProfile->Write(key, defaultVal);
 		}
 		return readSuccess;
 	}
 }
 
+/** Returns the current profile's slot for key, or NULL if there is no
+ current profile. type is only used in the warning. */
+const ProfileValueSlot* ProMan::GetCurrentValue(ProfileKeyId key, const wxChar* type) const {
+	wxCHECK_MSG(key >= 0 && key < PRO_KEY_COUNT, NULL,
+		wxT_2("attempt to read a profile key that is not in the schema"));
+	if (this->currentProfile == NULL) {
+		wxLogWarning(wxT_2("attempt to read %s for key %s from null current profile"),
+			type, PROFILE_SCHEMA[key].path);
+		return NULL;
+	}
+	return &this->currentValues[key];
+}
+
+/** Tests whether the schema key is in the current profile. */
+bool ProMan::ProfileExists(ProfileKeyId key) const {
+	const ProfileValueSlot* slot = this->GetCurrentValue(key, wxT_2("existence"));
+	return (slot != NULL) && slot->isPresent;
+}
+
+/** Reads a bool from the current profile by its schema slot, using the
+ schema's default if the key is not present. Returns true if the key was present. */
+bool ProMan::ProfileRead(ProfileKeyId key, bool* b) const {
+	const ProfileValueSlot* slot = this->GetCurrentValue(key, wxT_2("bool"));
+	if (slot == NULL) {
+		return false;
+	}
+	*b = (slot->hasNumber ? slot->number : PROFILE_SCHEMA[key].defaultNumber) != 0;
+	return slot->hasNumber;
+}
+
+/** Reads a bool from the current profile by its schema slot,
+ using the default value if the key is not present.
+ Returns true if the key was present. */
+bool ProMan::ProfileRead(ProfileKeyId key, bool* b, bool defaultVal) const {
+	const ProfileValueSlot* slot = this->GetCurrentValue(key, wxT_2("bool"));
+	if (slot == NULL) {
+		return false;
+	}
+	*b = slot->hasNumber ? (slot->number != 0) : defaultVal;
+	return slot->hasNumber;
+}
+
+/** Reads a string from the current profile by its schema slot, using the
+ schema's default if the key is not present. Returns true if the key was present. */
+bool ProMan::ProfileRead(ProfileKeyId key, wxString* str) const {
+	const ProfileValueSlot* slot = this->GetCurrentValue(key, wxT_2("string"));
+	if (slot == NULL) {
+		return false;
+	}
+	if (slot->isPresent) {
+		*str = slot->value;
+	} else {
+		*str = PROFILE_SCHEMA[key].defaultValue;
+	}
+	return slot->isPresent;
+}
+
+/** Reads a string from the current profile by its schema slot,
+ using the default value if the key is not present.
+ Returns true if the key was present. */
+bool ProMan::ProfileRead(ProfileKeyId key, wxString* str, const wxString& defaultVal) const {
+	const ProfileValueSlot* slot = this->GetCurrentValue(key, wxT_2("string"));
+	if (slot == NULL) {
+		return false;
+	}
+	*str = slot->isPresent ? slot->value : defaultVal;
+	return slot->isPresent;
+}
+
+/** Reads a long from the current profile by its schema slot, using the
+ schema's default if the key is not present. Returns true if the key was present. */
+bool ProMan::ProfileRead(ProfileKeyId key, long* l) const {
+	const ProfileValueSlot* slot = this->GetCurrentValue(key, wxT_2("long"));
+	if (slot == NULL) {
+		return false;
+	}
+	*l = slot->hasNumber ? slot->number : PROFILE_SCHEMA[key].defaultNumber;
+	return slot->hasNumber;
+}
+
+/** Reads a long from the current profile by its schema slot,
+ using the default value if the key is not present.
+ Returns true if the key was present. */
+bool ProMan::ProfileRead(ProfileKeyId key, long* l, long defaultVal) const {
+	const ProfileValueSlot* slot = this->GetCurrentValue(key, wxT_2("long"));
+	if (slot == NULL) {
+		return false;
+	}
+	*l = slot->hasNumber ? slot->number : defaultVal;
+	return slot->hasNumber;
+}
+
 /** Writes a string for the given key to the current profile.
  Returns true on success. */
 bool ProMan::ProfileWrite(const wxString& key, const wxString& value) {
@@ -730,6 +1083,7 @@ bool ProMan::ProfileWrite(const wxString& key, const wxString& value) {
 					oldValue.c_str(), value.c_str(), key.c_str());
 			}
 		}
+		this->RecordProfileChange(key, value);
 		return this->currentProfile->Write(key, value);
 	}
 }
@@ -752,6 +1106,7 @@ bool ProMan::ProfileWrite(const wxString& key, const wxChar* value) {
 						   oldValue.c_str(), value, key.c_str());
 			}
 		}
+		this->RecordProfileChange(key, value);
 		return this->currentProfile->Write(key, value);
 	}
 }
@@ -774,6 +1129,7 @@ bool ProMan::ProfileWrite(const wxString& key, long value) {
 					oldValue, value, key.c_str());
 			}
 		}
+		this->RecordProfileChange(key, value);
 		return this->currentProfile->Write(key, value);
 	}
 }
@@ -799,10 +1155,124 @@ bool ProMan::ProfileWrite(const wxString& key, bool value) {
 			}
 		}
 		
+		this->RecordProfileChange(key, value);
 		return this->currentProfile->Write(key, value);
 	}
 }
 
+/** Journals a pending write to the current profile. The value is recorded
+ in the form that wxConfigBase stores it, so that writing back the
+ original value of a long or bool is recognised as undoing the change. */
+void ProMan::RecordProfileChange(const wxString& key, const wxString& value) {
+	this->journal.Record(*this->currentProfile, key, &value);
+	this->DiscardTemplate(this->currentProfileName);
+	// the slot must hold what reading the profile back would give, as
+	// LoadCurrentValues() does, and reads expand environment variables
+	if (this->currentProfile->IsExpandingEnvVars()) {
+		const wxString expanded(wxExpandEnvVars(value));
+		this->StoreCurrentValue(key, &expanded);
+	} else {
+		this->StoreCurrentValue(key, &value);
+	}
+	this->InvalidateSnapshot();
+}
+
+void ProMan::RecordProfileChange(const wxString& key, const wxChar* value) {
+	this->RecordProfileChange(key, wxString(value));
+}
+
+void ProMan::RecordProfileChange(const wxString& key, long value) {
+	this->RecordProfileChange(key, wxString::Format(wxT_2("%ld"), value));
+}
+
+void ProMan::RecordProfileChange(const wxString& key, bool value) {
+	this->RecordProfileChange(key, value ? 1L : 0L);
+}
+
+/** Refills every slot of currentValues from the current profile. Needed
+ whenever the current profile changes other than through ProfileWrite()
+ or ProfileDeleteEntry(). */
+void ProMan::LoadCurrentValues() {
+	for (int i = 0; i < PRO_KEY_COUNT; ++i) {
+		const ProfileKeyId key = static_cast<ProfileKeyId>(i);
+		wxString value;
+		if (this->currentProfile != NULL
+			&& this->currentProfile->Read(PROFILE_SCHEMA[i].path, &value)) {
+			this->StoreCurrentValue(key, &value);
+		} else {
+			this->StoreCurrentValue(key, NULL);
+		}
+	}
+}
+
+/** Keeps currentValues in step with a write (or, when value is NULL, a
+ delete) of key in the current profile. Keys outside the schema are ignored. */
+void ProMan::StoreCurrentValue(const wxString& key, const wxString* value) {
+	const ProfileKeyId id = FindProfileKey(key);
+	if (id != PRO_KEY_INVALID) {
+		this->StoreCurrentValue(id, value);
+	}
+}
+
+/** Marks the current profile as changed. Snapshots already handed out keep
+ the contents they were taken with; the next GetSnapshot() takes a new one. */
+void ProMan::InvalidateSnapshot() {
+	this->profileVersion++;
+	this->snapshot = ProfileSnapshotPtr();
+}
+
+/** Returns a read-only snapshot of the current profile as it is now, for
+ handing to work that runs off the UI thread. Must itself be called on the
+ UI thread. The snapshot is only taken on the first call after the current
+ profile changes; later calls share it. Returns an empty pointer if there
+ is no current profile. */
+ProfileSnapshotPtr ProMan::GetSnapshot() {
+	if (this->currentProfile == NULL) {
+		wxLogWarning(wxT_2("attempt to take snapshot of null current profile"));
+		return ProfileSnapshotPtr();
+	}
+	if (!this->snapshot.IsOk()) {
+		ProfileEntryValues entries;
+		ReadProfileEntries(*this->currentProfile, entries);
+		this->snapshot = ProfileSnapshotPtr(new ProfileSnapshot(
+			this->currentProfileName, this->profileVersion, entries));
+	}
+	return this->snapshot;
+}
+
+/** Takes a snapshot of any profile, with the entries in overrides
+ replacing or adding to its own, without changing the profile. Used to try
+ out variations of a profile. Returns an empty pointer if there is no
+ profile called name. */
+ProfileSnapshotPtr ProMan::GetSnapshotOf(const wxString& name,
+	const ProfileEntryValues* overrides) {
+	wxFileConfig* config = this->GetProfile(name);
+	if (config == NULL) {
+		wxLogWarning(_("Profile %s does not exist."), name.c_str());
+		return ProfileSnapshotPtr();
+	}
+	ProfileEntryValues entries;
+	ReadProfileEntries(*config, entries);
+	if (overrides != NULL) {
+		for (ProfileEntryValues::const_iterator it = overrides->begin(), end = overrides->end();
+			 it != end; ++it) {
+			entries[it->first] = it->second;
+		}
+	}
+	// it isn't the current profile, so it has no version of its own
+	return ProfileSnapshotPtr(new ProfileSnapshot(name, 0, entries));
+}
+
+void ProMan::StoreCurrentValue(ProfileKeyId key, const wxString* value) {
+	ProfileValueSlot& slot = this->currentValues[key];
+	slot.isPresent = (value != NULL);
+	slot.value = slot.isPresent ? *value : wxString();
+	slot.hasNumber = slot.isPresent && slot.value.ToLong(&slot.number);
+	if (!slot.hasNumber) {
+		slot.number = 0;
+	}
+}
+
 /** Deletes an entry from the current profile,
  deleting the group if the entry was the only one in the group
  and the second parameter is true. */
@@ -812,10 +1282,14 @@ bool ProMan::ProfileDeleteEntry(const wxString& key, bool bDeleteGroupIfEmpty) {
 			key.c_str());
 		return false;
 	} else {
-		if (this-currentProfile->Exists(key)) {
+		if (this->currentProfile->Exists(key)) {
 			wxLogDebug(wxT_2("deleting key %s in profile"),
 				key.c_str());
 		}
+		this->journal.Record(*this->currentProfile, key, NULL);
+		this->DiscardTemplate(this->currentProfileName);
+		this->StoreCurrentValue(key, NULL);
+		this->InvalidateSnapshot();
 		return this->currentProfile->DeleteEntry(key, bDeleteGroupIfEmpty);
 	}
 }
@@ -847,8 +1321,7 @@ const wxString ProMan::GetSaveDialogCaptionText(ProMan::SaveDialogContext contex
 	switch (context) {
 		case ON_PROFILE_SWITCH:
 #if PROFILE_DEBUGGING
-			wxLogDebug(wxT_2("contents of private copy at save prompt on profile switch:"));
-			LogConfigContents(*ProMan::proman->privateCopy);
+			ProMan::proman->journal.LogChanges();
 			wxLogDebug(wxT_2("contents of current profile at save prompt on profile switch:"));
 			LogConfigContents(*ProMan::proman->currentProfile);
 #endif
@@ -857,8 +1330,7 @@ const wxString ProMan::GetSaveDialogCaptionText(ProMan::SaveDialogContext contex
 
 		case ON_PROFILE_CREATE:
 #if PROFILE_DEBUGGING
-			wxLogDebug(wxT_2("contents of private copy at save prompt on profile create:"));
-			LogConfigContents(*ProMan::proman->privateCopy);
+			ProMan::proman->journal.LogChanges();
 			wxLogDebug(wxT_2("contents of current profile at save prompt on profile create:"));
 			LogConfigContents(*ProMan::proman->currentProfile);
 #endif
@@ -867,8 +1339,7 @@ const wxString ProMan::GetSaveDialogCaptionText(ProMan::SaveDialogContext contex
 
 		case ON_EXIT:
 #if PROFILE_DEBUGGING
-			wxLogDebug(wxT_2("contents of private copy at save prompt on exit:"));
-			LogConfigContents(*ProMan::proman->privateCopy);
+			ProMan::proman->journal.LogChanges();
 			wxLogDebug(wxT_2("contents of current profile at save prompt on exit:"));
 			LogConfigContents(*ProMan::proman->currentProfile);
 #endif
@@ -915,43 +1386,201 @@ const wxString ProMan::GetSaveDialogMessageText(ProMan::SaveDialogContext contex
 bool ProMan::DoesProfileExist(wxString name) {
 	/* Item exists if the returned value from find() does not equal 
 	the value of .end().  As per the HashMap docs. */
-	return (this->profiles.find(name) != this->profiles.end());
+	return (this->profileFiles.find(name) != this->profileFiles.end());
 }
 
 /** Returns an wxArrayString of all of the profile names. */
 wxArrayString ProMan::GetAllProfileNames() {
 	wxArrayString out;
 
-	ProfileMap::iterator iter = this->profiles.begin();
-	do {
+	for (ProfileIndex::const_iterator iter = this->profileFiles.begin(),
+		 end = this->profileFiles.end(); iter != end; ++iter) {
 		out.Add(iter->first);
-		iter++;
-	} while (iter != this->profiles.end());
+	}
 
 	return out;
 }
 
-void SaveProfileToDisk(wxFileConfig* toSave, const wxString& name)
+/** Writes the profile to its pro?????.ini through the batch.
+ The caller decides when to Commit() the batch. */
+bool SaveProfileToDisk(wxFileConfig* toSave, const wxString& name, AtomicFileBatch& batch)
 {
 	wxString profileFilename;
 	if ( !toSave->Read(PRO_CFG_MAIN_FILENAME, &profileFilename) ) {
 		wxLogError(wxT_2("Profile '%s' does not have a file name. Cannot save it."),
 			name.c_str());
 		// FIXME maybe make a new file and save the current profile there
+		return false;
 	} else {
 		wxFileName file;
 		file.Assign(GetProfileStorageFolder(), profileFilename);
 		wxASSERT( file.IsOk() );
-		wxFFileOutputStream configOutput(file.GetFullPath());
-		toSave->Save(configOutput);
+		if ( !batch.Save(*toSave, file) ) {
+			return false;
+		}
 		wxLogDebug(wxT_2("Profile '%s' saved to '%s'"),
 			name.c_str(), file.GetFullPath().c_str());
+		return true;
 	}
 }
 
+/** Saves the named profile to its file through the batch, or to the
+ database if it is used. The caller saves the profile index and commits. */
+bool ProMan::SaveProfile(const wxString& name, wxFileConfig& config, AtomicFileBatch& batch) {
+	if (this->database != NULL) {
+		this->SaveProfileToDatabase(name, config);
+		return true;
+	}
+	if ( !SaveProfileToDisk(&config, name, batch) ) {
+		return false;
+	}
+	wxString profileFilename;
+	if (config.Read(PRO_CFG_MAIN_FILENAME, &profileFilename)) {
+		this->UpdateProfileIndex(name, profileFilename);
+	}
+	return true;
+}
+
+/** Writes a string to the named profile, which need not be the current one. */
+bool ProMan::WriteToProfile(const wxString& name, const wxString& key, const wxString& value) {
+	if (name == this->currentProfileName) {
+		return this->ProfileWrite(key, value) && this->SaveEditedProfile(name);
+	}
+	this->DiscardTemplate(name);
+	ProfileOverlayMap::iterator overlay = this->overlays.find(name);
+	if (overlay != this->overlays.end()) {
+		overlay->second->Write(key, value);
+		return this->SaveEditedProfile(name);
+	}
+	wxFileConfig* config = this->GetProfile(name);
+	if (config == NULL) {
+		wxLogWarning(_("Profile %s does not exist. Cannot write to it."), name.c_str());
+		return false;
+	}
+	return config->Write(key, value) && this->SaveEditedProfile(name);
+}
+
+/** Deletes an entry from the named profile, which need not be the current one. */
+bool ProMan::DeleteEntryFromProfile(const wxString& name, const wxString& key) {
+	if (name == this->currentProfileName) {
+		return this->ProfileDeleteEntry(key) && this->SaveEditedProfile(name);
+	}
+	this->DiscardTemplate(name);
+	ProfileOverlayMap::iterator overlay = this->overlays.find(name);
+	if (overlay != this->overlays.end()) {
+		overlay->second->DeleteEntry(key);
+		return this->SaveEditedProfile(name);
+	}
+	wxFileConfig* config = this->GetProfile(name);
+	if (config == NULL) {
+		wxLogWarning(_("Profile %s does not exist. Cannot delete from it."), name.c_str());
+		return false;
+	}
+	return config->DeleteEntry(key) && this->SaveEditedProfile(name);
+}
+
+/** Saves a profile just changed by WriteToProfile() or DeleteEntryFromProfile(),
+ or notes it for EndDeferredSaves() if saves are being deferred. */
+bool ProMan::SaveEditedProfile(const wxString& name) {
+	if (this->isDeferringSaves) {
+		if (this->deferredProfiles.Index(name) == wxNOT_FOUND) {
+			this->deferredProfiles.Add(name);
+		}
+		return true;
+	}
+
+	AtomicFileBatch batch;
+	bool ok = this->SaveProfile(name, *this->GetProfile(name), batch);
+	ok = this->SaveProfileIndex(batch) && ok;
+	ok = this->CommitChanges(batch) && ok;
+	if (ok && name == this->currentProfileName) {
+		this->journal.Clear();
+	}
+	return ok;
+}
+
+/** Saves a profile that is still an overlay, which is the first time its
+ settings are copied. Written to a file, it stays unread until it is
+ needed, like any other profile; the database needs it read. */
+bool ProMan::SaveOverlay(const wxString& name, const ProfileOverlay& overlay,
+	AtomicFileBatch& batch) {
+	if (this->database != NULL) {
+		wxFileConfig* config = this->GetProfile(name);
+		return config != NULL && this->SaveProfile(name, *config, batch);
+	}
+	wxMemoryBuffer contents;
+	if (!overlay.Serialize(contents)
+		|| !batch.SaveBytes(contents.GetData(), contents.GetDataLen(),
+			wxFileName(GetProfileStorageFolder(), overlay.GetFileName()))) {
+		return false;
+	}
+	this->UpdateProfileIndex(name, overlay.GetFileName());
+	this->DiscardOverlay(name);
+	return true;
+}
+
+/** Forgets the named profile's overlay, if it has one. */
+void ProMan::DiscardOverlay(const wxString& name) {
+	ProfileOverlayMap::iterator found = this->overlays.find(name);
+	if (found != this->overlays.end()) {
+		delete found->second;
+		this->overlays.erase(found);
+	}
+}
+
+/** Holds back writing created and edited profiles until EndDeferredSaves(),
+ so that a run of operations on many profiles writes each one once. */
+void ProMan::BeginDeferredSaves() {
+	wxCHECK_RET(!this->isDeferringSaves, wxT_2("BeginDeferredSaves called twice"));
+	this->isDeferringSaves = true;
+}
+
+/** Writes every profile created or edited since BeginDeferredSaves() in a
+ single batch. Returns false if any of them could not be written. */
+bool ProMan::EndDeferredSaves() {
+	wxCHECK_MSG(this->isDeferringSaves, false,
+		wxT_2("EndDeferredSaves called without BeginDeferredSaves"));
+	this->isDeferringSaves = false;
+
+	AtomicFileBatch batch;
+	bool ok = true;
+	for (size_t i = 0; i < this->deferredProfiles.GetCount(); ++i) {
+		const wxString& name = this->deferredProfiles[i];
+		ProfileOverlayMap::iterator overlay = this->overlays.find(name);
+		if (overlay != this->overlays.end()) {
+			if (!this->SaveOverlay(name, *overlay->second, batch)) {
+				wxLogError(_("Unable to save profile '%s'"), name.c_str());
+				ok = false;
+			}
+			continue;
+		}
+		wxFileConfig* config = this->GetProfile(name);
+		if (config == NULL || !this->SaveProfile(name, *config, batch)) {
+			wxLogError(_("Unable to save profile '%s'"), name.c_str());
+			ok = false;
+		} else if (name == this->currentProfileName) {
+			this->journal.Clear();
+		}
+	}
+	ok = this->SaveProfileIndex(batch) && ok;
+	ok = this->CommitChanges(batch) && ok;
+
+	wxLogDebug(wxT_2("Saved %lu deferred profile(s)"),
+		static_cast<unsigned long>(this->deferredProfiles.GetCount()));
+	this->deferredProfiles.Clear();
+	return ok;
+}
+
 /** Saves the current profile to disk, regardless of whether it has unsaved changes.
  Does not affect the global profile or any other profile. */
 void ProMan::SaveCurrentProfile(bool quiet) {
+	AtomicFileBatch batch;
+	this->SaveCurrentProfile(batch, quiet);
+	this->CommitChanges(batch);
+}
+
+/** Saves the current profile as part of a larger batch of writes. */
+void ProMan::SaveCurrentProfile(AtomicFileBatch& batch, bool quiet) {
 	wxConfigBase* configbase = wxFileConfig::Get(false);
 	if ( configbase == NULL ) {
 		wxLogError(wxT_2("There is no global file config."));
@@ -959,8 +1588,12 @@ void ProMan::SaveCurrentProfile(bool quiet) {
 	}
 	wxFileConfig* config = dynamic_cast<wxFileConfig*>(configbase);
 	if ( config != NULL ) {
-		SaveProfileToDisk(config, this->currentProfileName.c_str());
-		this->ResetPrivateCopy();
+		if ( !this->SaveProfile(this->currentProfileName, *config, batch) ) {
+			wxLogError(_("Unable to save profile '%s'"), this->currentProfileName.c_str());
+			return;
+		}
+		this->SaveProfileIndex(batch);
+		this->journal.Clear();
 		if (!quiet) {
 			wxLogStatus(_("Profile '%s' saved"), this->currentProfileName.c_str());				
 		}
@@ -973,12 +1606,12 @@ void ProMan::SaveCurrentProfile(bool quiet) {
 
 /** Reverts any unsaved changes to the current profile. */
 void ProMan::RevertCurrentProfile() {
-	ClearConfig(*(this->currentProfile));
-	CopyConfig(*(this->privateCopy), *(this->currentProfile));
-}
-
-bool ProMan::HasUnsavedChanges() {
-	return !AreConfigsEqual(*(this->currentProfile), *(this->privateCopy));
+	wxCHECK_RET(this->currentProfile != NULL,
+		wxT_2("RevertCurrentProfile called with null current profile!"));
+	this->journal.Revert(*(this->currentProfile));
+	this->DiscardTemplate(this->currentProfileName);
+	this->LoadCurrentValues();
+	this->InvalidateSnapshot();
 }
 
 wxString ProMan::GetCurrentName() {
@@ -989,9 +1622,18 @@ wxString ProMan::GetCurrentName() {
 Does not cause prompts and may destroy data if autosave is not on.
 */
 bool ProMan::SwitchTo(wxString name) {
-	if ( this->profiles.find(name) == this->profiles.end() ) {
+	wxFileConfig* newProfile = this->GetProfile(name);
+	if ( newProfile == NULL ) {
 		return false;
 	} else {
+		// diff against what the UI currently shows, which includes any
+		// changes that are about to be reverted
+		ProfileEntryValues previousEntries;
+		const bool hadProfile = (this->currentProfile != NULL);
+		if (hadProfile) {
+			ReadProfileEntries(*this->currentProfile, previousEntries);
+		}
+
 		if (this->currentProfile != NULL && this->HasUnsavedChanges()) {
 			if (this->isAutoSaving) {
 				wxLogDebug(wxT_2("Auto saving current profile %s before switching profiles"),
@@ -1004,13 +1646,26 @@ bool ProMan::SwitchTo(wxString name) {
 			}
 		}
 		this->currentProfileName = name;
-		this->currentProfile = this->profiles.find(name)->second;
+		this->currentProfile = newProfile;
+		this->LoadCurrentValues();
+		this->InvalidateSnapshot();
 		wxFileConfig::Set(this->currentProfile);
 		if ( !(ProMan::flags & NoUpdateLastProfile) )
 			this->globalProfile->Write(GBL_CFG_MAIN_LASTPROFILE, name);
-		this->ResetPrivateCopy();
+		this->journal.Clear();
 //		TestConfigFunctions(*this->currentProfile); // remove after testing on all platforms
-		this->GenerateCurrentProfileChangedEvent();
+
+		// a profile that hasn't been initialized yet still needs the flag
+		// file processing that finishes its initialization
+		int changes = PROFILE_CHANGED_ALL;
+		bool isInitialized = false;
+		this->currentProfile->Read(PRO_CFG_MAIN_INITIALIZED, &isInitialized, false);
+		if (hadProfile && isInitialized) {
+			ProfileEntryValues newEntries;
+			ReadProfileEntries(*this->currentProfile, newEntries);
+			changes = DiffProfileEntries(previousEntries, newEntries);
+		}
+		this->GenerateCurrentProfileChangedEvent(changes);
 		return true;
 	}
 }
@@ -1029,48 +1684,24 @@ bool ProMan::CreateProfile(const wxString& newProfileName, const wxFileName& sou
 If sourceConfig is NULL then the newProfile is created blank. */
 bool ProMan::CreateProfile(const wxString& newProfileName, const wxFileConfig *sourceConfig)
 {
-	if (this->DoesProfileExist(newProfileName)) {
-		wxLogWarning(_("New profile '%s' already exists!"), newProfileName.c_str());
-		return false;
-	}
-
-	if (!this->CreateNewProfile(newProfileName)) {
-		wxLogWarning(wxT_2("New profile creation failed."));
-		return false;
-	}
-
-	if (sourceConfig != NULL)
-	{
-		/* We just created this profile it had better exist */
-		wxFileConfig* newProfileConfig = this->profiles[newProfileName];
-		wxCHECK_MSG(newProfileConfig != NULL, false, wxT_2("Create returned true but did not create profile"));
-
-#if PROFILE_DEBUGGING
-		wxLogDebug(wxT_2("contents of new profile '%s' before clone:"), newProfileName.c_str());
-		LogConfigContents(*newProfileConfig);
-#endif
-
-		CopyConfig(*sourceConfig, *newProfileConfig, false);
-		SaveProfileToDisk(newProfileConfig, newProfileName);
-
-#if PROFILE_DEBUGGING
-		wxLogDebug(wxT_2("contents of new profile '%s' after clone:"), newProfileName.c_str());
-		LogConfigContents(*newProfileConfig);
-		wxLogDebug(wxT_2("contents of cloned from profile '%s' after clone:"), cloneFromProfileName.c_str());
-		LogConfigContents(*cloneFromProfileConfig);
-#endif
-
+	if (sourceConfig == NULL) {
+		return this->CreateProfileFromTemplate(newProfileName, NULL);
 	}
 
-	this->GenerateChangeEvent();
-	return true;
+	ProfileTemplate* base = MakeTemplate(*sourceConfig);
+	const bool created = base->IsOk()
+		&& this->CreateProfileFromTemplate(newProfileName, base);
+	delete base;
+	return created;
 }
 
 /** Creates a profile by name. If the second argument is non-empty and is the name
  of an existing profile, its settings/flags will be copied over to the new profile.
+ Cloning the same profile again reuses its template, so stamping out many
+ profiles from one costs a single pass over its settings.
  Returns true on success. */
 bool ProMan::CreateProfile(const wxString& newProfileName, const wxString& cloneFromProfileName) {
-	wxFileConfig *cloneSource = NULL;
+	const ProfileTemplate* base = NULL;
 
 	if (cloneFromProfileName.IsEmpty())
 	{
@@ -1085,13 +1716,77 @@ bool ProMan::CreateProfile(const wxString& newProfileName, const wxString& clone
 			wxLogWarning(_("Profile to clone from '%s' does not exist!"), cloneFromProfileName.c_str());
 			return false;
 		}
-		cloneSource = this->profiles[cloneFromProfileName];
-		wxCHECK_MSG( cloneSource != NULL, false,
-			wxString::Format(wxT_2("Cannot find profile '%s' from which to clone"),
+		base = this->GetTemplate(cloneFromProfileName);
+		wxCHECK_MSG( base != NULL, false,
+			wxString::Format(wxT_2("Cannot make template of profile '%s' from which to clone"),
 				cloneFromProfileName.c_str()) );
 	}
 
-	return this->CreateProfile(newProfileName, cloneSource);
+	return this->CreateProfileFromTemplate(newProfileName, base);
+}
+
+/** Creates a profile from base, or a blank profile if base is NULL. */
+bool ProMan::CreateProfileFromTemplate(const wxString& newProfileName, const ProfileTemplate* base)
+{
+	if (this->DoesProfileExist(newProfileName)) {
+		wxLogWarning(_("New profile '%s' already exists!"), newProfileName.c_str());
+		return false;
+	}
+
+	if (!this->CreateNewProfile(newProfileName, base)) {
+		wxLogWarning(wxT_2("New profile creation failed."));
+		return false;
+	}
+
+#if PROFILE_DEBUGGING
+	if (base != NULL) {
+		wxLogDebug(wxT_2("new profile '%s' made from %lu byte template"),
+			newProfileName.c_str(), static_cast<unsigned long>(base->GetSize()));
+	}
+#endif
+
+	this->GenerateChangeEvent();
+	return true;
+}
+
+/** Returns the template of the named profile, making it if needed.
+ Returns NULL if the profile cannot be read. */
+const ProfileTemplate* ProMan::GetTemplate(const wxString& name) {
+	ProfileTemplateMap::const_iterator found = this->templates.find(name);
+	if (found != this->templates.end()) {
+		return found->second;
+	}
+
+	wxFileConfig* source = this->GetProfile(name);
+	if (source == NULL) {
+		return NULL;
+	}
+
+	ProfileTemplate* base = MakeTemplate(*source);
+	if (!base->IsOk()) {
+		delete base;
+		return NULL;
+	}
+	this->templates[name] = base;
+	return base;
+}
+
+/** Forgets the named profile's template, if it has one.
+ Must be called whenever the profile's contents change. */
+void ProMan::DiscardTemplate(const wxString& name) {
+	ProfileTemplateMap::iterator found = this->templates.find(name);
+	if (found != this->templates.end()) {
+		delete found->second;
+		this->templates.erase(found);
+	}
+}
+
+/** Makes a template of everything in source except its main group. */
+ProfileTemplate* ProMan::MakeTemplate(const wxConfigBase& source) {
+	wxStringInputStream empty(wxEmptyString);
+	wxFileConfig settings(empty);
+	CopyConfig(source, settings, false);
+	return new ProfileTemplate(settings);
 }
 
 bool ProMan::DeleteProfile(wxString name) {
@@ -1108,36 +1803,232 @@ bool ProMan::DeleteProfile(wxString name) {
 	}
 	if ( this->DoesProfileExist(name) ) {
 		wxLogDebug(wxT_2(" Profile exists"));
-		wxFileConfig* config = this->profiles[name];
+		if ( this->RemoveProfileStorage(name) ) {
+			ProfileMap::iterator loaded = this->profiles.find(name);
+			if (loaded != this->profiles.end()) {
+				delete loaded->second;
+				this->profiles.erase(loaded);
+			}
+			this->profileFiles.erase(name);
+			this->DiscardTemplate(name);
+			if (!this->isDeferringSaves) {
+				AtomicFileBatch batch;
+				this->SaveProfileIndex(batch);
+				this->CommitChanges(batch);
+			}
+			
+			wxLogMessage(_("Profile '%s' deleted."), name.c_str());
+			this->GenerateChangeEvent();
+			return true;
+		}
+	} else {
+		wxLogWarning(_("Profile %s does not exist. Cannot delete."), name.c_str());
+	}
+	return false;
+}
+
+/** Removes the named profile from wherever it is stored.
+ Returns true if it is gone. */
+bool ProMan::RemoveProfileStorage(const wxString& name) {
+	const int deferred = this->deferredProfiles.Index(name);
+	if (deferred != wxNOT_FOUND) {
+		this->deferredProfiles.RemoveAt(deferred);
+	}
+	this->DiscardOverlay(name);
+
+	if (this->database != NULL) {
+		this->database->Drop(name);
+		return this->isDeferringSaves || this->database->Flush();
+	}
+
+	// the index knows the file name, so the profile need not be read
+	wxFileName file;
+	file.Assign(GetProfileStorageFolder(), this->profileFiles[name].fileName);
+
+	if ( !file.FileExists() && deferred != wxNOT_FOUND ) {
+		// created since saves were deferred, so never written
+		return true;
+	}
+	if ( !file.FileExists() ) {
+		wxLogWarning(_("Backing file (%s) for profile '%s' does not exist"), file.GetFullPath().c_str(), name.c_str());
+		return false;
+	}
+	wxLogDebug(wxT_2(" Backing file exists"));
+	if ( !wxRemoveFile(file.GetFullPath()) ) {
+		wxLogWarning(_("Unable to delete file for profile '%s'"), name.c_str());
+		return false;
+	}
+	return true;
+}
+
+/** Fills profileFiles with every profile in the database. The profiles
+ themselves are only turned into wxFileConfigs when they are first used. */
+void ProMan::ReadDatabaseProfiles() {
+	wxASSERT(this->profileFiles.empty());
+	wxASSERT(this->database != NULL);
+
+	const wxArrayString names(this->database->GetProfileNames());
+	for (size_t i = 0; i < names.GetCount(); ++i) {
+		const ProfileEntryValues* entries = this->database->GetEntries(names[i]);
+		ProfileEntryValues::const_iterator fileName = entries->find(PRO_CFG_MAIN_FILENAME);
+		this->profileFiles[names[i]] = ProfileIndexEntry(names[i],
+			(fileName != entries->end()) ? fileName->second : this->GenerateNewProfileFileName(),
+			0, 0);
+	}
+
+	wxLogInfo(wxT_2(" Found %lu profile(s) in the database."),
+		static_cast<unsigned long>(this->profileFiles.size()));
+}
+
+/** Records the profile's entries in the database. Only the entries that
+ differ from what the database already has are written. */
+void ProMan::SaveProfileToDatabase(const wxString& name, wxConfigBase& config) {
+	wxASSERT(this->database != NULL);
+
+	// store values as written, not with environment variables expanded
+	const bool wasExpanding = config.IsExpandingEnvVars();
+	config.SetExpandEnvVars(false);
+	ProfileEntryValues entries;
+	ReadProfileEntries(config, entries);
+	config.SetExpandEnvVars(wasExpanding);
+
+	this->database->Update(name, entries);
+}
+
+/** Saves the global profile to global.ini through the batch,
+ or to the database if it is used. */
+bool ProMan::SaveGlobalProfile(AtomicFileBatch& batch) {
+	wxCHECK_MSG(this->globalProfile != NULL, false,
+		wxT_2("SaveGlobalProfile called with null global profile!"));
+	if (this->database != NULL) {
+		this->SaveProfileToDatabase(ProfileDatabase::GLOBAL_SETTINGS, *this->globalProfile);
+		return true;
+	}
+	wxFileName file;
+	file.Assign(GetProfileStorageFolder(), GLOBAL_INI_FILE_NAME);
+	return batch.Save(*this->globalProfile, file);
+}
 
-		wxString filename;
-		if ( !config->Read(PRO_CFG_MAIN_FILENAME, &filename) ) {
-			wxLogWarning(wxT_2("Unable to get filename to delete %s"), name.c_str());
+/** Makes everything saved through the batch, and to the database, durable. */
+bool ProMan::CommitChanges(AtomicFileBatch& batch) {
+	bool ok = batch.Commit();
+	if (this->database != NULL) {
+		ok = this->database->Flush() && ok;
+	}
+	return ok;
+}
+
+/** Returns a new wxFileConfig holding entries, or an empty one if entries is NULL. */
+wxFileConfig* ProMan::MakeConfig(const ProfileEntryValues* entries) {
+	wxStringInputStream configInput(wxEmptyString);
+	wxFileConfig* config = new wxFileConfig(configInput);
+	if (entries != NULL) {
+		for (ProfileEntryValues::const_iterator it = entries->begin(),
+			 end = entries->end(); it != end; ++it) {
+			config->Write(it->first, it->second);
+		}
+	}
+	return config;
+}
+
+/** Copies the global profile and every profile into a new profile
+ database, which is used from then on. The pro?????.ini files and
+ global.ini are left where they are as a backup. */
+bool ProMan::MoveToDatabase() {
+	if (this->database != NULL) {
+		wxLogInfo(_("Profiles are already stored in %s"),
+			this->database->GetFile().GetFullPath().c_str());
+		return true;
+	}
+
+	ProfileDatabase* newDatabase = new ProfileDatabase(
+		wxFileName(GetProfileStorageFolder(), PROFILE_DATABASE_FILE_NAME));
+	this->database = newDatabase;
+
+	bool ok = true;
+	for (ProfileIndex::const_iterator it = this->profileFiles.begin(),
+		 end = this->profileFiles.end(); it != end; ++it) {
+		// read from the file, not from the database that is being filled
+		this->database = NULL;
+		wxFileConfig* config = this->GetProfile(it->first);
+		this->database = newDatabase;
+		if (config == NULL) {
+			wxLogError(_("Unable to read profile '%s'"), it->first.c_str());
+			ok = false;
+			continue;
+		}
+		this->SaveProfileToDatabase(it->first, *config);
+	}
+	this->SaveNewsMapToGlobalProfile();
+	this->SaveProfileToDatabase(ProfileDatabase::GLOBAL_SETTINGS, *this->globalProfile);
+
+	if (!ok || !this->database->Flush()) {
+		wxLogError(_("Unable to move profiles to %s"),
+			newDatabase->GetFile().GetFullPath().c_str());
+		::wxRemoveFile(newDatabase->GetFile().GetFullPath());
+		this->database = NULL;
+		delete newDatabase;
+		return false;
+	}
+
+	wxLogMessage(_("Moved %lu profile(s) to %s"),
+		static_cast<unsigned long>(this->profileFiles.size()),
+		newDatabase->GetFile().GetFullPath().c_str());
+	return true;
+}
+
+/** Writes every profile in the database back out to its pro?????.ini file
+ and the global settings to global.ini, then removes the database so that
+ the files are used from then on. */
+bool ProMan::MoveToProfileFiles() {
+	if (this->database == NULL) {
+		wxLogInfo(_("Profiles are already stored in files"));
+		return true;
+	}
+
+	// everything must be read out of the database before it is let go of
+	ProfileMap toSave;
+	for (ProfileIndex::const_iterator it = this->profileFiles.begin(),
+		 end = this->profileFiles.end(); it != end; ++it) {
+		wxFileConfig* config = this->GetProfile(it->first);
+		if (config == NULL) {
+			wxLogError(_("Unable to read profile '%s'"), it->first.c_str());
 			return false;
 		}
+		toSave[it->first] = config;
+	}
 
-		wxFileName file;
-		file.Assign(GetProfileStorageFolder(), filename);
+	ProfileDatabase* oldDatabase = this->database;
+	this->database = NULL;
 
-		if ( file.FileExists() ) {
-			wxLogDebug(wxT_2(" Backing file exists"));
-			if ( wxRemoveFile(file.GetFullPath()) ) {
-				this->profiles.erase(this->profiles.find(name));
-				delete config;
-				
-				wxLogMessage(_("Profile '%s' deleted."), name.c_str());
-				this->GenerateChangeEvent();
-				return true;
-			} else {
-				wxLogWarning(_("Unable to delete file for profile '%s'"), name.c_str());
-			}
-		} else {
-			wxLogWarning(_("Backing file (%s) for profile '%s' does not exist"), file.GetFullPath().c_str(), name.c_str());
+	AtomicFileBatch batch;
+	bool ok = true;
+	for (ProfileMap::const_iterator it = toSave.begin(), end = toSave.end();
+		 it != end; ++it) {
+		if (!SaveProfileToDisk(it->second, it->first, batch)) {
+			ok = false;
+			continue;
 		}
-	} else {
-		wxLogWarning(_("Profile %s does not exist. Cannot delete."), name.c_str());
+		this->UpdateProfileIndex(it->first, this->profileFiles[it->first].fileName);
 	}
-	return false;
+	this->SaveNewsMapToGlobalProfile();
+	ok = this->SaveGlobalProfile(batch) && ok;
+	ok = this->SaveProfileIndex(batch) && ok;
+	ok = this->CommitChanges(batch) && ok;
+
+	if (!ok) {
+		wxLogError(_("Unable to move profiles out of %s"),
+			oldDatabase->GetFile().GetFullPath().c_str());
+		this->database = oldDatabase;
+		return false;
+	}
+
+	::wxRemoveFile(oldDatabase->GetFile().GetFullPath());
+	wxLogMessage(_("Moved %lu profile(s) out of %s"),
+		static_cast<unsigned long>(toSave.size()),
+		oldDatabase->GetFile().GetFullPath().c_str());
+	delete oldDatabase;
+	return true;
 }
 
 // the config manipulation functions are adapted from CopyEntriesRecursive and CopyEntry
@@ -1383,6 +2274,85 @@ void ProMan::LogConfigContents(wxConfigBase& cfg, const wxString path, const boo
 	}
 }
 
+/** Reads every entry of cfg outside of the wxWindows group into entries as
+ strings, keyed by full path. */
+void ProMan::ReadProfileEntries(wxConfigBase& cfg, ProfileEntryValues& entries, const wxString path) {
+	const wxString oldPath(cfg.GetPath());
+	cfg.SetPath(path);
+
+	wxString entryName;
+	long entryIndex;
+	bool entryKeepGoing;
+	
+	entryKeepGoing = cfg.GetFirstEntry(entryName, entryIndex);
+	while (entryKeepGoing) {
+		entries[path + entryName] = cfg.Read(entryName, wxEmptyString);
+		entryKeepGoing = cfg.GetNextEntry(entryName, entryIndex);
+	}
+	
+	wxString groupName;
+	long groupIndex;
+	bool groupKeepGoing;
+	
+	groupKeepGoing = cfg.GetFirstGroup(groupName, groupIndex);
+	while (groupKeepGoing) {
+		if (groupName != _T("wxWindows")) {
+			ReadProfileEntries(cfg, entries, path + groupName + _T("/"));
+			cfg.SetPath(path);
+		}
+		groupKeepGoing = cfg.GetNextGroup(groupName, groupIndex);
+	}
+
+	cfg.SetPath(oldPath);
+}
+
+/** Returns the mask of ProfileChanges covering every entry that was added,
+ removed or changed between before and after. */
+int ProMan::DiffProfileEntries(const ProfileEntryValues& before, const ProfileEntryValues& after) {
+	int changes = PROFILE_CHANGED_NOTHING;
+
+	for (ProfileEntryValues::const_iterator it = before.begin(), end = before.end();
+		 it != end; ++it) {
+		ProfileEntryValues::const_iterator other = after.find(it->first);
+		if (other == after.end() || other->second != it->second) {
+			changes |= GetProfileChangeForKey(it->first);
+		}
+	}
+
+	for (ProfileEntryValues::const_iterator it = after.begin(), end = after.end();
+		 it != end; ++it) {
+		if (before.find(it->first) == before.end()) {
+			changes |= GetProfileChangeForKey(it->first);
+		}
+	}
+
+	return changes;
+}
+
+/** Returns which part of the profile the key at the given full path belongs to. */
+int ProMan::GetProfileChangeForKey(const wxString& key) {
+	if (key == PRO_CFG_TC_ROOT_FOLDER) {
+		return PROFILE_CHANGED_TC_ROOT_FOLDER;
+	} else if (key == PRO_CFG_TC_CURRENT_BINARY) {
+		return PROFILE_CHANGED_BINARY;
+	} else if (key == PRO_CFG_TC_CURRENT_FRED) {
+		return PROFILE_CHANGED_FRED_BINARY;
+	} else if (key == PRO_CFG_TC_CURRENT_MOD || key == PRO_CFG_TC_CURRENT_MODLINE) {
+		return PROFILE_CHANGED_MOD;
+	} else if (key == PRO_CFG_TC_CURRENT_FLAG_LINE
+		|| key.StartsWith(_T("/lighting/"))) {
+		return PROFILE_CHANGED_FLAG_LINE;
+	} else if (key.StartsWith(_T("/launch/"))) {
+		return PROFILE_CHANGED_LAUNCH;
+	} else if (key.StartsWith(_T("/main/"))) {
+		// name, file name and initialization state are bookkeeping,
+		// not settings that any page shows
+		return PROFILE_CHANGED_NOTHING;
+	} else {
+		return PROFILE_CHANGED_SETTINGS;
+	}
+}
+
 /** Start of a test case for config manipulation functions */
 void ProMan::TestConfigFunctions(wxConfigBase& src) {
 	wxLogDebug(_T("contents of source config:"));
@@ -1469,23 +2439,23 @@ ProMan::RegistryCodes ProMan::PushCurrentProfile() {
 		wxLogError(_T("PushCurrentProfile: attempt to push null current profile"));
 		return ProMan::UnknownError;
 	} else {
-		return ProMan::PushProfile(this->currentProfile);
+		return ProMan::PushProfile(*this->GetSnapshot());
 	}
 }
 
-/** Applies the passed wxFileConfig profile to the registry where 
-Freespace 2 can read it. */
-ProMan::RegistryCodes ProMan::PushProfile(wxFileConfig *cfg) {
-	wxCHECK_MSG(cfg != NULL, ProMan::UnknownError, _T("ProMan::PushProfile given null wxFileConfig!"));
+/** Applies the passed profile snapshot to the registry where 
+Freespace 2 can read it. Reads only the snapshot, never the current
+profile, so the current profile may change while the push is running. */
+ProMan::RegistryCodes ProMan::PushProfile(const ProfileSnapshot& profile) {
 #if IS_WIN32
 	// check if binary supports configfile
-	if (FlagListManager::GetFlagListManager()->GetBuildCaps() & FlagListManager::BUILD_CAPS_SDL) {
-		return FilePushProfile(cfg);
+	if (GetLaunchBuildCaps(profile) & FlagListManager::BUILD_CAPS_SDL) {
+		return FilePushProfile(profile);
 	} else {
-		return RegistryPushProfile(cfg);
+		return RegistryPushProfile(profile);
 	}	
 #elif IS_LINUX || IS_APPLE
-	return FilePushProfile(cfg);
+	return FilePushProfile(profile);
 #else
 #error "One of IS_WIN32, IS_LINUX, IS_APPLE must evaluate to true"
 #endif
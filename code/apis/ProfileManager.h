@@ -25,12 +25,47 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <wx/filename.h>
 
 #include "apis/EventHandlers.h"
+#include "datastructures/ProfileChangeJournal.h"
+#include "datastructures/ProfileSnapshot.h"
+#include "datastructures/ProfileTemplate.h"
+#include "global/ProfileSchema.h"
+
+class AtomicFileBatch;
+class ProfileDatabase;
 
 WX_DECLARE_STRING_HASH_MAP( wxFileConfig*, ProfileMap );
 
+/** What the profile index records about a profile's backing file. The name
+ can be trusted without opening the file as long as the file's modification
+ time and size still match. */
+struct ProfileIndexEntry {
+	ProfileIndexEntry() : modificationTime(0), size(0) { } // required for wxHashMap
+	ProfileIndexEntry(const wxString& name, const wxString& fileName,
+		unsigned long modificationTime, unsigned long size);
+	wxString name;
+	wxString fileName; //!< pro#####.ini, relative to the profile storage folder
+	unsigned long modificationTime;
+	unsigned long size;
+};
+
+/** Profile index entries, by profile name or by file name. */
+WX_DECLARE_STRING_HASH_MAP( ProfileIndexEntry, ProfileIndex );
+
+/** The current profile's value for one schema key, kept as wxFileConfig
+ stores it and, when it parses, as a number as well. */
+struct ProfileValueSlot {
+	ProfileValueSlot() : isPresent(false), hasNumber(false), number(0) { }
+	bool isPresent;
+	bool hasNumber;
+	wxString value;
+	long number;
+};
+
 /** event is generated anytime the number of profiles in the manager change. */
 LAUNCHER_DECLARE_EVENT_TYPE(EVT_PROFILE_CHANGE);
-/** Event is generated anytime the currently selected profile is changed. */
+/** Event is generated anytime the currently selected profile is changed.
+ The event's int value is a mask of ProMan::ProfileChanges saying which parts
+ of the new profile differ from the previous one. */
 LAUNCHER_DECLARE_EVENT_TYPE(EVT_CURRENT_PROFILE_CHANGED);
 
 /** Stores data about downloaded news. */
@@ -53,6 +88,20 @@ public:
 		NoUpdateLastProfile = 1 << 0,
 		ProManFlagsMax
 	};
+	/** What differs between two profiles, as sent with
+	 EVT_CURRENT_PROFILE_CHANGED. Handlers should only redo the work for the
+	 parts that changed. */
+	enum ProfileChanges {
+		PROFILE_CHANGED_NOTHING = 0,
+		PROFILE_CHANGED_TC_ROOT_FOLDER = 1 << 0,
+		PROFILE_CHANGED_BINARY = 1 << 1,
+		PROFILE_CHANGED_FRED_BINARY = 1 << 2,
+		PROFILE_CHANGED_MOD = 1 << 3, //!< current mod or mod line
+		PROFILE_CHANGED_FLAG_LINE = 1 << 4, //!< flag line or lighting preset
+		PROFILE_CHANGED_SETTINGS = 1 << 5, //!< video, speech, network, audio or joystick
+		PROFILE_CHANGED_LAUNCH = 1 << 6, //!< launch preset or CPUs
+		PROFILE_CHANGED_ALL = (1 << 7) - 1
+	};
 	static bool Initialize(Flags flags = None);
 	static bool DeInitialize();
 	static bool IsInitialized() { return isInitialized; }
@@ -86,6 +135,15 @@ public:
 	bool ProfileRead(const wxString& key, long* l) const;
 	bool ProfileRead(const wxString& key, long* l, long defaultVal, bool writeBackIfAbsent = false);
 	
+	bool ProfileExists(ProfileKeyId key) const;
+	
+	bool ProfileRead(ProfileKeyId key, bool* b) const;
+	bool ProfileRead(ProfileKeyId key, bool* b, bool defaultVal) const;
+	bool ProfileRead(ProfileKeyId key, wxString* str) const;
+	bool ProfileRead(ProfileKeyId key, wxString* str, const wxString& defaultVal) const;
+	bool ProfileRead(ProfileKeyId key, long* l) const;
+	bool ProfileRead(ProfileKeyId key, long* l, long defaultVal) const;
+	
 	bool ProfileWrite(const wxString& key, const wxString& value);
 	bool ProfileWrite(const wxString& key, const wxChar* value);
 	bool ProfileWrite(const wxString& key, long value);
@@ -116,9 +174,15 @@ public:
 	bool SwitchTo(wxString name);
 	void SaveCurrentProfile(bool quiet = false);
 	void RevertCurrentProfile();
-	bool HasUnsavedChanges();
+	bool HasUnsavedChanges() const { return this->journal.HasChanges(); }
 	inline bool NeedToPromptToSave() { return (!this->isAutoSaving) && this->HasUnsavedChanges(); }
 	void SetAutoSave(bool value) { this->isAutoSaving = value; }
+	ProfileSnapshotPtr GetSnapshot();
+	ProfileSnapshotPtr GetSnapshotOf(const wxString& name,
+		const ProfileEntryValues* overrides = NULL);
+	/** Same as the version of the next snapshot; changes whenever the
+	 current profile does. */
+	unsigned long GetProfileVersion() const { return this->profileVersion; }
 
 	void AddEventHandler(wxEvtHandler *handler);
 	void RemoveEventHandler(wxEvtHandler *handler);
@@ -134,7 +198,21 @@ public:
 		UnknownError,
 	};
 
+	bool IsUsingDatabase() const { return this->database != NULL; }
+	bool MoveToDatabase();
+	bool MoveToProfileFiles();
+
+	/** Editing profiles other than the current one, for provisioning.
+	 Between BeginDeferredSaves() and EndDeferredSaves(), created and
+	 edited profiles are only written when EndDeferredSaves() is called,
+	 all in one batch. */
+	bool WriteToProfile(const wxString& name, const wxString& key, const wxString& value);
+	bool DeleteEntryFromProfile(const wxString& name, const wxString& key);
+	void BeginDeferredSaves();
+	bool EndDeferredSaves();
+
 	RegistryCodes PushCurrentProfile(); //!< push current profile into registry
+	static RegistryCodes PushProfile(const ProfileSnapshot& profile); //!< push profile into registry
 
 	static const wxString& DEFAULT_PROFILE_NAME;
 private:
@@ -144,10 +222,30 @@ private:
 	wxFileConfig* currentProfile;
 	wxString currentProfileName;
 	
-	bool CreateNewProfile(wxString newName);
-	static wxString GenerateNewProfileFileName();
+	bool CreateNewProfile(wxString newName, const ProfileTemplate* base = NULL);
+	bool CreateProfileFromTemplate(const wxString& newProfileName, const ProfileTemplate* base);
+	wxString GenerateNewProfileFileName() const;
+	
+	void ScanProfiles();
+	void ReadDatabaseProfiles();
+	bool RemoveProfileStorage(const wxString& name);
+	bool SaveProfile(const wxString& name, wxFileConfig& config, AtomicFileBatch& batch);
+	bool SaveEditedProfile(const wxString& name);
+	bool SaveOverlay(const wxString& name, const ProfileOverlay& overlay, AtomicFileBatch& batch);
+	void DiscardOverlay(const wxString& name);
+	void SaveProfileToDatabase(const wxString& name, wxConfigBase& config);
+	bool SaveGlobalProfile(AtomicFileBatch& batch);
+	bool CommitChanges(AtomicFileBatch& batch);
+	static wxFileConfig* MakeConfig(const ProfileEntryValues* entries);
+	wxFileConfig* GetProfile(const wxString& name);
+	static void ReadProfileIndex(ProfileIndex& index);
+	bool SaveProfileIndex(AtomicFileBatch& batch) const;
+	bool UpdateProfileIndex(const wxString& name, const wxString& fileName);
+	
+	const ProfileTemplate* GetTemplate(const wxString& name);
+	void DiscardTemplate(const wxString& name);
+	static ProfileTemplate* MakeTemplate(const wxConfigBase& source);
 
-	static RegistryCodes PushProfile(wxFileConfig *cfg); //!< push profile into registry
 	static RegistryCodes PullProfile(wxFileConfig *cfg); //!< pull profile from registry
 
 	static void CopyConfig(const wxConfigBase& src, wxConfigBase &dest, const bool includeMainGroup = true, const wxString path = _T("/"));
@@ -160,23 +258,45 @@ private:
 	static bool AreEntriesEqual(const wxConfigBase& cfg1, const wxConfigBase& cfg2, const wxString path, const wxString entry);
 
 	static void LogConfigContents(wxConfigBase& cfg, const wxString path = _T("/"), const bool includeWxWindows = false);
+	static void ReadProfileEntries(wxConfigBase& cfg, ProfileEntryValues& entries, const wxString path = _T("/"));
+	static int DiffProfileEntries(const ProfileEntryValues& before, const ProfileEntryValues& after);
+	static int GetProfileChangeForKey(const wxString& key);
 	static void TestConfigFunctions(wxConfigBase& src);
 	
 	ProMan();
 	void SaveProfilesBeforeExiting();
+	void SaveCurrentProfile(AtomicFileBatch& batch, bool quiet = false);
+	
+	void RecordProfileChange(const wxString& key, const wxString& value);
+	void RecordProfileChange(const wxString& key, const wxChar* value);
+	void RecordProfileChange(const wxString& key, long value);
+	void RecordProfileChange(const wxString& key, bool value);
+	void InvalidateSnapshot();
+	
+	void LoadCurrentValues();
+	void StoreCurrentValue(const wxString& key, const wxString* value);
+	void StoreCurrentValue(ProfileKeyId key, const wxString* value);
+	const ProfileValueSlot* GetCurrentValue(ProfileKeyId key, const wxChar* type) const;
 	
 	NewsMap newsMap;
 	void LoadNewsMapFromGlobalProfile();
 	void SaveNewsMapToGlobalProfile();
 
-	ProfileMap profiles; //!< The profiles. Indexed by Name;
+	ProfileMap profiles; //!< The profiles that have been read from disk. Indexed by Name;
+	ProfileIndex profileFiles; //!< Every profile, loaded or not. Indexed by Name;
+	ProfileTemplateMap templates; //!< Templates of the profiles that have been cloned. Indexed by Name;
+	ProfileOverlayMap overlays; //!< Profiles cloned while saves are deferred and not needed as a whole since. Indexed by Name;
 	wxFileConfig* globalProfile;  //!< Global profile settings, like language, or proxy
-	wxString privateCopyFilename; //!< Name of file used for private copy
-	wxFileConfig* privateCopy; //!< Private copy, used in determining whether current profile has unsaved changes
-	void ResetPrivateCopy();
+	ProfileDatabase* database; //!< Where profiles are stored, or NULL if they are in pro?????.ini files
+	ProfileChangeJournal journal; //!< Changes to the current profile since it was last saved or switched to
+	ProfileValueSlot currentValues[PRO_KEY_COUNT]; //!< The current profile's schema keys. Indexed by ProfileKeyId;
+	ProfileSnapshotPtr snapshot; //!< Snapshot of the current profile, if one has been taken since it last changed
+	unsigned long profileVersion; //!< Version of the current profile's contents
 	bool isAutoSaving; //!< Are we auto saving the profiles?
+	bool isDeferringSaves; //!< Are saves being held until EndDeferredSaves()?
+	wxSortedArrayString deferredProfiles; //!< Profiles created or edited since BeginDeferredSaves()
 	void GenerateChangeEvent();
-	void GenerateCurrentProfileChangedEvent();
+	void GenerateCurrentProfileChangedEvent(int changes = PROFILE_CHANGED_ALL);
 
 	EventHandlers eventHandlers;
 };
@@ -16,13 +16,389 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <vector>
+
+#include <wx/dir.h>
+#include <wx/file.h>
+#include <wx/mstream.h>
+#include <wx/stdpaths.h>
+#include <wx/stopwatch.h>
+#include <wx/textfile.h>
+#include <wx/tokenzr.h>
+
 #include "generated/configure_launcher.h"
+#include "apis/LaunchBenchmark.h"
+#include "apis/ProcessSupervisorCheck.h"
 #include "apis/ProfileManager.h"
 #include "apis/ProfileManagerOperator.h"
+#include "apis/resolution_manager.hpp"
+#include "datastructures/ProfileChangeJournal.h"
+#include "datastructures/ProfileTemplate.h"
+#include "global/AtomicFileBatch.h"
+#include "global/Compatibility.h"
+#include "global/ProfileKeys.h"
 #include "wxLauncherApp.h"
 
 #include "global/MemoryDebugging.h"
 
+/** Reports one line of benchmark output to both stdout and the log. */
+void ProManOperator::ReportBenchmark(const wxString& line)
+{
+	wxPrintf(wxT_2("%s\n"), line.c_str());
+	wxLogInfo(wxT_2("%s"), line.c_str());
+}
+
+using ProManOperator::ReportBenchmark;
+
+/** Times writing count scratch copies of the current profile, first with
+ a batch (and so a directory sync) per file and then as one batch.
+ Everything is written to a scratch folder so that the user's profiles
+ are never touched. */
+static int RunSaveBenchmark(long count)
+{
+	wxFileConfig* source = dynamic_cast<wxFileConfig*>(wxFileConfig::Get(false));
+	wxCHECK_MSG(source != NULL, 1, wxT_2("RunSaveBenchmark: no current profile"));
+
+	wxMemoryOutputStream serialized;
+	source->Save(serialized);
+
+	wxFileName scratch;
+	scratch.AssignDir(wxStandardPaths::Get().GetTempDir());
+	scratch.AppendDir(wxString::Format(wxT_2("wxLbench%lu"), wxGetProcessId()));
+	if (!scratch.DirExists() && !scratch.Mkdir(0700, wxPATH_MKDIR_FULL)) {
+		wxLogError(_("Unable to create benchmark folder %s"), scratch.GetPath().c_str());
+		return 1;
+	}
+
+	std::vector<wxFileConfig*> configs;
+	std::vector<wxFileName> files;
+	for (long i = 0; i < count; i++) {
+		wxMemoryInputStream in(serialized);
+		configs.push_back(new wxFileConfig(in));
+		files.push_back(wxFileName(scratch.GetPath(),
+			wxString::Format(wxT_2("pro%05ld.ini"), i)));
+	}
+
+	bool ok = true;
+
+	wxStopWatch singleTimer;
+	for (long i = 0; i < count; i++) {
+		AtomicFileBatch batch;
+		ok = batch.Save(*configs[i], files[i]) && ok;
+		ok = batch.Commit() && ok;
+	}
+	const long singleMs = singleTimer.Time();
+
+	AtomicFileBatch batch;
+	wxStopWatch batchTimer;
+	for (long i = 0; i < count; i++) {
+		ok = batch.Save(*configs[i], files[i]) && ok;
+	}
+	ok = batch.Commit() && ok;
+	const long batchMs = batchTimer.Time();
+
+	ReportBenchmark(wxString::Format(
+		wxT_2("Saved %ld profiles of %lu bytes each"),
+		count, static_cast<unsigned long>(serialized.GetSize())));
+	ReportBenchmark(wxString::Format(
+		wxT_2("  one at a time: %ld ms, %.1f profiles/s"),
+		singleMs, (count * 1000.0) / wxMax(singleMs, 1L)));
+	ReportBenchmark(wxString::Format(
+		wxT_2("  single batch:  %ld ms, %.1f profiles/s, %lu directory sync(s)"),
+		batchMs, (count * 1000.0) / wxMax(batchMs, 1L),
+		static_cast<unsigned long>(batch.GetDirSyncCount())));
+
+	for (long i = 0; i < count; i++) {
+		delete configs[i];
+		::wxRemoveFile(files[i].GetFullPath());
+	}
+	::wxRmdir(scratch.GetPath());
+
+	return ok ? 0 : 1;
+}
+
+/** Number of entries added to the padded profile in the clone benchmark. */
+static const long CLONE_BENCHMARK_PADDING = 2000;
+
+/** Times count clones of settings and count reverts of a single change to
+ it, first the way they used to be done (parsing a full copy of the
+ profile each time) and then from a template and with a change journal.
+ Nothing is written to disk. */
+static bool RunCloneRound(const wxString& label, wxFileConfig& settings, long count)
+{
+	wxMemoryOutputStream serializedStream;
+	settings.Save(serializedStream);
+	wxMemoryBuffer serialized;
+	const size_t length = static_cast<size_t>(serializedStream.GetSize());
+	serializedStream.CopyTo(serialized.GetWriteBuf(length), length);
+	serialized.UngetWriteBuf(length);
+
+	bool ok = true;
+
+	// clone
+	wxStopWatch deepCloneTimer;
+	for (long i = 0; i < count; i++) {
+		wxMemoryInputStream in(serialized.GetData(), serialized.GetDataLen());
+		wxFileConfig clone(in);
+		clone.Write(PRO_CFG_MAIN_NAME, wxString::Format(wxT_2("clone %ld"), i));
+		wxMemoryOutputStream out;
+		ok = clone.Save(out) && ok;
+	}
+	const long deepCloneMs = deepCloneTimer.Time();
+
+	ProfileTemplate base(settings);
+	ok = base.IsOk() && ok;
+	wxStopWatch templateCloneTimer;
+	for (long i = 0; ok && i < count; i++) {
+		wxMemoryBuffer contents;
+		ok = base.Materialize(wxString::Format(wxT_2("clone %ld"), i),
+			wxString::Format(wxT_2("pro%05ld.ini"), i), contents) && ok;
+	}
+	const long templateCloneMs = templateCloneTimer.Time();
+
+	// revert a single change
+	const wxString key(PRO_CFG_VIDEO_BIT_DEPTH);
+	wxString originalValue;
+	const bool hadKey = settings.Read(key, &originalValue);
+
+	wxStopWatch deepRevertTimer;
+	for (long i = 0; i < count; i++) {
+		settings.Write(key, i);
+		wxMemoryInputStream in(serialized.GetData(), serialized.GetDataLen());
+		wxFileConfig original(in);
+	}
+	const long deepRevertMs = deepRevertTimer.Time();
+
+	if (hadKey) {
+		settings.Write(key, originalValue);
+	} else {
+		settings.DeleteEntry(key);
+	}
+
+	ProfileChangeJournal journal;
+	wxStopWatch journalRevertTimer;
+	for (long i = 0; i < count; i++) {
+		const wxString value(wxString::Format(wxT_2("%ld"), i));
+		journal.Record(settings, key, &value);
+		settings.Write(key, i);
+		journal.Revert(settings);
+	}
+	const long journalRevertMs = journalRevertTimer.Time();
+
+	ReportBenchmark(wxString::Format(
+		wxT_2("%s: %lu bytes, %ld operations"), label.c_str(),
+		static_cast<unsigned long>(serialized.GetDataLen()), count));
+	ReportBenchmark(wxString::Format(
+		wxT_2("  clone by deep copy:   %.2f us each"), (deepCloneMs * 1000.0) / count));
+	ReportBenchmark(wxString::Format(
+		wxT_2("  clone from template:  %.2f us each"), (templateCloneMs * 1000.0) / count));
+	ReportBenchmark(wxString::Format(
+		wxT_2("  revert by deep copy:  %.2f us each"), (deepRevertMs * 1000.0) / count));
+	ReportBenchmark(wxString::Format(
+		wxT_2("  revert with journal:  %.2f us each"), (journalRevertMs * 1000.0) / count));
+
+	return ok;
+}
+
+/** Runs the clone benchmark on a copy of the current profile, once as it is
+ and once padded with extra entries, to show which costs grow with the
+ size of the profile. */
+static int RunCloneBenchmark(long count)
+{
+	wxFileConfig* source = dynamic_cast<wxFileConfig*>(wxFileConfig::Get(false));
+	wxCHECK_MSG(source != NULL, 1, wxT_2("RunCloneBenchmark: no current profile"));
+
+	wxMemoryOutputStream serialized;
+	source->Save(serialized);
+	wxMemoryInputStream in(serialized);
+	wxFileConfig settings(in);
+	settings.DeleteGroup(wxT_2("/main"));
+
+	bool ok = RunCloneRound(wxT_2("Current profile"), settings, count);
+
+	for (long i = 0; i < CLONE_BENCHMARK_PADDING; i++) {
+		settings.Write(wxString::Format(wxT_2("/benchmark/padding%05ld"), i),
+			wxT_2("a value of typical length"));
+	}
+	ok = RunCloneRound(wxString::Format(wxT_2("Padded with %ld entries"),
+		CLONE_BENCHMARK_PADDING), settings, count) && ok;
+
+	return ok ? 0 : 1;
+}
+
+/** Sizes of the scratch pilot files, alternating, about those of a pilot
+ file and a campaign save. */
+static const size_t PILOT_BENCHMARK_SIZES[] = { 8 * 1024, 48 * 1024 };
+
+/** Removes folder and everything in it. */
+static void RemoveScratchFolder(const wxString& folder)
+{
+	wxArrayString files;
+	wxDir::GetAllFiles(folder, &files, wxEmptyString, wxDIR_FILES | wxDIR_DIRS | wxDIR_HIDDEN);
+	for (size_t i = 0; i < files.GetCount(); i++) {
+		::wxRemoveFile(files[i]);
+	}
+	wxArrayString dirs;
+	{
+		// closed before the folders are removed
+		wxDir dir(folder);
+		wxString name;
+		for (bool cont = dir.IsOpened() && dir.GetFirst(&name, wxEmptyString, wxDIR_DIRS | wxDIR_HIDDEN);
+			cont; cont = dir.GetNext(&name)) {
+			dirs.Add(folder + wxFileName::GetPathSeparator() + name);
+		}
+	}
+	for (size_t i = 0; i < dirs.GetCount(); i++) {
+		RemoveScratchFolder(dirs[i]);
+	}
+	::wxRmdir(folder);
+}
+
+/** Times copying a scratch pilot folder of count files the way pilots are
+ copied for SDL builds, once starting from each copy method, so the cost of
+ each fallback shows. Where a method isn't supported by the file system the
+ next one does the copies, which the counts at the end of each line show. */
+static int RunPilotCopyBenchmark(long count)
+{
+	wxFileName scratch;
+	scratch.AssignDir(wxStandardPaths::Get().GetTempDir());
+	scratch.AppendDir(wxString::Format(wxT_2("wxLpilots%lu"), wxGetProcessId()));
+	wxFileName from(scratch);
+	from.AppendDir(wxT_2("players"));
+	if (!from.DirExists() && !from.Mkdir(0700, wxPATH_MKDIR_FULL)) {
+		wxLogError(_("Unable to create benchmark folder %s"), from.GetPath().c_str());
+		return 1;
+	}
+
+	bool ok = true;
+	wxULongLong totalBytes = 0;
+	std::vector<char> contents(PILOT_BENCHMARK_SIZES[1]);
+	for (long i = 0; ok && i < count; i++) {
+		const size_t size = PILOT_BENCHMARK_SIZES[i % 2];
+		for (size_t j = 0; j < size; j++) {
+			contents[j] = static_cast<char>((i * 31 + j * 7) & 0xff);
+		}
+		wxFile pilot;
+		ok = pilot.Create(wxFileName(from.GetPath(), wxString::Format(
+			(i % 2 == 0) ? wxT_2("pilot%05ld.plr") : wxT_2("pilot%05ld.csg"), i)).GetFullPath())
+			&& pilot.Write(&contents[0], size) == size;
+		totalBytes += size;
+	}
+	if (!ok) {
+		wxLogError(_("Unable to create scratch pilot files in %s"), from.GetPath().c_str());
+		RemoveScratchFolder(scratch.GetPath());
+		return 1;
+	}
+
+	ReportBenchmark(wxString::Format(
+		wxT_2("Copying %ld pilot files, %s bytes in all"),
+		count, totalBytes.ToString().c_str()));
+
+	static const wxChar* const methodNames[AtomicFileBatch::COPY_METHODS] = {
+		wxT_2("reflink"), wxT_2("kernel"), wxT_2("buffered")
+	};
+	for (int method = 0; method < AtomicFileBatch::COPY_METHODS; method++) {
+		wxFileName to(scratch);
+		to.AppendDir(wxString::Format(wxT_2("copy%d"), method));
+		const wxFileName manifestName(to.GetPath(), wxT_2("manifest.txt"));
+		to.AppendDir(wxT_2("players"));
+
+		Compatibility::PilotCopyStats stats;
+		const bool copied = Compatibility::CopyPilotFolder(from, to, manifestName,
+			static_cast<AtomicFileBatch::CopyMethod>(method), stats);
+		ok = copied && ok;
+
+		ReportBenchmark(wxString::Format(
+			wxT_2("  %-8s first: %lu files, %s bytes, %ld ms, %.1f files/s, %d thread(s); "
+				"reflink %lu, kernel %lu, buffered %lu"),
+			methodNames[method], static_cast<unsigned long>(stats.files),
+			stats.bytes.ToString().c_str(), stats.ms,
+			(stats.files * 1000.0) / wxMax(stats.ms, 1L), stats.threads,
+			static_cast<unsigned long>(stats.copies[AtomicFileBatch::COPY_REFLINK]),
+			static_cast<unsigned long>(stats.copies[AtomicFileBatch::COPY_KERNEL]),
+			static_cast<unsigned long>(stats.copies[AtomicFileBatch::COPY_BUFFERED])));
+	}
+
+	RemoveScratchFolder(scratch.GetPath());
+
+	return ok ? 0 : 1;
+}
+
+/** Applies one line of a batch manifest. Returns false if it failed. */
+static bool RunBatchOperation(const wxArrayString& fields)
+{
+	ProMan* proman = ProMan::GetProfileManager();
+	const wxString& op = fields[0];
+	const size_t count = fields.GetCount();
+
+	if (op == wxT_2("create") && count == 2) {
+		return proman->CreateProfile(fields[1]);
+	} else if (op == wxT_2("clone") && count == 3) {
+		return proman->CreateProfile(fields[1], fields[2]);
+	} else if (op == wxT_2("import") && count == 3) {
+		return proman->CreateProfile(fields[1], wxFileName(fields[2]));
+	} else if (op == wxT_2("set") && count == 4) {
+		return proman->WriteToProfile(fields[1], fields[2], fields[3]);
+	} else if (op == wxT_2("unset") && count == 3) {
+		return proman->DeleteEntryFromProfile(fields[1], fields[2]);
+	} else if (op == wxT_2("delete") && count == 2) {
+		return proman->DeleteProfile(fields[1]);
+	}
+
+	wxLogError(_("Unknown operation '%s' or wrong number of fields"), op.c_str());
+	return false;
+}
+
+/** Applies every operation in a manifest file in one go, writing each
+ profile that was created or changed once at the end.
+
+ Each line of the manifest is one operation, with its fields separated
+ by tabs so that profile names and values may contain spaces:
+   create  NAME
+   clone   NAME  SOURCE
+   import  NAME  FILE
+   set     NAME  KEY  VALUE
+   unset   NAME  KEY
+   delete  NAME
+ Blank lines and lines starting with # are ignored. A failed operation is
+ reported and the rest still run. */
+static int RunBatch(const wxString& manifestPath)
+{
+	wxTextFile manifest;
+	if (!manifest.Open(manifestPath, wxConvUTF8)) {
+		wxLogError(_("Unable to read batch manifest %s"), manifestPath.c_str());
+		return 1;
+	}
+
+	ProMan* proman = ProMan::GetProfileManager();
+	unsigned long operations = 0, failures = 0;
+
+	wxStopWatch timer;
+	proman->BeginDeferredSaves();
+	for (size_t i = 0, n = manifest.GetLineCount(); i < n; i++) {
+		const wxString& line = manifest[i];
+		if (line.Strip(wxString::both).IsEmpty() || line.StartsWith(wxT_2("#"))) {
+			continue;
+		}
+
+		wxArrayString fields(wxStringTokenize(line, wxT_2("\t"), wxTOKEN_RET_EMPTY_ALL));
+		operations++;
+		if (!RunBatchOperation(fields)) {
+			wxLogError(_("Batch operation on line %lu failed"),
+				static_cast<unsigned long>(i + 1));
+			failures++;
+		}
+	}
+	const bool saved = proman->EndDeferredSaves();
+	const long ms = timer.Time();
+
+	ReportBenchmark(wxString::Format(
+		wxT_2("Applied %lu operation(s), %lu failed, in %ld ms, %.1f operations/s"),
+		operations, failures, ms, (operations * 1000.0) / wxMax(ms, 1L)));
+
+	return (saved && failures == 0) ? 0 : 1;
+}
+
 int ProManOperator::RunProfileOperator(ProManOperator::profileOperator op)
 {
 	wxLauncher &app = wxGetApp();
@@ -42,6 +418,42 @@ int ProManOperator::RunProfileOperator(ProManOperator::profileOperator op)
 			SwitchTo(app.mProfileOperand);
 		return 0;
 	}
+	else if (op == benchmarksave)
+	{
+		return RunSaveBenchmark(app.mCountOperand);
+	}
+	else if (op == benchmarkclone)
+	{
+		return RunCloneBenchmark(app.mCountOperand);
+	}
+	else if (op == importdatabase)
+	{
+		return ProMan::GetProfileManager()->MoveToDatabase() ? 0 : 1;
+	}
+	else if (op == exportdatabase)
+	{
+		return ProMan::GetProfileManager()->MoveToProfileFiles() ? 0 : 1;
+	}
+	else if (op == batchprofiles)
+	{
+		return RunBatch(app.mFileOperand);
+	}
+	else if (op == benchmarklaunch)
+	{
+		return RunLaunchBenchmark(app.mFileOperand, app.mCountOperand);
+	}
+	else if (op == benchmarkpilotcopy)
+	{
+		return RunPilotCopyBenchmark(app.mCountOperand);
+	}
+	else if (op == checkprocesssupervisor)
+	{
+		return RunProcessSupervisorCheck(app.mFileOperand);
+	}
+	else if (op == checkgraphicsmodes)
+	{
+		return ResolutionMan::RunGraphicsModesCheck();
+	}
 
 	return 1;
 }
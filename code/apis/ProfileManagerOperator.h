@@ -19,6 +19,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef PROFILEMANAGEROPERATOR_H
 #define PROFILEMANAGEROPERATOR_H
 
+#include <wx/string.h>
+
 /** ProManOperator: Mechanism to manipulate profiles through cmd line options.
  none indicates that this feature is not in use and that normal operation
  should occur instead. */
@@ -30,10 +32,20 @@ enum profileOperator {
 	none = 0,
 	add,
 	select,
+	benchmarksave,
+	benchmarkclone,
+	importdatabase,
+	exportdatabase,
+	batchprofiles,
+	benchmarklaunch,
+	checkprocesssupervisor,
+	benchmarkpilotcopy,
+	checkgraphicsmodes,
 	invalid
 };
 
 int RunProfileOperator(profileOperator op);
+void ReportBenchmark(const wxString& line);
 
 };
 
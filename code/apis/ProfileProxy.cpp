@@ -25,6 +25,7 @@
 #include "controls/LightingPresets.h"
 
 #include "global/ProfileKeys.h"
+#include "global/ProfileSchema.h"
 
 #include <wx/tokenzr.h>
 
@@ -131,17 +132,48 @@ bool ProfileProxy::IsInitialized() {
 ProfileProxy::ProfileProxy()
 : isFlagDataReady(false) {
 	FlagListManager::RegisterFlagFileProcessingStatusChanged(this);
+	if (ProMan::IsInitialized()) {
+		ProMan::GetProfileManager()->AddEventHandler(this);
+	}
 }
 
 ProfileProxy::~ProfileProxy() {
 	FlagListManager::UnRegisterFlagFileProcessingStatusChanged(this);
+	if (ProMan::IsInitialized()) {
+		ProMan::GetProfileManager()->RemoveEventHandler(this);
+	}
 }
 
 BEGIN_EVENT_TABLE(ProfileProxy, wxEvtHandler)
 EVT_COMMAND(wxID_NONE, EVT_FLAG_FILE_PROCESSING_STATUS_CHANGED,
 	ProfileProxy::OnFlagFileProcessingStatusChanged)
+EVT_COMMAND(wxID_NONE, EVT_CURRENT_PROFILE_CHANGED,
+	ProfileProxy::OnCurrentProfileChanged)
 END_EVENT_TABLE()
 
+void ProfileProxy::OnCurrentProfileChanged(wxCommandEvent &event) {
+	const int changes = event.GetInt();
+	
+	// a new root folder or binary resets the proxy through flag file
+	// processing, which reads the new flag line anyway
+	if (!(changes & ProMan::PROFILE_CHANGED_FLAG_LINE)
+		|| (changes & (ProMan::PROFILE_CHANGED_TC_ROOT_FOLDER | ProMan::PROFILE_CHANGED_BINARY))
+		|| !this->IsFlagDataReady()) {
+		return;
+	}
+	
+	wxLogDebug(_T("Reloading flag line for new profile using existing flag data."));
+	this->enabledFlags.clear();
+	this->customFlags.Empty();
+	this->isFlagDataReady = false;
+	
+	this->ProcessFlagLine();
+	
+	this->isFlagDataReady = true;
+	
+	GenerateProxyFlagDataReady();
+}
+
 
 void ProfileProxy::OnFlagFileProcessingStatusChanged(wxCommandEvent &event) {
 	wxASSERT(event.GetEventType() == EVT_FLAG_FILE_PROCESSING_STATUS_CHANGED);
@@ -241,13 +273,13 @@ void ProfileProxy::SetCustomFlags(const wxString& customFlags,
 }
 
 bool ProfileProxy::HasLightingPreset() const {
-	return ProMan::GetProfileManager()->ProfileExists(PRO_CFG_LIGHTING_PRESET);
+	return ProMan::GetProfileManager()->ProfileExists(PRO_KEY_LIGHTING_PRESET);
 }
 
 wxString ProfileProxy::GetLightingPresetName() const {
 	wxString presetName;
 	ProMan::GetProfileManager()->ProfileRead(
-		PRO_CFG_LIGHTING_PRESET, &presetName, wxEmptyString);
+		PRO_KEY_LIGHTING_PRESET, &presetName, wxEmptyString);
 	return presetName;
 }
 
@@ -282,7 +314,7 @@ void ProfileProxy::CopyPresetToCustomFlags() {
 bool ProfileProxy::IsProfileInitialized() const {
 	bool isProfileInitialized;
 	ProMan::GetProfileManager()->ProfileRead(
-		PRO_CFG_MAIN_INITIALIZED, &isProfileInitialized, false);
+		PRO_KEY_MAIN_INITIALIZED, &isProfileInitialized, false);
 	return isProfileInitialized;
 }
 
@@ -335,7 +367,7 @@ void ProfileProxy::ProcessFlagLine() {
 	wxString flagLine;
 	
 	ProMan::GetProfileManager()->ProfileRead(
-		PRO_CFG_TC_CURRENT_FLAG_LINE, &flagLine, wxEmptyString);
+		PRO_KEY_TC_CURRENT_FLAG_LINE, &flagLine, wxEmptyString);
 	
 	wxStringTokenizer tokenizer(flagLine, _T(" "));
 	
@@ -36,7 +36,7 @@
 LAUNCHER_DECLARE_EVENT_TYPE(EVT_PROXY_RESET);
 
 /** Indicates the proxy has successfully processed flag data from the flag file
- and profile. */
+ and profile, or has reread the flag line of a newly selected profile. */
 LAUNCHER_DECLARE_EVENT_TYPE(EVT_PROXY_FLAG_DATA_READY);
 
 WX_DECLARE_STRING_HASH_MAP(int, FlagStringToIndexMap);
@@ -58,6 +58,10 @@ public:
 
 	void OnFlagFileProcessingStatusChanged(wxCommandEvent &event);
 	
+	/** Rereads the flag line when a profile switch changed only the flag line,
+	 so that the flag file does not need to be processed again. */
+	void OnCurrentProfileChanged(wxCommandEvent &event);
+	
 	/** Indicates whether the proxy has processed flag data for the current
 	 profile's FSO binary and flag line. */
 	bool IsFlagDataReady() const { return this->isFlagDataReady; }
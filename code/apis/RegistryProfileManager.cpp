@@ -18,7 +18,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "apis/ProfileManager.h"
 #include "apis/PlatformProfileManager.h"
-#include "apis/JoystickManager.h"
 #include "global/BasicDefaults.h"
 #include "global/ProfileKeys.h"
 #include "global/RegistryKeys.h"
@@ -220,7 +219,7 @@ HKEY GetRegistryKeyname(wxString& out_keyname)
 /* File contains the Win32 incatations for Pushing and Pulling the passed
 profile to/from the registry. */
 
-ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
+ProMan::RegistryCodes RegistryPushProfile(const ProfileSnapshot& profile) {
 #if PLATFORM_USES_REGISTRY == 1
 	wxString keyName;
 	HKEY useKey = GetRegistryKeyname(keyName);
@@ -262,9 +261,9 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 	// Video
 	int width, height, bitdepth;
-	cfg->Read(PRO_CFG_VIDEO_RESOLUTION_WIDTH, &width, DEFAULT_VIDEO_RESOLUTION_WIDTH);
-	cfg->Read(PRO_CFG_VIDEO_RESOLUTION_HEIGHT, &height, DEFAULT_VIDEO_RESOLUTION_HEIGHT);
-	cfg->Read(PRO_CFG_VIDEO_BIT_DEPTH, &bitdepth, DEFAULT_VIDEO_BIT_DEPTH);
+	profile.Read(PRO_CFG_VIDEO_RESOLUTION_WIDTH, &width, DEFAULT_VIDEO_RESOLUTION_WIDTH);
+	profile.Read(PRO_CFG_VIDEO_RESOLUTION_HEIGHT, &height, DEFAULT_VIDEO_RESOLUTION_HEIGHT);
+	profile.Read(PRO_CFG_VIDEO_BIT_DEPTH, &bitdepth, DEFAULT_VIDEO_BIT_DEPTH);
 
 	wxString videocardValue = wxString::Format(_T("OGL -(%dx%d)x%d bit"), width, height, bitdepth);
 	ret = RegSetValueExW(
@@ -278,7 +277,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	wxString filterMethod;
-	cfg->Read(PRO_CFG_VIDEO_TEXTURE_FILTER, &filterMethod, DEFAULT_VIDEO_TEXTURE_FILTER);
+	profile.Read(PRO_CFG_VIDEO_TEXTURE_FILTER, &filterMethod, DEFAULT_VIDEO_TEXTURE_FILTER);
 	int filterMethodValue = ( filterMethod.StartsWith(_T("Bilinear"))) ? 0 : 1;
 
 	ret = RegSetValueExW(
@@ -292,7 +291,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int oglAnisotropicFilterInt;
-	cfg->Read(PRO_CFG_VIDEO_ANISOTROPIC,
+	profile.Read(PRO_CFG_VIDEO_ANISOTROPIC,
 		&oglAnisotropicFilterInt,
 		DEFAULT_VIDEO_ANISOTROPIC);
 
@@ -311,7 +310,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int oglAntiAliasSample;
-	cfg->Read(PRO_CFG_VIDEO_ANTI_ALIAS, &oglAntiAliasSample, DEFAULT_VIDEO_ANTI_ALIAS);
+	profile.Read(PRO_CFG_VIDEO_ANTI_ALIAS, &oglAntiAliasSample, DEFAULT_VIDEO_ANTI_ALIAS);
 		
 	ret = RegSetValueExW(
 		regHandle,
@@ -325,7 +324,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 	// Audio
 	wxString soundDevice;
-	cfg->Read(PRO_CFG_OPENAL_DEVICE, &soundDevice, DEFAULT_AUDIO_OPENAL_DEVICE);
+	profile.Read(PRO_CFG_OPENAL_DEVICE, &soundDevice, DEFAULT_AUDIO_OPENAL_DEVICE);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -353,7 +352,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	wxString playbackDevice;
-	cfg->Read(
+	profile.Read(
 		PRO_CFG_OPENAL_DEVICE,
 		&playbackDevice,
 		DEFAULT_AUDIO_OPENAL_PLAYBACK_DEVICE);
@@ -369,7 +368,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	wxString captureDevice;
-	bool hasEntry = cfg->Read(
+	bool hasEntry = profile.Read(
 		PRO_CFG_OPENAL_CAPTURE_DEVICE,
 		&captureDevice,
 		DEFAULT_AUDIO_OPENAL_CAPTURE_DEVICE);
@@ -387,7 +386,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int enableEFX;
-	hasEntry = cfg->Read(PRO_CFG_OPENAL_EFX, &enableEFX, DEFAULT_AUDIO_OPENAL_EFX);
+	hasEntry = profile.Read(PRO_CFG_OPENAL_EFX, &enableEFX, DEFAULT_AUDIO_OPENAL_EFX);
 
 	if (hasEntry) {
 		ret = RegSetValueExW(
@@ -402,7 +401,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int sampleRate;
-	cfg->Read(
+	profile.Read(
 		PRO_CFG_OPENAL_SAMPLE_RATE,
 		&sampleRate,
 		DEFAULT_AUDIO_OPENAL_SAMPLE_RATE);
@@ -424,7 +423,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 	// Speech
 	int speechVoice;
-	cfg->Read(PRO_CFG_SPEECH_VOICE, &speechVoice, DEFAULT_SPEECH_VOICE);
+	profile.Read(PRO_CFG_SPEECH_VOICE, &speechVoice, DEFAULT_SPEECH_VOICE);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -437,7 +436,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int speechVolume;
-	cfg->Read(PRO_CFG_SPEECH_VOLUME, &speechVolume, DEFAULT_SPEECH_VOLUME);
+	profile.Read(PRO_CFG_SPEECH_VOLUME, &speechVolume, DEFAULT_SPEECH_VOLUME);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -450,10 +449,10 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int inTechroom, inBriefings, inGame, inMulti;
-	cfg->Read(PRO_CFG_SPEECH_IN_TECHROOM, &inTechroom, DEFAULT_SPEECH_IN_TECHROOM);
-	cfg->Read(PRO_CFG_SPEECH_IN_BRIEFINGS, &inBriefings, DEFAULT_SPEECH_IN_BRIEFINGS);
-	cfg->Read(PRO_CFG_SPEECH_IN_GAME, &inGame, DEFAULT_SPEECH_IN_GAME);
-	cfg->Read(PRO_CFG_SPEECH_IN_MULTI, &inMulti, DEFAULT_SPEECH_IN_MULTI);
+	profile.Read(PRO_CFG_SPEECH_IN_TECHROOM, &inTechroom, DEFAULT_SPEECH_IN_TECHROOM);
+	profile.Read(PRO_CFG_SPEECH_IN_BRIEFINGS, &inBriefings, DEFAULT_SPEECH_IN_BRIEFINGS);
+	profile.Read(PRO_CFG_SPEECH_IN_GAME, &inGame, DEFAULT_SPEECH_IN_GAME);
+	profile.Read(PRO_CFG_SPEECH_IN_MULTI, &inMulti, DEFAULT_SPEECH_IN_MULTI);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -494,7 +493,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 	// Joystick
 	int currentJoystick;
-	cfg->Read(PRO_CFG_JOYSTICK_ID, &currentJoystick, DEFAULT_JOYSTICK_ID);
+	profile.Read(PRO_CFG_JOYSTICK_ID, &currentJoystick, DEFAULT_JOYSTICK_ID);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -506,7 +505,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 	ReturnChecker(ret, __LINE__);
 
 	// Joystick GUID
-	wxString currentJoystickGUID = JoyMan::JoystickGUID(currentJoystick);
+	wxString currentJoystickGUID = GetLaunchJoystickGUID(profile);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -519,7 +518,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 	
 	int joystickForceFeedback;
-	cfg->Read(
+	profile.Read(
 		PRO_CFG_JOYSTICK_FORCE_FEEDBACK,
 		&joystickForceFeedback,
 		DEFAULT_JOYSTICK_FORCE_FEEDBACK);
@@ -535,7 +534,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int joystickHit;
-	cfg->Read(PRO_CFG_JOYSTICK_DIRECTIONAL, &joystickHit, DEFAULT_JOYSTICK_DIRECTIONAL);
+	profile.Read(PRO_CFG_JOYSTICK_DIRECTIONAL, &joystickHit, DEFAULT_JOYSTICK_DIRECTIONAL);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -549,7 +548,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 	// Network
 	wxString networkConnectionValue;
-	cfg->Read(PRO_CFG_NETWORK_TYPE, &networkConnectionValue, DEFAULT_NETWORK_TYPE);
+	profile.Read(PRO_CFG_NETWORK_TYPE, &networkConnectionValue, DEFAULT_NETWORK_TYPE);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -562,7 +561,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	wxString connectionSpeedValue;
-	cfg->Read(PRO_CFG_NETWORK_SPEED, &connectionSpeedValue, DEFAULT_NETWORK_SPEED);
+	profile.Read(PRO_CFG_NETWORK_SPEED, &connectionSpeedValue, DEFAULT_NETWORK_SPEED);
 
 	ret = RegSetValueExW(
 		regHandle,
@@ -575,7 +574,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	int forcedport;
-	cfg->Read(PRO_CFG_NETWORK_PORT, &forcedport, DEFAULT_NETWORK_PORT);
+	profile.Read(PRO_CFG_NETWORK_PORT, &forcedport, DEFAULT_NETWORK_PORT);
 
 	if (forcedport != DEFAULT_NETWORK_PORT) {
 		ret = RegSetValueExW(
@@ -600,7 +599,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 
 	wxString networkIP;
-	cfg->Read(PRO_CFG_NETWORK_IP, &networkIP, DEFAULT_NETWORK_IP);
+	profile.Read(PRO_CFG_NETWORK_IP, &networkIP, DEFAULT_NETWORK_IP);
 
 	// Network folder (for custom IP address)
 	HKEY networkRegHandle = 0;
@@ -642,7 +641,7 @@ ProMan::RegistryCodes RegistryPushProfile(wxFileConfig *cfg) {
 
 	RegCloseKey(regHandle);
 
-	return PushCmdlineFSO(cfg);
+	return PushCmdlineFSO(profile);
 #else // PLATFORM_USES_REGISTRY
 	return ProMan::SupportNotCompiledIn;
 #endif // PLATFORM_USES_REGISTRY
@@ -18,6 +18,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "apis/TCManager.h"
 #include "apis/ProfileManager.h"
+#include "global/ProfileKeys.h"
 
 #include "global/MemoryDebugging.h"
 
@@ -181,11 +182,28 @@ void TCManager::GenerateTCFredBinaryChanged() {
 	}
 }
 
-void TCManager::CurrentProfileChanged(wxCommandEvent &WXUNUSED(event)) {
+void TCManager::CurrentProfileChanged(wxCommandEvent &event) {
+	const int changes = event.GetInt();
 
-	TCManager::GenerateTCChanged();
+	if (changes & ProMan::PROFILE_CHANGED_TC_ROOT_FOLDER) {
+		TCManager::GenerateTCChanged();
 //	it's assumed that BasicSettingsPage::OnTCChanged() (which is called on an EVT_TC_CHANGED event)
 //	calls TCManager::GenerateTCBinaryChanged() unconditionally, so no need to explicitly call it here
 //	it's also assumed that BasicSettingsPage::OnTCChanged() calls TCManager::GenerateTCFredBinaryChanged()
 //	unconditionally if FRED launching is enabled
+		return;
+	}
+
+	// same game root folder, so the mod list and executable lists stay as they are
+	// and only a different binary needs its flags reprobed
+	if (changes & ProMan::PROFILE_CHANGED_BINARY) {
+		TCManager::GenerateTCBinaryChanged();
+	}
+	if (changes & ProMan::PROFILE_CHANGED_FRED_BINARY) {
+		bool fredEnabled;
+		ProMan::GetProfileManager()->GlobalRead(GBL_CFG_OPT_CONFIG_FRED, &fredEnabled, false);
+		if (fredEnabled) {
+			TCManager::GenerateTCFredBinaryChanged();
+		}
+	}
 }
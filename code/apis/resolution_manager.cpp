@@ -18,7 +18,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "generated/configure_launcher.h"
 
+#include <wx/stopwatch.h>
+
 #include "apis/resolution_manager.hpp"
+#include "apis/ProfileManagerOperator.h"
 #include "global/ProfileKeys.h"
 
 #if HAS_SDL
@@ -28,6 +31,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 /** \namespace ResolutionMan
 The ResolutionMan namespace contains the code that gets the
 available resolutions for the BasicSettingsTab.
+
+The display modes for each API are only enumerated when they are first
+asked for, or after the displays have changed, and are kept sorted and
+grouped by aspect ratio. Every mod's minimum resolution is then applied
+to the kept modes, so switching mods doesn't ask the display for them
+again.
 */
 
 using namespace ResolutionMan;
@@ -96,17 +105,10 @@ int ComputeGCD(int a, int b) {
 	wxASSERT_MSG(a > 0, wxString::Format(_T("ComputeGCD(a=%d, b=%d): a must be positive"), a, b));
 	wxASSERT_MSG(b > 0, wxString::Format(_T("ComputeGCD(a=%d, b=%d): b must be positive"), a, b));
 
-	//	part of the original algorithm, but irrelevant, since a and b are positive
-	//	if (a == 0) {
-	//		return b;
-	//	}
 	while (b != 0) {
-		if (a > b) {
-			a = a - b;
-		}
-		else {
-			b = b - a;
-		}
+		const int remainder = a % b;
+		a = b;
+		b = remainder;
 	}
 	return a;
 }
@@ -214,6 +216,24 @@ void EnumerateGraphicsModes_win32(
 #endif
 
 #if HAS_SDL
+/** Starts the SDL video subsystem the first time it is needed and keeps it
+ running until wxLauncher::OnExit(), so that SDL doesn't have to find the
+ displays each time they are asked about. */
+static bool StartSDLVideo() {
+#if IS_APPLE || IS_WIN32
+	// Linux starts it in main(), as it can't be started this late
+	static bool sdlVideoStarted = false;
+	if (!sdlVideoStarted) {
+		if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
+			wxLogFatalError(wxT_2("SDL video subsystem failed to initialize!"));
+			return false;
+		}
+		sdlVideoStarted = true;
+	}
+#endif
+	return true;
+}
+
 void EnumerateGraphicsModes_sdl(
 	ResolutionArray &out_modes,
 	const int minHorizontalRes,
@@ -223,13 +243,9 @@ void EnumerateGraphicsModes_sdl(
 	// FSO currently only supports the primary display
 	const int DISPLAY_INDEX = 0;
 
-#if IS_APPLE || IS_WIN32
-	// It seems that linux cannot handle having the video subsystem inited
-	// too late
-	if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
-		wxLogFatalError(wxT_2("SDL video subsystem failed to initialize!"));
+	if (!StartSDLVideo()) {
+		return;
 	}
-#endif
 
 	if (SDL_GetNumVideoDisplays() > 0) {
 		int numDisplayModes = SDL_GetNumDisplayModes(DISPLAY_INDEX);
@@ -251,39 +267,278 @@ void EnumerateGraphicsModes_sdl(
 	else {
 		wxLogWarning(_T("SDL reported no displays!"));
 	}
-
-#if IS_APPLE || IS_WIN32
-	SDL_QuitSubSystem(SDL_INIT_VIDEO);
-#endif
-#endif
 }
+#endif
 
 #if !HAS_SDL && !defined(WIN32)
 #error No implementation of EnumerateGraphicsModes available
 #endif
 
-/** Get available graphics modes for API and return them sorted */
+/** The sorted modes, with their aspect ratio headers, for each API.
+ Once made a list is never changed, only replaced. */
+static ResolutionArray* graphicsModes[API_COUNT] = { NULL };
+/** The list came from UseGraphicsModes() rather than the display, so
+ there is nothing to compare the displays against. */
+static bool isUsingKnownModes[API_COUNT] = { false };
+/** The displays have changed since the lists were made. */
+static bool areDisplaysChanged = false;
+
+static void DeleteGraphicsModes(ApiType type) {
+	isUsingKnownModes[type] = false;
+	if (graphicsModes[type] != NULL) {
+		WX_CLEAR_ARRAY(*graphicsModes[type]);
+		delete graphicsModes[type];
+		graphicsModes[type] = NULL;
+	}
+}
+
+/** Arranges the resolutions for the drop down box. */
+static void ArrangeGraphicsModes(ResolutionArray& modes) {
+	modes.Sort(CompareResolutions);
+	AddHeaders(modes);
+}
+
+static const ResolutionArray& GetGraphicsModes(ApiType type) {
+	if (areDisplaysChanged) {
+		ResolutionMan::InvalidateGraphicsModes();
+	}
+	if (graphicsModes[type] == NULL) {
+		ResolutionArray* modes = new ResolutionArray();
+#if IS_WIN32
+		if (type == API_WIN32) {
+			EnumerateGraphicsModes_win32(*modes, 0, 0);
+		}
+#endif
+#if HAS_SDL
+		if (type == API_SDL) {
+			EnumerateGraphicsModes_sdl(*modes, 0, 0);
+		}
+#endif
+		ArrangeGraphicsModes(*modes);
+		graphicsModes[type] = modes;
+	}
+	return *graphicsModes[type];
+}
+
+/** Get available graphics modes for API and return them sorted, with an
+ aspect ratio header before each group. Modes smaller than the minimums
+ are left out, as are the headers of groups left empty. The caller owns
+ the returned resolutions. */
 void ResolutionMan::EnumerateGraphicsModes(
 	ApiType type, ResolutionArray& out_modes,
 	const long minHorizontalRes, const long minVerticalRes)
 {
+	wxCHECK_RET(type >= 0 && type < API_COUNT,
+		wxString::Format(_T("EnumerateGraphicsModes: invalid API type %d"), type));
+	const ResolutionArray& modes = GetGraphicsModes(type);
+
+	const Resolution* header = NULL;
+	for (size_t i = 0, n = modes.GetCount(); i < n; ++i) {
+		const Resolution* mode = modes.Item(i);
+		if (mode->IsHeader()) {
+			header = mode;
+		} else if ((mode->GetWidth() >= minHorizontalRes)
+			&& (mode->GetHeight() >= minVerticalRes)) {
+			if (header != NULL) {
+				out_modes.Add(new Resolution(*header));
+				header = NULL;
+			}
+			out_modes.Add(new Resolution(*mode));
+		}
+	}
+}
+
+/** Makes the next EnumerateGraphicsModes() ask the displays for their
+ modes again. */
+void ResolutionMan::InvalidateGraphicsModes() {
+	for (int type = 0; type < API_COUNT; ++type) {
+		DeleteGraphicsModes(static_cast<ApiType>(type));
+	}
+	areDisplaysChanged = false;
+}
+
+/** Notes that the displays have changed, so that the modes are asked for
+ again the next time they are wanted. */
+void ResolutionMan::FlagDisplaysChanged() {
+	areDisplaysChanged = true;
+}
+
+/** Returns true if the displays have changed since the modes were last
+ asked for. */
+bool ResolutionMan::HaveDisplaysChanged() {
+	return areDisplaysChanged;
+}
+
+/** Describes the displays API would enumerate modes for, cheaply enough
+ to be compared against what was described when the modes were found. The
+ modes themselves aren't included, so a change that keeps the number of
+ modes and the desktop size the same isn't noticed. */
+wxString ResolutionMan::GetDisplaySignature(ApiType type) {
+	wxCHECK_MSG(type >= 0 && type < API_COUNT, wxEmptyString,
+		wxString::Format(_T("GetDisplaySignature: invalid API type %d"), type));
 #if IS_WIN32
-	if (type == ResolutionMan::API_WIN32) {
-		EnumerateGraphicsModes_win32(out_modes,
-			static_cast<DWORD>(minHorizontalRes),
-			static_cast<DWORD>(minVerticalRes));
+	if (type == API_WIN32) {
+		DEVMODE desktop;
+		memset(&desktop, 0, sizeof(DEVMODE));
+		desktop.dmSize = sizeof(DEVMODE);
+		if (!EnumDisplaySettings(NULL, ENUM_CURRENT_SETTINGS, &desktop)) {
+			return wxEmptyString;
+		}
+		return wxString::Format(_T("win32:%d:%lux%lu@%lu"),
+			GetSystemMetrics(SM_CMONITORS),
+			static_cast<unsigned long>(desktop.dmPelsWidth),
+			static_cast<unsigned long>(desktop.dmPelsHeight),
+			static_cast<unsigned long>(desktop.dmDisplayFrequency));
 	}
 #endif
 #if HAS_SDL
-	if (type == ResolutionMan::API_SDL) {
-		EnumerateGraphicsModes_sdl(out_modes,
-			static_cast<int>(minHorizontalRes),
-			static_cast<int>(minVerticalRes));
+	if (type == API_SDL) {
+		// FSO currently only supports the primary display
+		const int DISPLAY_INDEX = 0;
+		if (!StartSDLVideo()) {
+			return wxEmptyString;
+		}
+		const int numDisplays = SDL_GetNumVideoDisplays();
+		SDL_DisplayMode desktop;
+		if (numDisplays <= 0 || SDL_GetDesktopDisplayMode(DISPLAY_INDEX, &desktop) != 0) {
+			return wxEmptyString;
+		}
+		return wxString::Format(_T("sdl:%d:%d:%dx%d@%d"), numDisplays,
+			SDL_GetNumDisplayModes(DISPLAY_INDEX), desktop.w, desktop.h,
+			desktop.refresh_rate);
 	}
 #endif
+	return wxEmptyString;
+}
+
+/** Takes SDL's display events, flagging the displays as changed if there
+ were any. Older SDLs don't send display events, so there only the hardware
+ probe notices changes. Must be called from the main thread, as SDL has to
+ pump its events there.
+\return true if the displays are flagged as changed. */
+bool ResolutionMan::PollDisplayChanges() {
+#if HAS_SDL && SDL_VERSION_ATLEAST(2, 0, 9)
+	SDL_PumpEvents();
+	SDL_Event events[8];
+	while (SDL_PeepEvents(events, WXSIZEOF(events), SDL_GETEVENT,
+		SDL_DISPLAYEVENT, SDL_DISPLAYEVENT) > 0) {
+		if (!areDisplaysChanged) {
+			wxLogDebug(_T("SDL reports the displays have changed"));
+		}
+		areDisplaysChanged = true;
+	}
+#endif
+	return areDisplaysChanged;
+}
+
+/** Uses modes, such as those found when the launcher last ran, until the
+ modes are invalidated, instead of asking the displays for them. */
+void ResolutionMan::UseGraphicsModes(ApiType type, const HardwareDisplayModes& modes) {
+	wxCHECK_RET(type >= 0 && type < API_COUNT,
+		wxString::Format(_T("UseGraphicsModes: invalid API type %d"), type));
+	if (modes.empty()) {
+		return;
+	}
+	DeleteGraphicsModes(type);
+	ResolutionArray* arranged = new ResolutionArray();
+	for (HardwareDisplayModes::const_iterator it = modes.begin(), end = modes.end();
+		 it != end; ++it) {
+		arranged->Add(new Resolution(it->width, it->height, false));
+	}
+	ArrangeGraphicsModes(*arranged);
+	graphicsModes[type] = arranged;
+	isUsingKnownModes[type] = true;
+}
+
+void ResolutionMan::DeInitialize() {
+	InvalidateGraphicsModes();
+}
 
-	// then arrange the resolutions for drop down box and insert them
-	out_modes.Sort(CompareResolutions);
+/** Enumerates the modes for type twice, the second time from the kept
+ list, and reports them as the drop down box would show them. Returns false
+ if there were none or the second list isn't the same as the first. */
+static bool ReportGraphicsModes(ApiType type, const wxString& label) {
+	ResolutionArray first;
+	wxStopWatch firstTimer;
+	ResolutionMan::EnumerateGraphicsModes(type, first, 0, 0);
+	const long firstMs = firstTimer.Time();
+
+	ResolutionArray second;
+	wxStopWatch secondTimer;
+	ResolutionMan::EnumerateGraphicsModes(type, second, 0, 0);
+	const long secondMs = secondTimer.Time();
+
+	bool isSame = (first.GetCount() == second.GetCount());
+	for (size_t i = 0, n = first.GetCount(); isSame && i < n; ++i) {
+		isSame = first.Item(i)->IsSameResolution(*second.Item(i))
+			&& (first.Item(i)->IsHeader() == second.Item(i)->IsHeader());
+	}
+
+	ProManOperator::ReportBenchmark(wxString::Format(
+		_T("%s: %lu entries, enumerated in %ld ms, again in %ld ms%s"),
+		label.c_str(), static_cast<unsigned long>(first.GetCount()), firstMs, secondMs,
+		isSame ? _T("") : _T(", but the second list differs")));
+	for (size_t i = 0, n = first.GetCount(); i < n; ++i) {
+		ProManOperator::ReportBenchmark(_T("  ") + first.Item(i)->GetResString());
+	}
+
+	const bool ok = isSame && !first.IsEmpty();
+	WX_CLEAR_ARRAY(first);
+	WX_CLEAR_ARRAY(second);
+	return ok;
+}
 
-	AddHeaders(out_modes);
-}
\ No newline at end of file
+/** Runs the mode enumeration and the grouping by aspect ratio without
+ asking the real displays: first on a known list of modes, then with each of SDL's
+ display-less video drivers, and reports what the drop down box would
+ show. SDL's video is left stopped, as the launcher exits after an
+ operator. Returns 0 if every list was found and grouped. */
+int ResolutionMan::RunGraphicsModesCheck() {
+#if HAS_SDL
+	// started first, so that enumerating doesn't restart it with the
+	// default driver
+	if (!StartSDLVideo()) {
+		return 1;
+	}
+
+	// what displays commonly report, including some whose aspect ratio
+	// only shows once the GCD is taken, and 8:5
+	static const int KNOWN_MODES[][2] = {
+		{ 3440, 1440 }, { 2560, 1080 }, { 1920, 1200 }, { 1920, 1080 },
+		{ 1680, 1050 }, { 1366, 768 }, { 1280, 1024 }, { 1280, 800 },
+		{ 1280, 720 }, { 1024, 768 }, { 800, 600 }
+	};
+	HardwareDisplayModes knownModes;
+	for (size_t i = 0; i < WXSIZEOF(KNOWN_MODES); ++i) {
+		knownModes.push_back(HardwareDisplayMode(KNOWN_MODES[i][0], KNOWN_MODES[i][1]));
+	}
+	ResolutionMan::UseGraphicsModes(API_SDL, knownModes);
+	bool ok = ReportGraphicsModes(API_SDL, _T("Known modes"));
+
+	static const char* const DRIVERS[] = { "dummy", "offscreen" };
+	size_t driversChecked = 0;
+	for (size_t i = 0; i < WXSIZEOF(DRIVERS); ++i) {
+		const wxString label(wxString::FromUTF8(DRIVERS[i]));
+		SDL_VideoQuit();
+		// older SDLs only offer the dummy driver when SDL_VIDEODRIVER asks
+		// for it, and the hint has no macro before SDL 2.0.22
+		SDL_SetHintWithPriority("SDL_VIDEODRIVER", DRIVERS[i], SDL_HINT_OVERRIDE);
+		if (SDL_VideoInit(DRIVERS[i]) != 0) {
+			ProManOperator::ReportBenchmark(wxString::Format(
+				_T("%s: not available, %s"), label.c_str(),
+				wxString::FromUTF8(SDL_GetError()).c_str()));
+			continue;
+		}
+		driversChecked++;
+		ResolutionMan::FlagDisplaysChanged();
+		ok = ReportGraphicsModes(API_SDL, label) && ok;
+	}
+	SDL_VideoQuit();
+	ResolutionMan::InvalidateGraphicsModes();
+
+	return (ok && driversChecked > 0) ? 0 : 1;
+#else
+	wxLogError(_("Graphics modes can only be checked with SDL"));
+	return 1;
+#endif
+}
@@ -22,10 +22,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <wx/wx.h>
 #include <wx/dynarray.h>
 
+#include "datastructures/HardwareSnapshot.h"
+
 namespace ResolutionMan {
 	enum ApiType {
 		API_WIN32,
-		API_SDL
+		API_SDL,
+		API_COUNT
 	};
 
 	class Resolution : public wxClientData {
@@ -53,6 +56,14 @@ namespace ResolutionMan {
 
 	void EnumerateGraphicsModes(ApiType type, ResolutionArray& out_modes,
 		const long minHorizontalRes, const long minVerticalRes);
+	void InvalidateGraphicsModes();
+	void FlagDisplaysChanged();
+	bool HaveDisplaysChanged();
+	bool PollDisplayChanges();
+	wxString GetDisplaySignature(ApiType type);
+	void UseGraphicsModes(ApiType type, const HardwareDisplayModes& modes);
+	void DeInitialize();
+	int RunGraphicsModesCheck();
 };
 
 #endif
@@ -22,8 +22,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "apis/SkinManager.h"
 #include "global/ids.h"
 
+#include <wx/tokenzr.h>
+
 #include "global/MemoryDebugging.h"
 
+/** Builds the text that a flag is matched against when searching, once per
+ flag, so that a search only has to do substring tests. */
+static wxString MakeSearchText(const wxString& flagString,
+	const wxString& shortDescription) {
+	return (flagString + _T("\n") + shortDescription).Lower();
+}
+
 FlagListCheckBox::FlagListCheckBox(
 	wxWindow* parent,
 	const wxString& label,
@@ -54,7 +63,8 @@ FlagListCheckBoxItem::FlagListCheckBoxItem(
 	const bool isRecommendedFlag)
 : fsoCategory(wxEmptyString), checkBox(&checkBox), checkBoxSizer(&checkBoxSizer),
   shortDescription(shortDescription), flagString(flagString),
-  isRecommendedFlag(isRecommendedFlag) {
+  isRecommendedFlag(isRecommendedFlag),
+  searchText(MakeSearchText(flagString, shortDescription)) {
 	  // shortDescription can be empty
 	  wxASSERT(!flagString.IsEmpty());
 }
@@ -63,6 +73,14 @@ FlagListCheckBoxItem::~FlagListCheckBoxItem() {
 	delete this->checkBoxSizer;
 }
 
+void FlagListCheckBoxItem::Update(
+	const wxString& shortDescription, const bool isRecommendedFlag) {
+	wxASSERT(this->checkBox != NULL);
+	this->shortDescription = shortDescription;
+	this->isRecommendedFlag = isRecommendedFlag;
+	this->searchText = MakeSearchText(this->flagString, shortDescription);
+}
+
 #include <wx/listimpl.cpp> // Magic Incantation
 WX_DEFINE_LIST(FlagListCheckBoxItems);
 
@@ -87,7 +105,7 @@ void FlagListBox::UnRegisterFlagListBoxReady(wxEvtHandler *handler) {
 void FlagListBox::GenerateFlagListBoxReady() {
 	wxASSERT(this->IsReady());
 	wxASSERT_MSG(!this->isReadyEventGenerated,
-		_T("GenerateFlagListBoxReady() was called a second time."));
+		_T("GenerateFlagListBoxReady() was called a second time for the same flag data."));
 	
 	wxCommandEvent event(EVT_FLAG_LIST_BOX_READY, wxID_NONE);
 	
@@ -132,63 +150,298 @@ FlagListBox::FlagListBox(wxWindow* parent)
 
 void FlagListBox::AcceptFlagData(FlagFileData* flagData) {
 	wxCHECK_RET(flagData != NULL, _T("AcceptFlagData(): flagData is null."));
-	wxCHECK_RET(this->flagData == NULL,
-		_T("AcceptFlagData(): flag list box given flag data twice."));
+	wxCHECK_RET(this->flagData != flagData,
+		_T("AcceptFlagData(): flag list box given the same flag data twice."));
+	wxCHECK_RET(!this->IsReady(),
+		_T("AcceptFlagData(): called without BeginRefresh() on a ready flag list box."));
 
-	this->isReady = true;
-	
-	this->flagData = flagData;
-	FlagListBoxData* data = this->flagData->GenerateFlagListBoxData();
+	FlagListBoxData* data = flagData->GenerateFlagListBoxData();
 	wxCHECK_RET(data != NULL,
 		_T("AcceptFlagData(): FlagFileData::GenerateFlagListBoxData() returned null."));
-	this->GenerateCheckBoxes(*data);
-	this->SetItemCount(flagData->GetItemCount());
+
+	FlagFileData* oldFlagData = this->flagData;
+	this->flagData = flagData;
+	this->isReady = true;
+	
+	if (this->areCheckBoxesGenerated) {
+		this->UpdateCheckBoxes(*data);
+	} else {
+		this->GenerateCheckBoxes(*data);
+		this->RebuildRowIndex();
+		this->ApplyFilter();
+	}
+	delete oldFlagData;
+	
+	data->DeleteContents(true);
+	delete data;
 
 	this->GenerateFlagListBoxReady();
 }
 
+void FlagListBox::BeginRefresh() {
+	if (!this->IsReady()) {
+		return; // never got flag data, or already waiting for new data
+	}
+	
+	// the rows stay on screen until the new binary's flags arrive,
+	// at which point UpdateCheckBoxes() reconciles them
+	this->isReady = false;
+	this->isReadyEventGenerated = false;
+	this->flagsLoaded = false;
+}
+
+FlagListCheckBoxItem* FlagListBox::CreateCheckBoxItem(const FlagListBoxDataItem& item) {
+	if (!item.fsoCategory.IsEmpty()) {
+		return new FlagListCheckBoxItem(item.fsoCategory);
+	}
+	
+	FlagListCheckBox* checkBox =
+		new FlagListCheckBox(
+			this,
+			wxEmptyString,
+			item.flagString);
+	checkBox->Hide(); // we don't yet know where it should appear, so hide
+	
+	checkBox->Connect(
+		checkBox->GetId(),
+		wxEVT_COMMAND_CHECKBOX_CLICKED,
+		wxCommandEventHandler(FlagListCheckBox::OnClicked));
+	
+	wxSizer* checkBoxSizer = new wxBoxSizer(wxVERTICAL);
+	checkBoxSizer->AddSpacer(ITEM_VERTICAL_OFFSET);
+	checkBoxSizer->Add(checkBox);
+	
+	return new FlagListCheckBoxItem(*checkBox, *checkBoxSizer,
+		item.shortDescription, item.flagString,
+		item.isRecommendedFlag);
+}
+
 void FlagListBox::GenerateCheckBoxes(const FlagListBoxData& data) {
 	wxASSERT(!data.IsEmpty());
 	wxASSERT_MSG(!this->areCheckBoxesGenerated,
 		_T("Attempted to generate checkboxes a second time."));
 	
-	FlagListCheckBox* checkBox;
-	wxSizer* checkBoxSizer;
+	for (FlagListBoxData::const_iterator dataIter = data.begin();
+		 dataIter != data.end(); ++dataIter) {
+		this->checkBoxes.Append(this->CreateCheckBoxItem(**dataIter));
+	}
+	
+	this->areCheckBoxesGenerated = true;
+}
+
+WX_DECLARE_STRING_HASH_MAP(FlagListCheckBoxItem*, FlagListCheckBoxItemMap);
+
+/** Returns the string that identifies a row across binaries. Category
+ headers and flags are kept in separate maps, so they cannot collide. */
+static const wxString& GetRowKey(const FlagListCheckBoxItem& item) {
+	return item.GetFlagString().IsEmpty()
+		? item.GetFsoCategory() : item.GetFlagString();
+}
+
+/** Reconciles the existing rows with the flags of a new binary.
+ Rows whose flag or category exists in both binaries keep their check box,
+ rows that are new get one, and rows the new binary lacks are destroyed.
+ Switching between two builds of the same branch usually touches only a
+ handful of rows. */
+void FlagListBox::UpdateCheckBoxes(const FlagListBoxData& data) {
+	wxASSERT(!data.IsEmpty());
+	wxASSERT(this->areCheckBoxesGenerated);
+	
+	// remember what the user was looking at, by key rather than by index,
+	// since indices shift when rows are added or removed above them
+	wxString selectedKey, topKey;
+	const int selection = this->GetSelection();
+	if (selection != wxNOT_FOUND
+			&& static_cast<size_t>(selection) < this->visibleRows.size()) {
+		selectedKey = GetRowKey(*this->FindFlagAt(selection));
+	}
+#if wxCHECK_VERSION(2, 9, 0)
+	const size_t topRow = this->GetVisibleRowsBegin();
+#else
+	const size_t topRow = this->GetFirstVisibleLine();
+#endif
+	if (topRow < this->visibleRows.size()) {
+		topKey = GetRowKey(*this->FindFlagAt(topRow));
+	}
+	
+	FlagListCheckBoxItemMap oldCategories, oldFlags;
+	for (FlagListCheckBoxItems::const_iterator
+		 it = this->checkBoxes.begin(), end = this->checkBoxes.end();
+		 it != end; ++it) {
+		FlagListCheckBoxItem* item = *it;
+		if (item->GetFlagString().IsEmpty()) {
+			oldCategories[item->GetFsoCategory()] = item;
+		} else {
+			oldFlags[item->GetFlagString()] = item;
+		}
+	}
+	
+	FlagListCheckBoxItems updated;
+	size_t added = 0, kept = 0;
 	
 	for (FlagListBoxData::const_iterator dataIter = data.begin();
 		 dataIter != data.end(); ++dataIter) {
+		const FlagListBoxDataItem& dataItem = **dataIter;
+		FlagListCheckBoxItemMap& oldItems =
+			dataItem.fsoCategory.IsEmpty() ? oldFlags : oldCategories;
+		const wxString& key = dataItem.fsoCategory.IsEmpty()
+			? dataItem.flagString : dataItem.fsoCategory;
 		
-		FlagListBoxDataItem* item = *dataIter;
+		FlagListCheckBoxItem* item;
+		FlagListCheckBoxItemMap::iterator found = oldItems.find(key);
+		if (found != oldItems.end()) {
+			item = found->second;
+			oldItems.erase(found);
+			if (item->GetCheckBox() != NULL) {
+				item->Update(dataItem.shortDescription, dataItem.isRecommendedFlag);
+				// enabled flags are reloaded from the proxy
+				item->GetCheckBox()->SetValue(false);
+			}
+			kept++;
+		} else {
+			item = this->CreateCheckBoxItem(dataItem);
+			added++;
+		}
+		updated.Append(item);
+	}
+	
+	// whatever is left over is not supported by the new binary
+	size_t removed = 0;
+	FlagListCheckBoxItemMap* leftovers[] = { &oldCategories, &oldFlags };
+	for (size_t i = 0; i < WXSIZEOF(leftovers); i++) {
+		for (FlagListCheckBoxItemMap::iterator
+			 it = leftovers[i]->begin(), end = leftovers[i]->end();
+			 it != end; ++it) {
+			FlagListCheckBoxItem* item = it->second;
+			if (item->GetCheckBox() != NULL) {
+				item->GetCheckBox()->Destroy();
+			}
+			delete item;
+			removed++;
+		}
+	}
+	
+	this->checkBoxes.Clear();
+	for (FlagListCheckBoxItems::const_iterator
+		 it = updated.begin(), end = updated.end(); it != end; ++it) {
+		this->checkBoxes.Append(*it);
+	}
+	
+	wxLogDebug(_T("Flag list updated in place: %lu kept, %lu added, %lu removed"),
+		kept, added, removed);
+	
+	this->RebuildRowIndex();
+	this->ApplyFilter();
+	
+	const int newTopRow = this->FindVisibleRow(topKey);
+	this->SetSelection(this->FindVisibleRow(selectedKey));
+#if wxCHECK_VERSION(2, 9, 0)
+	this->ScrollToRow(newTopRow == wxNOT_FOUND ? 0 : newTopRow);
+#else
+	this->ScrollToLine(newTopRow == wxNOT_FOUND ? 0 : newTopRow);
+#endif
+}
+
+void FlagListBox::RebuildRowIndex() {
+	this->allRows.clear();
+	this->allRows.reserve(this->checkBoxes.GetCount());
+	for (FlagListCheckBoxItems::const_iterator
+		 it = this->checkBoxes.begin(), end = this->checkBoxes.end();
+		 it != end; ++it) {
+		this->allRows.push_back(*it);
+	}
+}
+
+bool FlagListBox::MatchesFilter(const FlagListCheckBoxItem& item) const {
+	for (size_t i = 0, n = this->filterTerms.GetCount(); i < n; ++i) {
+		if (item.GetSearchText().Find(this->filterTerms[i]) == wxNOT_FOUND) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Recomputes which rows are visible. Only visibleRows is rewritten, and
+ since it never holds more entries than allRows it is not reallocated once
+ it has been reserved; the rows themselves are untouched. */
+void FlagListBox::ApplyFilter() {
+	const size_t NO_HEADER = static_cast<size_t>(-1);
+	
+	this->visibleRows.clear();
+	this->visibleRows.reserve(this->allRows.size());
+	
+	size_t header = NO_HEADER;
+	bool isHeaderVisible = false;
+	for (size_t i = 0, n = this->allRows.size(); i < n; ++i) {
+		FlagListCheckBoxItem* item = this->allRows[i];
 		
-		if (!item->fsoCategory.IsEmpty()) {
-			this->checkBoxes.Append(
-				new FlagListCheckBoxItem(item->fsoCategory));
+		if (item->GetCheckBox() == NULL) { // category header
+			if (this->filterTerms.IsEmpty()) {
+				this->visibleRows.push_back(i);
+			} else {
+				header = i;
+				isHeaderVisible = false;
+			}
 			continue;
 		}
 		
-		checkBox =
-			new FlagListCheckBox(
-				this,
-				wxEmptyString,
-				item->flagString);
-		checkBox->Hide(); // we don't yet know where it should appear, so hide
+		// shown again by OnDrawItem() if its row is drawn
+		item->GetCheckBox()->Hide();
 		
-		checkBox->Connect(
-			checkBox->GetId(),
-			wxEVT_COMMAND_CHECKBOX_CLICKED,
-			wxCommandEventHandler(FlagListCheckBox::OnClicked));
-		
-		checkBoxSizer = new wxBoxSizer(wxVERTICAL);
-		checkBoxSizer->AddSpacer(ITEM_VERTICAL_OFFSET);
-		checkBoxSizer->Add(checkBox);
-		
-		this->checkBoxes.Append(
-			new FlagListCheckBoxItem(*checkBox, *checkBoxSizer,
-				item->shortDescription, item->flagString,
-				item->isRecommendedFlag));
+		if (!this->MatchesFilter(*item)) {
+			continue;
+		}
+		if (!isHeaderVisible && header != NO_HEADER) {
+			this->visibleRows.push_back(header);
+			isHeaderVisible = true;
+		}
+		this->visibleRows.push_back(i);
 	}
 	
-	this->areCheckBoxesGenerated = true;
+	this->SetItemCount(this->visibleRows.size());
+	this->RefreshAll();
+}
+
+/** Returns the visible row holding the flag or category key, or wxNOT_FOUND. */
+int FlagListBox::FindVisibleRow(const wxString& key) const {
+	if (key.IsEmpty()) {
+		return wxNOT_FOUND;
+	}
+	for (size_t i = 0, n = this->visibleRows.size(); i < n; ++i) {
+		if (GetRowKey(*this->allRows[this->visibleRows[i]]) == key) {
+			return static_cast<int>(i);
+		}
+	}
+	return wxNOT_FOUND;
+}
+
+void FlagListBox::SetFilter(const wxString& filter) {
+	const wxArrayString terms(wxStringTokenize(filter.Lower()));
+	if (terms == this->filterTerms) {
+		return;
+	}
+	this->filterTerms = terms;
+	
+	if (!this->HasRows()) {
+		return; // applied once the rows exist
+	}
+	
+	wxString selectedKey;
+	const int selection = this->GetSelection();
+	if (selection != wxNOT_FOUND
+			&& static_cast<size_t>(selection) < this->visibleRows.size()) {
+		selectedKey = GetRowKey(*this->FindFlagAt(selection));
+	}
+	
+	this->ApplyFilter();
+	
+#if wxCHECK_VERSION(2, 9, 0)
+	this->ScrollToRow(0);
+#else
+	this->ScrollToLine(0);
+#endif
+	// brings the selected flag into view if it is still shown
+	this->SetSelection(this->FindVisibleRow(selectedKey));
 }
 
 FlagListBox::~FlagListBox() {
@@ -200,12 +453,12 @@ FlagListBox::~FlagListBox() {
 }
 
 FlagListCheckBoxItem* FlagListBox::FindFlagAt(size_t n) const {
-	wxCHECK_MSG(this->IsReady(), NULL,
-		_T("FindFlagAt() called when flag list box is not ready"));
-	wxCHECK_MSG(n >= 0 && n < this->checkBoxes.GetCount(), NULL,
+	wxCHECK_MSG(this->HasRows(), NULL,
+		_T("FindFlagAt() called when flag list box has no rows"));
+	wxCHECK_MSG(n >= 0 && n < this->visibleRows.size(), NULL,
 		wxString::Format(_T("FindFlagAt() called with out-of-range value %lu"), n));
 	
-	return this->checkBoxes[n];
+	return this->allRows[this->visibleRows[n]];
 }
 
 void FlagListBox::OnDrawItem(wxDC &dc, const wxRect &rect, size_t n) const {
@@ -214,7 +467,7 @@ void FlagListBox::OnDrawItem(wxDC &dc, const wxRect &rect, size_t n) const {
 	dc.SetFont(font);
 #endif
 	
-	if (this->IsReady()) {
+	if (this->HasRows()) {
 		FlagListCheckBoxItem* item = this->FindFlagAt(n);
 		wxCHECK_RET(item != NULL, _T("Flag pointer is null"));
 		
@@ -262,7 +515,7 @@ void FlagListBox::OnDrawItem(wxDC &dc, const wxRect &rect, size_t n) const {
 }
 
 wxCoord FlagListBox::OnMeasureItem(size_t n) const {
-	if ( this->IsReady()) {
+	if (this->HasRows()) {
 		return SkinSystem::IdealIconHeight;
 	} else {
 		return this->GetSize().y;
@@ -272,7 +525,7 @@ wxCoord FlagListBox::OnMeasureItem(size_t n) const {
 void FlagListBox::OnDrawBackground(wxDC &dc, const wxRect &rect, size_t n) const {
 	wxColour background = wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOW);
 	
-	if (this->IsReady()) {
+	if (this->HasRows()) {
 		FlagListCheckBoxItem* item = FindFlagAt(n);
 		if (item != NULL && item->GetFlagString().IsEmpty()) { // category header
 			background = wxSystemSettings::GetColour(wxSYS_COLOUR_HIGHLIGHT);
@@ -291,7 +544,16 @@ void FlagListBox::OnDoubleClickFlag(wxCommandEvent &WXUNUSED(event)) {
 	wxCHECK_RET(this->IsReady(),
 		_T("OnDoubleClickFlag() called when flag list box is not ready."));
 	
-	const wxString* webURL = this->flagData->GetWebURL(this->GetSelection());
+	const int selection = this->GetSelection();
+	if (selection == wxNOT_FOUND) {
+		return;
+	}
+	wxCHECK_RET(static_cast<size_t>(selection) < this->visibleRows.size(),
+		_T("OnDoubleClickFlag(): selection is out of range."));
+	
+	// the flag data is indexed by unfiltered row
+	const wxString* webURL =
+		this->flagData->GetWebURL(static_cast<int>(this->visibleRows[selection]));
 	wxCHECK_RET(webURL != NULL,
 		_T("GetWebURL() returned NULL, which shouldn't happen."));
 	
@@ -325,6 +587,23 @@ void FlagListBox::LoadEnabledFlags() {
 	this->flagsLoaded = true;
 }
 
+void FlagListBox::UnloadEnabledFlags() {
+	wxCHECK_RET(this->IsReady(),
+		_T("UnloadEnabledFlags() called when flag list box is not ready."));
+	
+	for (FlagListCheckBoxItems::iterator
+		 it = this->checkBoxes.begin(), end = this->checkBoxes.end();
+		 it != end;
+		 ++it) {
+		FlagListCheckBox* checkBox = (*it)->GetCheckBox();
+		if (checkBox != NULL) {
+			checkBox->SetValue(false);
+		}
+	}
+	
+	this->flagsLoaded = false;
+}
+
 bool FlagListBox::SetFlag(
 	 const wxString& flagString, const bool state, const bool updateProxy) {
 	wxCHECK_MSG(this->IsReady(), false,
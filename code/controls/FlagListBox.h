@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <wx/wx.h>
 #include <wx/vlbox.h>
 
+#include <vector>
+
 #include "apis/EventHandlers.h"
 #include "apis/FlagListManager.h"
 
@@ -50,6 +52,10 @@ public:
 	const wxString& GetShortDescription() const { return this->shortDescription; }
 	const wxString& GetFlagString() const { return this->flagString; }
 	bool IsRecommendedFlag() const { return this->isRecommendedFlag; }
+	/** Lower-case flag string and description that searches are matched against.
+	 Empty for category headers. */
+	const wxString& GetSearchText() const { return this->searchText; }
+	void Update(const wxString& shortDescription, bool isRecommendedFlag);
 private:
 	FlagListCheckBoxItem();
 	wxString fsoCategory;
@@ -58,6 +64,7 @@ private:
 	wxString shortDescription;
 	wxString flagString;
 	bool isRecommendedFlag;
+	wxString searchText;
 };
 
 WX_DECLARE_LIST(FlagListCheckBoxItem, FlagListCheckBoxItems);
@@ -90,11 +97,31 @@ public:
 	
 	void GetFlagSets(wxArrayString& arr) const;
 	
+	/** Takes ownership of flagData. If the list box already shows the flags
+	 of a previous binary, the new flags are diffed into the existing rows
+	 so that selection, scroll position and unchanged check boxes survive. */
 	void AcceptFlagData(FlagFileData* flagData);
 	
+	/** Marks the list box as waiting for the flags of a new binary.
+	 The current rows remain visible until AcceptFlagData() is called. */
+	void BeginRefresh();
+	
 	bool IsReady() const { return this->isReady; }
 	
+	/** Returns true when there are rows to draw, even if they belong to
+	 a previous binary and the list box is not ready. */
+	bool HasRows() const { return this->areCheckBoxesGenerated; }
+	
 	bool FlagsLoaded() const { return this->flagsLoaded; }
+	
+	/** Unchecks every flag without touching the proxy, so that the enabled
+	 flags of another profile can be loaded into the same rows. */
+	void UnloadEnabledFlags();
+	
+	/** Shows only the flags whose flag string or description contains every
+	 whitespace-separated word of filter (case-insensitive), along with
+	 their category headers. An empty filter shows all rows. */
+	void SetFilter(const wxString& filter);
 
 private:
 	EventHandlers flagListBoxReadyHandlers;
@@ -111,7 +138,18 @@ private:
 	FlagFileData* flagData;
 	FlagListCheckBoxItems checkBoxes;
 	void GenerateCheckBoxes(const FlagListBoxData& data);
+	void UpdateCheckBoxes(const FlagListBoxData& data);
+	FlagListCheckBoxItem* CreateCheckBoxItem(const FlagListBoxDataItem& item);
 	bool areCheckBoxesGenerated;
+	
+	void RebuildRowIndex();
+	void ApplyFilter();
+	bool MatchesFilter(const FlagListCheckBoxItem& item) const;
+	int FindVisibleRow(const wxString& key) const;
+	
+	std::vector<FlagListCheckBoxItem*> allRows; //!< checkBoxes, indexable in constant time
+	std::vector<size_t> visibleRows; //!< indices into allRows of the rows that pass the filter
+	wxArrayString filterTerms; //!< lower-case words of the current filter
 
 	FlagListCheckBoxItem* FindFlagAt(size_t n) const;
 
@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/listctrl.h>
+
+#include "controls/LaunchHistoryDialog.h"
+#include "datastructures/LaunchHistory.h"
+#include "global/ids.h"
+
+#include "global/MemoryDebugging.h" // Last include for memory debugging
+
+namespace
+{
+	enum Columns {
+		COLUMN_BINARY,
+		COLUMN_MOD,
+		COLUMN_LAUNCHES,
+		COLUMN_FIRST_PHASE
+	};
+}
+
+static wxString FormatTimes(long median, long slowest90) {
+	if (median == LaunchRecord::NOT_MEASURED) {
+		return _T("-");
+	}
+	return wxString::Format(_T("%ld / %ld"), median, slowest90);
+}
+
+LaunchHistoryDialog::LaunchHistoryDialog(wxWindow* parent):
+wxDialog(parent, ID_LAUNCH_HISTORY_DIALOG, _("Launch history"), wxDefaultPosition,
+		 wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER) {
+	LaunchRecords records;
+	LaunchHistory::Load(records);
+	LaunchSummaries summaries;
+	LaunchHistory::Summarize(records, summaries);
+
+	wxStaticText* text = new wxStaticText(this, wxID_ANY,
+		wxString::Format(_("Median / 90th percentile in ms of the last %lu launches:"),
+			static_cast<unsigned long>(records.size())));
+
+	wxListCtrl* list = new wxListCtrl(this, wxID_ANY, wxDefaultPosition,
+		wxSize(720, 240), wxLC_REPORT | wxLC_SINGLE_SEL);
+	list->InsertColumn(COLUMN_BINARY, _("Executable"));
+	list->InsertColumn(COLUMN_MOD, _("Mods"));
+	list->InsertColumn(COLUMN_LAUNCHES, _("Launches"), wxLIST_FORMAT_RIGHT);
+	for (int phase = 0; phase < LaunchRecord::PHASE_COUNT; ++phase) {
+		list->InsertColumn(COLUMN_FIRST_PHASE + phase,
+			LaunchRecord::GetPhaseDescription(static_cast<LaunchRecord::Phase>(phase)),
+			wxLIST_FORMAT_RIGHT);
+	}
+
+	for (size_t i = 0; i < summaries.size(); ++i) {
+		const LaunchSummary& summary = summaries[i];
+		const long row = list->InsertItem(static_cast<long>(i), summary.binary);
+		list->SetItem(row, COLUMN_MOD,
+			summary.modLine.IsEmpty() ? wxString(_("(none)")) : summary.modLine);
+		list->SetItem(row, COLUMN_LAUNCHES,
+			wxString::Format(_T("%lu"), static_cast<unsigned long>(summary.launches)));
+		for (int phase = 0; phase < LaunchRecord::PHASE_COUNT; ++phase) {
+			list->SetItem(row, COLUMN_FIRST_PHASE + phase,
+				FormatTimes(summary.median[phase], summary.slowest90[phase]));
+		}
+	}
+	for (int column = 0; column < list->GetColumnCount(); ++column) {
+		list->SetColumnWidth(column, summaries.empty() ? wxLIST_AUTOSIZE_USEHEADER : wxLIST_AUTOSIZE);
+	}
+
+	wxButton* closeButton = new wxButton(this, wxID_OK, _("Close"));
+
+	wxBoxSizer *sizer = new wxBoxSizer(wxVERTICAL);
+	sizer->Add(text, wxSizerFlags().Expand().Border(wxALL, 5));
+	sizer->Add(list, wxSizerFlags(1).Expand().Border(wxLEFT | wxRIGHT, 5));
+	sizer->Add(closeButton, wxSizerFlags().Right().Border(wxALL, 5));
+
+	this->SetSizerAndFit(sizer);
+	this->Layout();
+	this->Center();
+
+	this->SetEscapeId(closeButton->GetId());
+}
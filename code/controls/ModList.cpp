@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "apis/SkinManager.h"
 #include "global/ids.h"
 #include "global/ProfileKeys.h"
+#include "global/ProfileSchema.h"
 #include "global/ModDefaults.h"
 #include "global/ModIniKeys.h"
 #include "global/Utils.h"
@@ -191,6 +192,7 @@ ModList::ModList(wxWindow *parent, wxSize& size, wxString tcPath)
 	this->SetMargins(10, 10);
 	
 	SkinSystem::RegisterTCSkinChanged(this);
+	ProMan::GetProfileManager()->AddEventHandler(this);
 
 	std::vector<ModItem*> modsTemp; // for use in presorting
 
@@ -607,6 +609,9 @@ ModList::~ModList() {
 	if (SkinSystem::IsInitialized()) {
 		SkinSystem::UnRegisterTCSkinChanged(this);
 	}
+	if (ProMan::IsInitialized()) {
+		ProMan::GetProfileManager()->RemoveEventHandler(this);
+	}
 	
 	if ( this->configFiles != NULL ) {
 		delete this->configFiles;
@@ -781,7 +786,7 @@ bool ModList::ParseModIni(const wxString& modIniPath, const wxString& tcPath, co
 void ModList::SetSelectedMod() {
 	wxString currentMod;
 	ProMan::GetProfileManager()->ProfileRead(
-		PRO_CFG_TC_CURRENT_MOD, &currentMod, NO_MOD);
+		PRO_KEY_TC_CURRENT_MOD, &currentMod, NO_MOD);
 	
 	size_t i;
 	for ( i = 0; i < this->tableData->size(); ++i ) {
@@ -838,7 +843,7 @@ void ModList::OnDrawBackground(wxDC &dc, const wxRect& rect, size_t n) const {
 	wxColour highlighted = wxSystemSettings::GetColour(wxSYS_COLOUR_HIGHLIGHT);
 	wxColour background = wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOW);
 	wxString activeMod;
-	ProMan::GetProfileManager()->ProfileRead(PRO_CFG_TC_CURRENT_MOD, &activeMod, NO_MOD, true);
+	ProMan::GetProfileManager()->ProfileRead(PRO_KEY_TC_CURRENT_MOD, &activeMod, NO_MOD);
 	wxBrush b;
 	wxRect selectedRect(rect.x+2, rect.y+2, rect.width-4, rect.height-4);
 	wxRect activeRect(selectedRect.x+3, selectedRect.y+3, selectedRect.width-7, selectedRect.height-7);
@@ -999,8 +1004,19 @@ BEGIN_EVENT_TABLE(ModList, wxVListBox)
 EVT_LISTBOX(ID_MODLISTBOX, ModList::OnSelectionChange)
 EVT_BUTTON(ID_MODLISTBOX_ACTIVATE_BUTTON, ModList::OnActivateMod)
 EVT_BUTTON(ID_MODLISTBOX_INFO_BUTTON, ModList::OnInfoMod)
+EVT_COMMAND(wxID_NONE, EVT_CURRENT_PROFILE_CHANGED, ModList::OnCurrentProfileChanged)
 END_EVENT_TABLE()
 
+/** Selects the new profile's mod when the profile switch kept the root folder.
+ A new root folder rebuilds the whole mod list instead. */
+void ModList::OnCurrentProfileChanged(wxCommandEvent &event) {
+	const int changes = event.GetInt();
+	if ((changes & ProMan::PROFILE_CHANGED_MOD)
+		&& !(changes & ProMan::PROFILE_CHANGED_TC_ROOT_FOLDER)) {
+		this->SetSelectedMod();
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Flagsets
 /** \class FlagSetItem
@@ -1328,7 +1344,7 @@ ModInfoDialog::ModInfoDialog(ModItem* item, wxWindow* parent) {
 	titleBox->SetFont(titleFont);
 
 	wxString tcPath;
-	ProMan::GetProfileManager()->ProfileRead(PRO_CFG_TC_ROOT_FOLDER, &tcPath, wxEmptyString);
+	ProMan::GetProfileManager()->ProfileRead(PRO_KEY_TC_ROOT_FOLDER, &tcPath, wxEmptyString);
 	wxString modFolderString =
 		wxString::Format(_T("%s%s"),
 			tcPath.c_str(),
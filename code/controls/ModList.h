@@ -154,6 +154,7 @@ public:
 	void OnActivateMod(wxCommandEvent &event);
 	void OnInfoMod(wxCommandEvent &event);
 	void OnTCSkinChanged(wxCommandEvent &event);
+	void OnCurrentProfileChanged(wxCommandEvent &event);
 	
 	static const ModItem* GetActiveMod() { return ModList::activeMod; }
 
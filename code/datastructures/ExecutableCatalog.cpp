@@ -0,0 +1,202 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/filefn.h>
+#include <wx/evtloop.h>
+
+#include "generated/configure_launcher.h"
+#include "datastructures/ExecutableCatalog.h"
+
+#include "global/MemoryDebugging.h"
+
+ExecutableCatalog* ExecutableCatalog::catalog = NULL;
+
+ExecutableCatalog* ExecutableCatalog::Get() {
+	if (catalog == NULL) {
+		catalog = new ExecutableCatalog();
+	}
+	return catalog;
+}
+
+void ExecutableCatalog::DeInitialize() {
+	delete catalog;
+	catalog = NULL;
+}
+
+ExecutableCatalog::ExecutableCatalog() {
+#if wxUSE_FSWATCHER
+	this->watcher = NULL;
+#endif
+}
+
+ExecutableCatalog::~ExecutableCatalog() {
+#if wxUSE_FSWATCHER
+	delete this->watcher;
+#endif
+	for (Listings::iterator it = this->listings.begin(); it != this->listings.end(); ++it) {
+		delete it->second;
+	}
+}
+
+ExecutableCatalog::Listing::~Listing() {
+	for (ExecutableCatalogEntries::iterator it = this->entries.begin();
+		it != this->entries.end(); ++it) {
+		delete it->second;
+	}
+}
+
+/** Returns the time the folder or file was last modified, or 0 if it
+ can't be stat'd. */
+static time_t GetModificationTime(const wxString& path, wxULongLong* size = NULL) {
+	wxStructStat st;
+	if (wxStat(path, &st) != 0) {
+		return 0;
+	}
+	if (size != NULL) {
+		*size = static_cast<wxULongLong_t>(st.st_size);
+	}
+	return st.st_mtime;
+}
+
+/** Puts the FS2 Open or FRED executables in root into binaries. Returns
+ false if root can't be read. */
+bool ExecutableCatalog::GetBinaries(const wxFileName& root, bool fred, wxArrayString& binaries) {
+	const Listing* listing = this->GetListing(root);
+	if (listing == NULL) {
+		return false;
+	}
+	binaries = fred ? listing->fredBinaries : listing->binaries;
+	return true;
+}
+
+/** Returns what is known about the executable binary in root, or NULL if
+ root has no such executable. */
+const ExecutableCatalogEntry* ExecutableCatalog::Find(const wxFileName& root, const wxString& binary) {
+	const Listing* listing = this->GetListing(root);
+	if (listing == NULL) {
+		return NULL;
+	}
+	ExecutableCatalogEntries::const_iterator it = listing->entries.find(binary);
+	return (it == listing->entries.end()) ? NULL : it->second;
+}
+
+/** Makes the next request about the folder list it again. Returns false
+ if the folder has not been listed. */
+bool ExecutableCatalog::Invalidate(const wxString& rootPath) {
+	Listings::iterator it = this->listings.find(rootPath);
+	if (it == this->listings.end()) {
+		return false;
+	}
+	it->second->isCurrent = false;
+	return true;
+}
+
+void ExecutableCatalog::InvalidateAll() {
+	for (Listings::iterator it = this->listings.begin(); it != this->listings.end(); ++it) {
+		it->second->isCurrent = false;
+	}
+}
+
+ExecutableCatalog::Listing* ExecutableCatalog::GetListing(const wxFileName& root) {
+	wxCHECK_MSG(root.IsOk(), NULL,
+		wxString::Format(_T("provided path %s to ExecutableCatalog is invalid"),
+			root.GetFullPath().c_str()));
+	const wxString rootPath(root.GetPath());
+
+	Listings::iterator it = this->listings.find(rootPath);
+	Listing* listing = (it == this->listings.end()) ? NULL : it->second;
+	// a watched folder tells us when it changes, any other needs a stat
+	const time_t folderModified = (listing != NULL && listing->isWatched)
+		? listing->folderModified : GetModificationTime(rootPath);
+	if (listing != NULL && listing->isCurrent
+		&& listing->folderModified == folderModified) {
+		// in case it was listed before the event loop started
+		this->Watch(rootPath, *listing);
+		return listing;
+	}
+
+	Listing* fresh = new Listing();
+	if (!FSOExecutable::ScanRootFolder(rootPath, fresh->binaries, fresh->fredBinaries)) {
+		delete fresh;
+		return NULL;
+	}
+	fresh->isCurrent = true;
+	fresh->isWatched = (listing != NULL) && listing->isWatched;
+	fresh->folderModified = folderModified;
+
+	wxArrayString* lists[] = { &fresh->binaries, &fresh->fredBinaries };
+	for (size_t i = 0; i < WXSIZEOF(lists); ++i) {
+		for (size_t j = 0; j < lists[i]->GetCount(); ++j) {
+			const wxString& binary = lists[i]->Item(j);
+			wxULongLong size = 0;
+			const time_t modified = GetModificationTime(
+				rootPath + wxFileName::GetPathSeparator() + binary, &size);
+			fresh->entries[binary] = new ExecutableCatalogEntry(
+				FSOExecutable::GetBinaryVersion(binary), modified, size);
+		}
+	}
+	wxLogDebug(_T("Listed %lu executables in '%s'"),
+		static_cast<unsigned long>(fresh->entries.size()), rootPath.c_str());
+
+	delete listing;
+	this->listings[rootPath] = fresh;
+	this->Watch(rootPath, *fresh);
+	return fresh;
+}
+
+void ExecutableCatalog::Watch(const wxString& rootPath, Listing& listing) {
+#if wxUSE_FSWATCHER
+	if (listing.isWatched) {
+		return;
+	}
+	// watchers can only be made once the event loop is running
+	if (wxEventLoopBase::GetActive() == NULL) {
+		return;
+	}
+	if (this->watcher == NULL) {
+		this->watcher = new wxFileSystemWatcher();
+		this->watcher->SetOwner(this);
+		this->Connect(wxEVT_FSWATCHER,
+			wxFileSystemWatcherEventHandler(ExecutableCatalog::OnFolderChanged));
+	}
+	listing.isWatched = this->watcher->Add(wxFileName::DirName(rootPath),
+		wxFSW_EVENT_CREATE | wxFSW_EVENT_DELETE | wxFSW_EVENT_RENAME | wxFSW_EVENT_MODIFY);
+#else
+	wxUnusedVar(rootPath);
+	wxUnusedVar(listing);
+#endif
+}
+
+#if wxUSE_FSWATCHER
+void ExecutableCatalog::OnFolderChanged(wxFileSystemWatcherEvent& event) {
+	if (event.GetChangeType() & (wxFSW_EVENT_WARNING | wxFSW_EVENT_ERROR)) {
+		// events may have been lost, so nothing can be trusted
+		wxLogDebug(_T("Executable folder watcher reported a problem, relisting all folders"));
+		this->InvalidateAll();
+		return;
+	}
+	wxLogDebug(_T("Executable folder changed: %s"), event.GetPath().GetFullPath().c_str());
+	wxFileName changed(event.GetPath());
+	if (!this->Invalidate(changed.GetPath()) && changed.GetDirCount() > 0) {
+		// a folder such as an OS X .app bundle is reported by its own path
+		changed.RemoveLastDir();
+		this->Invalidate(changed.GetPath());
+	}
+}
+#endif
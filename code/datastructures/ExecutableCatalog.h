@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef EXECUTABLECATALOG_H
+#define EXECUTABLECATALOG_H
+
+#include <wx/wx.h>
+#include <wx/filename.h>
+#include <wx/hashmap.h>
+#include <wx/longlong.h>
+#if wxUSE_FSWATCHER
+#include <wx/fswatcher.h>
+#endif
+
+#include "datastructures/FSOExecutable.h"
+
+/** One FS2 Open or FRED executable found in a root folder. */
+struct ExecutableCatalogEntry {
+	ExecutableCatalogEntry(const FSOExecutable& executable,
+		time_t modified, const wxULongLong& size)
+	: executable(executable), modified(modified), size(size) { }
+	FSOExecutable executable; //!< the version parsed from its name
+	time_t modified;
+	wxULongLong size;
+};
+
+WX_DECLARE_STRING_HASH_MAP( ExecutableCatalogEntry*, ExecutableCatalogEntries );
+
+/** The executables in each root folder that has been looked at, so that
+ everything which wants to know about a root folder's executables shares
+ one listing of it.
+
+ A listing is made the first time a root folder is asked about and kept
+ until the folder changes. Where wxWidgets has a file system watcher the
+ folder is watched; elsewhere, or before the event loop has started, the
+ folder's modification time is checked instead, which still costs a single
+ stat rather than a listing.
+
+ Only to be used from the main thread. */
+class ExecutableCatalog: public wxEvtHandler {
+public:
+	static ExecutableCatalog* Get();
+	static void DeInitialize();
+
+	bool GetBinaries(const wxFileName& root, bool fred, wxArrayString& binaries);
+	const ExecutableCatalogEntry* Find(const wxFileName& root, const wxString& binary);
+	bool Invalidate(const wxString& rootPath);
+	void InvalidateAll();
+
+private:
+	ExecutableCatalog();
+	~ExecutableCatalog();
+
+	struct Listing {
+		Listing() : isCurrent(false), isWatched(false), folderModified(0) { }
+		~Listing();
+		bool isCurrent;
+		bool isWatched;
+		time_t folderModified;
+		wxArrayString binaries;
+		wxArrayString fredBinaries;
+		ExecutableCatalogEntries entries;
+	};
+	WX_DECLARE_STRING_HASH_MAP( Listing*, Listings );
+
+	Listing* GetListing(const wxFileName& root);
+	void Watch(const wxString& rootPath, Listing& listing);
+#if wxUSE_FSWATCHER
+	void OnFolderChanged(wxFileSystemWatcherEvent& event);
+	wxFileSystemWatcher* watcher;
+#endif
+
+	Listings listings;
+	static ExecutableCatalog* catalog;
+};
+
+#endif
@@ -18,6 +18,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "generated/configure_launcher.h"
 #include "datastructures/FSOExecutable.h"
+#include "datastructures/ExecutableCatalog.h"
 #include <wx/dir.h>
 #include <wx/tokenzr.h>
 
@@ -42,8 +43,12 @@ FSOExecutable::FSOExecutable():
 	configuration(CONFIG_RELEASE),
 	build(0), year(0), month(0),
 	antipodes(false),antNumber(0),
-	buildCaps(0)
+	buildCaps(0),
+	nightlyDate(0), commitHash(0)
 {
+	for (int i = 0; i < SORT_KEY_LENGTH; ++i) {
+		this->sortKey[i] = 0;
+	}
 }
 
 FSOExecutable::~FSOExecutable() {
@@ -110,35 +115,50 @@ wxString EXECUTABLE_END_PATTERN(_T(".app"));
 #error "One of IS_WIN32, IS_LINUX, IS_APPLE must evaluate to true"
 #endif
 
+static wxArrayString GetBinariesFromCatalog(const wxFileName& path, bool fred, bool quiet) {
+	wxArrayString files;
+	if (!ExecutableCatalog::Get()->GetBinaries(path, fred, files)) {
+		return files;
+	}
+
+	if (!quiet) {
+		wxString execType = fred ? _T("FRED2") : _T("FS2");
+		wxLogInfo(_T(" Found %d %s Open executables in '%s'"),
+			files.GetCount(), execType.c_str(), path.GetPath().c_str());
+		
+		for (size_t i = 0, n = files.GetCount(); i < n; ++i) {
+			wxLogDebug(_T("Found executable: %s"), files.Item(i).c_str());
+		}
+	}
+
+	return files;
+}
+
 // quiet is for when you just want to check whether there are FSO/FRED binaries
 wxArrayString FSOExecutable::GetBinariesFromRootFolder(
 	const wxFileName& path, bool quiet)
 {
-	return FSOExecutable::GetBinariesFromRootFolder(
-		path, EXECUTABLE_START_PATTERN, EXECUTABLE_END_PATTERN, quiet);
+	return GetBinariesFromCatalog(path, false, quiet);
 }
 
 wxArrayString FSOExecutable::GetFredBinariesFromRootFolder(
 	const wxFileName& path, bool quiet)
 {
-	return FSOExecutable::GetBinariesFromRootFolder(
-		path, FRED_EXECUTABLE_START_PATTERN, EXECUTABLE_END_PATTERN, quiet);
+	return GetBinariesFromCatalog(path, true, quiet);
 }
 
-wxArrayString FSOExecutable::GetBinariesFromRootFolder(
-	const wxFileName& path,
-	const wxString& startPattern,
-	const wxString& endPattern,
-	bool quiet)
+/** Sorts the executables in the folder into FS2 Open and FRED binaries
+ with a single listing of it. Returns false if the folder can't be read. */
+bool FSOExecutable::ScanRootFolder(
+	const wxString& pathStr,
+	wxArrayString& binaries,
+	wxArrayString& fredBinaries)
 {
-	wxArrayString files;
-
 	// Check args because this function gets crap tossed at it to validate
-	wxString pathStr(path.GetPath());
 	if (pathStr.IsEmpty())
 	{
 		wxLogInfo(wxT("GetBinaries called with empty root folder"));
-		return files;
+		return false;
 	}
 
 	wxDir folder(pathStr);
@@ -146,7 +166,7 @@ wxArrayString FSOExecutable::GetBinariesFromRootFolder(
 	{
 		wxLogInfo(wxT("GetBinaries called on '%s' which cannot be opened"),
 			pathStr.c_str());
-		return files;
+		return false;
 	}
 	wxString filename;
 
@@ -164,7 +184,12 @@ wxArrayString FSOExecutable::GetBinariesFromRootFolder(
 		if (lowerFilename.Contains(_T("launcher"))) {
 			continue;
 		}
-		if (!lowerFilename.StartsWith(startPattern)) {
+		wxArrayString* files;
+		if (lowerFilename.StartsWith(EXECUTABLE_START_PATTERN)) {
+			files = &binaries;
+		} else if (lowerFilename.StartsWith(FRED_EXECUTABLE_START_PATTERN)) {
+			files = &fredBinaries;
+		} else {
 			continue;
 		}
 #if IS_LINUX
@@ -172,38 +197,40 @@ wxArrayString FSOExecutable::GetBinariesFromRootFolder(
 			continue;
 		}
 #endif
-		if (!lowerFilename.EndsWith(endPattern)) {
+		if (!lowerFilename.EndsWith(EXECUTABLE_END_PATTERN)) {
 			continue;
 		}
-		files.Add(filename);
+		files->Add(filename);
 	}
 	
 #if IS_APPLE
 	// find actual (Unix) executable inside .app bundle and call the path to it the "executable"
-	for (wxArrayString::iterator it = files.begin(), end = files.end(); it != end; ++it) {
-		wxString pathToBin = 
-			wxDir::FindFirst(path.GetPath(wxPATH_GET_SEPARATOR) + *it + _T("/Contents/MacOS"),
-							 _T("*"),
-							 wxDIR_FILES);
-		pathToBin.Replace(path.GetPath(wxPATH_GET_SEPARATOR), _T(""));
-		*it = pathToBin;
-	}
-#endif
-	
-	if (!quiet) {
-		wxString execType = startPattern.Lower().Find(_T("fred")) == wxNOT_FOUND ? _T("FS2") : _T("FRED2");
-		wxLogInfo(_T(" Found %d %s Open executables in '%s'"),
-			files.GetCount(), execType.c_str(), path.GetPath().c_str());
-		
-		for (size_t i = 0, n = files.GetCount(); i < n; ++i) {
-			wxLogDebug(_T("Found executable: %s"), files.Item(i).c_str());
+	wxArrayString* lists[] = { &binaries, &fredBinaries };
+	for (size_t i = 0; i < WXSIZEOF(lists); ++i) {
+		for (wxArrayString::iterator it = lists[i]->begin(), end = lists[i]->end(); it != end; ++it) {
+			wxString pathToBin = 
+				wxDir::FindFirst(pathStr + wxFileName::GetPathSeparator() + *it + _T("/Contents/MacOS"),
+								 _T("*"),
+								 wxDIR_FILES);
+			pathToBin.Replace(pathStr + wxFileName::GetPathSeparator(), _T(""));
+			*it = pathToBin;
 		}
 	}
+#endif
 
-	return files;
+	return true;
 }
 
+/** Parses the executable's name into its version, and works out what is
+ needed to show and sort it. */
 FSOExecutable FSOExecutable::GetBinaryVersion(wxString binaryname) {
+	FSOExecutable ver(FSOExecutable::ParseBinaryName(binaryname));
+	ver.versionString = ver.FormatVersionString();
+	ver.MakeSortKey();
+	return ver;
+}
+
+FSOExecutable FSOExecutable::ParseBinaryName(const wxString& binaryname) {
 	wxLogDebug(_T("Making version struct for the executable '%s'"), binaryname.c_str());
 	FSOExecutable ver;
 	wxStringTokenizer tok(binaryname, _T("_.- ()[]/"));
@@ -258,6 +285,7 @@ FSOExecutable FSOExecutable::GetBinaryVersion(wxString binaryname) {
 
 			year.ToLong(&ver.year);
 			year.ToLong(&ver.month);
+			ver.nightlyDate = tempVersion;
 			// not interested in the day at this time
 
 			// add it in YYYY-MM-DD format
@@ -270,6 +298,7 @@ FSOExecutable FSOExecutable::GetBinaryVersion(wxString binaryname) {
 			&& token.size() == 7 && SmellsLikeGitCommitHash(token))
 		{
 			// must be a commit hash on a nightly build
+			token.ToULong(&ver.commitHash, 16);
 			if (ver.string.size() > 0) {
 				ver.string += _T(' ');
 			}
@@ -408,7 +437,7 @@ FSOExecutable FSOExecutable::GetBinaryVersion(wxString binaryname) {
 	return ver;
 }
 
-/** Returns the version string to display to the user from a previously
+/** Makes the version string to display to the user from a previously
 parsed FSOVersion object.  The intention is to display all information that
 is normally encoded into the executable's file name into a long string that
 more user friendly. 
@@ -419,7 +448,7 @@ FS2 Open 3.6.10 Inferno SSE
 FRED2 Open 3.6.11 Debug
 \endverbatim
 */
-wxString FSOExecutable::GetVersionString() const {
+wxString FSOExecutable::FormatVersionString() const {
 	const bool hasVersion = (this->major != 0) || this->antipodes;
 	const bool useFullVersion = hasVersion && !this->antipodes;
 	
@@ -482,6 +511,33 @@ wxString FSOExecutable::GetVersionString() const {
 		);
 }
 
+void FSOExecutable::MakeSortKey() {
+	// executables whose names couldn't be parsed go first
+	this->sortKey[0] = this->binaryname.IsEmpty() ? 0 : 1;
+	this->sortKey[1] = this->antipodes ? 1 : 0;
+	this->sortKey[2] = this->antNumber;
+	this->sortKey[3] = this->major;
+	this->sortKey[4] = this->minor;
+	this->sortKey[5] = this->revision;
+	this->sortKey[6] = this->nightlyDate;
+	this->sortKey[7] = this->build;
+	this->sortKey[8] = static_cast<long>(this->commitHash);
+	this->sortKey[9] = this->configuration;
+	this->sortKey[10] = (this->inferno ? 2 : 0) + (this->_64bit ? 1 : 0);
+	this->sortKey[11] = this->sse;
+}
+
+/** Orders executables by version, oldest first. Executables that only
+ differ in parts of their names that aren't understood are ordered by name. */
+bool FSOExecutable::IsOlderThan(const FSOExecutable* exe1, const FSOExecutable* exe2) {
+	for (int i = 0; i < SORT_KEY_LENGTH; ++i) {
+		if (exe1->sortKey[i] != exe2->sortKey[i]) {
+			return exe1->sortKey[i] < exe2->sortKey[i];
+		}
+	}
+	return exe1->executablename.CmpNoCase(exe2->executablename) < 0;
+}
+
 bool FSOExecutable::SmellsLikeGitCommitHash(const wxString & str)
 {
 	auto c = str.begin();
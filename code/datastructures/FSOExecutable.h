@@ -47,7 +47,9 @@ public:
 		const wxFileName &path, bool quiet = false);
 	static FSOExecutable GetBinaryVersion(wxString binaryname);
 	static bool SmellsLikeGitCommitHash(const wxString& str);
-	wxString GetVersionString() const;
+	/** The description shown to the user, made when the name was parsed. */
+	inline const wxString& GetVersionString() const;
+	static bool IsOlderThan(const FSOExecutable* exe1, const FSOExecutable* exe2);
 protected:
 	int major;
 	int minor;
@@ -65,13 +67,27 @@ protected:
 	wxString binaryname; //!< FS2 Open or FRED
 	wxString executablename; //!< the actual name of the binary
 	wxByte buildCaps;
+	long nightlyDate; //!< YYYYMMDD of a nightly build
+	unsigned long commitHash; //!< the abbreviated commit hash of a nightly build, as a number
 private:
+	enum {
+		SORT_KEY_LENGTH = 12
+	};
+	/** The parsed version as numbers, most significant first, so that
+	 sorting needs no string work. */
+	long sortKey[SORT_KEY_LENGTH];
+	wxString versionString;
+
 	FSOExecutable();
-	static wxArrayString GetBinariesFromRootFolder(
-		const wxFileName &path,
-		const wxString &startPattern,
-		const wxString &endPattern,
-		bool quiet);
+	static FSOExecutable ParseBinaryName(const wxString& binaryname);
+	wxString FormatVersionString() const;
+	void MakeSortKey();
+	static bool ScanRootFolder(
+		const wxString &pathStr,
+		wxArrayString &binaries,
+		wxArrayString &fredBinaries);
+
+	friend class ExecutableCatalog;
 };
 
 inline bool FSOExecutable::ExecutableNameEqualTo(const wxString& str) const {
@@ -82,4 +98,8 @@ inline const wxString& FSOExecutable::GetExecutableName() const {
 	return this->executablename;
 }
 
+inline const wxString& FSOExecutable::GetVersionString() const {
+	return this->versionString;
+}
+
 #endif
\ No newline at end of file
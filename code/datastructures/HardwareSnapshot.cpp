@@ -0,0 +1,237 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/fileconf.h>
+#include <wx/wfstream.h>
+#include <wx/sstream.h>
+
+#include "datastructures/HardwareSnapshot.h"
+#include "global/AtomicFileBatch.h"
+
+#include "global/MemoryDebugging.h"
+
+/** Bumped whenever what is saved changes, so older files are ignored. */
+static const long HARDWARE_FILE_FORMAT = 2;
+
+HardwareSnapshot::HardwareSnapshot(const HardwareInfo& info)
+: info(info), fingerprint(MakeFingerprint(info)), refCount(0) {
+}
+
+const HardwareAudioDevice* HardwareSnapshot::FindPlaybackDevice(const wxString& name) const {
+	for (HardwareAudioDevices::const_iterator it = this->info.playbackDevices.begin(),
+		 end = this->info.playbackDevices.end(); it != end; ++it) {
+		if (it->name == name) {
+			return &(*it);
+		}
+	}
+	return NULL;
+}
+
+/** FNV-1a over a description of everything in info. */
+wxString HardwareSnapshot::MakeFingerprint(const HardwareInfo& info) {
+	wxString description;
+	description << HARDWARE_FILE_FORMAT << _T('|') << info.displayApi
+		<< _T('|') << info.displaySignature;
+	for (HardwareDisplayModes::const_iterator it = info.displayModes.begin(),
+		 end = info.displayModes.end(); it != end; ++it) {
+		description << _T('|') << it->width << _T('x') << it->height;
+	}
+	description << _T("|audio|") << (info.hasAudio ? 1 : 0)
+		<< _T('|') << info.defaultPlaybackDevice
+		<< _T('|') << info.defaultCaptureDevice;
+	for (HardwareAudioDevices::const_iterator it = info.playbackDevices.begin(),
+		 end = info.playbackDevices.end(); it != end; ++it) {
+		description << _T('|') << it->name << _T('|') << (it->isOk ? 1 : 0)
+			<< _T('|') << it->version << _T('|') << (it->hasEFX ? 1 : 0)
+			<< _T('|') << it->maxAuxiliarySends;
+	}
+	for (size_t i = 0; i < info.captureDevices.GetCount(); ++i) {
+		description << _T('|') << info.captureDevices[i];
+	}
+	description << _T("|joysticks|") << info.joystickApi;
+	for (HardwareJoysticks::const_iterator it = info.joysticks.begin(),
+		 end = info.joysticks.end(); it != end; ++it) {
+		description << _T('|') << it->name << _T('|') << it->guid
+			<< _T('|') << (it->hasForceFeedback ? 1 : 0);
+	}
+
+	const wxCharBuffer bytes(description.utf8_str());
+	wxUint64 hash = wxULL(14695981039346656037);
+	for (const char* c = bytes.data(); *c != '\0'; ++c) {
+		hash ^= static_cast<unsigned char>(*c);
+		hash *= wxULL(1099511628211);
+	}
+	return wxString::Format(_T("%08lx%08lx"),
+		static_cast<unsigned long>(hash >> 32),
+		static_cast<unsigned long>(hash & 0xffffffff));
+}
+
+bool HardwareSnapshot::Save(const wxFileName& file) const {
+	wxStringInputStream emptyInput(wxEmptyString);
+	wxFileConfig config(emptyInput);
+	config.SetExpandEnvVars(false);
+
+	config.Write(_T("/hardware/format"), HARDWARE_FILE_FORMAT);
+	config.Write(_T("/hardware/fingerprint"), this->fingerprint);
+
+	config.Write(_T("/display/api"), static_cast<long>(this->info.displayApi));
+	config.Write(_T("/display/signature"), this->info.displaySignature);
+	config.Write(_T("/display/count"), static_cast<long>(this->info.displayModes.size()));
+	for (size_t i = 0; i < this->info.displayModes.size(); ++i) {
+		config.Write(wxString::Format(_T("/display/%lu"), static_cast<unsigned long>(i)),
+			wxString::Format(_T("%dx%d"),
+				this->info.displayModes[i].width, this->info.displayModes[i].height));
+	}
+
+	config.Write(_T("/audio/probed"), this->info.hasAudio);
+	config.Write(_T("/audio/defaultPlayback"), this->info.defaultPlaybackDevice);
+	config.Write(_T("/audio/defaultCapture"), this->info.defaultCaptureDevice);
+	config.Write(_T("/audio/playbackCount"), static_cast<long>(this->info.playbackDevices.size()));
+	for (size_t i = 0; i < this->info.playbackDevices.size(); ++i) {
+		const HardwareAudioDevice& device = this->info.playbackDevices[i];
+		const wxString group(wxString::Format(_T("/playback%lu/"), static_cast<unsigned long>(i)));
+		config.Write(group + _T("name"), device.name);
+		config.Write(group + _T("ok"), device.isOk);
+		config.Write(group + _T("version"), device.version);
+		config.Write(group + _T("efx"), device.hasEFX);
+		config.Write(group + _T("sends"), static_cast<long>(device.maxAuxiliarySends));
+	}
+	config.Write(_T("/audio/captureCount"), static_cast<long>(this->info.captureDevices.GetCount()));
+	for (size_t i = 0; i < this->info.captureDevices.GetCount(); ++i) {
+		config.Write(wxString::Format(_T("/capture/%lu"), static_cast<unsigned long>(i)),
+			this->info.captureDevices[i]);
+	}
+
+	config.Write(_T("/joystick/api"), static_cast<long>(this->info.joystickApi));
+	config.Write(_T("/joystick/count"), static_cast<long>(this->info.joysticks.size()));
+	for (size_t i = 0; i < this->info.joysticks.size(); ++i) {
+		const HardwareJoystick& joystick = this->info.joysticks[i];
+		const wxString group(wxString::Format(_T("/joystick%lu/"), static_cast<unsigned long>(i)));
+		config.Write(group + _T("name"), joystick.name);
+		config.Write(group + _T("guid"), joystick.guid);
+		config.Write(group + _T("forceFeedback"), joystick.hasForceFeedback);
+	}
+
+	AtomicFileBatch batch;
+	return batch.Save(config, file) && batch.Commit();
+}
+
+/** Reads a snapshot saved by Save(). Returns NULL if there is none, or if
+ it was saved by a different version of the launcher or has been changed
+ since. */
+HardwareSnapshot* HardwareSnapshot::Load(const wxFileName& file) {
+	if (!file.FileExists()) {
+		return NULL;
+	}
+	wxFFileInputStream input(file.GetFullPath());
+	if (!input.IsOk()) {
+		return NULL;
+	}
+	wxFileConfig config(input);
+	config.SetExpandEnvVars(false);
+
+	long format = 0;
+	wxString savedFingerprint;
+	if (!config.Read(_T("/hardware/format"), &format) || format != HARDWARE_FILE_FORMAT
+		|| !config.Read(_T("/hardware/fingerprint"), &savedFingerprint)) {
+		wxLogDebug(_T("Ignoring hardware cache %s in an old format"),
+			file.GetFullPath().c_str());
+		return NULL;
+	}
+
+	HardwareInfo info;
+	long value = 0;
+	long count = 0;
+
+	config.Read(_T("/display/api"), &value, HardwareInfo::NOT_PROBED);
+	info.displayApi = static_cast<int>(value);
+	config.Read(_T("/display/signature"), &info.displaySignature);
+	config.Read(_T("/display/count"), &count, 0L);
+	for (long i = 0; i < count; ++i) {
+		wxString mode;
+		long width = 0, height = 0;
+		config.Read(wxString::Format(_T("/display/%ld"), i), &mode);
+		if (!mode.BeforeFirst(_T('x')).ToLong(&width)
+			|| !mode.AfterFirst(_T('x')).ToLong(&height)) {
+			return NULL;
+		}
+		info.displayModes.push_back(HardwareDisplayMode(
+			static_cast<int>(width), static_cast<int>(height)));
+	}
+
+	config.Read(_T("/audio/probed"), &info.hasAudio, false);
+	config.Read(_T("/audio/defaultPlayback"), &info.defaultPlaybackDevice);
+	config.Read(_T("/audio/defaultCapture"), &info.defaultCaptureDevice);
+	config.Read(_T("/audio/playbackCount"), &count, 0L);
+	for (long i = 0; i < count; ++i) {
+		HardwareAudioDevice device;
+		const wxString group(wxString::Format(_T("/playback%ld/"), i));
+		config.Read(group + _T("name"), &device.name);
+		config.Read(group + _T("ok"), &device.isOk, false);
+		config.Read(group + _T("version"), &device.version);
+		config.Read(group + _T("efx"), &device.hasEFX, false);
+		config.Read(group + _T("sends"), &value, 0L);
+		device.maxAuxiliarySends = static_cast<int>(value);
+		info.playbackDevices.push_back(device);
+	}
+	config.Read(_T("/audio/captureCount"), &count, 0L);
+	for (long i = 0; i < count; ++i) {
+		wxString device;
+		config.Read(wxString::Format(_T("/capture/%ld"), i), &device);
+		info.captureDevices.Add(device);
+	}
+
+	config.Read(_T("/joystick/api"), &value, HardwareInfo::NOT_PROBED);
+	info.joystickApi = static_cast<int>(value);
+	config.Read(_T("/joystick/count"), &count, 0L);
+	for (long i = 0; i < count; ++i) {
+		HardwareJoystick joystick;
+		const wxString group(wxString::Format(_T("/joystick%ld/"), i));
+		config.Read(group + _T("name"), &joystick.name);
+		config.Read(group + _T("guid"), &joystick.guid);
+		config.Read(group + _T("forceFeedback"), &joystick.hasForceFeedback, false);
+		info.joysticks.push_back(joystick);
+	}
+
+	HardwareSnapshot* snapshot = new HardwareSnapshot(info);
+	if (snapshot->GetFingerprint() != savedFingerprint) {
+		wxLogDebug(_T("Ignoring hardware cache %s, its fingerprint does not match"),
+			file.GetFullPath().c_str());
+		delete snapshot;
+		return NULL;
+	}
+	return snapshot;
+}
+
+void HardwareSnapshot::IncRef() const {
+	wxCriticalSectionLocker lock(this->refLock);
+	this->refCount++;
+}
+
+void HardwareSnapshot::DecRef() const {
+	bool isLast;
+	{
+		wxCriticalSectionLocker lock(this->refLock);
+		wxASSERT_MSG(this->refCount > 0, _T("HardwareSnapshot released too often"));
+		isLast = (--this->refCount == 0);
+	}
+	if (isLast) {
+		delete this;
+	}
+}
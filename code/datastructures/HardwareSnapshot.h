@@ -0,0 +1,151 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef HARDWARE_SNAPSHOT_H
+#define HARDWARE_SNAPSHOT_H
+
+#include <wx/wx.h>
+#include <wx/filename.h>
+#include <wx/thread.h>
+
+#include <vector>
+
+struct HardwareDisplayMode {
+	HardwareDisplayMode(int width, int height) : width(width), height(height) { }
+	int width;
+	int height;
+};
+typedef std::vector<HardwareDisplayMode> HardwareDisplayModes;
+
+struct HardwareAudioDevice {
+	HardwareAudioDevice() : isOk(false), hasEFX(false), maxAuxiliarySends(0) { }
+	wxString name;
+	bool isOk; //!< the device could be opened
+	wxString version; //!< AL_VERSION, or why the device couldn't be opened
+	bool hasEFX;
+	int maxAuxiliarySends;
+};
+typedef std::vector<HardwareAudioDevice> HardwareAudioDevices;
+
+struct HardwareJoystick {
+	HardwareJoystick() : hasForceFeedback(false) { }
+	wxString name;
+	wxString guid;
+	bool hasForceFeedback;
+};
+typedef std::vector<HardwareJoystick> HardwareJoysticks;
+
+/** What was found by probing the hardware. Each part is only filled in if
+ it was probed; the APIs are the ResolutionMan::ApiType and JoyMan::ApiType
+ that were used, or NOT_PROBED. */
+struct HardwareInfo {
+	enum { NOT_PROBED = -1 };
+	HardwareInfo() : displayApi(NOT_PROBED), hasAudio(false), joystickApi(NOT_PROBED) { }
+
+	int displayApi;
+	wxString displaySignature; //!< from ResolutionMan::GetDisplaySignature()
+	HardwareDisplayModes displayModes;
+
+	bool hasAudio;
+	HardwareAudioDevices playbackDevices;
+	wxArrayString captureDevices;
+	wxString defaultPlaybackDevice;
+	wxString defaultCaptureDevice;
+
+	int joystickApi;
+	HardwareJoysticks joysticks; //!< in the order the joystick API numbers them
+};
+
+/** A read-only copy of what the hardware prober found.
+
+ Like ProfileSnapshot, a snapshot is never modified after it is made and
+ is reference counted, so it can be handed between threads freely. Each
+ snapshot has a fingerprint of its contents, so two snapshots with the
+ same fingerprint describe the same hardware. Snapshots can be saved to
+ disk so that the next start can show the hardware without probing it
+ first. */
+class HardwareSnapshot {
+public:
+	explicit HardwareSnapshot(const HardwareInfo& info);
+
+	const HardwareInfo& GetInfo() const { return this->info; }
+	const wxString& GetFingerprint() const { return this->fingerprint; }
+	const HardwareAudioDevice* FindPlaybackDevice(const wxString& name) const;
+
+	bool Save(const wxFileName& file) const;
+	static HardwareSnapshot* Load(const wxFileName& file);
+
+	void IncRef() const;
+	void DecRef() const;
+
+private:
+	~HardwareSnapshot() { }
+	HardwareSnapshot(const HardwareSnapshot&);
+	HardwareSnapshot& operator=(const HardwareSnapshot&);
+
+	static wxString MakeFingerprint(const HardwareInfo& info);
+
+	HardwareInfo info;
+	wxString fingerprint;
+
+	mutable wxCriticalSection refLock;
+	mutable int refCount;
+};
+
+/** Holds one reference to a snapshot. A HardwareSnapshotPtr itself is not
+ thread-safe; give each thread its own copy. */
+class HardwareSnapshotPtr {
+public:
+	HardwareSnapshotPtr() : snapshot(NULL) { }
+	explicit HardwareSnapshotPtr(const HardwareSnapshot* snapshot)
+	: snapshot(snapshot) {
+		if (this->snapshot != NULL) {
+			this->snapshot->IncRef();
+		}
+	}
+	HardwareSnapshotPtr(const HardwareSnapshotPtr& other)
+	: snapshot(other.snapshot) {
+		if (this->snapshot != NULL) {
+			this->snapshot->IncRef();
+		}
+	}
+	~HardwareSnapshotPtr() {
+		if (this->snapshot != NULL) {
+			this->snapshot->DecRef();
+		}
+	}
+	HardwareSnapshotPtr& operator=(const HardwareSnapshotPtr& other) {
+		if (other.snapshot != NULL) {
+			other.snapshot->IncRef();
+		}
+		if (this->snapshot != NULL) {
+			this->snapshot->DecRef();
+		}
+		this->snapshot = other.snapshot;
+		return *this;
+	}
+
+	bool IsOk() const { return this->snapshot != NULL; }
+	const HardwareSnapshot* operator->() const { return this->snapshot; }
+	const HardwareSnapshot& operator*() const { return *this->snapshot; }
+
+private:
+	const HardwareSnapshot* snapshot;
+};
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/ffile.h>
+#include <wx/tokenzr.h>
+
+#include "datastructures/LaunchHistory.h"
+#include "global/AtomicFileBatch.h"
+#include "global/ProfileKeys.h"
+
+#include <algorithm>
+#include <map>
+
+#include "global/MemoryDebugging.h"
+
+namespace
+{
+	const wxString LAUNCH_HISTORY_FILE_NAME(_T("launches.tsv"));
+	const wxString LAUNCH_HISTORY_HEADER(_T("# wxLauncher launch history, format 1"));
+	const size_t FIELD_COUNT = 4 + LaunchRecord::PHASE_COUNT + 1;
+	/** Trim() is only needed once the file is this big. */
+	const wxFileOffset MAX_FILE_BYTES = 1024 * 1024;
+}
+
+LaunchRecord::LaunchRecord()
+: startedAt(0), exitCode(-1) {
+	for (int i = 0; i < PHASE_COUNT; ++i) {
+		this->phaseTimes[i] = NOT_MEASURED;
+	}
+}
+
+wxString LaunchRecord::GetPhaseDescription(Phase phase) {
+	switch (phase) {
+		case PHASE_MIGRATE_CONFIG:
+			return _("Migrate");
+		case PHASE_PUSH_PROFILE:
+			return _("Settings");
+		case PHASE_SYNC_PILOTS:
+			return _("Pilots");
+		case PHASE_EXEC:
+			return _("Exec");
+		case PHASE_FIRST_OUTPUT:
+			return _("First output");
+		case PHASE_RUN:
+			return _("Run time");
+		default:
+			wxFAIL_MSG(wxString::Format(_T("Unknown launch phase %d"), phase));
+			return wxEmptyString;
+	}
+}
+
+LaunchSummary::LaunchSummary()
+: launches(0) {
+	for (int i = 0; i < LaunchRecord::PHASE_COUNT; ++i) {
+		this->median[i] = LaunchRecord::NOT_MEASURED;
+		this->slowest90[i] = LaunchRecord::NOT_MEASURED;
+	}
+}
+
+wxFileName LaunchHistory::GetFile() {
+	return wxFileName(GetProfileStorageFolder(), LAUNCH_HISTORY_FILE_NAME);
+}
+
+/** Mod and flag lines are user supplied, so keep them on one field. */
+static wxString Escape(const wxString& str) {
+	wxString escaped;
+	escaped.Alloc(str.length());
+	for (size_t i = 0; i < str.length(); ++i) {
+		switch (static_cast<wxChar>(str[i])) {
+			case _T('\\'): escaped += _T("\\\\"); break;
+			case _T('\t'): escaped += _T("\\t"); break;
+			case _T('\n'): escaped += _T("\\n"); break;
+			case _T('\r'): escaped += _T("\\r"); break;
+			default: escaped += str[i]; break;
+		}
+	}
+	return escaped;
+}
+
+static wxString Unescape(const wxString& str) {
+	wxString unescaped;
+	unescaped.Alloc(str.length());
+	for (size_t i = 0; i < str.length(); ++i) {
+		if (str[i] != _T('\\') || i + 1 == str.length()) {
+			unescaped += str[i];
+			continue;
+		}
+		switch (static_cast<wxChar>(str[++i])) {
+			case _T('t'): unescaped += _T('\t'); break;
+			case _T('n'): unescaped += _T('\n'); break;
+			case _T('r'): unescaped += _T('\r'); break;
+			default: unescaped += str[i]; break;
+		}
+	}
+	return unescaped;
+}
+
+wxString LaunchHistory::FormatRecord(const LaunchRecord& record) {
+	wxString line;
+	line << static_cast<long>(record.startedAt)
+		<< _T('\t') << Escape(record.binary)
+		<< _T('\t') << Escape(record.modLine)
+		<< _T('\t') << Escape(record.flagLine);
+	for (int i = 0; i < LaunchRecord::PHASE_COUNT; ++i) {
+		line << _T('\t') << record.phaseTimes[i];
+	}
+	line << _T('\t') << record.exitCode << _T('\n');
+	return line;
+}
+
+bool LaunchHistory::ParseRecord(const wxString& line, LaunchRecord& record) {
+	const wxArrayString fields(wxStringTokenize(line, _T("\t"), wxTOKEN_RET_EMPTY_ALL));
+	if (fields.GetCount() != FIELD_COUNT) {
+		return false;
+	}
+	long value;
+	if (!fields[0].ToLong(&value)) {
+		return false;
+	}
+	record.startedAt = static_cast<time_t>(value);
+	record.binary = Unescape(fields[1]);
+	record.modLine = Unescape(fields[2]);
+	record.flagLine = Unescape(fields[3]);
+	for (int i = 0; i < LaunchRecord::PHASE_COUNT; ++i) {
+		if (!fields[4 + i].ToLong(&record.phaseTimes[i])) {
+			return false;
+		}
+	}
+	if (!fields[FIELD_COUNT - 1].ToLong(&value)) {
+		return false;
+	}
+	record.exitCode = static_cast<int>(value);
+	return true;
+}
+
+/** Adds record to the end of the history. */
+bool LaunchHistory::Append(const LaunchRecord& record) {
+	const wxFileName file(GetFile());
+	const bool isNew = !file.FileExists();
+	wxFFile history(file.GetFullPath(), _T("ab"));
+	if (!history.IsOpened()) {
+		wxLogWarning(_T("Unable to open the launch history %s"), file.GetFullPath().c_str());
+		return false;
+	}
+	wxString text;
+	if (isNew) {
+		text << LAUNCH_HISTORY_HEADER << _T('\n');
+	}
+	text << FormatRecord(record);
+	const wxCharBuffer bytes(text.mb_str(wxConvUTF8));
+	const size_t length = strlen(bytes.data());
+	if (history.Write(bytes.data(), length) != length || !history.Close()) {
+		wxLogWarning(_T("Unable to write to the launch history %s"), file.GetFullPath().c_str());
+		return false;
+	}
+	return (file.GetSize() < MAX_FILE_BYTES) || Trim();
+}
+
+/** Reads the history, oldest launch first. Lines that can't be read are
+ skipped. */
+bool LaunchHistory::Load(LaunchRecords& records) {
+	records.clear();
+	const wxFileName file(GetFile());
+	if (!file.FileExists()) {
+		return true;
+	}
+	wxFFile history(file.GetFullPath(), _T("rb"));
+	wxString contents;
+	if (!history.IsOpened() || !history.ReadAll(&contents, wxConvUTF8)) {
+		wxLogWarning(_T("Unable to read the launch history %s"), file.GetFullPath().c_str());
+		return false;
+	}
+
+	wxStringTokenizer lines(contents, _T("\n"));
+	while (lines.HasMoreTokens()) {
+		const wxString line(lines.GetNextToken());
+		LaunchRecord record;
+		if (line.StartsWith(_T("#")) || line.IsEmpty()) {
+			continue;
+		} else if (ParseRecord(line, record)) {
+			records.push_back(record);
+		} else {
+			wxLogDebug(_T("Skipping unreadable launch history line '%s'"), line.c_str());
+		}
+	}
+	return true;
+}
+
+/** Rewrites the history with only the most recent launches, keeping it to
+ MAX_RECORDS launches and half of MAX_FILE_BYTES. */
+bool LaunchHistory::Trim() {
+	LaunchRecords records;
+	if (!Load(records)) {
+		return false;
+	}
+	std::vector<wxString> kept;
+	size_t keptBytes = 0;
+	for (LaunchRecords::reverse_iterator it = records.rbegin(), end = records.rend();
+		 it != end && kept.size() < MAX_RECORDS; ++it) {
+		const wxString line(FormatRecord(*it));
+		keptBytes += line.length();
+		if (keptBytes > static_cast<size_t>(MAX_FILE_BYTES / 2)) {
+			break;
+		}
+		kept.push_back(line);
+	}
+
+	wxString text(LAUNCH_HISTORY_HEADER + _T("\n"));
+	for (std::vector<wxString>::reverse_iterator it = kept.rbegin(), end = kept.rend();
+		 it != end; ++it) {
+		text << *it;
+	}
+	const wxCharBuffer bytes(text.mb_str(wxConvUTF8));
+	AtomicFileBatch batch;
+	return batch.SaveBytes(bytes.data(), strlen(bytes.data()), GetFile()) && batch.Commit();
+}
+
+/** Nearest rank percentile of sorted, which must not be empty. */
+static long Percentile(const std::vector<long>& sorted, int percent) {
+	size_t rank = (sorted.size() * percent + 99) / 100;
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/** Groups records by executable and mod line, sorted by executable. */
+void LaunchHistory::Summarize(const LaunchRecords& records, LaunchSummaries& summaries) {
+	typedef std::map<std::pair<wxString, wxString>, std::vector<const LaunchRecord*> > Groups;
+	Groups groups;
+	for (LaunchRecords::const_iterator it = records.begin(), end = records.end();
+		 it != end; ++it) {
+		groups[std::make_pair(it->binary, it->modLine)].push_back(&(*it));
+	}
+
+	summaries.clear();
+	for (Groups::const_iterator group = groups.begin(), end = groups.end();
+		 group != end; ++group) {
+		LaunchSummary summary;
+		summary.binary = group->first.first;
+		summary.modLine = group->first.second;
+		summary.launches = group->second.size();
+		for (int phase = 0; phase < LaunchRecord::PHASE_COUNT; ++phase) {
+			std::vector<long> times;
+			for (size_t i = 0; i < group->second.size(); ++i) {
+				const long time = group->second[i]->phaseTimes[phase];
+				if (time != LaunchRecord::NOT_MEASURED) {
+					times.push_back(time);
+				}
+			}
+			if (!times.empty()) {
+				std::sort(times.begin(), times.end());
+				summary.median[phase] = Percentile(times, 50);
+				summary.slowest90[phase] = Percentile(times, 90);
+			}
+		}
+		summaries.push_back(summary);
+	}
+}
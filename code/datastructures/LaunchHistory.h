@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef LAUNCHHISTORY_H
+#define LAUNCHHISTORY_H
+
+#include <wx/wx.h>
+#include <wx/filename.h>
+
+#include <vector>
+
+/** How long each part of one launch of FS2 Open or FRED took. */
+struct LaunchRecord {
+	enum Phase {
+		PHASE_MIGRATE_CONFIG,
+		PHASE_PUSH_PROFILE,
+		PHASE_SYNC_PILOTS,
+		PHASE_EXEC,
+		PHASE_FIRST_OUTPUT, //!< from exec to the first line the executable wrote
+		PHASE_RUN, //!< from exec to the executable exiting
+		PHASE_COUNT
+	};
+	enum { NOT_MEASURED = -1 };
+
+	LaunchRecord();
+
+	static wxString GetPhaseDescription(Phase phase);
+
+	time_t startedAt;
+	wxString binary;
+	wxString modLine;
+	wxString flagLine;
+	long phaseTimes[PHASE_COUNT]; //!< ms, or NOT_MEASURED
+	int exitCode;
+};
+typedef std::vector<LaunchRecord> LaunchRecords;
+
+/** The launches of one executable with one mod line. */
+struct LaunchSummary {
+	LaunchSummary();
+	wxString binary;
+	wxString modLine;
+	size_t launches;
+	long median[LaunchRecord::PHASE_COUNT]; //!< ms, or LaunchRecord::NOT_MEASURED
+	long slowest90[LaunchRecord::PHASE_COUNT]; //!< 90th percentile
+};
+typedef std::vector<LaunchSummary> LaunchSummaries;
+
+/** The launches made from this launcher, kept in a tab separated file in
+ the profile storage folder with one line per launch. Only the most recent
+ MAX_RECORDS launches are kept. */
+class LaunchHistory {
+public:
+	enum { MAX_RECORDS = 1000 };
+
+	static bool Append(const LaunchRecord& record);
+	static bool Load(LaunchRecords& records);
+	static void Summarize(const LaunchRecords& records, LaunchSummaries& summaries);
+	static wxFileName GetFile();
+
+private:
+	static wxString FormatRecord(const LaunchRecord& record);
+	static bool ParseRecord(const wxString& line, LaunchRecord& record);
+	static bool Trim();
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/tokenzr.h>
+
+#include "datastructures/LaunchPreset.h"
+#include "global/ProfileKeys.h"
+
+#include "global/MemoryDebugging.h"
+
+namespace
+{
+	const long MAX_CPU = 1023; // the most a cpu_set_t holds
+
+	// threaded GL for NVIDIA's and Mesa's drivers, and glibc's malloc
+	// backed by huge pages where it supports them
+	const wxChar* const PERFORMANCE_ENVIRONMENT[] = {
+		_T("__GL_THREADED_OPTIMIZATIONS=1"),
+		_T("mesa_glthread=true"),
+		_T("__GL_SYNC_TO_VBLANK=0"),
+		_T("vblank_mode=0"),
+		_T("GLIBC_TUNABLES=glibc.malloc.hugetlb=1"),
+		NULL
+	};
+	const wxChar* const VSYNC_ENVIRONMENT[] = {
+		_T("__GL_THREADED_OPTIMIZATIONS=1"),
+		_T("mesa_glthread=true"),
+		_T("__GL_SYNC_TO_VBLANK=1"),
+		_T("vblank_mode=3"),
+		NULL
+	};
+	const wxChar* const NO_ENVIRONMENT[] = {
+		NULL
+	};
+
+	// the descriptions are translated where they are shown
+	const LaunchPreset PRESETS[] = {
+		{ _T("performance"), wxTRANSLATE("Performance (threaded GL, no vsync)"),
+			0, ProcessOptions::IO_CLASS_BEST_EFFORT, 0, PERFORMANCE_ENVIRONMENT },
+		{ _T("performance-priority"), wxTRANSLATE("Performance, higher priority (needs permission)"),
+			-10, ProcessOptions::IO_CLASS_BEST_EFFORT, 0, PERFORMANCE_ENVIRONMENT },
+		{ _T("vsync"), wxTRANSLATE("Threaded GL with vsync"),
+			0, ProcessOptions::IO_CLASS_DEFAULT, 4, VSYNC_ENVIRONMENT },
+		{ _T("background"), wxTRANSLATE("Low impact (lower priority, idle I/O)"),
+			10, ProcessOptions::IO_CLASS_IDLE, 7, NO_ENVIRONMENT },
+	};
+}
+
+size_t LaunchPreset::GetCount() {
+	return WXSIZEOF(PRESETS);
+}
+
+const LaunchPreset& LaunchPreset::Get(size_t i) {
+	wxASSERT_MSG(i < WXSIZEOF(PRESETS),
+		wxString::Format(_T("There is no launch preset %lu"), static_cast<unsigned long>(i)));
+	return PRESETS[i];
+}
+
+/** Returns NULL if no preset has that name. */
+const LaunchPreset* LaunchPreset::Find(const wxString& name) {
+	for (size_t i = 0; i < WXSIZEOF(PRESETS); ++i) {
+		if (name == PRESETS[i].name) {
+			return &PRESETS[i];
+		}
+	}
+	return NULL;
+}
+
+/** Reads a list of CPUs written as taskset does, such as "0-3,6". An empty
+ list means any CPU. */
+bool LaunchPreset::ParseCpus(const wxString& cpuList, std::vector<int>& cpus) {
+	cpus.clear();
+	if (cpuList.Strip(wxString::both).IsEmpty()) {
+		return true;
+	}
+	wxStringTokenizer ranges(cpuList, _T(","), wxTOKEN_RET_EMPTY_ALL);
+	while (ranges.HasMoreTokens()) {
+		const wxString range(ranges.GetNextToken().Strip(wxString::both));
+		long first, last;
+		if (range.Find(_T('-')) == wxNOT_FOUND) {
+			if (!range.ToLong(&first)) {
+				return false;
+			}
+			last = first;
+		} else if (!range.BeforeFirst(_T('-')).Strip(wxString::both).ToLong(&first)
+			|| !range.AfterFirst(_T('-')).Strip(wxString::both).ToLong(&last)) {
+			return false;
+		}
+		if (first < 0 || last > MAX_CPU || first > last) {
+			return false;
+		}
+		for (long cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(static_cast<int>(cpu));
+		}
+	}
+	return true;
+}
+
+/** Works out how the profile wants FS2 Open run. Returns false with error
+ set if the profile's preset or CPUs can't be used. */
+bool LaunchPreset::GetProcessOptions(const ProfileSnapshot& profile,
+	ProcessOptions& options, wxString& error) {
+	options = ProcessOptions();
+
+	wxString cpuList;
+	profile.Read(PRO_CFG_LAUNCH_CPUS, &cpuList, wxEmptyString);
+	if (!ParseCpus(cpuList, options.cpus)) {
+		error = wxString::Format(_T("'%s' is not a list of CPUs to run on (%s)"),
+			cpuList.c_str(), PRO_CFG_LAUNCH_CPUS.c_str());
+		return false;
+	}
+
+	wxString name;
+	profile.Read(PRO_CFG_LAUNCH_PRESET, &name, wxEmptyString);
+	if (name.IsEmpty()) {
+		return true;
+	}
+	const LaunchPreset* preset = Find(name);
+	if (preset == NULL) {
+		error = wxString::Format(_T("There is no launch preset called '%s' (%s)"),
+			name.c_str(), PRO_CFG_LAUNCH_PRESET.c_str());
+		return false;
+	}
+	options.niceness = preset->niceness;
+	options.ioClass = preset->ioClass;
+	options.ioLevel = preset->ioLevel;
+	for (const wxChar* const* var = preset->environment; *var != NULL; ++var) {
+		options.environment.Add(*var);
+	}
+	return true;
+}
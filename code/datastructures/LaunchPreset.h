@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef LAUNCHPRESET_H
+#define LAUNCHPRESET_H
+
+#include <wx/wx.h>
+
+#include <vector>
+
+#include "apis/ProcessSupervisor.h"
+#include "datastructures/ProfileSnapshot.h"
+
+/** A built-in way of running FS2 Open for speed or for staying out of the
+ way: a priority, an I/O class and a curated environment. Which preset a
+ profile uses is stored by name, in PRO_CFG_LAUNCH_PRESET. The CPUs to run
+ on are stored apart from the preset, in PRO_CFG_LAUNCH_CPUS, as they
+ depend on the machine. */
+struct LaunchPreset {
+	const wxChar* name; //!< stored in profiles, never translated
+	const wxChar* description;
+	int niceness;
+	ProcessOptions::IoClass ioClass;
+	int ioLevel;
+	const wxChar* const* environment; //!< NAME=value, NULL terminated
+
+	static size_t GetCount();
+	static const LaunchPreset& Get(size_t i);
+	static const LaunchPreset* Find(const wxString& name);
+
+	static bool ParseCpus(const wxString& cpuList, std::vector<int>& cpus);
+	static bool GetProcessOptions(const ProfileSnapshot& profile,
+		ProcessOptions& options, wxString& error);
+};
+
+#endif
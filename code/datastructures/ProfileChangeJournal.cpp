@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/log.h>
+#include "datastructures/ProfileChangeJournal.h"
+
+#include "global/MemoryDebugging.h"
+
+ProfileChangeJournal::ProfileChangeJournal()
+: changedCount(0) {
+}
+
+void ProfileChangeJournal::Record(const wxConfigBase& config,
+	const wxString& key, const wxString* newValue) {
+	wxCHECK_RET(!key.IsEmpty(), _T("ProfileChangeJournal::Record given empty key"));
+	
+	ProfileChangeJournalEntries::iterator found = this->entries.find(key);
+	if (found == this->entries.end()) {
+		ProfileChangeJournalEntry entry;
+		entry.existed = config.HasEntry(key);
+		if (entry.existed) {
+			config.Read(key, &entry.originalValue);
+		}
+		found = this->entries.insert(
+			ProfileChangeJournalEntries::value_type(key, entry)).first;
+	}
+	
+	ProfileChangeJournalEntry& entry = found->second;
+	const bool isChanged = (newValue == NULL)
+		? entry.existed
+		: (!entry.existed || entry.originalValue != *newValue);
+	
+	if (isChanged && !entry.isChanged) {
+		this->changedCount++;
+	} else if (!isChanged && entry.isChanged) {
+		wxASSERT(this->changedCount > 0);
+		this->changedCount--;
+	}
+	entry.isChanged = isChanged;
+}
+
+void ProfileChangeJournal::Revert(wxConfigBase& config) {
+	for (ProfileChangeJournalEntries::const_iterator it = this->entries.begin(),
+		 end = this->entries.end(); it != end; ++it) {
+		const wxString& key = it->first;
+		const ProfileChangeJournalEntry& entry = it->second;
+		
+		if (!entry.isChanged) {
+			continue;
+		}
+		if (entry.existed) {
+			config.Write(key, entry.originalValue);
+		} else if (config.HasEntry(key)) {
+			config.DeleteEntry(key, true);
+		}
+		wxLogDebug(_T("reverted profile entry %s"), key.c_str());
+	}
+	this->Clear();
+}
+
+void ProfileChangeJournal::Clear() {
+	this->entries.clear();
+	this->changedCount = 0;
+}
+
+void ProfileChangeJournal::LogChanges() const {
+	wxLogDebug(_T("%lu unsaved change(s):"),
+		static_cast<unsigned long>(this->changedCount));
+	for (ProfileChangeJournalEntries::const_iterator it = this->entries.begin(),
+		 end = this->entries.end(); it != end; ++it) {
+		if (it->second.isChanged) {
+			const wxString original(it->second.existed
+				? it->second.originalValue : wxString(_T("absent")));
+			wxLogDebug(_T(" %s (was %s)"), it->first.c_str(), original.c_str());
+		}
+	}
+}
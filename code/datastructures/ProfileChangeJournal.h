@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROFILE_CHANGE_JOURNAL_H
+#define PROFILE_CHANGE_JOURNAL_H
+
+#include <wx/string.h>
+#include <wx/config.h>
+#include <wx/hashmap.h>
+
+/** The value a journaled key had before its first change. */
+struct ProfileChangeJournalEntry {
+	ProfileChangeJournalEntry() : existed(false), isChanged(false) { } // required for wxHashMap
+	bool existed; //!< whether the key was present at all
+	wxString originalValue;
+	bool isChanged; //!< whether the key's value currently differs from the original
+};
+
+WX_DECLARE_STRING_HASH_MAP(ProfileChangeJournalEntry, ProfileChangeJournalEntries);
+
+/** Records the changes made to a profile since it was last saved or loaded.
+
+ For every key that is written or deleted, the journal keeps the value the
+ key had before its first change and whether its value differs from that
+ now, along with a count of such keys. This makes asking whether there are
+ unsaved changes a constant time operation, and reverting only touches
+ the keys that were changed. */
+class ProfileChangeJournal {
+public:
+	ProfileChangeJournal();
+	
+	/** Records that key in config is about to be set to newValue, or to be
+	 deleted if newValue is NULL. Must be called before the change is made. */
+	void Record(const wxConfigBase& config, const wxString& key,
+		const wxString* newValue);
+	
+	/** Returns true when at least one key differs from its original value. */
+	bool HasChanges() const { return this->changedCount > 0; }
+	/** Returns the number of keys that differ from their original values. */
+	size_t GetChangeCount() const { return this->changedCount; }
+	
+	/** Restores the original value of every changed key in config,
+	 then clears the journal. */
+	void Revert(wxConfigBase& config);
+	
+	/** Forgets all recorded changes, making the current values the originals. */
+	void Clear();
+	
+	void LogChanges() const;
+	
+private:
+	ProfileChangeJournalEntries entries;
+	size_t changedCount;
+};
+
+#endif
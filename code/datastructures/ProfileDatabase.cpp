@@ -0,0 +1,382 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <wx/wx.h>
+#include <wx/ffile.h>
+
+#include "generated/configure_launcher.h"
+#include "datastructures/ProfileDatabase.h"
+#include "global/AtomicFileBatch.h"
+
+#if IS_WIN32
+#include <io.h>
+#else
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+#include "global/MemoryDebugging.h"
+
+#define PROFILE_DATABASE_HEADER "# wxLauncher profile database, version 1"
+/** Files with fewer records than this are never worth compacting. */
+#define COMPACTION_MIN_RECORDS 512
+
+// record types
+#define RECORD_ADD_PROFILE wxT_2('P')
+#define RECORD_DROP_PROFILE wxT_2('X')
+#define RECORD_SET_KEY wxT_2('S')
+#define RECORD_DELETE_KEY wxT_2('D')
+
+const wxString ProfileDatabase::GLOBAL_SETTINGS(wxEmptyString);
+
+ProfileDatabase::ProfileDatabase(const wxFileName& file)
+: file(file), recordCount(0), mustRewrite(true) {
+}
+
+bool ProfileDatabase::Load() {
+	this->profiles.clear();
+	this->pending.Clear();
+	this->recordCount = 0;
+	this->mustRewrite = true;
+	
+	const wxString path(this->file.GetFullPath());
+	if (!this->file.FileExists()) {
+		return true;
+	}
+	
+	wxFFile in(path, wxT_2("rb"));
+	if (!in.IsOpened()) {
+		wxLogError(_("Unable to open profile database %s"), path.c_str());
+		return false;
+	}
+	const wxFileOffset fileLength = in.Length();
+	if (fileLength == wxInvalidOffset) {
+		wxLogError(_("Unable to read profile database %s"), path.c_str());
+		return false;
+	}
+	const size_t length = static_cast<size_t>(fileLength);
+	wxMemoryBuffer contents;
+	if (in.Read(contents.GetWriteBuf(length), length) != length) {
+		wxLogError(_("Unable to read profile database %s"), path.c_str());
+		return false;
+	}
+	contents.UngetWriteBuf(length);
+	const char* data = static_cast<const char*>(contents.GetData());
+	
+	const size_t headerLength = strlen(PROFILE_DATABASE_HEADER);
+	if (length <= headerLength
+		|| strncmp(data, PROFILE_DATABASE_HEADER, headerLength) != 0
+		|| data[headerLength] != '\n') {
+		wxLogError(_("%s is not a profile database"), path.c_str());
+		return false;
+	}
+	
+	// each line is the record's checksum as 8 hex digits, a tab and the record
+	bool isDamaged = false;
+	size_t pos = headerLength + 1;
+	while (pos < length) {
+		const char* line = data + pos;
+		const char* end = static_cast<const char*>(memchr(line, '\n', length - pos));
+		if (end == NULL || end - line < 10 || line[8] != '\t') {
+			isDamaged = true;
+			break;
+		}
+		char checksum[9];
+		memcpy(checksum, line, 8);
+		checksum[8] = '\0';
+		const size_t recordLength = static_cast<size_t>(end - line) - 9;
+		if (strtoul(checksum, NULL, 16) != Checksum(line + 9, recordLength)
+			|| !this->ApplyRecord(wxString::FromUTF8(line + 9, recordLength))) {
+			isDamaged = true;
+			break;
+		}
+		this->recordCount++;
+		pos = static_cast<size_t>(end - data) + 1;
+	}
+	
+	if (isDamaged) {
+		// the rest cannot be trusted, and appending after a torn record
+		// would hide the new records too, so the next Flush() rewrites
+		wxLogWarning(_("Profile database %s is damaged after record %lu, ignoring the rest of it"),
+			path.c_str(), static_cast<unsigned long>(this->recordCount));
+	} else {
+		this->mustRewrite = false;
+	}
+	wxLogDebug(wxT_2("Read %lu records for %lu profiles from %s"),
+		static_cast<unsigned long>(this->recordCount),
+		static_cast<unsigned long>(this->profiles.size()), path.c_str());
+	return true;
+}
+
+bool ProfileDatabase::HasProfile(const wxString& name) const {
+	return this->profiles.find(name) != this->profiles.end();
+}
+
+wxArrayString ProfileDatabase::GetProfileNames() const {
+	wxArrayString names;
+	for (ProfileDatabaseIndex::const_iterator it = this->profiles.begin(),
+		 end = this->profiles.end(); it != end; ++it) {
+		if (it->first != GLOBAL_SETTINGS) {
+			names.Add(it->first);
+		}
+	}
+	return names;
+}
+
+const ProfileEntryValues* ProfileDatabase::GetEntries(const wxString& name) const {
+	ProfileDatabaseIndex::const_iterator found = this->profiles.find(name);
+	return (found == this->profiles.end()) ? NULL : &found->second;
+}
+
+void ProfileDatabase::Update(const wxString& name, const ProfileEntryValues& entries) {
+	if (!this->HasProfile(name)) {
+		this->AddRecord(RECORD_ADD_PROFILE, name);
+	}
+	ProfileEntryValues& stored = this->profiles[name];
+	
+	wxArrayString removed;
+	for (ProfileEntryValues::const_iterator it = stored.begin(),
+		 end = stored.end(); it != end; ++it) {
+		if (entries.find(it->first) == entries.end()) {
+			removed.Add(it->first);
+		}
+	}
+	for (size_t i = 0; i < removed.GetCount(); ++i) {
+		this->AddRecord(RECORD_DELETE_KEY, name, removed[i]);
+		stored.erase(removed[i]);
+	}
+	
+	for (ProfileEntryValues::const_iterator it = entries.begin(),
+		 end = entries.end(); it != end; ++it) {
+		ProfileEntryValues::const_iterator old = stored.find(it->first);
+		if (old == stored.end() || old->second != it->second) {
+			this->AddRecord(RECORD_SET_KEY, name, it->first, it->second);
+			stored[it->first] = it->second;
+		}
+	}
+}
+
+void ProfileDatabase::Drop(const wxString& name) {
+	ProfileDatabaseIndex::iterator found = this->profiles.find(name);
+	if (found != this->profiles.end()) {
+		this->AddRecord(RECORD_DROP_PROFILE, name);
+		this->profiles.erase(found);
+	}
+}
+
+bool ProfileDatabase::Flush() {
+	if (this->mustRewrite) {
+		return this->Compact();
+	}
+	if (this->pending.IsEmpty()) {
+		return true;
+	}
+	return this->AppendPending();
+}
+
+bool ProfileDatabase::AppendPending() {
+	const wxString path(this->file.GetFullPath());
+	const wxCharBuffer buffer(this->pending.mb_str(wxConvUTF8));
+	const size_t length = strlen(buffer.data());
+	
+	wxFFile out(path, wxT_2("ab"));
+	bool ok = out.IsOpened();
+	ok = ok && (out.Write(buffer.data(), length) == length);
+	ok = ok && out.Flush();
+#if IS_WIN32
+	ok = ok && (_commit(_fileno(out.fp())) == 0);
+#elif IS_LINUX
+	ok = ok && (fdatasync(fileno(out.fp())) == 0);
+#else
+	ok = ok && (fsync(fileno(out.fp())) == 0);
+#endif
+	ok = out.Close() && ok;
+	
+	if (!ok) {
+		wxLogError(_("Unable to append to profile database %s"), path.c_str());
+		// part of the records may have made it, so start over from the index
+		this->mustRewrite = true;
+		return false;
+	}
+	this->pending.Clear();
+	return true;
+}
+
+bool ProfileDatabase::Compact() {
+	const size_t oldRecordCount = this->recordCount;
+	this->pending.Clear();
+	this->recordCount = 0;
+	
+	for (ProfileDatabaseIndex::const_iterator it = this->profiles.begin(),
+		 end = this->profiles.end(); it != end; ++it) {
+		this->AddRecord(RECORD_ADD_PROFILE, it->first);
+		for (ProfileEntryValues::const_iterator entry = it->second.begin(),
+			 entryEnd = it->second.end(); entry != entryEnd; ++entry) {
+			this->AddRecord(RECORD_SET_KEY, it->first, entry->first, entry->second);
+		}
+	}
+	
+	wxString contents(wxString::FromUTF8(PROFILE_DATABASE_HEADER));
+	contents += wxT_2("\n");
+	contents += this->pending;
+	this->pending.Clear();
+	
+	const wxCharBuffer buffer(contents.mb_str(wxConvUTF8));
+	AtomicFileBatch batch;
+	if (!batch.SaveBytes(buffer.data(), strlen(buffer.data()), this->file)
+		|| !batch.Commit()) {
+		wxLogError(_("Unable to write profile database %s"),
+			this->file.GetFullPath().c_str());
+		this->mustRewrite = true;
+		return false;
+	}
+	
+	wxLogDebug(wxT_2("Compacted profile database from %lu to %lu records"),
+		static_cast<unsigned long>(oldRecordCount),
+		static_cast<unsigned long>(this->recordCount));
+	this->mustRewrite = false;
+	return true;
+}
+
+bool ProfileDatabase::NeedsCompaction() const {
+	return this->recordCount >= COMPACTION_MIN_RECORDS
+		&& this->recordCount > 2 * this->GetLiveRecordCount();
+}
+
+size_t ProfileDatabase::GetLiveRecordCount() const {
+	size_t count = 0;
+	for (ProfileDatabaseIndex::const_iterator it = this->profiles.begin(),
+		 end = this->profiles.end(); it != end; ++it) {
+		count += 1 + it->second.size();
+	}
+	return count;
+}
+
+void ProfileDatabase::AddRecord(wxChar type, const wxString& name,
+	const wxString& key, const wxString& value) {
+	wxString record(type);
+	AppendField(record, name);
+	if (type == RECORD_SET_KEY || type == RECORD_DELETE_KEY) {
+		AppendField(record, key);
+	}
+	if (type == RECORD_SET_KEY) {
+		AppendField(record, value);
+	}
+	this->pending += EncodeRecord(record);
+	this->recordCount++;
+}
+
+/** Replays one record into the index. Returns false if it is malformed. */
+bool ProfileDatabase::ApplyRecord(const wxString& record) {
+	wxArrayString fields;
+	if (!SplitFields(record, fields) || fields[0].Len() != 1) {
+		return false;
+	}
+	
+	const wxChar type = fields[0][0];
+	if (type == RECORD_ADD_PROFILE && fields.GetCount() == 2) {
+		this->profiles[fields[1]];
+	} else if (type == RECORD_DROP_PROFILE && fields.GetCount() == 2) {
+		this->profiles.erase(fields[1]);
+	} else if (type == RECORD_SET_KEY && fields.GetCount() == 4) {
+		this->profiles[fields[1]][fields[2]] = fields[3];
+	} else if (type == RECORD_DELETE_KEY && fields.GetCount() == 3) {
+		ProfileDatabaseIndex::iterator found = this->profiles.find(fields[1]);
+		if (found != this->profiles.end()) {
+			found->second.erase(fields[2]);
+		}
+	} else {
+		return false;
+	}
+	return true;
+}
+
+/** Returns the record as a line of the file, checksum first. */
+wxString ProfileDatabase::EncodeRecord(const wxString& record) {
+	const wxCharBuffer utf8(record.mb_str(wxConvUTF8));
+	return wxString::Format(wxT_2("%08lx\t%s\n"),
+		Checksum(utf8.data(), strlen(utf8.data())), record.c_str());
+}
+
+/** Appends a tab and field to record, escaping the characters that would
+ otherwise end the field or the record. */
+void ProfileDatabase::AppendField(wxString& record, const wxString& field) {
+	record += wxT_2('\t');
+	for (size_t i = 0; i < field.Len(); ++i) {
+		const wxChar c = field[i];
+		switch (c) {
+			case wxT_2('\\'): record += wxT_2("\\\\"); break;
+			case wxT_2('\t'): record += wxT_2("\\t"); break;
+			case wxT_2('\n'): record += wxT_2("\\n"); break;
+			case wxT_2('\r'): record += wxT_2("\\r"); break;
+			default: record += c; break;
+		}
+	}
+}
+
+/** Splits a record at its tabs, undoing AppendField()'s escapes.
+ Returns false if the record has a bad escape. */
+bool ProfileDatabase::SplitFields(const wxString& record, wxArrayString& fields) {
+	wxString field;
+	for (size_t i = 0; i < record.Len(); ++i) {
+		const wxChar c = record[i];
+		if (c == wxT_2('\t')) {
+			fields.Add(field);
+			field.Clear();
+		} else if (c != wxT_2('\\')) {
+			field += c;
+		} else if (++i < record.Len()) {
+			switch (static_cast<wxChar>(record[i])) {
+				case wxT_2('\\'): field += wxT_2('\\'); break;
+				case wxT_2('t'): field += wxT_2('\t'); break;
+				case wxT_2('n'): field += wxT_2('\n'); break;
+				case wxT_2('r'): field += wxT_2('\r'); break;
+				default: return false;
+			}
+		} else {
+			return false;
+		}
+	}
+	fields.Add(field);
+	return true;
+}
+
+/** CRC-32 as used by zip and PNG. */
+unsigned long ProfileDatabase::Checksum(const char* data, size_t length) {
+	static unsigned long table[256];
+	static bool isTableReady = false;
+	if (!isTableReady) {
+		for (unsigned long n = 0; n < 256; ++n) {
+			unsigned long c = n;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xEDB88320UL ^ (c >> 1)) : (c >> 1);
+			}
+			table[n] = c;
+		}
+		isTableReady = true;
+	}
+	
+	unsigned long crc = 0xFFFFFFFFUL;
+	for (size_t i = 0; i < length; ++i) {
+		crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+	}
+	return (crc ^ 0xFFFFFFFFUL) & 0xFFFFFFFFUL;
+}
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROFILE_DATABASE_H
+#define PROFILE_DATABASE_H
+
+#include <wx/string.h>
+#include <wx/filename.h>
+#include <wx/hashmap.h>
+
+#include "datastructures/ProfileSnapshot.h"
+
+/** Entries of every profile in a database, by profile name. */
+WX_DECLARE_STRING_HASH_MAP( ProfileEntryValues, ProfileDatabaseIndex );
+
+/** Every profile and the global settings in a single append-only file.
+
+ The file is a header line followed by one record per line: a profile
+ being added or dropped, or one of its keys being set or deleted. Each
+ record carries a CRC-32 of itself, so a record torn by a crash, and
+ anything after it, is recognised and ignored. Load() replays the records
+ into an in-memory index once; after that, reads come from the index and
+ Update() appends records only for the keys that actually changed, so
+ saving a profile in which one key changed writes one short line.
+
+ Records that have been superseded stay in the file until Compact()
+ rewrites it with only the live ones. The launcher compacts the database
+ only as it exits, when NeedsCompaction() says so; by design nothing
+ compacts it while the launcher runs. */
+class ProfileDatabase {
+public:
+	/** Name under which the global settings are stored. No profile can
+	 have an empty name. */
+	static const wxString GLOBAL_SETTINGS;
+	
+	explicit ProfileDatabase(const wxFileName& file);
+	
+	/** Reads the file into the index. A missing file is an empty database.
+	 Returns false if the file exists but cannot be read. */
+	bool Load();
+	
+	const wxFileName& GetFile() const { return this->file; }
+	bool HasProfile(const wxString& name) const;
+	/** Names of all profiles, not including GLOBAL_SETTINGS. */
+	wxArrayString GetProfileNames() const;
+	/** Returns NULL if there is no such profile. */
+	const ProfileEntryValues* GetEntries(const wxString& name) const;
+	
+	/** Makes the stored entries of the named profile equal to entries,
+	 adding the profile if needed. Nothing is written until Flush(). */
+	void Update(const wxString& name, const ProfileEntryValues& entries);
+	/** Removes the named profile. Nothing is written until Flush(). */
+	void Drop(const wxString& name);
+	
+	/** Appends the records made since the last Flush() to the file and
+	 syncs it. Rewrites the file instead if it does not exist yet or its
+	 end was found damaged. */
+	bool Flush();
+	/** Rewrites the file with only the live records, by way of a
+	 temporary file so that a crash leaves either the old or new file. */
+	bool Compact();
+	/** True when most of the file is superseded records. */
+	bool NeedsCompaction() const;
+	
+	size_t GetRecordCount() const { return this->recordCount; }
+	size_t GetLiveRecordCount() const;
+	
+private:
+	void AddRecord(wxChar type, const wxString& name,
+		const wxString& key = wxEmptyString, const wxString& value = wxEmptyString);
+	bool ApplyRecord(const wxString& record);
+	bool AppendPending();
+	
+	static wxString EncodeRecord(const wxString& record);
+	static void AppendField(wxString& record, const wxString& field);
+	static bool SplitFields(const wxString& record, wxArrayString& fields);
+	static unsigned long Checksum(const char* data, size_t length);
+	
+	wxFileName file;
+	ProfileDatabaseIndex profiles;
+	wxString pending; //!< Encoded records not yet written to the file
+	size_t recordCount; //!< Records in the file plus pending ones
+	bool mustRewrite; //!< The file is missing or ends in a damaged record
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/log.h>
+#include "datastructures/ProfileSnapshot.h"
+
+#include "global/MemoryDebugging.h"
+
+ProfileSnapshot::ProfileSnapshot(const wxString& name, unsigned long version,
+	const ProfileEntryValues& entries)
+: name(name.c_str()), version(version), refCount(0) {
+	// copies of a wxString can share one buffer whose count is not updated
+	// atomically, so take private copies that nothing on the UI thread holds
+	for (ProfileEntryValues::const_iterator it = entries.begin(),
+		 end = entries.end(); it != end; ++it) {
+		this->entries[wxString(it->first.c_str())] = wxString(it->second.c_str());
+	}
+}
+
+/** A snapshot of the same profile and version as base, with overrides
+ added to or replacing its entries. */
+ProfileSnapshot::ProfileSnapshot(const ProfileSnapshot& base,
+	const ProfileEntryValues& overrides)
+: name(base.name.c_str()), version(base.version), refCount(0) {
+	for (ProfileEntryValues::const_iterator it = base.entries.begin(),
+		 end = base.entries.end(); it != end; ++it) {
+		this->entries[wxString(it->first.c_str())] = wxString(it->second.c_str());
+	}
+	for (ProfileEntryValues::const_iterator it = overrides.begin(),
+		 end = overrides.end(); it != end; ++it) {
+		this->entries[wxString(it->first.c_str())] = wxString(it->second.c_str());
+	}
+}
+
+const wxString* ProfileSnapshot::Find(const wxString& key) const {
+	ProfileEntryValues::const_iterator found = this->entries.find(key);
+	return (found == this->entries.end()) ? NULL : &found->second;
+}
+
+bool ProfileSnapshot::Exists(const wxString& key) const {
+	return this->Find(key) != NULL;
+}
+
+bool ProfileSnapshot::Read(const wxString& key, wxString* str) const {
+	const wxString* value = this->Find(key);
+	if (value == NULL) {
+		return false;
+	}
+	*str = *value;
+	return true;
+}
+
+bool ProfileSnapshot::Read(const wxString& key, wxString* str, const wxString& defaultVal) const {
+	if (this->Read(key, str)) {
+		return true;
+	}
+	*str = defaultVal;
+	return false;
+}
+
+bool ProfileSnapshot::Read(const wxString& key, long* l) const {
+	const wxString* value = this->Find(key);
+	return (value != NULL) && value->ToLong(l);
+}
+
+bool ProfileSnapshot::Read(const wxString& key, long* l, long defaultVal) const {
+	if (this->Read(key, l)) {
+		return true;
+	}
+	*l = defaultVal;
+	return false;
+}
+
+bool ProfileSnapshot::Read(const wxString& key, int* i, int defaultVal) const {
+	long l;
+	const bool found = this->Read(key, &l, defaultVal);
+	*i = static_cast<int>(l);
+	return found;
+}
+
+bool ProfileSnapshot::Read(const wxString& key, bool* b, bool defaultVal) const {
+	long l;
+	const bool found = this->Read(key, &l, defaultVal ? 1L : 0L);
+	*b = (l != 0);
+	return found;
+}
+
+void ProfileSnapshot::IncRef() const {
+	wxCriticalSectionLocker lock(this->refLock);
+	this->refCount++;
+}
+
+void ProfileSnapshot::DecRef() const {
+	bool isLast;
+	{
+		wxCriticalSectionLocker lock(this->refLock);
+		wxASSERT_MSG(this->refCount > 0, _T("ProfileSnapshot released too often"));
+		isLast = (--this->refCount == 0);
+	}
+	if (isLast) {
+		delete this;
+	}
+}
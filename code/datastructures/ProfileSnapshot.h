@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROFILE_SNAPSHOT_H
+#define PROFILE_SNAPSHOT_H
+
+#include <wx/string.h>
+#include <wx/hashmap.h>
+#include <wx/thread.h>
+
+/** Every entry of a profile as a string, by full key path. */
+WX_DECLARE_STRING_HASH_MAP( wxString, ProfileEntryValues );
+
+/** A read-only copy of a profile as it was at one moment.
+
+ ProMan hands these out so that work which only needs to read settings,
+ such as pushing them to fs2_open's config or launching, can run on a
+ worker thread while the UI keeps changing the current profile. A snapshot
+ is never modified after it is made, so any number of threads may read it
+ at once without locking.
+
+ Snapshots are reference counted and deleted when the last
+ ProfileSnapshotPtr to them goes away. The Read() functions mirror
+ wxConfigBase's so that code reading a wxFileConfig can read a snapshot
+ instead without other changes. */
+class ProfileSnapshot {
+public:
+	ProfileSnapshot(const wxString& name, unsigned long version,
+		const ProfileEntryValues& entries);
+	ProfileSnapshot(const ProfileSnapshot& base, const ProfileEntryValues& overrides);
+	
+	const wxString& GetName() const { return this->name; }
+	/** Increases each time the current profile changes or another profile
+	 becomes current, so equal versions mean equal contents. */
+	unsigned long GetVersion() const { return this->version; }
+	
+	bool Exists(const wxString& key) const;
+	bool Read(const wxString& key, wxString* str) const;
+	bool Read(const wxString& key, wxString* str, const wxString& defaultVal) const;
+	bool Read(const wxString& key, long* l) const;
+	bool Read(const wxString& key, long* l, long defaultVal) const;
+	bool Read(const wxString& key, int* i, int defaultVal) const;
+	bool Read(const wxString& key, bool* b, bool defaultVal) const;
+	
+	void IncRef() const;
+	void DecRef() const;
+	
+private:
+	~ProfileSnapshot() { }
+	ProfileSnapshot(const ProfileSnapshot&);
+	ProfileSnapshot& operator=(const ProfileSnapshot&);
+	
+	const wxString* Find(const wxString& key) const;
+	
+	wxString name;
+	unsigned long version;
+	ProfileEntryValues entries;
+	
+	mutable wxCriticalSection refLock;
+	mutable int refCount;
+};
+
+/** Holds one reference to a snapshot. A ProfileSnapshotPtr itself is not
+ thread-safe; give each thread its own copy. */
+class ProfileSnapshotPtr {
+public:
+	ProfileSnapshotPtr() : snapshot(NULL) { }
+	explicit ProfileSnapshotPtr(const ProfileSnapshot* snapshot)
+	: snapshot(snapshot) {
+		if (this->snapshot != NULL) {
+			this->snapshot->IncRef();
+		}
+	}
+	ProfileSnapshotPtr(const ProfileSnapshotPtr& other)
+	: snapshot(other.snapshot) {
+		if (this->snapshot != NULL) {
+			this->snapshot->IncRef();
+		}
+	}
+	~ProfileSnapshotPtr() {
+		if (this->snapshot != NULL) {
+			this->snapshot->DecRef();
+		}
+	}
+	ProfileSnapshotPtr& operator=(const ProfileSnapshotPtr& other) {
+		if (other.snapshot != NULL) {
+			other.snapshot->IncRef();
+		}
+		if (this->snapshot != NULL) {
+			this->snapshot->DecRef();
+		}
+		this->snapshot = other.snapshot;
+		return *this;
+	}
+	
+	bool IsOk() const { return this->snapshot != NULL; }
+	const ProfileSnapshot* operator->() const { return this->snapshot; }
+	const ProfileSnapshot& operator*() const { return *this->snapshot; }
+	
+private:
+	const ProfileSnapshot* snapshot;
+};
+
+#endif
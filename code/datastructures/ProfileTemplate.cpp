@@ -0,0 +1,127 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/log.h>
+#include <wx/mstream.h>
+#include <wx/sstream.h>
+#include "datastructures/ProfileTemplate.h"
+#include "global/ProfileKeys.h"
+
+#include "global/MemoryDebugging.h"
+
+ProfileTemplate::ProfileTemplate(wxFileConfig& settings)
+: isOk(false) {
+	wxASSERT_MSG(!settings.HasGroup(_T("/main")),
+		_T("ProfileTemplate given settings with a main group"));
+	
+	wxMemoryOutputStream serialized;
+	if (!settings.Save(serialized)) {
+		wxLogError(_T("Unable to serialize profile template"));
+		return;
+	}
+	
+	const size_t length = static_cast<size_t>(serialized.GetSize());
+	serialized.CopyTo(this->base.GetWriteBuf(length), length);
+	this->base.UngetWriteBuf(length);
+	this->isOk = true;
+}
+
+bool ProfileTemplate::Materialize(const wxString& name, const wxString& fileName,
+	wxMemoryBuffer& contents) const {
+	wxCHECK_MSG(this->IsOk(), false, _T("Materialize() called on a bad template"));
+	
+	// let wxFileConfig take care of escaping the name
+	wxStringInputStream empty(wxEmptyString);
+	wxFileConfig overlay(empty);
+	overlay.Write(PRO_CFG_MAIN_NAME, name);
+	overlay.Write(PRO_CFG_MAIN_FILENAME, fileName);
+	
+	wxMemoryOutputStream serializedOverlay;
+	if (!overlay.Save(serializedOverlay)) {
+		wxLogError(_T("Unable to serialize overlay for profile '%s'"), name.c_str());
+		return false;
+	}
+	
+	const size_t overlayLength = static_cast<size_t>(serializedOverlay.GetSize());
+	contents.SetDataLen(0);
+	contents.AppendData(this->base.GetData(), this->base.GetDataLen());
+	serializedOverlay.CopyTo(contents.GetAppendBuf(overlayLength), overlayLength);
+	contents.UngetAppendBuf(overlayLength);
+	return true;
+}
+
+ProfileOverlay::ProfileOverlay(const ProfileTemplate& base, const wxString& name,
+	const wxString& fileName)
+: base(base), name(name), fileName(fileName) {
+	wxASSERT_MSG(base.IsOk(), _T("ProfileOverlay given a bad template"));
+}
+
+void ProfileOverlay::Write(const wxString& key, const wxString& value) {
+	const int wasDeleted = this->deleted.Index(key);
+	if (wasDeleted != wxNOT_FOUND) {
+		this->deleted.RemoveAt(wasDeleted);
+	}
+	this->written[key] = value;
+}
+
+void ProfileOverlay::DeleteEntry(const wxString& key) {
+	this->written.erase(key);
+	if (this->deleted.Index(key) == wxNOT_FOUND) {
+		this->deleted.Add(key);
+	}
+}
+
+bool ProfileOverlay::Serialize(wxMemoryBuffer& contents) const {
+	if (this->written.empty() && this->deleted.IsEmpty()) {
+		return this->base.Materialize(this->name, this->fileName, contents);
+	}
+
+	wxFileConfig* config = this->Materialize();
+	if (config == NULL) {
+		return false;
+	}
+	wxMemoryOutputStream serialized;
+	const bool isSaved = config->Save(serialized);
+	delete config;
+	if (!isSaved) {
+		wxLogError(_T("Unable to serialize profile '%s'"), this->name.c_str());
+		return false;
+	}
+	const size_t length = static_cast<size_t>(serialized.GetSize());
+	contents.SetDataLen(0);
+	serialized.CopyTo(contents.GetWriteBuf(length), length);
+	contents.UngetWriteBuf(length);
+	return true;
+}
+
+wxFileConfig* ProfileOverlay::Materialize() const {
+	wxMemoryBuffer contents;
+	if (!this->base.Materialize(this->name, this->fileName, contents)) {
+		return NULL;
+	}
+	wxMemoryInputStream input(contents.GetData(), contents.GetDataLen());
+	wxFileConfig* config = new wxFileConfig(input);
+	for (size_t i = 0; i < this->deleted.GetCount(); ++i) {
+		config->DeleteEntry(this->deleted[i]);
+	}
+	for (ProfileEntryValues::const_iterator it = this->written.begin(),
+		 end = this->written.end(); it != end; ++it) {
+		config->Write(it->first, it->second);
+	}
+	return config;
+}
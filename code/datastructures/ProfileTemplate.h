@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROFILE_TEMPLATE_H
+#define PROFILE_TEMPLATE_H
+
+#include <wx/string.h>
+#include <wx/buffer.h>
+#include <wx/fileconf.h>
+#include <wx/hashmap.h>
+
+#include "datastructures/ProfileSnapshot.h"
+
+/** The settings of a profile, serialized once, from which any number of
+ new profiles can be stamped out.
+
+ A profile made from a template is the template's bytes (the base) followed
+ by a [main] group holding the new profile's name and file name (the
+ overlay). Making a profile therefore never walks the settings again,
+ however many there are, and the new profile only gets parsed into a
+ wxFileConfig when it is first read. Copies of a template share its base. */
+class ProfileTemplate {
+public:
+	/** settings must not have a main group, since every profile made from
+	 the template brings its own. */
+	explicit ProfileTemplate(wxFileConfig& settings);
+	
+	/** Returns false if the settings could not be serialized. */
+	bool IsOk() const { return this->isOk; }
+	/** Size of the base, in bytes. */
+	size_t GetSize() const { return this->base.GetDataLen(); }
+	
+	/** Fills contents with the file contents of a profile made from this
+	 template. Returns false if the overlay could not be serialized. */
+	bool Materialize(const wxString& name, const wxString& fileName,
+		wxMemoryBuffer& contents) const;
+	
+private:
+	wxMemoryBuffer base;
+	bool isOk;
+};
+
+/** Templates by name of the profile they were made from. Owns the templates. */
+WX_DECLARE_STRING_HASH_MAP(ProfileTemplate*, ProfileTemplateMap);
+
+/** A profile cloned from a template that nothing has needed as a whole yet:
+ the template it came from, shared rather than copied, and the entries set
+ or deleted in it since. Cloning a profile this way costs the same however
+ big the profile is; the settings are only copied when the profile is
+ first read or saved. */
+class ProfileOverlay {
+public:
+	ProfileOverlay(const ProfileTemplate& base, const wxString& name,
+		const wxString& fileName);
+
+	const wxString& GetFileName() const { return this->fileName; }
+	void Write(const wxString& key, const wxString& value);
+	void DeleteEntry(const wxString& key);
+
+	/** Fills contents with the file contents of the profile. Returns false
+	 if it could not be serialized. */
+	bool Serialize(wxMemoryBuffer& contents) const;
+	/** Returns the profile as a new wxFileConfig, or NULL if it could not be
+	 serialized. */
+	wxFileConfig* Materialize() const;
+
+private:
+	ProfileTemplate base;
+	wxString name;
+	wxString fileName;
+	ProfileEntryValues written; //!< set since the clone, by full key path
+	wxArrayString deleted; //!< deleted since the clone, by full key path
+};
+
+/** Overlays by name of the profile. Owns the overlays. */
+WX_DECLARE_STRING_HASH_MAP(ProfileOverlay*, ProfileOverlayMap);
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/wx.h>
+#include <wx/ffile.h>
+#include <wx/mstream.h>
+
+#include "generated/configure_launcher.h"
+#include "global/AtomicFileBatch.h"
+
+#if IS_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <io.h>
+#else
+#include <errno.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if IS_LINUX
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
+#endif
+
+#include "global/MemoryDebugging.h"
+
+#define ATOMIC_TEMP_SUFFIX _T(".tmp")
+
+AtomicFileBatch::AtomicFileBatch()
+: fileCount(0), dirSyncCount(0), firstCopyMethod(COPY_REFLINK) {
+	for (int i = 0; i < COPY_METHODS; i++) {
+		this->copyCounts[i] = 0;
+	}
+}
+
+AtomicFileBatch::~AtomicFileBatch() {
+	if (!this->pendingDirs.IsEmpty()) {
+		this->Commit();
+	}
+}
+
+/** Saves the config to target by way of a temporary file.
+ Returns true if target now holds the new contents. */
+bool AtomicFileBatch::Save(wxFileConfig& config, const wxFileName& target) {
+	wxMemoryOutputStream buffer;
+	if (!config.Save(buffer)) {
+		wxLogError(_T("Unable to serialize config destined for '%s'"),
+			target.GetFullPath().c_str());
+		return false;
+	}
+
+	const wxStreamBuffer* contents = buffer.GetOutputStreamBuffer();
+	return this->SaveBytes(contents->GetBufferStart(),
+		contents->GetIntPosition(), target);
+}
+
+/** Writes length bytes to target by way of a temporary file.
+ Returns true if target now holds the new contents. */
+bool AtomicFileBatch::SaveBytes(const void* data, size_t length, const wxFileName& target) {
+	wxCHECK_MSG(target.IsOk(), false, _T("AtomicFileBatch::SaveBytes given invalid target"));
+
+	const wxString tempPath(target.GetFullPath() + ATOMIC_TEMP_SUFFIX);
+
+	wxFFile file(tempPath, _T("wb"));
+	if (!file.IsOpened()) {
+		wxLogError(_T("Unable to open temporary file '%s'"), tempPath.c_str());
+		return false;
+	}
+
+	bool ok = (length == 0) || (file.Write(data, length) == length);
+	ok = ok && file.Flush();
+#if IS_WIN32
+	ok = ok && (_commit(_fileno(file.fp())) == 0);
+#elif IS_LINUX
+	// only the data needs to be on disk before the rename, not the timestamps
+	ok = ok && (fdatasync(fileno(file.fp())) == 0);
+#else
+	ok = ok && (fsync(fileno(file.fp())) == 0);
+#endif
+	ok = file.Close() && ok;
+
+	if (!ok) {
+		wxLogError(_T("Unable to write temporary file '%s'"), tempPath.c_str());
+		::wxRemoveFile(tempPath);
+		return false;
+	}
+
+	return this->ReplaceTarget(tempPath, target);
+}
+
+/** Copies the file source to target by way of a temporary file, letting
+ the file system share or copy the data itself where it can.
+ Returns true if target now holds a copy of source. */
+bool AtomicFileBatch::SaveCopy(const wxString& source, const wxFileName& target,
+	wxULongLong* bytesCopied) {
+	wxCHECK_MSG(target.IsOk(), false, _T("AtomicFileBatch::SaveCopy given invalid target"));
+
+	const wxString tempPath(target.GetFullPath() + ATOMIC_TEMP_SUFFIX);
+#if IS_WIN32
+	// CopyFileW() copies on the server for network shares and keeps
+	// the file's attributes, neither of which a read/write loop would do
+	bool ok = ::CopyFileW(source.wc_str(), tempPath.wc_str(), FALSE) != 0;
+	if (ok && bytesCopied != NULL) {
+		*bytesCopied = wxFileName::GetSize(tempPath);
+	}
+	if (ok) {
+		// CopyFileW() leaves the data in the cache, unlike SaveBytes()
+		HANDLE handle = ::CreateFileW(tempPath.wc_str(), GENERIC_WRITE, 0, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		ok = (handle != INVALID_HANDLE_VALUE) && ::FlushFileBuffers(handle);
+		if (handle != INVALID_HANDLE_VALUE) {
+			::CloseHandle(handle);
+		}
+	}
+	if (ok) {
+		this->copyCounts[COPY_KERNEL]++;
+	}
+#else
+	int in = ::open(source.fn_str(), O_RDONLY);
+	if (in < 0) {
+		wxLogError(_T("Unable to open '%s' for copying"), source.c_str());
+		return false;
+	}
+	struct stat info;
+	const mode_t mode = (::fstat(in, &info) == 0) ? (info.st_mode & 0777) : 0644;
+	int out = ::open(tempPath.fn_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+	if (out < 0) {
+		wxLogError(_T("Unable to open temporary file '%s'"), tempPath.c_str());
+		::close(in);
+		return false;
+	}
+
+	bool ok = this->CopyContents(in, out, bytesCopied);
+#if IS_LINUX
+	ok = ok && (::fdatasync(out) == 0);
+#else
+	ok = ok && (::fsync(out) == 0);
+#endif
+	ok = (::close(out) == 0) && ok;
+	::close(in);
+#endif
+
+	if (!ok) {
+		wxLogError(_T("Unable to copy '%s' to temporary file '%s'"),
+			source.c_str(), tempPath.c_str());
+		::wxRemoveFile(tempPath);
+		return false;
+	}
+
+	return this->ReplaceTarget(tempPath, target);
+}
+
+#if !IS_WIN32
+/** Copies everything from in to out, which must both be at the start of
+ their files. Tries, in order, sharing the data (a reflink), having the
+ kernel copy it and copying it through a buffer, starting from
+ firstCopyMethod. */
+bool AtomicFileBatch::CopyContents(int in, int out, wxULongLong* bytesCopied) {
+	wxULongLong copied = 0;
+#if IS_LINUX && defined(FICLONE)
+	struct stat info;
+	if (this->firstCopyMethod <= COPY_REFLINK
+		&& ::ioctl(out, FICLONE, in) == 0 && ::fstat(out, &info) == 0) {
+		if (bytesCopied != NULL) {
+			*bytesCopied = static_cast<wxULongLong_t>(info.st_size);
+		}
+		this->copyCounts[COPY_REFLINK]++;
+		return true;
+	}
+#endif
+#if IS_LINUX && defined(SYS_copy_file_range)
+	while (this->firstCopyMethod <= COPY_KERNEL) {
+		const long n = ::syscall(SYS_copy_file_range, in, NULL, out, NULL,
+			static_cast<size_t>(1 << 30), 0u);
+		if (n > 0) {
+			copied += static_cast<wxULongLong_t>(n);
+		} else if (n == 0) {
+			if (bytesCopied != NULL) {
+				*bytesCopied = copied;
+			}
+			this->copyCounts[COPY_KERNEL]++;
+			return true;
+		} else if (copied == 0 && (errno == ENOSYS || errno == EXDEV
+				|| errno == EINVAL || errno == EOPNOTSUPP)) {
+			break; // not supported here, nothing written yet
+		} else {
+			return false;
+		}
+	}
+#endif
+	char buffer[64 * 1024];
+	for (;;) {
+		const ssize_t n = ::read(in, buffer, sizeof(buffer));
+		if (n == 0) {
+			break;
+		} else if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		for (ssize_t written = 0; written < n; ) {
+			const ssize_t w = ::write(out, buffer + written, n - written);
+			if (w < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+			written += w;
+		}
+		copied += static_cast<wxULongLong_t>(n);
+	}
+	if (bytesCopied != NULL) {
+		*bytesCopied = copied;
+	}
+	this->copyCounts[COPY_BUFFERED]++;
+	return true;
+}
+#endif
+
+bool AtomicFileBatch::ReplaceTarget(const wxString& tempPath, const wxFileName& target) {
+	const wxString targetPath(target.GetFullPath());
+#if IS_WIN32
+	// wxRenameFile() deletes an existing target before renaming, which is
+	// exactly the window we are trying to close
+	const bool renamed = ::MoveFileExW(tempPath.wc_str(), targetPath.wc_str(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	const bool renamed = ::rename(tempPath.fn_str(), targetPath.fn_str()) == 0;
+#endif
+	if (!renamed) {
+		wxLogError(_T("Unable to replace '%s' with '%s'"),
+			targetPath.c_str(), tempPath.c_str());
+		::wxRemoveFile(tempPath);
+		return false;
+	}
+
+	this->fileCount++;
+	if (this->pendingDirs.Index(target.GetPath()) == wxNOT_FOUND) {
+		this->pendingDirs.Add(target.GetPath());
+	}
+	return true;
+}
+
+/** Makes every rename done since the last Commit() durable, syncing each
+ folder once no matter how many files were replaced in it. */
+bool AtomicFileBatch::Commit() {
+	bool ok = true;
+	for (size_t i = 0; i < this->pendingDirs.GetCount(); i++) {
+		if (SyncDirectory(this->pendingDirs[i])) {
+			this->dirSyncCount++;
+		} else {
+			wxLogWarning(_T("Unable to sync folder '%s'"),
+				this->pendingDirs[i].c_str());
+			ok = false;
+		}
+	}
+	this->pendingDirs.Clear();
+	return ok;
+}
+
+bool AtomicFileBatch::SyncDirectory(const wxString& dir) {
+#if IS_WIN32
+	// MOVEFILE_WRITE_THROUGH already flushed the rename
+	return true;
+#else
+	int fd = ::open(dir.fn_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	bool ok = (::fsync(fd) == 0);
+	::close(fd);
+	return ok;
+#endif
+}
@@ -0,0 +1,84 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef ATOMICFILEBATCH_H
+#define ATOMICFILEBATCH_H
+
+#include <wx/wx.h>
+#include <wx/fileconf.h>
+#include <wx/filename.h>
+#include <wx/longlong.h>
+
+#include "generated/configure_launcher.h"
+
+/** Crash-safe writer for config files.
+
+ Each file is written in full to a temporary file next to its target,
+ flushed to disk and then renamed over the target, so the target always
+ holds either the old or the new contents and never a truncated mix.
+ The rename only becomes durable once the containing directory is synced;
+ that sync is deferred to Commit() so that saving several profiles and the
+ global ini in one operation costs a single directory sync per folder.
+
+ A batch that goes out of scope without Commit() being called commits
+ itself. */
+class AtomicFileBatch {
+public:
+	/** The ways SaveCopy() may copy data, fastest first. Each falls back to
+	 the next where the file system or kernel can't do it. Windows always
+	 has the system copy the file, which counts as COPY_KERNEL. */
+	enum CopyMethod {
+		COPY_REFLINK = 0, //!< share the data, Linux only
+		COPY_KERNEL, //!< have the kernel copy the data
+		COPY_BUFFERED, //!< copy the data through a buffer
+		COPY_METHODS
+	};
+
+	AtomicFileBatch();
+	~AtomicFileBatch();
+
+	bool Save(wxFileConfig& config, const wxFileName& target);
+	bool SaveBytes(const void* data, size_t length, const wxFileName& target);
+	bool SaveCopy(const wxString& source, const wxFileName& target,
+		wxULongLong* bytesCopied = NULL);
+	bool Commit();
+
+	/** Number of files replaced since the batch was created. */
+	size_t GetFileCount() const { return this->fileCount; }
+	/** Number of directory syncs done by this batch so far. */
+	size_t GetDirSyncCount() const { return this->dirSyncCount; }
+	/** Skips the methods faster than method, to time the fallbacks. */
+	void SetFirstCopyMethod(CopyMethod method) { this->firstCopyMethod = method; }
+	/** Number of files SaveCopy() has copied with method so far. */
+	size_t GetCopyCount(CopyMethod method) const { return this->copyCounts[method]; }
+
+private:
+	bool ReplaceTarget(const wxString& tempPath, const wxFileName& target);
+	static bool SyncDirectory(const wxString& dir);
+#if !IS_WIN32
+	bool CopyContents(int in, int out, wxULongLong* bytesCopied);
+#endif
+
+	wxArrayString pendingDirs; //!< Folders that have had files renamed into them since the last Commit()
+	size_t fileCount;
+	size_t dirSyncCount;
+	CopyMethod firstCopyMethod;
+	size_t copyCounts[COPY_METHODS];
+};
+
+#endif
@@ -1,10 +1,18 @@
 #include <wx/dir.h>
+#include <wx/ffile.h>
 #include <wx/filefn.h>
 #include <wx/sstream.h>
+#include <wx/stopwatch.h>
+#include <wx/textfile.h>
+#include <wx/thread.h>
 #include <wx/wfstream.h>
 
+#include <vector>
+
 #include "generated/configure_launcher.h"
 #include "apis/FlagListManager.h"
+#include "apis/PlatformProfileManager.h"
+#include "global/AtomicFileBatch.h"
 #include "global/Compatibility.h"
 #include "global/ProfileKeys.h"
 
@@ -80,14 +88,267 @@ void copyValuesIntoConfig(HKEY key, wxFileConfig& config, const wxString& sectio
 
 #define FSO_CONFIG_FILENAME _T("fs2_open.ini")
 
-extern wxFileName GetPlatformDefaultConfigFilePathNew();
 extern wxFileName GetPlatformDefaultConfigFilePathOld();
 
+#define PILOT_MIGRATION_MANIFEST _T("wxlauncher_pilot_migration.txt")
+#define PILOT_MIGRATION_DONE _T("# done")
+#define PILOT_MIGRATION_MAX_THREADS 4
+
+/** Copies the files of one pilot folder to another using a few threads,
+ recording each file that has been copied in a manifest. */
+class PilotCopyJob
+{
+public:
+	PilotCopyJob(const wxFileName& from, const wxFileName& to,
+		AtomicFileBatch::CopyMethod firstCopyMethod = AtomicFileBatch::COPY_REFLINK)
+	: from(from), to(to), firstCopyMethod(firstCopyMethod), nextFile(0), filesCopied(0),
+	  bytesCopied(0), failures(0)
+	{
+		for (int i = 0; i < AtomicFileBatch::COPY_METHODS; i++)
+		{
+			this->copyCounts[i] = 0;
+		}
+	}
+
+	/** Reads the names of the files copied by an earlier, interrupted run.
+	 Returns false if that run finished. */
+	bool ReadManifest(const wxFileName& manifestName)
+	{
+		wxTextFile manifest(manifestName.GetFullPath());
+		if (!manifest.Open(wxConvUTF8))
+		{
+			return true;
+		}
+		for (size_t i = 0; i < manifest.GetLineCount(); i++)
+		{
+			const wxString& line = manifest.GetLine(i);
+			if (line == PILOT_MIGRATION_DONE)
+			{
+				return false;
+			}
+			if (!line.IsEmpty() && !line.StartsWith(_T("#")))
+			{
+				this->copied.Add(line);
+			}
+		}
+		return true;
+	}
+
+	bool OpenManifest(const wxFileName& manifestName)
+	{
+		if (!manifestName.DirExists() && !wxFileName::Mkdir(manifestName.GetPath(), 0777, wxPATH_MKDIR_FULL))
+		{
+			wxLogError(_T("Failed to create directory '%s'"), manifestName.GetPath().c_str());
+			return false;
+		}
+		const bool isNew = !manifestName.FileExists();
+		if (!this->manifest.Open(manifestName.GetFullPath(), _T("ab")))
+		{
+			wxLogError(_T("Unable to open pilot copy manifest '%s'"), manifestName.GetFullPath().c_str());
+			return false;
+		}
+		if (isNew)
+		{
+			this->AppendToManifest(_T("# pilot files copied from ") + this->from.GetFullPath());
+		}
+		return true;
+	}
+
+	/** Copies the files, and fills in stats if it isn't NULL. */
+	void Run(Compatibility::PilotCopyStats* stats = NULL)
+	{
+		wxStopWatch timer;
+		wxDir oldDir(this->from.GetFullPath());
+		wxString pilotFile;
+		for (bool cont = oldDir.GetFirst(&pilotFile, wxEmptyString, wxDIR_FILES);
+			cont; cont = oldDir.GetNext(&pilotFile))
+		{
+			if (!this->IsAlreadyCopied(pilotFile))
+			{
+				this->files.Add(pilotFile);
+			}
+		}
+
+		// this thread copies too, so it counts as one
+		int threadsStarted = 1;
+#if wxCHECK_VERSION(2, 9, 1)
+		int threadCount = wxThread::GetCPUCount();
+		threadCount = wxMax(1, wxMin(threadCount, PILOT_MIGRATION_MAX_THREADS));
+		threadCount = wxMin(threadCount, static_cast<int>(this->files.GetCount()));
+		std::vector<PilotCopyWorker*> workers;
+		for (int i = 1; i < threadCount; i++)
+		{
+			PilotCopyWorker* worker = new PilotCopyWorker(*this);
+			if (worker->Create() == wxTHREAD_NO_ERROR && worker->Run() == wxTHREAD_NO_ERROR)
+			{
+				workers.push_back(worker);
+				threadsStarted++;
+			}
+			else
+			{
+				delete worker;
+			}
+		}
+#else
+		// wxWidgets 2.8 can't log from worker threads, so this one copies alone
+#endif
+		this->CopyFiles();
+#if wxCHECK_VERSION(2, 9, 1)
+		for (size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i]->Wait();
+			delete workers[i];
+		}
+#endif
+
+		if (this->failures == 0)
+		{
+			this->AppendToManifest(PILOT_MIGRATION_DONE);
+		}
+		else
+		{
+			wxLogWarning(_T("%lu pilot file(s) could not be copied, will try again on the next launch"),
+				static_cast<unsigned long>(this->failures));
+		}
+		this->manifest.Close();
+
+		wxLogStatus(_T("  Copied %lu pilot file(s), %s bytes, in %ldms using %d thread(s)."),
+			static_cast<unsigned long>(this->filesCopied),
+			this->bytesCopied.ToString().c_str(), timer.Time(), threadsStarted);
+
+		if (stats != NULL)
+		{
+			stats->files = this->filesCopied;
+			stats->bytes = this->bytesCopied;
+			stats->ms = timer.Time();
+			stats->threads = threadsStarted;
+			stats->failures = this->failures;
+			for (int i = 0; i < AtomicFileBatch::COPY_METHODS; i++)
+			{
+				stats->copies[i] = this->copyCounts[i];
+			}
+		}
+	}
+
+	/** Copies files until there are none left. Called by every thread. */
+	void CopyFiles()
+	{
+		AtomicFileBatch batch;
+		batch.SetFirstCopyMethod(this->firstCopyMethod);
+		wxString pilotFile;
+		while (this->TakeNextFile(pilotFile))
+		{
+			wxFileName pilotFileName(this->from.GetFullPath(), pilotFile);
+			wxFileName newPilotFile(this->to.GetFullPath(), pilotFile);
+
+			wxULongLong size = 0;
+			// the folder is only synced once the batch goes out of scope;
+			// IsAlreadyCopied() catches a rename lost before then
+			const bool ok = batch.SaveCopy(pilotFileName.GetFullPath(), newPilotFile, &size);
+			if (!ok)
+			{
+				wxLogError(_T("Failed to copy pilot file '%s'!"), pilotFileName.GetFullPath().c_str());
+			}
+			this->FinishFile(pilotFile, ok, size);
+		}
+
+		wxCriticalSectionLocker locker(this->lock);
+		for (int i = 0; i < AtomicFileBatch::COPY_METHODS; i++)
+		{
+			this->copyCounts[i] += batch.GetCopyCount(static_cast<AtomicFileBatch::CopyMethod>(i));
+		}
+	}
+
+private:
+	class PilotCopyWorker: public wxThread
+	{
+	public:
+		PilotCopyWorker(PilotCopyJob& job) : wxThread(wxTHREAD_JOINABLE), job(job) { }
+	protected:
+		virtual ExitCode Entry()
+		{
+			this->job.CopyFiles();
+			return 0;
+		}
+	private:
+		PilotCopyJob& job;
+	};
+
+	/** A file listed in the manifest only counts as copied if the copy is
+	 still there and as large as the original. */
+	bool IsAlreadyCopied(const wxString& pilotFile) const
+	{
+		if (this->copied.Index(pilotFile) == wxNOT_FOUND)
+		{
+			return false;
+		}
+		wxFileName original(this->from.GetFullPath(), pilotFile);
+		wxFileName copy(this->to.GetFullPath(), pilotFile);
+		return copy.FileExists() && copy.GetSize() == original.GetSize();
+	}
+
+	bool TakeNextFile(wxString& pilotFile)
+	{
+		wxCriticalSectionLocker locker(this->lock);
+		if (this->nextFile >= this->files.GetCount())
+		{
+			return false;
+		}
+		// copied so that no two threads share a string's buffer
+		pilotFile = this->files[this->nextFile++].c_str();
+		return true;
+	}
+
+	void FinishFile(const wxString& pilotFile, bool ok, const wxULongLong& size)
+	{
+		wxCriticalSectionLocker locker(this->lock);
+		if (ok)
+		{
+			this->filesCopied++;
+			this->bytesCopied += size;
+			this->AppendToManifest(pilotFile);
+		}
+		else
+		{
+			this->failures++;
+		}
+	}
+
+	/** Must be called with lock held once threads are running. */
+	void AppendToManifest(const wxString& line)
+	{
+		const wxCharBuffer utf8((line + _T("\n")).mb_str(wxConvUTF8));
+		this->manifest.Write(utf8.data(), strlen(utf8.data()));
+		this->manifest.Flush();
+	}
+
+	const wxFileName from, to;
+	const AtomicFileBatch::CopyMethod firstCopyMethod;
+	wxSortedArrayString copied; //!< files the manifest says were copied
+	wxArrayString files; //!< files to copy this time
+	wxFFile manifest;
+
+	wxCriticalSection lock; //!< guards everything below, and the manifest
+	size_t nextFile;
+	size_t filesCopied;
+	wxULongLong bytesCopied;
+	size_t failures;
+	size_t copyCounts[AtomicFileBatch::COPY_METHODS]; //!< copies done by each method
+};
+
 namespace Compatibility
 {
-	bool SynchronizeOldPilots(ProMan* profileManager)
+	/** Copies pilots from before SDL builds to where SDL builds look for
+	 them. Only reads files and what MakeLaunchSnapshot() put in profile,
+	 so it may run on a worker thread.
+
+	 Each pilot file is copied under a temporary name and renamed into
+	 place, and its name is then added to a manifest in the new data
+	 folder. If the copy is interrupted, the next launch uses the manifest
+	 to copy only the files that are still missing. */
+	bool SynchronizeOldPilots(const ProfileSnapshot& profile, const wxString& rootFolder)
 	{
-		if (!(FlagListManager::GetFlagListManager()->GetBuildCaps() & FlagListManager::BUILD_CAPS_SDL))
+		if (!(GetLaunchBuildCaps(profile) & FlagListManager::BUILD_CAPS_SDL))
 		{
 			// Nothing to do, we have an old build
 			return true;
@@ -96,14 +357,13 @@ namespace Compatibility
 		wxLogStatus(_T("Synchronizing old pilot files..."));
 		wxFileName oldConfigFolder;
 #if IS_WIN32
-		wxString rootPath;
-		if (!profileManager->ProfileRead(PRO_CFG_TC_ROOT_FOLDER, &rootPath))
+		if (rootFolder.IsEmpty())
 		{
 			wxLogWarning(_T("No TC root folder in configuration!"));
 			return false;
 		}
 
-		oldConfigFolder.AssignDir(rootPath, wxPATH_NATIVE);
+		oldConfigFolder.AssignDir(rootFolder, wxPATH_NATIVE);
 #else
 		oldConfigFolder.Assign(GetPlatformDefaultConfigFilePathOld());
 #endif
@@ -111,8 +371,9 @@ namespace Compatibility
 		oldConfigFolder.AppendDir(_T("data"));
 		oldConfigFolder.AppendDir(_T("players"));
 
-		wxFileName newConfigFolder(GetPlatformDefaultConfigFilePathNew());
+		wxFileName newConfigFolder(GetLaunchPrefFolder(profile));
 		newConfigFolder.AppendDir(_T("data"));
+		wxFileName manifestName(newConfigFolder.GetPath(), PILOT_MIGRATION_MANIFEST);
 		newConfigFolder.AppendDir(_T("players"));
 
 		if (!oldConfigFolder.DirExists())
@@ -122,58 +383,70 @@ namespace Compatibility
 			return true;
 		}
 
-		// Heuristic to determine if the files were copied before
-		if (newConfigFolder.DirExists())
+		PilotCopyJob job(oldConfigFolder, newConfigFolder);
+		if (manifestName.FileExists())
+		{
+			if (!job.ReadManifest(manifestName))
+			{
+				wxLogStatus(_T("  Pilot files were already copied."));
+				return true;
+			}
+			wxLogStatus(_T("  Resuming interrupted copy of pilot files."));
+		}
+		else if (newConfigFolder.DirExists())
 		{
+			// Heuristic to determine if the files were copied before:
 			// new players directory already exists so it was already used before
 			// Don't try to copy in this case
 			wxLogStatus(_T("  New pilot directory already exists, was probably copied before."));
 			return true;
 		}
 
-		if (!newConfigFolder.Mkdir(0777, wxPATH_MKDIR_FULL))
+		// the manifest must exist before the players folder does, or an
+		// interrupted copy would look like a finished one
+		if (!job.OpenManifest(manifestName))
+		{
+			return false;
+		}
+		if (!newConfigFolder.DirExists() && !newConfigFolder.Mkdir(0777, wxPATH_MKDIR_FULL))
 		{
 			wxLogError(_T("Failed to create directory '%s'"), newConfigFolder.GetFullPath().c_str());
 			return false;
 		}
 
-		// If we are here we need to copy the old pilot files
-		wxDir oldDir(oldConfigFolder.GetFullPath());
-
-		wxString pilotFile;
-		bool cont = oldDir.GetFirst(&pilotFile, wxEmptyString, wxDIR_FILES);
-
 		wxLogStatus(_T("Copying pilot files from '%s' to '%s'."), oldConfigFolder.GetFullPath().c_str(), newConfigFolder.GetFullPath().c_str());
-		while (cont)
-		{
-			wxFileName pilotFileName;
-			pilotFileName.Assign(oldConfigFolder.GetFullPath(), pilotFile);
-
-			wxFileName newPilotFile;
-			newPilotFile.Assign(newConfigFolder.GetFullPath(), pilotFile);
-
-			wxLogStatus(_T("  Copying '%s' to '%s'"), pilotFileName.GetFullPath().c_str(), newPilotFile.GetFullPath().c_str());
-			if (!wxCopyFile(pilotFileName.GetFullPath(), newPilotFile.GetFullPath()))
-			{
-				wxLogError(_T("Failed to copy pilot file '%s'!"), pilotFileName.GetFullPath().c_str());
-			}
+		job.Run();
+		return true;
+	}
 
-			cont = oldDir.GetNext(&pilotFile);
+	/** Copies the pilot files in from to to the way SynchronizeOldPilots()
+	 does, starting from firstCopyMethod, for the pilot copy benchmark. */
+	bool CopyPilotFolder(const wxFileName& from, const wxFileName& to, const wxFileName& manifestName,
+		AtomicFileBatch::CopyMethod firstCopyMethod, PilotCopyStats& stats)
+	{
+		PilotCopyJob job(from, to, firstCopyMethod);
+		if (!job.OpenManifest(manifestName))
+		{
+			return false;
 		}
-
-		wxLogStatus(_T("  Done copying pilot files."));
-		return true;
+		if (!to.DirExists() && !wxFileName::Mkdir(to.GetPath(), 0777, wxPATH_MKDIR_FULL))
+		{
+			wxLogError(_T("Failed to create directory '%s'"), to.GetFullPath().c_str());
+			return false;
+		}
+		job.Run(&stats);
+		return stats.failures == 0;
 	}
 
-	bool MigrateOldConfig()
+	bool MigrateOldConfig(const ProfileSnapshot& profile)
 	{
-		if (!(FlagListManager::GetFlagListManager()->GetBuildCaps() & FlagListManager::BUILD_CAPS_SDL))
+		if (!(GetLaunchBuildCaps(profile) & FlagListManager::BUILD_CAPS_SDL))
 		{
 			// Nothing to do, we have an old build
 			return true;
 		}
 
-		wxFileName newName = GetPlatformDefaultConfigFilePathNew();
+		wxFileName newName = GetLaunchPrefFolder(profile);
 		newName.SetFullName(FSO_CONFIG_FILENAME);
 
 		if (wxFile::Exists(newName.GetFullPath())) {
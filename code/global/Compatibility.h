@@ -6,12 +6,34 @@
 #define WXLAUNCHER_COMPATIBILITY_H
 
 #include "apis/ProfileManager.h"
+#include "global/AtomicFileBatch.h"
 
 namespace Compatibility
 {
-	bool SynchronizeOldPilots(ProMan* profileManager);
+	bool SynchronizeOldPilots(const ProfileSnapshot& profile, const wxString& rootFolder);
 
-	bool MigrateOldConfig();
+	// what one copy of a pilot folder did
+	struct PilotCopyStats
+	{
+		PilotCopyStats() : files(0), bytes(0), ms(0), threads(0), failures(0)
+		{
+			for (int i = 0; i < AtomicFileBatch::COPY_METHODS; i++)
+			{
+				copies[i] = 0;
+			}
+		}
+		size_t files;
+		wxULongLong bytes;
+		long ms;
+		int threads;
+		size_t failures;
+		size_t copies[AtomicFileBatch::COPY_METHODS]; // files copied by each method
+	};
+
+	bool CopyPilotFolder(const wxFileName& from, const wxFileName& to, const wxFileName& manifestName,
+		AtomicFileBatch::CopyMethod firstCopyMethod, PilotCopyStats& stats);
+
+	bool MigrateOldConfig(const ProfileSnapshot& profile);
 }
 
 #endif //WXLAUNCHER_COMPATIBILITY_H
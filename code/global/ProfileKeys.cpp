@@ -17,6 +17,7 @@
  */
 
 #include "ProfileKeys.h"
+#include "ProfileSchema.h"
 
 // Global profile keys and constants
 const wxString GBL_CFG_MAIN_AUTOSAVEPROFILES	(_T("/main/autosaveprofiles"));
@@ -35,45 +36,48 @@ const wxString GBL_CFG_NET_THE_NEWS				(_T("thenews"));
 const wxString GBL_CFG_OPT_CONFIG_FRED			(_T("/opt/configfred"));
 
 // Profile keys and constants
-const wxString PRO_CFG_MAIN_NAME				(_T("/main/name"));
-const wxString PRO_CFG_MAIN_FILENAME			(_T("/main/filename"));
-const wxString PRO_CFG_MAIN_INITIALIZED			(_T("/main/initialized"));
+const wxString PRO_CFG_MAIN_NAME				(PROFILE_SCHEMA[PRO_KEY_MAIN_NAME].path);
+const wxString PRO_CFG_MAIN_FILENAME			(PROFILE_SCHEMA[PRO_KEY_MAIN_FILENAME].path);
+const wxString PRO_CFG_MAIN_INITIALIZED			(PROFILE_SCHEMA[PRO_KEY_MAIN_INITIALIZED].path);
 
-const wxString PRO_CFG_TC_ROOT_FOLDER			(_T("/tc/folder"));
-const wxString PRO_CFG_TC_CURRENT_BINARY		(_T("/tc/currentbinary"));
-const wxString PRO_CFG_TC_CURRENT_MODLINE		(_T("/tc/currentmodline"));
-const wxString PRO_CFG_TC_CURRENT_MOD			(_T("/tc/currentmod"));
-const wxString PRO_CFG_TC_CURRENT_FLAG_LINE		(_T("/tc/flags"));
-const wxString PRO_CFG_TC_CURRENT_FRED			(_T("/tc/currentfred"));
+const wxString PRO_CFG_TC_ROOT_FOLDER			(PROFILE_SCHEMA[PRO_KEY_TC_ROOT_FOLDER].path);
+const wxString PRO_CFG_TC_CURRENT_BINARY		(PROFILE_SCHEMA[PRO_KEY_TC_CURRENT_BINARY].path);
+const wxString PRO_CFG_TC_CURRENT_MODLINE		(PROFILE_SCHEMA[PRO_KEY_TC_CURRENT_MODLINE].path);
+const wxString PRO_CFG_TC_CURRENT_MOD			(PROFILE_SCHEMA[PRO_KEY_TC_CURRENT_MOD].path);
+const wxString PRO_CFG_TC_CURRENT_FLAG_LINE		(PROFILE_SCHEMA[PRO_KEY_TC_CURRENT_FLAG_LINE].path);
+const wxString PRO_CFG_TC_CURRENT_FRED			(PROFILE_SCHEMA[PRO_KEY_TC_CURRENT_FRED].path);
 
-const wxString PRO_CFG_VIDEO_RESOLUTION_WIDTH	(_T("/video/width"));
-const wxString PRO_CFG_VIDEO_RESOLUTION_HEIGHT	(_T("/video/height"));
+const wxString PRO_CFG_VIDEO_RESOLUTION_WIDTH	(PROFILE_SCHEMA[PRO_KEY_VIDEO_RESOLUTION_WIDTH].path);
+const wxString PRO_CFG_VIDEO_RESOLUTION_HEIGHT	(PROFILE_SCHEMA[PRO_KEY_VIDEO_RESOLUTION_HEIGHT].path);
 const wxString CFG_RES_FORMAT_STRING			(_T("%d x %d"));
-const wxString PRO_CFG_VIDEO_BIT_DEPTH			(_T("/video/depth"));
-const wxString PRO_CFG_VIDEO_ANISOTROPIC		(_T("/video/anisotropic"));
-const wxString PRO_CFG_VIDEO_ANTI_ALIAS			(_T("/video/antialias"));
-const wxString PRO_CFG_VIDEO_TEXTURE_FILTER		(_T("/video/texturefilter"));
+const wxString PRO_CFG_VIDEO_BIT_DEPTH			(PROFILE_SCHEMA[PRO_KEY_VIDEO_BIT_DEPTH].path);
+const wxString PRO_CFG_VIDEO_ANISOTROPIC		(PROFILE_SCHEMA[PRO_KEY_VIDEO_ANISOTROPIC].path);
+const wxString PRO_CFG_VIDEO_ANTI_ALIAS			(PROFILE_SCHEMA[PRO_KEY_VIDEO_ANTI_ALIAS].path);
+const wxString PRO_CFG_VIDEO_TEXTURE_FILTER		(PROFILE_SCHEMA[PRO_KEY_VIDEO_TEXTURE_FILTER].path);
 
-const wxString PRO_CFG_LIGHTING_PRESET			(_T("/lighting/preset"));
+const wxString PRO_CFG_LIGHTING_PRESET			(PROFILE_SCHEMA[PRO_KEY_LIGHTING_PRESET].path);
 
-const wxString PRO_CFG_SPEECH_VOICE				(_T("/speech/voice"));
-const wxString PRO_CFG_SPEECH_VOLUME			(_T("/speech/volume"));
-const wxString PRO_CFG_SPEECH_IN_TECHROOM		(_T("/speech/intechroom"));
-const wxString PRO_CFG_SPEECH_IN_BRIEFINGS		(_T("/speech/inbriefings"));
-const wxString PRO_CFG_SPEECH_IN_GAME			(_T("/speech/ingame"));
-const wxString PRO_CFG_SPEECH_IN_MULTI			(_T("/speech/inmulti"));
+const wxString PRO_CFG_SPEECH_VOICE				(PROFILE_SCHEMA[PRO_KEY_SPEECH_VOICE].path);
+const wxString PRO_CFG_SPEECH_VOLUME			(PROFILE_SCHEMA[PRO_KEY_SPEECH_VOLUME].path);
+const wxString PRO_CFG_SPEECH_IN_TECHROOM		(PROFILE_SCHEMA[PRO_KEY_SPEECH_IN_TECHROOM].path);
+const wxString PRO_CFG_SPEECH_IN_BRIEFINGS		(PROFILE_SCHEMA[PRO_KEY_SPEECH_IN_BRIEFINGS].path);
+const wxString PRO_CFG_SPEECH_IN_GAME			(PROFILE_SCHEMA[PRO_KEY_SPEECH_IN_GAME].path);
+const wxString PRO_CFG_SPEECH_IN_MULTI			(PROFILE_SCHEMA[PRO_KEY_SPEECH_IN_MULTI].path);
 
-const wxString PRO_CFG_NETWORK_TYPE				(_T("/network/type"));
-const wxString PRO_CFG_NETWORK_SPEED			(_T("/network/speed"));
-const wxString PRO_CFG_NETWORK_PORT				(_T("/network/port"));
-const wxString PRO_CFG_NETWORK_IP				(_T("/network/ip"));
+const wxString PRO_CFG_NETWORK_TYPE				(PROFILE_SCHEMA[PRO_KEY_NETWORK_TYPE].path);
+const wxString PRO_CFG_NETWORK_SPEED			(PROFILE_SCHEMA[PRO_KEY_NETWORK_SPEED].path);
+const wxString PRO_CFG_NETWORK_PORT				(PROFILE_SCHEMA[PRO_KEY_NETWORK_PORT].path);
+const wxString PRO_CFG_NETWORK_IP				(PROFILE_SCHEMA[PRO_KEY_NETWORK_IP].path);
 
-const wxString PRO_CFG_OPENAL_DEVICE			(_T("/openal/device"));
-const wxString PRO_CFG_OPENAL_CAPTURE_DEVICE	(_T("/openal/capturedevice"));
-const wxString PRO_CFG_OPENAL_EFX				(_T("/openal/efx"));
-const wxString PRO_CFG_OPENAL_SAMPLE_RATE		(_T("/openal/samplerate"));
+const wxString PRO_CFG_OPENAL_DEVICE			(PROFILE_SCHEMA[PRO_KEY_OPENAL_DEVICE].path);
+const wxString PRO_CFG_OPENAL_CAPTURE_DEVICE	(PROFILE_SCHEMA[PRO_KEY_OPENAL_CAPTURE_DEVICE].path);
+const wxString PRO_CFG_OPENAL_EFX				(PROFILE_SCHEMA[PRO_KEY_OPENAL_EFX].path);
+const wxString PRO_CFG_OPENAL_SAMPLE_RATE		(PROFILE_SCHEMA[PRO_KEY_OPENAL_SAMPLE_RATE].path);
 
-const wxString PRO_CFG_JOYSTICK_ID				(_T("/joystick/id"));
-const wxString PRO_CFG_JOYSTICK_FORCE_FEEDBACK	(_T("/joystick/forcefeedback"));
-const wxString PRO_CFG_JOYSTICK_DIRECTIONAL		(_T("/joystick/directional"));
+const wxString PRO_CFG_JOYSTICK_ID				(PROFILE_SCHEMA[PRO_KEY_JOYSTICK_ID].path);
+const wxString PRO_CFG_JOYSTICK_FORCE_FEEDBACK	(PROFILE_SCHEMA[PRO_KEY_JOYSTICK_FORCE_FEEDBACK].path);
+const wxString PRO_CFG_JOYSTICK_DIRECTIONAL		(PROFILE_SCHEMA[PRO_KEY_JOYSTICK_DIRECTIONAL].path);
+
+const wxString PRO_CFG_LAUNCH_PRESET			(PROFILE_SCHEMA[PRO_KEY_LAUNCH_PRESET].path);
+const wxString PRO_CFG_LAUNCH_CPUS				(PROFILE_SCHEMA[PRO_KEY_LAUNCH_CPUS].path);
 /** @}*/
@@ -30,6 +30,9 @@ inline const wxString GetProfileStorageFolder() { return wxStandardPaths::Get().
 /** \defgroup Internal Store location */
 /** @{ */
 #define INT_CONFIG_FILE_LOCATION			_T("/wxlauncher/configlocation")	//!< string
+#define INT_LAUNCH_BUILD_CAPS				_T("/wxlauncher/launch/buildcaps")	//!< int, only in launch snapshots
+#define INT_LAUNCH_JOYSTICK_GUID			_T("/wxlauncher/launch/joystickguid")	//!< string, only in launch snapshots
+#define INT_LAUNCH_PREF_FOLDER				_T("/wxlauncher/launch/preffolder")	//!< string, only in launch snapshots
 /** @} */
 
 /** \defgroup globalkeys Keys used in global config file */
@@ -94,6 +97,9 @@ extern const wxString PRO_CFG_OPENAL_SAMPLE_RATE;		//!< int
 extern const wxString PRO_CFG_JOYSTICK_ID;				//!< int
 extern const wxString PRO_CFG_JOYSTICK_FORCE_FEEDBACK;	//!< bool
 extern const wxString PRO_CFG_JOYSTICK_DIRECTIONAL;		//!< bool
+
+extern const wxString PRO_CFG_LAUNCH_PRESET;			//!< string, name of the launch preset, empty for none
+extern const wxString PRO_CFG_LAUNCH_CPUS;				//!< string, the CPUs to run on, such as "0-3,6", empty for all
 /** @}*/
 
 #endif
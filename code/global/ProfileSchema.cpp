@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <wx/string.h>
+#include <wx/hashmap.h>
+#include "global/ProfileSchema.h"
+
+#include "global/MemoryDebugging.h"
+
+// defaults agree with BasicDefaults.cpp. Callers whose default depends on
+// context, such as the system speech voice or the translated name of the
+// "no mod" entry, pass their own default when reading.
+// The size is left to the initializer so that a table that falls out of step
+// with ProfileKeyId no longer matches the declaration and fails to compile.
+const ProfileKeyInfo PROFILE_SCHEMA[] = {
+	{ _T("/main/name"),				PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/main/filename"),			PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/main/initialized"),		PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+
+	{ _T("/tc/folder"),				PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/tc/currentbinary"),		PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/tc/currentmodline"),		PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/tc/currentmod"),			PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/tc/flags"),				PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/tc/currentfred"),		PRO_KEY_TYPE_STRING,	_T(""),				0 },
+
+	{ _T("/video/width"),			PRO_KEY_TYPE_LONG,		_T("1024"),			1024 },
+	{ _T("/video/height"),			PRO_KEY_TYPE_LONG,		_T("768"),			768 },
+	{ _T("/video/depth"),			PRO_KEY_TYPE_LONG,		_T("32"),			32 },
+	{ _T("/video/anisotropic"),		PRO_KEY_TYPE_LONG,		_T("0"),			0 },
+	{ _T("/video/antialias"),		PRO_KEY_TYPE_LONG,		_T("0"),			0 },
+	{ _T("/video/texturefilter"),	PRO_KEY_TYPE_STRING,	_T("Trilinear"),	0 },
+
+	{ _T("/lighting/preset"),		PRO_KEY_TYPE_STRING,	_T(""),				0 },
+
+	{ _T("/speech/voice"),			PRO_KEY_TYPE_LONG,		_T("0"),			0 },
+	{ _T("/speech/volume"),			PRO_KEY_TYPE_LONG,		_T("100"),			100 },
+	{ _T("/speech/intechroom"),		PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+	{ _T("/speech/inbriefings"),	PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+	{ _T("/speech/ingame"),			PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+	{ _T("/speech/inmulti"),		PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+
+	{ _T("/network/type"),			PRO_KEY_TYPE_STRING,	_T("None"),			0 },
+	{ _T("/network/speed"),			PRO_KEY_TYPE_STRING,	_T("None"),			0 },
+	{ _T("/network/port"),			PRO_KEY_TYPE_LONG,		_T("0"),			0 },
+	{ _T("/network/ip"),			PRO_KEY_TYPE_STRING,	_T(""),				0 },
+
+	{ _T("/openal/device"),			PRO_KEY_TYPE_STRING,	_T("no sound"),		0 },
+	{ _T("/openal/capturedevice"),	PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/openal/efx"),			PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+	{ _T("/openal/samplerate"),		PRO_KEY_TYPE_LONG,		_T("0"),			0 },
+
+	{ _T("/joystick/id"),			PRO_KEY_TYPE_LONG,		_T("99999"),		99999 },
+	{ _T("/joystick/forcefeedback"),PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+	{ _T("/joystick/directional"),	PRO_KEY_TYPE_BOOL,		_T("0"),			0 },
+
+	{ _T("/launch/preset"),			PRO_KEY_TYPE_STRING,	_T(""),				0 },
+	{ _T("/launch/cpus"),			PRO_KEY_TYPE_STRING,	_T(""),				0 },
+};
+
+WX_DECLARE_STRING_HASH_MAP(ProfileKeyId, ProfileKeyIdMap);
+
+/** Only used when a key is written or deleted by path, which is rare
+ compared to reads. */
+ProfileKeyId FindProfileKey(const wxString& path) {
+	static ProfileKeyIdMap ids;
+	if (ids.empty()) {
+		for (int i = 0; i < PRO_KEY_COUNT; ++i) {
+			ids[PROFILE_SCHEMA[i].path] = static_cast<ProfileKeyId>(i);
+		}
+	}
+	
+	ProfileKeyIdMap::const_iterator found = ids.find(path);
+	return (found == ids.end()) ? PRO_KEY_INVALID : found->second;
+}
@@ -0,0 +1,106 @@
+/*
+ Copyright (C) 2026 wxLauncher Team
+ 
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROFILE_SCHEMA_H
+#define PROFILE_SCHEMA_H
+
+#include <wx/defs.h>
+#include <wx/chartype.h>
+#include <wx/string.h>
+
+/** \defgroup profileschema Schema of the keys used in profiles
+ Every profile key has a fixed slot, type and default, known at compile
+ time, so that the current profile's values can be kept in a flat array
+ and read by slot without building or hashing the key's path. */
+/** @{*/
+
+/** Slots of the profile keys, in the order of PROFILE_SCHEMA. */
+enum ProfileKeyId {
+	PRO_KEY_MAIN_NAME = 0,
+	PRO_KEY_MAIN_FILENAME,
+	PRO_KEY_MAIN_INITIALIZED,
+
+	PRO_KEY_TC_ROOT_FOLDER,
+	PRO_KEY_TC_CURRENT_BINARY,
+	PRO_KEY_TC_CURRENT_MODLINE,
+	PRO_KEY_TC_CURRENT_MOD,
+	PRO_KEY_TC_CURRENT_FLAG_LINE,
+	PRO_KEY_TC_CURRENT_FRED,
+
+	PRO_KEY_VIDEO_RESOLUTION_WIDTH,
+	PRO_KEY_VIDEO_RESOLUTION_HEIGHT,
+	PRO_KEY_VIDEO_BIT_DEPTH,
+	PRO_KEY_VIDEO_ANISOTROPIC,
+	PRO_KEY_VIDEO_ANTI_ALIAS,
+	PRO_KEY_VIDEO_TEXTURE_FILTER,
+
+	PRO_KEY_LIGHTING_PRESET,
+
+	PRO_KEY_SPEECH_VOICE,
+	PRO_KEY_SPEECH_VOLUME,
+	PRO_KEY_SPEECH_IN_TECHROOM,
+	PRO_KEY_SPEECH_IN_BRIEFINGS,
+	PRO_KEY_SPEECH_IN_GAME,
+	PRO_KEY_SPEECH_IN_MULTI,
+
+	PRO_KEY_NETWORK_TYPE,
+	PRO_KEY_NETWORK_SPEED,
+	PRO_KEY_NETWORK_PORT,
+	PRO_KEY_NETWORK_IP,
+
+	PRO_KEY_OPENAL_DEVICE,
+	PRO_KEY_OPENAL_CAPTURE_DEVICE,
+	PRO_KEY_OPENAL_EFX,
+	PRO_KEY_OPENAL_SAMPLE_RATE,
+
+	PRO_KEY_JOYSTICK_ID,
+	PRO_KEY_JOYSTICK_FORCE_FEEDBACK,
+	PRO_KEY_JOYSTICK_DIRECTIONAL,
+
+	PRO_KEY_LAUNCH_PRESET,
+	PRO_KEY_LAUNCH_CPUS,
+
+	PRO_KEY_COUNT,
+	PRO_KEY_INVALID = PRO_KEY_COUNT
+};
+
+enum ProfileKeyType {
+	PRO_KEY_TYPE_STRING,
+	PRO_KEY_TYPE_LONG,
+	PRO_KEY_TYPE_BOOL
+};
+
+/** A key's path in the profile, its type and its default, with the default
+ written the way wxFileConfig stores it. Plain data, so the schema is
+ initialized at compile time rather than during static initialization. */
+struct ProfileKeyInfo {
+	const wxChar* path;
+	ProfileKeyType type;
+	const wxChar* defaultValue;
+	long defaultNumber; //!< defaultValue as a number for long and bool keys
+};
+
+/** Indexed by ProfileKeyId. */
+extern const ProfileKeyInfo PROFILE_SCHEMA[PRO_KEY_COUNT];
+
+/** Returns the slot of the key with the given full path,
+ or PRO_KEY_INVALID if the key is not in the schema. */
+ProfileKeyId FindProfileKey(const wxString& path);
+/** @}*/
+
+#endif
@@ -40,10 +40,9 @@ enum WindowIDS {
 	ID_UPDATE_BUTTON,
 	ID_PLAY_BUTTON,
 	ID_ABOUT_BUTTON,
-	ID_FS2_PROCESS,
-	ID_FRED2_PROCESS,
 	
 	ID_F3_PRESSED,
+	ID_F4_PRESSED,
 
 	ID_PROFILE_COMBO,
 	ID_NEW_PROFILE,
@@ -129,13 +128,17 @@ enum WindowIDS {
 	ID_CLONE_PROFILE_NEWNAME,
 	ID_CLONE_PROFILE_CHECKBOX,
 	ID_DELETE_PROFILE_DIALOG,
+	ID_LAUNCH_HISTORY_DIALOG,
 
 	// Advanced settings page
 	ID_FLAGLISTBOX,
+	ID_FLAG_SEARCH_TEXT,
 	ID_SELECT_FLAG_SET,
 	ID_CUSTOM_FLAGS_TEXT,
 	ID_COMMAND_LINE_TEXT,
 	ID_FLAG_SET_NOTES_TEXT,
+	ID_LAUNCH_PRESET_CHOICE,
+	ID_LAUNCH_CPUS_TEXT,
 
 	ID_NET_DOWNLOAD_NEWS,
 	ID_EVENT_NET_DOWNLOAD_NEWS,
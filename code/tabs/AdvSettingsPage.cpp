@@ -27,18 +27,22 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "apis/ProfileManager.h"
 #include "apis/SkinManager.h"
 #include "controls/LightingPresets.h"
+#include "datastructures/LaunchPreset.h"
 #include "global/ids.h"
 #include "global/ProfileKeys.h"
+#include "global/ProfileSchema.h"
 #include "global/Utils.h"
 
 #include <wx/html/htmlwin.h>
+#include <wx/srchctrl.h>
 #include <wx/tokenzr.h>
 
 #include "global/MemoryDebugging.h" // Last include for memory debugging
 
 const size_t TOP_SIZER_INDEX = 0;
 const size_t TOP_LEFT_SIZER_INDEX = 0;
-const size_t WIKI_LINK_SIZER_INDEX = 1;
+const size_t FLAG_SEARCH_SIZER_INDEX = 0;
+const size_t WIKI_LINK_SIZER_INDEX = 2;
 const size_t TOP_RIGHT_SIZER_INDEX = 1;
 const size_t BOTTOM_SIZER_INDEX = 1;
 
@@ -56,6 +60,13 @@ AdvSettingsPage::AdvSettingsPage(wxWindow* parent): wxPanel(parent, wxID_ANY), f
 	TCManager::RegisterTCActiveModChanged(this);
 	ProfileProxy::GetProxy()->RegisterProxyReset(this);
 	ProfileProxy::GetProxy()->RegisterProxyFlagDataReady(this);
+	ProMan::GetProfileManager()->AddEventHandler(this);
+}
+
+AdvSettingsPage::~AdvSettingsPage() {
+	if (ProMan::IsInitialized()) {
+		ProMan::GetProfileManager()->RemoveEventHandler(this);
+	}
 }
 
 BEGIN_EVENT_TABLE(AdvSettingsPage, wxPanel)
@@ -68,6 +79,11 @@ EVT_COMMAND(wxID_NONE, EVT_CUSTOM_FLAGS_CHANGED, AdvSettingsPage::OnNeedUpdateCu
 EVT_COMMAND(wxID_NONE, EVT_FLAG_LIST_BOX_READY, AdvSettingsPage::OnFlagListBoxReady)
 EVT_TEXT(ID_CUSTOM_FLAGS_TEXT, AdvSettingsPage::OnCustomFlagsBoxChanged)
 EVT_CHOICE(ID_SELECT_FLAG_SET, AdvSettingsPage::OnSelectFlagSet)
+EVT_TEXT(ID_FLAG_SEARCH_TEXT, AdvSettingsPage::OnFlagSearchChanged)
+EVT_SEARCHCTRL_CANCEL_BTN(ID_FLAG_SEARCH_TEXT, AdvSettingsPage::OnFlagSearchCancelled)
+EVT_CHOICE(ID_LAUNCH_PRESET_CHOICE, AdvSettingsPage::OnSelectLaunchPreset)
+EVT_TEXT(ID_LAUNCH_CPUS_TEXT, AdvSettingsPage::OnLaunchCpusChanged)
+EVT_COMMAND(wxID_NONE, EVT_CURRENT_PROFILE_CHANGED, AdvSettingsPage::OnCurrentProfileChanged)
 END_EVENT_TABLE()
 
 // FIXME HACK for now, hard-code flag list box height (sigh)
@@ -82,17 +98,36 @@ const int FLAG_LIST_BOX_HEIGHT = 363;
 #endif
 
 void AdvSettingsPage::OnExeChanged(wxCommandEvent& event) {
-	if (this->GetSizer() != NULL) {
-		// detach it so it won't be deleted when we clear the sizer
-		this->lightingPresets->GetContainingSizer()->Detach(this->lightingPresets);
-		
-		this->GetSizer()->Clear(true);
+	if (this->flagListBox == NULL) {
+		this->CreateComponents();
+	} else {
+		// Keep the page as it is. The current flags stay on screen (disabled)
+		// until the new binary's flags arrive and are merged into the list.
+		this->flagListBox->BeginRefresh();
+		this->UpdateComponents();
 	}
+	
+	FlagListManager::GetFlagListManager()->BeginFlagFileProcessing();
+
+	if (!ProfileProxy::GetProxy()->IsProfileInitialized()) {
+		ProfileProxy::GetProxy()->FinishProfileInitialization();
+	}
+}
+
+/** Builds the page's controls. Done only once, the page is then kept
+ across binary changes. */
+void AdvSettingsPage::CreateComponents() {
+	wxASSERT(this->GetSizer() == NULL);
 
 	// top left components
+	wxSearchCtrl* flagSearch = new wxSearchCtrl(this, ID_FLAG_SEARCH_TEXT);
+	flagSearch->ShowCancelButton(true);
+#if wxCHECK_VERSION(2, 9, 0)
+	flagSearch->SetDescriptiveText(_("Search flags"));
+#endif
+	
 	this->flagListBox = new FlagListBox(this);
 	this->flagListBox->RegisterFlagListBoxReady(this);
-	FlagListManager::GetFlagListManager()->BeginFlagFileProcessing();
 
 #if 0 // doesn't do anything
 	wxHtmlWindow* description = new wxHtmlWindow(this);
@@ -117,6 +152,7 @@ void AdvSettingsPage::OnExeChanged(wxCommandEvent& event) {
 #endif
 
 	wxBoxSizer* topLeftSizer = new wxBoxSizer(wxVERTICAL);
+	topLeftSizer->Add(flagSearch, wxSizerFlags().Expand().Border(wxBOTTOM, 5));
 	topLeftSizer->Add(this->flagListBox, wxSizerFlags().Proportion(1).Expand());
 	topLeftSizer->Add(wikiLinkSizer, 0, wxALIGN_CENTER_HORIZONTAL|wxTOP, 5);
 
@@ -126,11 +162,28 @@ void AdvSettingsPage::OnExeChanged(wxCommandEvent& event) {
 
 	wxStaticText* flagSetChoiceLabel = new wxStaticText(this, wxID_ANY, _T("Flag sets:"));
 	wxChoice* flagSetChoice = new wxChoice(this, ID_SELECT_FLAG_SET);
+
+	wxStaticText* launchPresetLabel = new wxStaticText(this, wxID_ANY, _("Launch preset:"));
+	wxChoice* launchPresetChoice = new wxChoice(this, ID_LAUNCH_PRESET_CHOICE);
+	launchPresetChoice->Append(_("None"));
+	for (size_t i = 0; i < LaunchPreset::GetCount(); ++i) {
+		launchPresetChoice->Append(wxGetTranslation(LaunchPreset::Get(i).description));
+	}
+	wxStaticText* launchCpusLabel = new wxStaticText(this, wxID_ANY, _("Run on CPUs (such as 0-3,6):"));
+	wxTextCtrl* launchCpusText = new wxTextCtrl(this, ID_LAUNCH_CPUS_TEXT);
+#if !IS_LINUX
+	// the environment is applied everywhere, the rest only on Linux
+	launchCpusText->Disable();
+#endif
 	
 	wxBoxSizer* topRightSizer = new wxBoxSizer(wxVERTICAL);
 	topRightSizer->Add(lightingPresetsSizer, wxSizerFlags().Proportion(1).Border(wxBOTTOM, 5));
 	topRightSizer->Add(flagSetChoiceLabel, wxSizerFlags().Left().Border(wxBOTTOM, 5));
-	topRightSizer->Add(flagSetChoice, wxSizerFlags().Expand());
+	topRightSizer->Add(flagSetChoice, wxSizerFlags().Expand().Border(wxBOTTOM, 5));
+	topRightSizer->Add(launchPresetLabel, wxSizerFlags().Left().Border(wxBOTTOM, 5));
+	topRightSizer->Add(launchPresetChoice, wxSizerFlags().Expand().Border(wxBOTTOM, 5));
+	topRightSizer->Add(launchCpusLabel, wxSizerFlags().Left().Border(wxBOTTOM, 5));
+	topRightSizer->Add(launchCpusText, wxSizerFlags().Expand());
 	
 	// putting the top sizer together
 	wxBoxSizer* topSizer = new wxBoxSizer(wxHORIZONTAL);
@@ -186,11 +239,8 @@ void AdvSettingsPage::OnExeChanged(wxCommandEvent& event) {
 	sizer->Add(bottomSizer, wxSizerFlags().Expand().Proportion(1).Border(wxALL, 5));
 
 	this->SetSizer(sizer);
+	this->UpdateLaunchPresetControls();
 	this->Layout();
-
-	if (!ProfileProxy::GetProxy()->IsProfileInitialized()) {
-		ProfileProxy::GetProxy()->FinishProfileInitialization();
-	}
 }
 
 void AdvSettingsPage::OnFlagFileProcessingStatusChanged(wxCommandEvent &event) {
@@ -225,7 +275,15 @@ void AdvSettingsPage::OnNeedUpdateCustomFlags(wxCommandEvent &event) {
 	wxCHECK_RET(customFlagsText != NULL,
 		_T("Unable to find the custom flags text ctrl"));
 	
-	customFlagsText->ChangeValue(ProfileProxy::GetProxy()->GetCustomFlags());
+	// leave the text (and so the caret and selection) alone if nothing changed,
+	// which is the usual case when only the binary was switched
+	const wxString& customFlags(ProfileProxy::GetProxy()->GetCustomFlags());
+	if (customFlagsText->GetValue() != customFlags) {
+		const long insertionPoint = customFlagsText->GetInsertionPoint();
+		customFlagsText->ChangeValue(customFlags);
+		customFlagsText->SetInsertionPoint(
+			wxMin(insertionPoint, customFlagsText->GetLastPosition()));
+	}
 }
 
 void AdvSettingsPage::OnFlagListBoxReady(wxCommandEvent &WXUNUSED(event)) {
@@ -246,7 +304,11 @@ void AdvSettingsPage::OnProxyFlagDataReady(wxCommandEvent& event) {
 	wxASSERT((this->flagListBox != NULL) &&
 		ProfileProxy::GetProxy()->IsFlagDataReady());
 	
-	if (this->flagListBox->IsReady() && !this->flagListBox->FlagsLoaded()) {
+	if (this->flagListBox->IsReady()) {
+		// a profile switch that only changed the flag line reuses the rows
+		if (this->flagListBox->FlagsLoaded()) {
+			this->flagListBox->UnloadEnabledFlags();
+		}
 		this->flagListBox->LoadEnabledFlags();
 		CmdLineManager::GenerateCustomFlagsChanged();
 		CmdLineManager::GenerateCmdLineChanged();
@@ -263,8 +325,27 @@ void AdvSettingsPage::UpdateComponents() {
 	wxCHECK_RET(this->flagListBox != NULL,
 		_T("UpdateComponents() called when flagListBox was null."));
 	
-	if (this->flagListBox->IsReady()) {
+	// while the flags of a new binary are being fetched, the previous
+	// binary's flags are still shown, but cannot be changed
+	const bool isReady = this->flagListBox->IsReady();
+	const bool showFlags = isReady ||
+		(this->flagListBox->HasRows()
+		 && FlagListManager::GetFlagListManager()->GetFlagFileProcessingStatus()
+			!= FlagListManager::FLAG_FILE_PROCESSING_ERROR);
+	
+	this->flagListBox->Enable(isReady);
+	wxWindow* customFlagsText = wxWindow::FindWindowById(ID_CUSTOM_FLAGS_TEXT, this);
+	if (customFlagsText != NULL) {
+		customFlagsText->Enable(isReady);
+	}
+	wxWindow* flagSetChoice = wxWindow::FindWindowById(ID_SELECT_FLAG_SET, this);
+	if (flagSetChoice != NULL) {
+		flagSetChoice->Enable(isReady);
+	}
+	
+	if (showFlags) {
 		topSizer->Show(TOP_RIGHT_SIZER_INDEX);
+		topLeftSizer->Show(FLAG_SEARCH_SIZER_INDEX);
 		topLeftSizer->Show(WIKI_LINK_SIZER_INDEX);
 		this->GetSizer()->Show(BOTTOM_SIZER_INDEX);
 		this->flagListBox->Show();
@@ -272,6 +353,7 @@ void AdvSettingsPage::UpdateComponents() {
 		this->Layout();
 	} else {
 		topSizer->Hide(TOP_RIGHT_SIZER_INDEX);
+		topLeftSizer->Hide(FLAG_SEARCH_SIZER_INDEX);
 		topLeftSizer->Hide(WIKI_LINK_SIZER_INDEX);
 		this->GetSizer()->Hide(BOTTOM_SIZER_INDEX);
 		this->flagListBox->Hide();
@@ -320,9 +402,10 @@ void AdvSettingsPage::UpdateFlagSetsBox() {
 	wxCHECK_RET(flagSetChoice != NULL,
 		_T("Unable to find the flagset choice control"));
 	
-	// TODO rethink the following assertion when new mod.ini is supported
-	// the assertion also assumes that the flag sets box is never reused
-	wxASSERT(flagSetChoice->IsEmpty()); // shouldn't add sets more than once
+	// the box is reused across binaries, so keep the user's choice if the
+	// new binary offers the same set
+	const wxString previousSelection(flagSetChoice->GetStringSelection());
+	flagSetChoice->Clear();
 	
 	wxArrayString flagSetsArray;
 	this->flagListBox->GetFlagSets(flagSetsArray);
@@ -333,6 +416,9 @@ void AdvSettingsPage::UpdateFlagSetsBox() {
 	flagSetsArray.Remove(_T("Custom"));
 	
 	flagSetChoice->Append(flagSetsArray);
+	if (!previousSelection.IsEmpty()) {
+		flagSetChoice->SetStringSelection(previousSelection);
+	}
 	
 	wxClientDC dc(this);
 	wxArrayString flagSets = flagSetChoice->GetStrings();
@@ -367,15 +453,15 @@ void AdvSettingsPage::OnNeedUpdateCommandLine(wxCommandEvent &WXUNUSED(event)) {
 	wxString tcPath, exeName, modline;
 	wxCHECK_RET(
 		ProMan::GetProfileManager()->ProfileRead(
-			PRO_CFG_TC_ROOT_FOLDER, &tcPath),
+			PRO_KEY_TC_ROOT_FOLDER, &tcPath),
 		_T("Could not find profile entry for root folder."));
 	wxCHECK_RET(
 		ProMan::GetProfileManager()->ProfileRead(
-			PRO_CFG_TC_CURRENT_BINARY, &exeName),
+			PRO_KEY_TC_CURRENT_BINARY, &exeName),
 		_T("Could not find profile entry for FSO binary."));
 	wxCHECK_RET(
 		ProMan::GetProfileManager()->ProfileRead(
-			PRO_CFG_TC_CURRENT_MODLINE, &modline),
+			PRO_KEY_TC_CURRENT_MODLINE, &modline),
 		_T("Could not find profile entry for mod line."));
 	
 	wxString flagFileFlags(ProfileProxy::GetProxy()->GetEnabledFlagsString());
@@ -466,3 +552,68 @@ void AdvSettingsPage::OnSelectFlagSet(wxCommandEvent &WXUNUSED(event)) {
 	}
 }
 	
+
+void AdvSettingsPage::OnFlagSearchChanged(wxCommandEvent& event) {
+	wxCHECK_RET(this->flagListBox != NULL,
+		_T("OnFlagSearchChanged() called when flagListBox was null."));
+	
+	this->flagListBox->SetFilter(event.GetString());
+}
+
+void AdvSettingsPage::OnFlagSearchCancelled(wxCommandEvent& WXUNUSED(event)) {
+	wxSearchCtrl* flagSearch = dynamic_cast<wxSearchCtrl*>(
+		wxWindow::FindWindowById(ID_FLAG_SEARCH_TEXT, this));
+	wxCHECK_RET(flagSearch != NULL, _T("Unable to find the flag search control"));
+	
+	flagSearch->Clear(); // generates EVT_TEXT, which clears the filter
+}
+
+/** Shows the current profile's launch preset and CPUs. */
+void AdvSettingsPage::UpdateLaunchPresetControls() {
+	wxChoice* launchPresetChoice = dynamic_cast<wxChoice*>(
+		wxWindow::FindWindowById(ID_LAUNCH_PRESET_CHOICE, this));
+	wxCHECK_RET(launchPresetChoice != NULL,
+		_T("Unable to find the launch preset choice control"));
+	wxTextCtrl* launchCpusText = dynamic_cast<wxTextCtrl*>(
+		wxWindow::FindWindowById(ID_LAUNCH_CPUS_TEXT, this));
+	wxCHECK_RET(launchCpusText != NULL,
+		_T("Unable to find the launch CPUs text ctrl"));
+
+	wxString presetName, cpuList;
+	ProMan::GetProfileManager()->ProfileRead(PRO_CFG_LAUNCH_PRESET, &presetName, wxEmptyString);
+	ProMan::GetProfileManager()->ProfileRead(PRO_CFG_LAUNCH_CPUS, &cpuList, wxEmptyString);
+
+	int selection = 0;
+	if (!presetName.IsEmpty()) {
+		const LaunchPreset* preset = LaunchPreset::Find(presetName);
+		// one from a newer launcher is left alone unless the user picks another
+		selection = (preset == NULL) ? wxNOT_FOUND
+			: static_cast<int>(preset - &LaunchPreset::Get(0)) + 1;
+	}
+	launchPresetChoice->SetSelection(selection);
+	if (launchCpusText->GetValue() != cpuList) {
+		launchCpusText->ChangeValue(cpuList);
+	}
+}
+
+void AdvSettingsPage::OnSelectLaunchPreset(wxCommandEvent &event) {
+	const int selection = event.GetSelection();
+	wxCHECK_RET(selection >= 0 && static_cast<size_t>(selection) <= LaunchPreset::GetCount(),
+		wxString::Format(_T("Launch preset choice has no entry %d"), selection));
+
+	ProMan::GetProfileManager()->ProfileWrite(PRO_CFG_LAUNCH_PRESET,
+		(selection == 0) ? wxString() : wxString(LaunchPreset::Get(selection - 1).name));
+}
+
+void AdvSettingsPage::OnLaunchCpusChanged(wxCommandEvent &event) {
+	// a list that can't be read is still saved, and stops the launch with
+	// an error saying so, just as a bad executable does
+	ProMan::GetProfileManager()->ProfileWrite(PRO_CFG_LAUNCH_CPUS, event.GetString());
+}
+
+void AdvSettingsPage::OnCurrentProfileChanged(wxCommandEvent &event) {
+	if ((event.GetInt() & ProMan::PROFILE_CHANGED_LAUNCH)
+		&& wxWindow::FindWindowById(ID_LAUNCH_PRESET_CHOICE, this) != NULL) {
+		this->UpdateLaunchPresetControls();
+	}
+}
@@ -26,13 +26,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 class AdvSettingsPage: public wxPanel {
 public:
 	AdvSettingsPage(wxWindow* parent);
+	~AdvSettingsPage();
 
 	void OnNeedUpdateCommandLine(wxCommandEvent &event);
 
 private:
+	void CreateComponents();
 	void UpdateComponents();
 	void UpdateErrorText();
 	void UpdateFlagSetsBox();
+	void UpdateLaunchPresetControls();
 	wxString FormatCommandLineString(const wxString& origCmdLine,
 									 const int textAreaWidth);
 	FlagListBox* flagListBox;
@@ -42,11 +45,16 @@ private:
 public:
 	void OnExeChanged(wxCommandEvent& event);
 	void OnSelectFlagSet(wxCommandEvent& event);
+	void OnFlagSearchChanged(wxCommandEvent& event);
+	void OnFlagSearchCancelled(wxCommandEvent& event);
 	void OnFlagFileProcessingStatusChanged(wxCommandEvent& event);
 	void OnNeedUpdateCustomFlags(wxCommandEvent& event);
 	void OnCustomFlagsBoxChanged(wxCommandEvent& event);
 	void OnFlagListBoxReady(wxCommandEvent& event);
 	void OnProxyFlagDataReady(wxCommandEvent& event);
+	void OnSelectLaunchPreset(wxCommandEvent& event);
+	void OnLaunchCpusChanged(wxCommandEvent& event);
+	void OnCurrentProfileChanged(wxCommandEvent& event);
 
 	DECLARE_EVENT_TABLE()
 };
@@ -36,6 +36,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "global/ProfileKeys.h"
 #include "apis/FlagListManager.h"
 #include "apis/FREDManager.h"
+#include "apis/HardwareProber.h"
 #include "apis/ProfileManager.h"
 #include "apis/TCManager.h"
 #include "apis/SpeechManager.h"
@@ -44,6 +45,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "apis/resolution_manager.hpp"
 #include "apis/HelpManager.h"
 #include "controls/ModList.h"
+#include "datastructures/ExecutableCatalog.h"
 #include "datastructures/FSOExecutable.h"
 #include "datastructures/ResolutionMap.h"
 
@@ -164,12 +166,26 @@ BasicSettingsPage::BasicSettingsPage(wxWindow* parent): wxPanel(parent, wxID_ANY
 	ProMan::GetProfileManager()->AddEventHandler(this);
 	FlagListManager::GetFlagListManager()->RegisterFlagFileProcessingStatusChanged(this);
 	FREDManager::RegisterFREDEnabledChanged(this);
+	// before the settings are shown, so they can be shown from what was found last time
+	HardwareProber::Initialize();
+	HardwareProber::RegisterHardwareSnapshotChanged(this);
 	wxCommandEvent event(this->GetId());
 	this->ProfileChanged(event);
+	HardwareProber::Get()->Probe();
 }
 
-void BasicSettingsPage::ProfileChanged(wxCommandEvent &WXUNUSED(event)) {
-	if (this->GetSizer() != NULL) {
+void BasicSettingsPage::ProfileChanged(wxCommandEvent &event) {
+	const int changes = event.GetInt();
+	const bool isRebuild = (this->GetSizer() != NULL);
+
+	// the executable section follows the TC events from TCManager,
+	// so the page only needs rebuilding when the settings below it differ
+	if (isRebuild && !(changes & ProMan::PROFILE_CHANGED_SETTINGS)) {
+		wxLogDebug(_T("BasicSettingsPage: new profile has the same settings, keeping page."));
+		return;
+	}
+
+	if (isRebuild) {
 		this->GetSizer()->Clear(true);
 	}
 
@@ -707,6 +723,23 @@ void BasicSettingsPage::ProfileChanged(wxCommandEvent &WXUNUSED(event)) {
 
 	this->SetSizer(sizer);
 	this->Layout();
+
+	// TCManager only sends EVT_TC_CHANGED for a new root folder, so restore
+	// what the rebuild threw away from the profile and the active mod
+	if (isRebuild && !(changes & ProMan::PROFILE_CHANGED_TC_ROOT_FOLDER)) {
+		this->UpdateExecutableChoices();
+
+		wxCommandEvent nullEvent;
+		this->OnCurrentBinaryChanged(nullEvent);
+		bool fredEnabled;
+		proman->GlobalRead(GBL_CFG_OPT_CONFIG_FRED, &fredEnabled, false);
+		if (fredEnabled) {
+			this->OnCurrentFredBinaryChanged(nullEvent);
+		}
+		if (ModList::GetActiveMod() != NULL) {
+			this->OnActiveModChanged(nullEvent);
+		}
+	}
 }
 
 BasicSettingsPage::~BasicSettingsPage() {
@@ -714,6 +747,9 @@ BasicSettingsPage::~BasicSettingsPage() {
 	if ( SpeechMan::IsInitialized() ) {
 		SpeechMan::DeInitialize();
 	}
+	// waits for the prober, which may still be using OpenAL
+	HardwareProber::UnRegisterHardwareSnapshotChanged(this);
+	HardwareProber::DeInitialize();
 	JoyMan::DeInitialize();
 	OpenALMan::DeInitialize();
 }
@@ -732,6 +768,8 @@ EVT_COMMAND(wxID_NONE, EVT_TC_FRED_BINARY_CHANGED, BasicSettingsPage::OnCurrentF
 EVT_COMMAND(wxID_NONE, EVT_FLAG_FILE_PROCESSING_STATUS_CHANGED,
 	BasicSettingsPage::OnFlagFileProcessingStatusChanged)
 EVT_COMMAND(wxID_NONE, EVT_FRED_ENABLED_CHANGED, BasicSettingsPage::OnFREDEnabledChanged)
+EVT_COMMAND(wxID_NONE, EVT_HARDWARE_SNAPSHOT_CHANGED, BasicSettingsPage::OnHardwareSnapshotChanged)
+EVT_COMMAND(wxID_NONE, EVT_HARDWARE_JOYSTICK_CHANGED, BasicSettingsPage::OnHardwareJoystickChanged)
 
 // Video controls
 EVT_CHOICE(ID_RESOLUTION_COMBO, BasicSettingsPage::OnSelectVideoResolution)
@@ -787,6 +825,24 @@ void BasicSettingsPage::OnFlagFileProcessingStatusChanged(wxCommandEvent& event)
 	}
 }
 
+/** Shows the hardware the prober found in place of what was shown. */
+void BasicSettingsPage::OnHardwareSnapshotChanged(wxCommandEvent& WXUNUSED(event)) {
+	if (!FlagListManager::GetFlagListManager()->IsProcessingOK()) {
+		// the sections will be set up once it is
+		return;
+	}
+	if (OpenALMan::IsInitialized()) {
+		this->soundDeviceCombo->Clear();
+		this->captureDeviceCombo->Clear();
+		this->SetupOpenALSection();
+	}
+	this->SetupJoystickSection();
+	if (ModList::GetActiveMod() != NULL) {
+		wxCommandEvent nullEvent;
+		this->OnActiveModChanged(nullEvent);
+	}
+}
+
 void BasicSettingsPage::OnFREDEnabledChanged(wxCommandEvent& WXUNUSED(event)) {
 	wxStaticText* useFredText = dynamic_cast<wxStaticText*>(
 		wxWindow::FindWindowById(ID_EXE_FRED_CHOICE_TEXT, this));
@@ -866,6 +922,24 @@ specified in the profile does not exist in the TC.
 \note clearing the selected executable disables the play button.
 \note Emits a EVT_TC_BINARY_CHANGED in any case.*/
 void BasicSettingsPage::OnTCChanged(wxCommandEvent &WXUNUSED(event)) {
+	this->UpdateExecutableChoices();
+
+	bool fredEnabled;
+	ProMan::GetProfileManager()->GlobalRead(GBL_CFG_OPT_CONFIG_FRED, &fredEnabled, false);
+
+	// TCManager::CurrentProfileChanged() (which calls TCManager::GenerateTCChanged())
+	// assumes that TCManager::GenerateTCBinaryChanged() is called here unconditionally
+	TCManager::GenerateTCBinaryChanged();
+	// TCManager::CurrentProfileChanged() also assumes that TCManager::GenerateTCFredBinaryChanged()
+	// is called here unconditionally if FRED launching is enabled
+	if (fredEnabled) {
+		TCManager::GenerateTCFredBinaryChanged();
+	}
+}
+
+/** Refills the root folder box and the executable choices from the profile,
+ without telling anyone that the binaries changed. */
+void BasicSettingsPage::UpdateExecutableChoices() {
 	ExeChoice* exeChoice = dynamic_cast<ExeChoice*>(
 		wxWindow::FindWindowById(ID_EXE_CHOICE_BOX, this));
 	wxCHECK_RET( exeChoice != NULL, 
@@ -956,15 +1030,6 @@ void BasicSettingsPage::OnTCChanged(wxCommandEvent &WXUNUSED(event)) {
 		this->DisableExecutableChoiceControls(MISSING_TC_ROOT_FOLDER);
 	}
 	this->GetSizer()->Layout();
-
-	// TCManager::CurrentProfileChanged() (which calls TCManager::GenerateTCChanged())
-	// assumes that TCManager::GenerateTCBinaryChanged() is called here unconditionally
-	TCManager::GenerateTCBinaryChanged();
-	// TCManager::CurrentProfileChanged() also assumes that TCManager::GenerateTCFredBinaryChanged()
-	// is called here unconditionally if FRED launching is enabled
-	if (fredEnabled) {
-		TCManager::GenerateTCFredBinaryChanged();
-	}
 }
 
 /** Puts the pretty description of all of the executables in the TCs folder
@@ -972,39 +1037,32 @@ into the Executable DropBox.  This function does nothing else to the choice
 control, not even clearing the drop box (call the Clear function if you don't
 want the old items to stay. */
 void BasicSettingsPage::FillFSOExecutableDropBox(wxChoice* exeChoice, wxFileName path) {
-	BasicSettingsPage::FillExecutableDropBox(exeChoice, FSOExecutable::GetBinariesFromRootFolder(path));
+	BasicSettingsPage::FillExecutableDropBox(exeChoice, path, FSOExecutable::GetBinariesFromRootFolder(path));
 }
 
 void BasicSettingsPage::FillFredExecutableDropBox(wxChoice* exeChoice, wxFileName path) {
-	BasicSettingsPage::FillExecutableDropBox(exeChoice, FSOExecutable::GetFredBinariesFromRootFolder(path));
+	BasicSettingsPage::FillExecutableDropBox(exeChoice, path, FSOExecutable::GetFredBinariesFromRootFolder(path));
 }
 
-bool compareExecutables(FSOExecutable exe1, FSOExecutable exe2) {
-	return exe1.GetVersionString().CmpNoCase(exe2.GetVersionString()) < 0;
-}
-
-void BasicSettingsPage::FillExecutableDropBox(wxChoice* exeChoice, wxArrayString exes) {
-	std::vector<FSOExecutable> fsoExes;
+void BasicSettingsPage::FillExecutableDropBox(wxChoice* exeChoice, const wxFileName& path, const wxArrayString& exes) {
+	// the catalog parsed every executable's version when it listed the folder
+	ExecutableCatalog* catalog = ExecutableCatalog::Get();
+	std::vector<const FSOExecutable*> fsoExes;
+	fsoExes.reserve(exes.GetCount());
 	
-	wxArrayString::iterator iter = exes.begin();
-	while ( iter != exes.end() ) {
-		wxFileName path(*iter);
-#if IS_APPLE // need complete path through app bundle to executable
-		FSOExecutable ver = FSOExecutable::GetBinaryVersion(path.GetFullPath());
-#else
-		FSOExecutable ver = FSOExecutable::GetBinaryVersion(path.GetFullName());
-#endif
-		
-		fsoExes.push_back(ver);
-		iter++;
+	for (size_t i = 0; i < exes.GetCount(); ++i) {
+		const ExecutableCatalogEntry* entry = catalog->Find(path, exes[i]);
+		if (entry != NULL) {
+			fsoExes.push_back(&entry->executable);
+		}
 	}
 	
-	sort(fsoExes.begin(), fsoExes.end(), compareExecutables);
+	sort(fsoExes.begin(), fsoExes.end(), FSOExecutable::IsOlderThan);
 	
-	for (std::vector<FSOExecutable>::const_iterator
+	for (std::vector<const FSOExecutable*>::const_iterator
 		 it = fsoExes.begin(), end = fsoExes.end();
 		 it != end; ++it) {
-		exeChoice->Append(it->GetVersionString(), new FSOExecutable(*it));
+		exeChoice->Append((*it)->GetVersionString(), new FSOExecutable(**it));
 	}
 }
 
@@ -1361,6 +1419,12 @@ void BasicSettingsPage::OnCurrentBinaryChanged(wxCommandEvent& event) {
 	}
 	
 	bool hasBinary = ProMan::GetProfileManager()->ProfileRead(PRO_CFG_TC_CURRENT_BINARY, &binaryName);
+	// a profile switch within the same root folder doesn't refill the choice
+	ExeChoice* exeChoice = dynamic_cast<ExeChoice*>(
+		wxWindow::FindWindowById(ID_EXE_CHOICE_BOX, this));
+	if (hasBinary && exeChoice != NULL) {
+		exeChoice->FindAndSetSelectionWithClientData(binaryName);
+	}
 	this->isCurrentBinaryValid =
 		this->isTcRootFolderValid && hasBinary && wxFileName::FileExists(tcPath + wxFileName::GetPathSeparator() + binaryName);
 
@@ -1394,6 +1458,11 @@ void BasicSettingsPage::OnCurrentFredBinaryChanged(wxCommandEvent& event) {
 	}
 
 	bool hasFredBinary = ProMan::GetProfileManager()->ProfileRead(PRO_CFG_TC_CURRENT_FRED, &fredBinaryName);
+	ExeChoice* fredChoice = dynamic_cast<ExeChoice*>(
+		wxWindow::FindWindowById(ID_EXE_FRED_CHOICE_BOX, this));
+	if (hasFredBinary && fredChoice != NULL) {
+		fredChoice->FindAndSetSelectionWithClientData(fredBinaryName);
+	}
 	this->isCurrentFredBinaryValid =
 		this->isTcRootFolderValid && hasFredBinary && wxFileName::FileExists(tcPath + wxFileName::GetPathSeparator() + fredBinaryName);
 
@@ -1705,6 +1774,34 @@ void BasicSettingsPage::OnSelectNetworkType(wxCommandEvent &event) {
 		networkTypeOptions[networkType->GetSelection()].GetRegistryValue());
 }
 
+/** The hardware found by the prober, which is empty until it has found any. */
+static HardwareSnapshotPtr GetHardware() {
+	return HardwareProber::IsInitialized()
+		? HardwareProber::Get()->GetSnapshot() : HardwareSnapshotPtr();
+}
+
+static bool IsEFXSupported(const wxString& playbackDevice) {
+	const HardwareSnapshotPtr hardware(GetHardware());
+	const HardwareAudioDevice* device = hardware.IsOk()
+		? hardware->FindPlaybackDevice(playbackDevice) : NULL;
+	return (device != NULL) ? device->hasEFX : OpenALMan::IsEFXSupported(playbackDevice);
+}
+
+static wxString GetOpenALVersion() {
+	wxString selectedDevice;
+	ProMan::GetProfileManager()->ProfileRead(PRO_CFG_OPENAL_DEVICE, &selectedDevice);
+	
+	const HardwareSnapshotPtr hardware(GetHardware());
+	const HardwareAudioDevice* device = hardware.IsOk()
+		? hardware->FindPlaybackDevice(selectedDevice) : NULL;
+	if (device == NULL) {
+		return OpenALMan::GetCurrentVersion();
+	} else if (!device->isOk) {
+		return device->version; // why it couldn't be opened
+	}
+	return wxString::Format(_("Detected OpenAL version: %s"), device->version.c_str());
+}
+
 void BasicSettingsPage::OnSelectSoundDevice(wxCommandEvent &event) {
 	wxChoice* openaldevice = dynamic_cast<wxChoice*>(
 		wxWindow::FindWindowById(event.GetId(), this));
@@ -1717,7 +1814,7 @@ void BasicSettingsPage::OnSelectSoundDevice(wxCommandEvent &event) {
 			wxWindow::FindWindowById(ID_ENABLE_EFX));
 		wxCHECK_RET(enableEFX != NULL, _T("Unable to find enable EFX checkbox"));
 
-		enableEFX->Show(OpenALMan::IsEFXSupported(openaldevice->GetStringSelection()));
+		enableEFX->Show(IsEFXSupported(openaldevice->GetStringSelection()));
 	}
 }
 
@@ -1793,18 +1890,36 @@ void BasicSettingsPage::InitializeSoundDeviceDropDownBox(
 	wxArrayString availableDevices;
 	wxString defaultDevice;
 	
+	// the devices the prober found, if it has looked at them
+	const HardwareSnapshotPtr hardware(GetHardware());
+	const HardwareInfo* known =
+		(hardware.IsOk() && hardware->GetInfo().hasAudio) ? &hardware->GetInfo() : NULL;
+	
 	if (deviceType == PLAYBACK) {
 		deviceDropDownBoxID = ID_SELECT_SOUND_DEVICE;
 		// (deviceTypeNameAdjustment remains empty in this case)
 		deviceProfileEntryName = PRO_CFG_OPENAL_DEVICE;
-		availableDevices = OpenALMan::GetAvailablePlaybackDevices();
-		defaultDevice = OpenALMan::GetSystemDefaultPlaybackDevice();
+		if (known != NULL) {
+			for (HardwareAudioDevices::const_iterator it = known->playbackDevices.begin(),
+				 end = known->playbackDevices.end(); it != end; ++it) {
+				availableDevices.Add(it->name);
+			}
+			defaultDevice = known->defaultPlaybackDevice;
+		} else {
+			availableDevices = OpenALMan::GetAvailablePlaybackDevices();
+			defaultDevice = OpenALMan::GetSystemDefaultPlaybackDevice();
+		}
 	} else {
 		deviceDropDownBoxID = ID_SELECT_CAPTURE_DEVICE;
 		deviceTypeNameAdjustment = _T(" capture");
 		deviceProfileEntryName = PRO_CFG_OPENAL_CAPTURE_DEVICE;
-		availableDevices = OpenALMan::GetAvailableCaptureDevices();
-		defaultDevice = OpenALMan::GetSystemDefaultCaptureDevice();
+		if (known != NULL) {
+			availableDevices = known->captureDevices;
+			defaultDevice = known->defaultCaptureDevice;
+		} else {
+			availableDevices = OpenALMan::GetAvailableCaptureDevices();
+			defaultDevice = OpenALMan::GetSystemDefaultCaptureDevice();
+		}
 	}
 	
 	wxChoice* deviceDropDownBox = dynamic_cast<wxChoice*>(
@@ -1950,7 +2065,7 @@ void BasicSettingsPage::SetupOpenALSection() {
 			this->audioSizer->Show(this->audioNewSoundSizer, true);
 			
 			const wxString playbackDevice(this->soundDeviceCombo->GetStringSelection());
-			if (!OpenALMan::IsEFXSupported(playbackDevice)) {
+			if (!IsEFXSupported(playbackDevice)) {
 				wxLogDebug(
 					_T("Playback device '%s' does not support EFX.")
 					_T(" Hiding Enable EFX checkbox."),
@@ -2023,7 +2138,7 @@ void BasicSettingsPage::SetupOpenALSection() {
 		this->soundDeviceText->Enable();
 		this->soundDeviceCombo->Enable();
 		
-		wxLogInfo(OpenALMan::GetCurrentVersion());
+		wxLogInfo(GetOpenALVersion());
 		
 		this->audioOldSoundSizer->Hide(this->openALVersion);
 		
@@ -2052,6 +2167,7 @@ private:
 
 void BasicSettingsPage::SetupJoystickSection() {
 	this->joystickSelected->Clear();
+	this->joysticks.clear();
 	if ( !JoyMan::WasCompiledIn() ) {
 		this->joystickSelected->Disable();
 		this->joystickSelected->Append(_("No Launcher Support"));
@@ -2081,7 +2197,12 @@ void BasicSettingsPage::SetupJoystickSection() {
 		}
 #endif
 
-		if (!JoyMan::Initialize(apiType)) {
+		// use the joysticks the prober found if it looked with the same API
+		const HardwareSnapshotPtr hardware(GetHardware());
+		const bool isKnown = hardware.IsOk()
+			&& hardware->GetInfo().joystickApi == static_cast<int>(apiType);
+
+		if (!isKnown && !JoyMan::Initialize(apiType)) {
 			this->joystickSelected->Disable();
 			this->joystickSelected->Append(_("Initialize Failed"));
 			this->joystickForceFeedback->Disable();
@@ -2092,16 +2213,25 @@ void BasicSettingsPage::SetupJoystickSection() {
 #endif
 		}
 		else {
+			if (isKnown) {
+				this->joysticks = hardware->GetInfo().joysticks;
+			} else {
+				HardwareProber::FindJoysticks(this->joysticks);
+			}
+
+			unsigned int pluggedInJoysticks = 0;
 			this->joystickSelected
 				->Append(_("No Joystick"), new JoyNumber(DEFAULT_JOYSTICK_ID));
-			for (unsigned int i = 0; i < JoyMan::NumberOfJoysticks(); i++) {
-				if (JoyMan::IsJoystickPluggedIn(i)) {
+			for (unsigned int i = 0; i < this->joysticks.size(); i++) {
+				// joysticks that aren't plugged in have no name
+				if (!this->joysticks[i].name.IsEmpty()) {
 					this->joystickSelected
-						->Append(JoyMan::JoystickName(i), new JoyNumber(i));
+						->Append(this->joysticks[i].name, new JoyNumber(i));
+					pluggedInJoysticks++;
 				}
 			}
 
-			if (JoyMan::NumberOfPluggedInJoysticks() == 0) {
+			if (pluggedInJoysticks == 0) {
 				this->joystickSelected->SetSelection(0);
 				this->joystickSelected->Disable();
 				this->joystickForceFeedback->Disable();
@@ -2138,7 +2268,8 @@ void BasicSettingsPage::SetupJoystickSection() {
 				}
 				// Getting here means that the joystick is no longer installed
 				// or is not plugged in
-				if (JoyMan::IsJoystickPluggedIn(profileJoystick)) {
+				if (profileJoystick >= 0
+					&& static_cast<size_t>(profileJoystick) < this->joysticks.size()) {
 					wxLogWarning(_T("Last selected joystick is not plugged in"));
 				}
 				else {
@@ -2166,7 +2297,12 @@ void BasicSettingsPage::SetupControlsForJoystick(unsigned int i) {
 	}
 #endif
 
-	if ( JoyMan::SupportsForceFeedback(joynumber->GetNumber()) ) {
+	const int number = joynumber->GetNumber();
+	const bool hasForceFeedback = (number >= 0)
+		&& (static_cast<size_t>(number) < this->joysticks.size())
+		&& this->joysticks[number].hasForceFeedback;
+
+	if ( hasForceFeedback ) {
 		bool ff, direct;
 		ProMan::GetProfileManager()->ProfileRead(
 			PRO_CFG_JOYSTICK_DIRECTIONAL, &direct, DEFAULT_JOYSTICK_DIRECTIONAL, true);
@@ -2182,15 +2318,95 @@ void BasicSettingsPage::SetupControlsForJoystick(unsigned int i) {
 		this->joystickForceFeedback->Disable();
 	}
 
+	if (number >= 0 && static_cast<size_t>(number) < this->joysticks.size()
+		&& !this->joysticks[number].guid.IsEmpty()) {
+		this->selectedJoystickGUID = this->joysticks[number].guid;
+	}
+
 	ProMan::GetProfileManager()->ProfileWrite(PRO_CFG_JOYSTICK_ID, static_cast<long>(joynumber->GetNumber()));
 }
 
 void BasicSettingsPage::OnSelectJoystick(
 	wxCommandEvent &WXUNUSED(event)) {
+	if (this->joystickSelected->GetSelection() == 0) {
+		// chose "No Joystick", so don't bring the last one back
+		this->selectedJoystickGUID.Clear();
+	}
 	this->SetupControlsForJoystick(
 		this->joystickSelected->GetSelection());
 }
 
+/** Adds or removes the one joystick that was plugged in or unplugged,
+ leaving the rest of the section as it is. */
+void BasicSettingsPage::OnHardwareJoystickChanged(wxCommandEvent& event) {
+	const HardwareSnapshotPtr hardware(GetHardware());
+	const int number = event.GetInt();
+	if (!hardware.IsOk() || number < 0
+		|| static_cast<size_t>(number) >= hardware->GetInfo().joysticks.size()) {
+		return;
+	}
+	if (this->joystickSelected->IsEmpty()
+		|| !this->joystickSelected->HasClientObjectData()) {
+		// the section isn't showing a joystick list, so start it over
+		this->SetupJoystickSection();
+		return;
+	}
+
+	const HardwareJoystick& joystick = hardware->GetInfo().joysticks[number];
+	if (this->joysticks.size() < hardware->GetInfo().joysticks.size()) {
+		this->joysticks.resize(hardware->GetInfo().joysticks.size());
+	}
+	this->joysticks[number] = joystick;
+
+	// the entries after "No Joystick" are in number order
+	const int selection = this->joystickSelected->GetSelection();
+	bool wasSelected = false;
+	unsigned int position = this->joystickSelected->GetCount();
+	for (unsigned int i = 1; i < this->joystickSelected->GetCount(); i++) {
+		JoyNumber* data = dynamic_cast<JoyNumber*>(
+			this->joystickSelected->GetClientObject(i));
+		wxCHECK2_MSG(data != NULL, continue,
+			_T("JoyNumber is not the clientObject in joystickSelected"));
+		if (data->GetNumber() == number) {
+			wasSelected = (selection == static_cast<int>(i));
+			this->joystickSelected->Delete(i);
+			position = i;
+			break;
+		} else if (data->GetNumber() > number) {
+			position = i;
+			break;
+		}
+	}
+
+	if (!joystick.name.IsEmpty()) {
+		this->joystickSelected->Insert(joystick.name, position, new JoyNumber(number));
+		if (wasSelected
+			|| (this->joystickSelected->GetSelection() <= 0
+				&& !this->selectedJoystickGUID.IsEmpty()
+				&& joystick.guid == this->selectedJoystickGUID)) {
+			wxLogInfo(_T("Joystick '%s' is plugged in"), joystick.name.c_str());
+			this->joystickSelected->SetSelection(position);
+			this->SetupControlsForJoystick(position);
+		}
+	} else if (wasSelected) {
+		// keep the profile's joystick so that it is chosen again when it is
+		// plugged back in, but show that it can't be used for now
+		wxLogInfo(_T("Selected joystick has been unplugged"));
+		this->joystickSelected->SetSelection(0);
+		this->joystickForceFeedback->Disable();
+		this->joystickDirectionalHit->Disable();
+#if IS_WIN32
+		this->joystickCalibrateButton->Disable();
+#endif
+	}
+
+	if (this->joystickSelected->GetSelection() == wxNOT_FOUND) {
+		this->joystickSelected->SetSelection(0);
+	}
+	// disabled when only "No Joystick" is left
+	this->joystickSelected->Enable(this->joystickSelected->GetCount() > 1);
+}
+
 void BasicSettingsPage::OnCheckForceFeedback(
 	wxCommandEvent &event) {
 		ProMan::GetProfileManager()->ProfileWrite(PRO_CFG_JOYSTICK_FORCE_FEEDBACK, event.IsChecked());
@@ -2213,9 +2429,8 @@ void BasicSettingsPage::OnCalibrateJoystick(
 }
 
 void BasicSettingsPage::OnDetectJoystick(wxCommandEvent &WXUNUSED(event)) {
-		if ( JoyMan::DeInitialize() ) {
-			this->SetupJoystickSection();
-		}
+		// the section is set up again if the prober finds something different
+		HardwareProber::Get()->Probe();
 }
 
 //////////// ProxyChoice
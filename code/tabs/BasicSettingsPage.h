@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <wx/wx.h>
 
 #include "controls/TruncatableChoice.h"
+#include "datastructures/HardwareSnapshot.h"
 
 #include "global/ModDefaults.h"
 
@@ -75,13 +76,15 @@ public:
 
 	void ProfileChanged(wxCommandEvent& event);
 	void OnFlagFileProcessingStatusChanged(wxCommandEvent& event);
+	void OnHardwareSnapshotChanged(wxCommandEvent& event);
+	void OnHardwareJoystickChanged(wxCommandEvent& event);
 	void OnFREDEnabledChanged(wxCommandEvent& event);
 	void OnActiveModChanged(wxCommandEvent& event);
 
 private:
 	static void FillFSOExecutableDropBox(wxChoice* exeChoice, wxFileName path);
 	static void FillFredExecutableDropBox(wxChoice* exeChoice, wxFileName path);
-	static void FillExecutableDropBox(wxChoice* exeChoice, wxArrayString exes);
+	static void FillExecutableDropBox(wxChoice* exeChoice, const wxFileName& path, const wxArrayString& exes);
 	
 	void SetUpResolution(
 		long minHorizRes = DEFAULT_MOD_RESOLUTION_MIN_HORIZONTAL_RES,
@@ -96,6 +99,7 @@ private:
 	};
 	
 	void InitializeMemberVariables();
+	void UpdateExecutableChoices();
 	void DisableExecutableChoiceControls(const ReasonForExecutableDisabling reason);
 	void OnCurrentBinaryChanged(wxCommandEvent& event);
 	void OnCurrentFredBinaryChanged(wxCommandEvent& event);
@@ -136,6 +140,8 @@ private:
 #if IS_WIN32
 	wxButton* joystickCalibrateButton;
 #endif
+	HardwareJoysticks joysticks; //!< the joysticks in joystickSelected, by JoyNumber
+	wxString selectedJoystickGUID; //!< reselected if it is plugged in again
 	bool isTcRootFolderValid;
 	bool isCurrentBinaryValid;
 	bool isCurrentFredBinaryValid;
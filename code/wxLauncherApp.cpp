@@ -42,8 +42,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "apis/TCManager.h"
 #include "apis/ProfileManager.h"
 #include "apis/HelpManager.h"
+#include "apis/LaunchBenchmark.h"
 #include "apis/FlagListManager.h"
 #include "apis/ProfileProxy.h"
+#include "apis/resolution_manager.hpp"
+#include "datastructures/ExecutableCatalog.h"
 
 #include "global/MemoryDebugging.h" // Last include for memory debugging
 
@@ -68,6 +71,46 @@ void wxLauncher::OnInitCmdLine(wxCmdLineParser& parser)
 		"The name of a profile to operate on. Operand PROFILE.";
 	static const char filedesc[] =
 		"The path to a file to operate on. Operand FILE.";
+	static const char benchmarksavedesc[] =
+		"Time saving COUNT scratch copies of the current profile, "
+		"one file at a time and as a single batch, then report the "
+		"throughput. *Operator*";
+	static const char benchmarkclonedesc[] =
+		"Time making COUNT clones of the current profile and reverting "
+		"a change to it, by deep copy and by template/journal, at the "
+		"profile's own size and padded, then report the cost per "
+		"operation. *Operator*";
+	static const char benchmarkpilotcopydesc[] =
+		"Time copying a scratch folder of COUNT pilot files the way they "
+		"are copied for SDL builds, starting from each copy method, then "
+		"report the throughput and which methods did the copies. "
+		"*Operator*";
+	static const char importdatabasedesc[] =
+		"Copy all profiles and global settings into a single profile "
+		"database file and use it from then on. The profile files are "
+		"kept as a backup. *Operator*";
+	static const char exportdatabasedesc[] =
+		"Write all profiles in the profile database back out to profile "
+		"files, then remove the database. *Operator*";
+	static const char batchdesc[] =
+		"Apply the profile operations listed in FILE, one per line, "
+		"writing each changed profile once at the end, then report the "
+		"throughput. *Operator*";
+	static const char benchmarklaunchdesc[] =
+		"Launch the game, or a stand-in for it, COUNT times (5 by "
+		"default) for each profile or mod and flag combination listed in "
+		"FILE, then report how each compares with the first. *Operator*";
+	static const char checksupervisordesc[] =
+		"Run the stand-in for the game at FILE through the process "
+		"supervisor in the ways the launcher does, and report whether "
+		"what it saw is what the stand-in did. Linux only. *Operator*";
+	static const char checkgraphicsmodesdesc[] =
+		"List the graphics modes found for a known set of modes and with "
+		"SDL's dummy and offscreen video drivers, which don't ask the "
+		"real displays, grouped by aspect ratio as the video settings "
+		"show them. *Operator*";
+	static const char countdesc[] =
+		"The number of items to operate on. Operand COUNT.";
 	static const char sessiononlydesc[] =
 		"Do not remember the profile that is selected at exit";
 
@@ -76,6 +119,24 @@ void wxLauncher::OnInitCmdLine(wxCmdLineParser& parser)
 		wxGetTranslation(wxString::FromUTF8(addprofiledesc)));
 	parser.AddSwitch(wxEmptyString, wxT_2("select-profile"),
 		wxGetTranslation(wxString::FromUTF8(selectprofiledesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("benchmark-save"),
+		wxGetTranslation(wxString::FromUTF8(benchmarksavedesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("benchmark-clone"),
+		wxGetTranslation(wxString::FromUTF8(benchmarkclonedesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("benchmark-pilot-copy"),
+		wxGetTranslation(wxString::FromUTF8(benchmarkpilotcopydesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("import-profiles-to-database"),
+		wxGetTranslation(wxString::FromUTF8(importdatabasedesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("export-profiles-from-database"),
+		wxGetTranslation(wxString::FromUTF8(exportdatabasedesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("batch-profiles"),
+		wxGetTranslation(wxString::FromUTF8(batchdesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("benchmark-launch"),
+		wxGetTranslation(wxString::FromUTF8(benchmarklaunchdesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("check-process-supervisor"),
+		wxGetTranslation(wxString::FromUTF8(checksupervisordesc)));
+	parser.AddSwitch(wxEmptyString, wxT_2("check-graphics-modes"),
+		wxGetTranslation(wxString::FromUTF8(checkgraphicsmodesdesc)));
 
 	/* Operands */
 	parser.AddOption(wxEmptyString, wxT_2("profile"),
@@ -84,6 +145,9 @@ void wxLauncher::OnInitCmdLine(wxCmdLineParser& parser)
 	parser.AddOption(wxEmptyString, wxT_2("file"),
 		wxGetTranslation(wxString::FromUTF8(filedesc)),
 		wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, wxT_2("count"),
+		wxGetTranslation(wxString::FromUTF8(countdesc)),
+		wxCMD_LINE_VAL_NUMBER);
 
 	/* Other */
 	parser.AddSwitch(wxEmptyString, wxT_2("session-only"),
@@ -127,12 +191,89 @@ bool wxLauncher::OnCmdLineParsed(wxCmdLineParser& parser)
 			return false;
 		}
 	}
+	else if(parser.Found(wxT_2("benchmark-save")))
+	{
+		mProfileOperator = ProManOperator::benchmarksave;
+		if (parser.Found(wxT_2("count"), &mCountOperand) && mCountOperand <= 0)
+		{
+			wxLogError(_("Count must be a positive number"));
+			return false;
+		}
+	}
+	else if(parser.Found(wxT_2("benchmark-clone")))
+	{
+		mProfileOperator = ProManOperator::benchmarkclone;
+		if (parser.Found(wxT_2("count"), &mCountOperand) && mCountOperand <= 0)
+		{
+			wxLogError(_("Count must be a positive number"));
+			return false;
+		}
+	}
+	else if(parser.Found(wxT_2("benchmark-pilot-copy")))
+	{
+		mProfileOperator = ProManOperator::benchmarkpilotcopy;
+		if (parser.Found(wxT_2("count"), &mCountOperand) && mCountOperand <= 0)
+		{
+			wxLogError(_("Count must be a positive number"));
+			return false;
+		}
+	}
+	else if(parser.Found(wxT_2("import-profiles-to-database")))
+	{
+		mProfileOperator = ProManOperator::importdatabase;
+	}
+	else if(parser.Found(wxT_2("export-profiles-from-database")))
+	{
+		mProfileOperator = ProManOperator::exportdatabase;
+	}
+	else if(parser.Found(wxT_2("batch-profiles")))
+	{
+		mProfileOperator = ProManOperator::batchprofiles;
+		if (!parser.Found(wxT_2("file"), &mFileOperand))
+		{
+			wxLogError(_("No manifest file specified for batch"));
+			return false;
+		}
+	}
+	else if(parser.Found(wxT_2("benchmark-launch")))
+	{
+		mProfileOperator = ProManOperator::benchmarklaunch;
+		if (!parser.Found(wxT_2("file"), &mFileOperand))
+		{
+			wxLogError(_("No manifest file specified for launch benchmark"));
+			return false;
+		}
+		// each run is a whole launch, so far fewer are wanted than the default
+		if (!parser.Found(wxT_2("count"), &mCountOperand))
+		{
+			mCountOperand = LAUNCH_BENCHMARK_DEFAULT_RUNS;
+		}
+		else if (mCountOperand <= 0)
+		{
+			wxLogError(_("Count must be a positive number"));
+			return false;
+		}
+	}
+	else if(parser.Found(wxT_2("check-process-supervisor")))
+	{
+		mProfileOperator = ProManOperator::checkprocesssupervisor;
+		if (!parser.Found(wxT_2("file"), &mFileOperand))
+		{
+			wxLogError(_("No stand-in specified for process supervisor check"));
+			return false;
+		}
+	}
+	else if(parser.Found(wxT_2("check-graphics-modes")))
+	{
+		mProfileOperator = ProManOperator::checkgraphicsmodes;
+	}
 
 	return true;
 }
 
 wxLauncher::wxLauncher()
-	:mProfileOperator(ProManOperator::none),
+	:mCountOperand(100),
+	mProfileOperator(ProManOperator::none),
 	mKeepForSessionOnly(false),
 	mShowGUI(false)
 	// The strings init themselves sanely
@@ -217,8 +358,9 @@ bool wxLauncher::OnInit() {
 		}
 	}
 
+	// operators run without any GUI, so there is nothing to splash over
 	wxSplashScreen* splashWindow = NULL;
-	if (!displaySplash(&splashWindow))
+	if (mProfileOperator == ProManOperator::none && !displaySplash(&splashWindow))
 		return false;
 
 	wxLogInfo(wxT_2("Initializing profiles..."));
@@ -265,6 +407,7 @@ bool wxLauncher::OnInit() {
 	// since initial profile switch takes place before TCManager has been initialized
 	// calling it here to ensure that AdvSettingsPage is set up by the time events are triggered
 	wxCommandEvent tcMgrInitEvent;
+	tcMgrInitEvent.SetInt(ProMan::PROFILE_CHANGED_ALL);
 	TCManager::Get()->CurrentProfileChanged(tcMgrInitEvent);
 
 	wxLogStatus(_("Ready."));
@@ -279,7 +422,9 @@ int wxLauncher::OnExit() {
 	{
 
 		// deinitialize subsystems in the opposite order of initialization
+		ResolutionMan::DeInitialize();
 		ProfileProxy::DeInitialize();
+		ExecutableCatalog::DeInitialize();
 		FlagListManager::DeInitialize();
 		HelpManager::DeInitialize();
 		SkinSystem::DeInitialize();
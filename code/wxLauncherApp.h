@@ -33,6 +33,7 @@ public:
 
 	wxString mFileOperand;
 	wxString mProfileOperand;
+	long mCountOperand;
 	ProManOperator::profileOperator mProfileOperator;
 	bool mKeepForSessionOnly;
 	bool mShowGUI;
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Stands in for fs2_open when checking the launch benchmark
+# (--benchmark-launch) or the process supervisor
+# (--check-process-supervisor) without the game. FS2 Open's own flags are
+# ignored.
+#
+#   -sleep SECONDS      how long to "run" for, default 0
+#   -exit CODE          what to exit with, default 0
+#   -metric NAME=VALUE  report a measurement, may be given more than once
+#   -ignore-term        ignore SIGTERM, so it has to be killed
+#
+# Besides any -metric, it reports how long it slept as slept_ms.
+
+sleep_seconds=0
+exit_code=0
+metrics=""
+
+while [ $# -gt 0 ]; do
+	case "$1" in
+		-sleep) sleep_seconds="$2"; shift 2 ;;
+		-exit) exit_code="$2"; shift 2 ;;
+		-metric) metrics="$metrics $2"; shift 2 ;;
+		-ignore-term) trap '' TERM; shift ;;
+		*) shift ;;
+	esac
+done
+
+started=$(date +%s%N)
+sleep "$sleep_seconds"
+finished=$(date +%s%N)
+
+for metric in $metrics; do
+	echo "METRIC ${metric%%=*} = ${metric#*=}"
+done
+echo "METRIC slept_ms = $(( (finished - started) / 1000000 ))"
+
+exit "$exit_code"
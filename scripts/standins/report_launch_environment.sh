@@ -0,0 +1,28 @@
+#!/bin/sh
+# Stands in for fs2_open to show what a launch preset and a profile's CPU
+# list did to the process: the CPUs it may run on, its priority, its I/O
+# priority and the variables the presets set. The report goes to stderr,
+# which the launch benchmark passes on; the priority and the number of CPUs
+# are also printed as METRIC lines, so the benchmark compares them.
+# FS2 Open's own flags are ignored.
+
+{
+	echo "== $0 (pid $$)"
+	grep '^Cpus_allowed' /proc/self/status
+	echo "nice: $(nice)"
+	echo "ionice: $(ionice -p $$ 2>&1)"
+	for name in __GL_THREADED_OPTIMIZATIONS mesa_glthread __GL_SYNC_TO_VBLANK \
+		vblank_mode GLIBC_TUNABLES; do
+		eval "value=\${$name-(unset)}"
+		echo "$name=$value"
+	done
+} >&2
+
+cpus=0
+for range in $(sed -n 's/^Cpus_allowed_list:[[:space:]]*//p' /proc/self/status | tr ',' ' '); do
+	first=${range%-*}
+	last=${range#*-}
+	cpus=$((cpus + last - first + 1))
+done
+echo "METRIC nice = $(nice)"
+echo "METRIC cpus = $cpus"